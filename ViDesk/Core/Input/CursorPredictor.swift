@@ -0,0 +1,91 @@
+import Foundation
+import QuartzCore
+
+/// 光标预测
+/// 本地光标在手势发生时立即移动到预测位置，不等待服务器往返；
+/// 服务器的指针位置更新到达时与最近发出的位置比对：与其中之一吻合说明是对本地输入的确认，
+/// 否则视为服务器主动移动了指针 (程序定位光标、光标被限制在窗口内等)，本地光标以服务器为准
+@MainActor
+final class CursorPredictor {
+    // MARK: - 常量
+
+    /// 判定为同一位置的容差 (桌面像素)
+    static let tolerance: CGFloat = 2
+
+    /// 保留已发出位置的时长，覆盖广域网下的往返时间
+    private static let historyWindow: CFTimeInterval = 1.0
+
+    /// 最多保留的已发出位置数
+    private static let maxHistory = 64
+
+    // MARK: - 属性
+
+    /// 预测的光标位置 (纹理坐标)，尚无输入时为 nil
+    private(set) var position: CGPoint?
+
+    /// 服务器确认 / 校正的次数
+    private(set) var confirmedCount: Int = 0
+    private(set) var correctedCount: Int = 0
+
+    private var history: [(point: CGPoint, time: CFTimeInterval)] = []
+
+    // MARK: - 公共方法
+
+    /// 本地输入移动了光标
+    func predict(_ point: CGPoint) {
+        position = point
+    }
+
+    /// 记录一次已发送到服务器的位置
+    func recordSent(_ point: CGPoint) {
+        let now = CACurrentMediaTime()
+        prune(now: now)
+        if history.count == Self.maxHistory {
+            history.removeFirst()
+        }
+        history.append((point, now))
+    }
+
+    /// 处理服务器的指针位置更新
+    /// - Returns: 需要校正时返回服务器位置；是对本地输入的确认时返回 nil
+    func reconcile(server point: CGPoint) -> CGPoint? {
+        prune(now: CACurrentMediaTime())
+
+        // 从最新的往回找：确认之前发出的位置都已被服务器处理
+        if let index = history.lastIndex(where: { matches($0.point, point) }) {
+            history.removeFirst(index + 1)
+            confirmedCount += 1
+            return nil
+        }
+
+        if let position, matches(position, point) {
+            confirmedCount += 1
+            return nil
+        }
+
+        history.removeAll()
+        position = point
+        correctedCount += 1
+        return point
+    }
+
+    /// 清空预测状态 (解除绑定时调用)
+    func reset() {
+        position = nil
+        history.removeAll()
+    }
+
+    // MARK: - 私有方法
+
+    private func matches(_ a: CGPoint, _ b: CGPoint) -> Bool {
+        abs(a.x - b.x) <= Self.tolerance && abs(a.y - b.y) <= Self.tolerance
+    }
+
+    private func prune(now: CFTimeInterval) {
+        if let index = history.firstIndex(where: { now - $0.time <= Self.historyWindow }) {
+            history.removeFirst(index)
+        } else {
+            history.removeAll()
+        }
+    }
+}
@@ -25,6 +25,7 @@ final class GestureTranslator {
     private var lastTapLocation: CGPoint?
     private var isDragging: Bool = false
     private var dragStartLocation: CGPoint?
+    private var isMagnifying: Bool = false
 
     // MARK: - 初始化
 
@@ -92,13 +93,17 @@ final class GestureTranslator {
     }
 
     /// 处理缩放手势
-    /// 映射: 鼠标滚轮
-    func handleMagnification(scale: CGFloat, velocity: CGFloat = 0) {
-        // 将缩放比例转换为滚轮增量
-        // scale > 1 表示放大 (向上滚动)
-        // scale < 1 表示缩小 (向下滚动)
-        let delta = (scale - 1.0) * 120
-        inputManager?.scroll(delta: delta)
+    /// 映射: 鼠标滚轮 (缩放过程中持续发送增量)
+    /// scale > 1 表示放大 (向上滚动)，scale < 1 表示缩小 (向下滚动)
+    func handleMagnification(scale: CGFloat, phase: GesturePhase) {
+        if !isMagnifying {
+            isMagnifying = true
+            inputManager?.handlePinchGesture(scale: 1, phase: .began)
+        }
+        inputManager?.handlePinchGesture(scale: scale, phase: phase)
+        if phase == .ended || phase == .cancelled {
+            isMagnifying = false
+        }
     }
 
     /// 处理旋转手势
@@ -109,16 +114,19 @@ final class GestureTranslator {
     }
 
     /// 处理滑动手势
-    /// 映射: 鼠标滚轮
-    func handleScroll(translation: CGSize, velocity: CGSize) {
-        // 垂直滚动
-        if abs(translation.height) > 1 {
-            inputManager?.scroll(delta: -translation.height)
-        }
-
-        // 水平滚动
-        if abs(translation.width) > 1 {
-            inputManager?.scroll(delta: translation.width, horizontal: true)
+    /// 映射: 鼠标滚轮 (translation 为本次增量，结束时 velocity 用于惯性)
+    func handleScroll(translation: CGSize, velocity: CGSize, phase: GesturePhase) {
+        switch phase {
+        case .began:
+            inputManager?.beginScroll()
+            inputManager?.updateScroll(translation: translation)
+        case .changed:
+            inputManager?.updateScroll(translation: translation)
+        case .ended:
+            inputManager?.updateScroll(translation: translation)
+            inputManager?.endScroll(velocity: velocity)
+        case .cancelled:
+            break
         }
     }
 
@@ -186,8 +194,11 @@ struct VisionOSGestureModifier: ViewModifier {
             )
             .gesture(
                 MagnifyGesture()
+                    .onChanged { value in
+                        translator.handleMagnification(scale: value.magnification, phase: .changed)
+                    }
                     .onEnded { value in
-                        translator.handleMagnification(scale: value.magnification)
+                        translator.handleMagnification(scale: value.magnification, phase: .ended)
                     }
             )
     }
@@ -9,10 +9,25 @@ final class InputManager {
     // MARK: - 属性
 
     /// 当前输入模式
-    var inputMode: InputMode = .pointer
+    var inputMode: InputMode = .pointer {
+        didSet { publishLocalCursor() }
+    }
+
+    /// 鼠标指针位置 (纹理坐标)，即本地预测的光标位置
+    private(set) var cursorPosition: CGPoint = .zero {
+        didSet {
+            cursorPredictor.predict(cursorPosition)
+            publishLocalCursor()
+        }
+    }
 
-    /// 鼠标指针位置 (纹理坐标)
-    private(set) var cursorPosition: CGPoint = .zero
+    /// 是否在本地绘制光标 (直接触控模式下不绘制)
+    var showsLocalCursor: Bool = true {
+        didSet { publishLocalCursor() }
+    }
+
+    /// 本地光标位置变化回调 (纹理坐标，nil 表示隐藏)，渲染器据此绘制光标
+    @ObservationIgnored var onLocalCursorChanged: ((CGPoint?) -> Void)?
 
     /// 鼠标是否按下
     private(set) var isMouseDown: Bool = false
@@ -23,54 +38,99 @@ final class InputManager {
     /// 是否启用惯性滚动
     var enableInertialScroll: Bool = true
 
+    /// 触控板模式和拖拽时优先使用相对移动 (服务器支持 ainput 时)
+    var preferRelativeMotion: Bool = true
+
     // MARK: - 私有属性
 
     private weak var session: RDPSession?
     private var gestureTranslator: GestureTranslator?
     private var keyboardMapper: KeyboardMapper
 
-    private var lastMoveTime: Date = Date()
-    private var moveThrottleInterval: TimeInterval = 1.0 / 120.0
+    /// 鼠标移动合并 (指针移动和拖拽共用，保证顺序)
+    @ObservationIgnored private var motion: MotionCoalescer!
+
+    /// 滚轮累积 (每个显示帧最多发送一次，含本地惯性)
+    @ObservationIgnored private var scroller: ScrollAccumulator!
+
+    /// 双指缩放上一次的比例，用于计算连续增量
+    @ObservationIgnored private var lastPinchScale: CGFloat = 1
+
+    /// 观察到的最高接收速率 (bit/s)，作为链路带宽的下限估计
+    @ObservationIgnored private var observedBandwidth: Int = 0
+
+    /// 服务器不支持触控时，用来模拟鼠标拖拽的手指
+    @ObservationIgnored private var emulatedTouchID: Int?
+
+    /// 服务器端指针最近一次被定位到的位置，相对移动以此为起点计算增量
+    @ObservationIgnored private var lastSentPosition: CGPoint? {
+        didSet {
+            if let lastSentPosition {
+                cursorPredictor.recordSent(lastSentPosition)
+            }
+        }
+    }
+
+    /// 本地光标预测，与服务器的指针位置更新对账
+    @ObservationIgnored private let cursorPredictor = CursorPredictor()
 
     // MARK: - 初始化
 
     init() {
         self.keyboardMapper = KeyboardMapper()
+        self.motion = MotionCoalescer { [weak self] point in
+            self?.sendMotion(to: point)
+        }
+        self.scroller = ScrollAccumulator { [weak self] delta, horizontal in
+            self?.session?.sendMouseWheel(delta: delta, horizontal: horizontal)
+        }
     }
 
     /// 绑定到 RDP 会话
     func bind(to session: RDPSession) {
         self.session = session
         self.gestureTranslator = GestureTranslator(inputManager: self)
+        session.onServerPointerMoved = { [weak self] point in
+            self?.reconcileCursor(withServer: point)
+        }
     }
 
     /// 解除绑定
     func unbind() {
+        motion.reset()
+        scroller.reset()
+        lastSentPosition = nil
+        emulatedTouchID = nil
+        cursorPredictor.reset()
+        session?.onServerPointerMoved = nil
         self.session = nil
         self.gestureTranslator = nil
+        publishLocalCursor()
     }
 
     // MARK: - 鼠标事件
 
-    /// 移动鼠标到指定位置
+    /// 移动鼠标到指定位置 (合并发送，只保留最新位置)
     func moveCursor(to point: CGPoint) {
-        let now = Date()
-        guard now.timeIntervalSince(lastMoveTime) >= moveThrottleInterval else { return }
-        lastMoveTime = now
-
         cursorPosition = point
-        session?.sendMouseMove(x: Int(point.x), y: Int(point.y))
+        submitMotion(point)
     }
 
     /// 鼠标左键单击
     func leftClick(at point: CGPoint) {
         cursorPosition = point
+        motion.flush()
+        scroller.flush()
+        lastSentPosition = point
         session?.sendMouseClick(button: .left, x: Int(point.x), y: Int(point.y))
     }
 
     /// 鼠标左键双击
     func leftDoubleClick(at point: CGPoint) {
         cursorPosition = point
+        motion.flush()
+        scroller.flush()
+        lastSentPosition = point
         session?.sendMouseClick(button: .left, x: Int(point.x), y: Int(point.y))
         session?.sendMouseClick(button: .left, x: Int(point.x), y: Int(point.y))
     }
@@ -78,6 +138,9 @@ final class InputManager {
     /// 鼠标右键单击
     func rightClick(at point: CGPoint) {
         cursorPosition = point
+        motion.flush()
+        scroller.flush()
+        lastSentPosition = point
         session?.sendMouseClick(button: .right, x: Int(point.x), y: Int(point.y))
     }
 
@@ -85,26 +148,137 @@ final class InputManager {
     func beginDrag(at point: CGPoint) {
         cursorPosition = point
         isMouseDown = true
+        motion.flush()
+        scroller.flush()
+        lastSentPosition = point
         session?.sendMouseDown(button: .left, x: Int(point.x), y: Int(point.y))
     }
 
-    /// 拖拽移动
+    /// 拖拽移动 (与指针移动一样合并发送)
     func drag(to point: CGPoint) {
         cursorPosition = point
-        session?.sendMouseMove(x: Int(point.x), y: Int(point.y))
+        submitMotion(point)
     }
 
     /// 结束拖拽
     func endDrag(at point: CGPoint) {
         cursorPosition = point
         isMouseDown = false
+        // 先送出拖拽途中最后的位置和未发完的滚动，再释放按钮
+        motion.flush()
+        scroller.flush()
+        lastSentPosition = point
         session?.sendMouseUp(button: .left, x: Int(point.x), y: Int(point.y))
     }
 
-    /// 滚轮滚动
+    /// 滚轮滚动 (单位 WHEEL_DELTA，累积后按显示帧发送)
     func scroll(delta: CGFloat, horizontal: Bool = false) {
-        let scaledDelta = Int(delta * scrollMultiplier)
-        session?.sendMouseWheel(delta: scaledDelta, horizontal: horizontal)
+        motion.flush()
+        let scaled = delta * scrollMultiplier
+        scroller.add(dx: horizontal ? scaled : 0, dy: horizontal ? 0 : scaled)
+    }
+
+    /// 连续滚动手势开始 (停止正在进行的惯性)
+    func beginScroll() {
+        motion.flush()
+        scroller.stopInertia()
+    }
+
+    /// 连续滚动手势的增量 (视图点数，手指向下/向右为正)
+    func updateScroll(translation: CGSize) {
+        let factor = Self.wheelUnitsPerPoint * scrollMultiplier
+        scroller.add(dx: translation.width * factor, dy: translation.height * factor)
+    }
+
+    /// 连续滚动手势结束，按抬手速度 (点/秒) 开始本地惯性
+    func endScroll(velocity: CGSize) {
+        guard enableInertialScroll else { return }
+        let factor = Self.wheelUnitsPerPoint * scrollMultiplier
+        scroller.startInertia(velocity: CGVector(dx: velocity.width * factor, dy: velocity.height * factor))
+    }
+
+    /// 每个视图点对应的滚轮单位 (一个刻度约 40 点，接近系统默认的三行)
+    private static let wheelUnitsPerPoint: CGFloat = ScrollAccumulator.notch / 40
+
+    /// 拖拽和触控板模式下的移动是连续的增量，适合走相对通道；
+    /// 指针 (眼动) 模式是离散跳转，始终使用绝对坐标
+    private var usesRelativeMotion: Bool {
+        preferRelativeMotion && (isMouseDown || inputMode == .touchpad)
+    }
+
+    /// 发出一次移动：可用时发送相对增量，否则回退到绝对坐标
+    private func sendMotion(to point: CGPoint) {
+        guard let session else { return }
+
+        if usesRelativeMotion, let origin = lastSentPosition,
+           session.sendMouseRelative(dx: point.x - origin.x, dy: point.y - origin.y) {
+            lastSentPosition = point
+            return
+        }
+
+        session.sendMouseMove(x: Int(point.x), y: Int(point.y))
+        lastSentPosition = point
+    }
+
+    /// 按当前链路状况更新发送间隔后提交位置
+    private func submitMotion(_ point: CGPoint) {
+        if let statistics = session?.statistics {
+            observedBandwidth = max(observedBandwidth, statistics.bandwidth)
+            motion.updateLinkConditions(rtt: statistics.latency, bandwidth: observedBandwidth)
+        }
+        motion.submit(point)
+    }
+
+    // MARK: - 本地光标
+
+    /// 本地绘制的光标位置 (纹理坐标)，nil 表示不绘制
+    var localCursorPosition: CGPoint? {
+        guard showsLocalCursor, inputMode != .directTouch, session != nil else { return nil }
+        return cursorPredictor.position
+    }
+
+    private func publishLocalCursor() {
+        onLocalCursorChanged?(localCursorPosition)
+    }
+
+    /// 服务器移动了指针：是对本地输入的确认时忽略，否则本地光标和相对移动的起点都以服务器为准
+    private func reconcileCursor(withServer point: CGPoint) {
+        guard let corrected = cursorPredictor.reconcile(server: point) else { return }
+        motion.reset()
+        cursorPosition = corrected
+        lastSentPosition = corrected
+    }
+
+    // MARK: - 直接触控
+
+    /// 直接触控模式下处理一次触点变化 (不经过 GestureTranslator)
+    /// 服务器支持 RDPEI 时按原样发送触控帧，否则用第一个手指模拟左键拖拽
+    func handleTouches(_ contacts: [TouchContact]) {
+        guard inputMode == .directTouch, !contacts.isEmpty else { return }
+        motion.flush()
+
+        if session?.sendTouchFrame(contacts) == true {
+            if let last = contacts.last {
+                cursorPosition = last.location
+            }
+            return
+        }
+
+        for contact in contacts {
+            switch contact.phase {
+            case .began where emulatedTouchID == nil:
+                emulatedTouchID = contact.id
+                beginDrag(at: contact.location)
+            case .moved where contact.id == emulatedTouchID:
+                drag(to: contact.location)
+            case .ended where contact.id == emulatedTouchID,
+                 .cancelled where contact.id == emulatedTouchID:
+                emulatedTouchID = nil
+                endDrag(at: contact.location)
+            default:
+                break
+            }
+        }
     }
 
     // MARK: - 键盘事件
@@ -112,6 +286,8 @@ final class InputManager {
     /// 处理按键事件
     func handleKeyEvent(_ keyCode: UInt16, characters: String?, modifiers: KeyModifiers, isDown: Bool) {
         guard let scanCode = keyboardMapper.scanCode(for: keyCode) else { return }
+        motion.flush()
+        scroller.flush()
 
         let extended = keyboardMapper.isExtendedKey(keyCode)
         session?.sendKeyEvent(scanCode: scanCode, pressed: isDown, extended: extended)
@@ -132,7 +308,7 @@ final class InputManager {
     /// 处理眼动+捏合手势
     func handleGazePinch(at point: CGPoint, phase: GesturePhase) {
         switch phase {
-        case .began:
+        case .began, .changed:
             moveCursor(to: point)
         case .ended:
             leftClick(at: point)
@@ -149,7 +325,7 @@ final class InputManager {
     /// 处理眼动+长捏手势
     func handleGazeLongPinch(at point: CGPoint, phase: GesturePhase) {
         switch phase {
-        case .began:
+        case .began, .changed:
             moveCursor(to: point)
         case .ended:
             rightClick(at: point)
@@ -163,6 +339,8 @@ final class InputManager {
         switch phase {
         case .began:
             beginDrag(at: point)
+        case .changed:
+            drag(to: point)
         case .ended:
             endDrag(at: point)
         case .cancelled:
@@ -170,12 +348,18 @@ final class InputManager {
         }
     }
 
-    /// 处理双指缩放手势 (映射为滚轮)
+    /// 处理双指缩放手势 (映射为滚轮)，缩放过程中持续发送增量
     func handlePinchGesture(scale: CGFloat, phase: GesturePhase) {
-        guard phase == .ended else { return }
-
-        let delta = (scale - 1.0) * 120
-        scroll(delta: delta)
+        switch phase {
+        case .began:
+            lastPinchScale = scale
+            beginScroll()
+        case .changed, .ended:
+            scroll(delta: (scale - lastPinchScale) * ScrollAccumulator.notch)
+            lastPinchScale = scale
+        case .cancelled:
+            lastPinchScale = 1
+        }
     }
 }
 
@@ -188,9 +372,25 @@ enum InputMode {
     case directTouch  // 直接触控模式
 }
 
+/// 触点阶段
+enum TouchPhase {
+    case began
+    case moved
+    case ended
+    case cancelled
+}
+
+/// 单个触点 (纹理坐标)
+struct TouchContact {
+    let id: Int
+    let location: CGPoint
+    let phase: TouchPhase
+}
+
 /// 手势阶段
 enum GesturePhase {
     case began
+    case changed
     case ended
     case cancelled
 }
@@ -0,0 +1,121 @@
+import Foundation
+
+/// 鼠标移动合并器
+/// 只保留最新位置 (latest-wins)，按链路状况自适应的间隔发送；
+/// 按钮事件前调用 flush()，保证按下/释放之前的最后位置一定已发出
+@MainActor
+final class MotionCoalescer {
+    // MARK: - 常量
+
+    /// 最快发送间隔 (120Hz)
+    static let minInterval: TimeInterval = 1.0 / 120.0
+
+    /// 最慢发送间隔 (20Hz)，再低拖拽就会明显卡顿
+    static let maxInterval: TimeInterval = 1.0 / 20.0
+
+    /// 单条鼠标移动 PDU 在链路上的估计字节数 (fast-path 输入 + TLS/TCP/IP 头)
+    private static let bytesPerMove: Double = 90
+
+    /// 鼠标移动最多占用的链路带宽比例
+    private static let bandwidthShare: Double = 0.05
+
+    // MARK: - 属性
+
+    /// 当前发送间隔
+    private(set) var interval: TimeInterval = MotionCoalescer.minInterval
+
+    /// 已发送/被合并的移动数
+    private(set) var sentCount: Int = 0
+    private(set) var coalescedCount: Int = 0
+
+    private let send: (CGPoint) -> Void
+    private var pending: CGPoint?
+    private var lastSent: CGPoint?
+    private var lastSendTime: Date = .distantPast
+    private var flushTask: Task<Void, Never>?
+
+    // MARK: - 初始化
+
+    init(send: @escaping (CGPoint) -> Void) {
+        self.send = send
+    }
+
+    // MARK: - 公共方法
+
+    /// 提交新位置，覆盖尚未发出的旧位置
+    func submit(_ point: CGPoint) {
+        if pending != nil {
+            coalescedCount += 1
+        }
+        pending = point
+
+        let elapsed = Date().timeIntervalSince(lastSendTime)
+        if elapsed >= interval {
+            flush()
+        } else if flushTask == nil {
+            scheduleFlush(after: interval - elapsed)
+        }
+    }
+
+    /// 立即发出尚未发送的位置 (按钮事件之前调用)
+    func flush() {
+        flushTask?.cancel()
+        flushTask = nil
+
+        guard let point = pending else { return }
+        pending = nil
+
+        // 与上次发出的位置相同 (取整后) 时不重复发送
+        if let last = lastSent, Int(last.x) == Int(point.x), Int(last.y) == Int(point.y) {
+            return
+        }
+
+        lastSent = point
+        lastSendTime = Date()
+        sentCount += 1
+        send(point)
+    }
+
+    /// 丢弃未发送的位置 (解除绑定时调用)
+    func reset() {
+        flushTask?.cancel()
+        flushTask = nil
+        pending = nil
+        lastSent = nil
+        lastSendTime = .distantPast
+    }
+
+    /// 根据链路状况调整发送间隔
+    /// - Parameters:
+    ///   - rtt: 往返时延 (秒)，0 表示未知
+    ///   - bandwidth: 链路带宽 (bit/s)，0 表示未知
+    func updateLinkConditions(rtt: TimeInterval, bandwidth: Int) {
+        var target = Self.minInterval
+
+        // 服务器对每次移动都会回送一帧，RTT 越大，过密的移动只会在链路上排队
+        if rtt > 0 {
+            target = max(target, rtt / 4)
+        }
+
+        // 移动事件只占用链路的一小部分
+        if bandwidth > 0 {
+            let movesPerSecond = Double(bandwidth) * Self.bandwidthShare / 8 / Self.bytesPerMove
+            if movesPerSecond > 0 {
+                target = max(target, 1 / movesPerSecond)
+            }
+        }
+
+        interval = min(max(target, Self.minInterval), Self.maxInterval)
+    }
+
+    // MARK: - 私有方法
+
+    private func scheduleFlush(after delay: TimeInterval) {
+        flushTask = Task { @MainActor [weak self] in
+            try? await Task.sleep(for: .seconds(delay))
+            guard !Task.isCancelled else { return }
+            self?.flushTask = nil
+            self?.flush()
+        }
+    }
+}
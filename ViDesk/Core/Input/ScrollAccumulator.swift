@@ -0,0 +1,165 @@
+import Foundation
+import QuartzCore
+
+/// 滚动累积器
+/// 连续的手势增量先累积，每个显示帧最多发出一个垂直和一个水平滚轮事件；
+/// 不足一个量子的余量留到下一帧，手势结束后在本地按减速曲线继续滚动 (惯性)
+@MainActor
+final class ScrollAccumulator {
+    // MARK: - 常量
+
+    /// 一个滚轮刻度 (WHEEL_DELTA)
+    static let notch: CGFloat = 120
+
+    /// 单个滚轮事件的最大幅度 (PTR_FLAGS_WHEEL 的旋转量只有 8 位)
+    static let maxUnitsPerEvent: CGFloat = 255
+
+    /// 发送量子：累积满四分之一刻度才发送，高精度滚动的应用仍能平滑响应，
+    /// 同时避免每帧都发送 1~2 个单位的微小事件
+    static let quantum: CGFloat = 30
+
+    /// 惯性每毫秒的速度保留比例 (与 UIScrollView 的 normal 减速一致)
+    private static let decelerationRate: CGFloat = 0.998
+
+    /// 惯性速度低于该值 (单位/秒) 时停止
+    private static let minimumVelocity: CGFloat = 40
+
+    // MARK: - 属性
+
+    /// 已发送的事件数
+    private(set) var sentCount: Int = 0
+
+    /// 是否处于惯性滚动中
+    var isDecelerating: Bool { velocity != .zero }
+
+    private let send: (_ delta: Int, _ horizontal: Bool) -> Void
+    private var pending: CGVector = .zero
+    private var velocity: CGVector = .zero
+    private var displayLink: CADisplayLink?
+    private var lastTimestamp: CFTimeInterval = 0
+
+    // MARK: - 初始化
+
+    init(send: @escaping (_ delta: Int, _ horizontal: Bool) -> Void) {
+        self.send = send
+    }
+
+    // MARK: - 公共方法
+
+    /// 累积滚轮增量 (单位：WHEEL_DELTA，正值向上/向右)
+    func add(dx: CGFloat, dy: CGFloat) {
+        pending.dx += dx
+        pending.dy += dy
+        startTicking()
+    }
+
+    /// 新手势开始时停止惯性
+    func stopInertia() {
+        velocity = .zero
+    }
+
+    /// 以手势结束时的速度 (单位/秒) 开始惯性滚动
+    func startInertia(velocity: CGVector) {
+        let speed = hypot(velocity.dx, velocity.dy)
+        guard speed >= Self.minimumVelocity else { return }
+        self.velocity = velocity
+        startTicking()
+    }
+
+    /// 立即发出余量 (按钮和按键事件之前调用)
+    func flush() {
+        emit(force: true)
+    }
+
+    /// 丢弃未发送的增量并停止惯性
+    func reset() {
+        pending = .zero
+        velocity = .zero
+        stopTicking()
+    }
+
+    // MARK: - 私有方法
+
+    private func startTicking() {
+        guard displayLink == nil else { return }
+        let link = CADisplayLink(target: DisplayLinkTarget(self), selector: #selector(DisplayLinkTarget.tick(_:)))
+        link.add(to: .main, forMode: .common)
+        displayLink = link
+        lastTimestamp = 0
+    }
+
+    private func stopTicking() {
+        displayLink?.invalidate()
+        displayLink = nil
+    }
+
+    fileprivate func tick(_ link: CADisplayLink) {
+        let dt = lastTimestamp > 0 ? link.timestamp - lastTimestamp : link.duration
+        lastTimestamp = link.timestamp
+
+        if velocity != .zero {
+            pending.dx += velocity.dx * dt
+            pending.dy += velocity.dy * dt
+
+            let decay = pow(Self.decelerationRate, dt * 1000)
+            velocity.dx *= decay
+            velocity.dy *= decay
+            if hypot(velocity.dx, velocity.dy) < Self.minimumVelocity {
+                velocity = .zero
+            }
+        }
+
+        emit(force: false)
+
+        // 没有惯性且余量不足一个量子时，发出余量后停止，保证总滚动量不丢失
+        if velocity == .zero && abs(pending.dx) < Self.quantum && abs(pending.dy) < Self.quantum {
+            emit(force: true)
+            stopTicking()
+        }
+    }
+
+    /// 每个轴最多发出一个事件；force 时发出不足量子的余量
+    private func emit(force: Bool) {
+        if let delta = take(&pending.dy, force: force) {
+            sentCount += 1
+            send(delta, false)
+        }
+        if let delta = take(&pending.dx, force: force) {
+            sentCount += 1
+            send(delta, true)
+        }
+    }
+
+    private func take(_ value: inout CGFloat, force: Bool) -> Int? {
+        let threshold = force ? 1 : Self.quantum
+        guard abs(value) >= threshold else { return nil }
+
+        var units = min(abs(value), Self.maxUnitsPerEvent)
+        if !force {
+            units = (units / Self.quantum).rounded(.down) * Self.quantum
+        }
+        units = units.rounded(.down)
+
+        let delta = value < 0 ? -units : units
+        value -= delta
+        return Int(delta)
+    }
+}
+
+/// CADisplayLink 强引用 target，通过弱引用转发避免循环引用
+private final class DisplayLinkTarget: NSObject {
+    private weak var accumulator: ScrollAccumulator?
+
+    init(_ accumulator: ScrollAccumulator) {
+        self.accumulator = accumulator
+    }
+
+    @MainActor
+    @objc func tick(_ link: CADisplayLink) {
+        guard let accumulator else {
+            link.invalidate()
+            return
+        }
+        accumulator.tick(link)
+    }
+}
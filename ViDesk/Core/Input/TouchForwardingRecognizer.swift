@@ -0,0 +1,87 @@
+import UIKit
+
+/// 原始触点转发识别器
+/// 直接触控模式下不识别任何手势，只把每次触点变化原样回调，
+/// 回调频率即系统的触摸采样频率
+final class TouchForwardingRecognizer: UIGestureRecognizer {
+    /// 单个触点变化 (视图坐标)
+    typealias Touch = (id: Int, location: CGPoint, phase: TouchPhase)
+
+    /// 触点变化回调
+    var onTouches: (@MainActor ([Touch]) -> Void)?
+
+    /// RDPEI 允许的最大同时触点数
+    static let maxContacts = 10
+
+    /// UITouch 到触点编号的映射，编号在手指抬起后复用
+    private var touchIDs: [ObjectIdentifier: Int] = [:]
+
+    override init(target: Any?, action: Selector?) {
+        super.init(target: target, action: action)
+        cancelsTouchesInView = false
+        delaysTouchesBegan = false
+        delaysTouchesEnded = false
+    }
+
+    override func touchesBegan(_ touches: Set<UITouch>, with event: UIEvent) {
+        var contacts: [Touch] = []
+        for touch in touches {
+            guard let id = allocateID(for: touch) else { continue }
+            contacts.append((id, touch.location(in: view), .began))
+        }
+        deliver(contacts)
+        state = state == .possible ? .began : .changed
+    }
+
+    override func touchesMoved(_ touches: Set<UITouch>, with event: UIEvent) {
+        let contacts = touches.compactMap { touch -> Touch? in
+            guard let id = touchIDs[ObjectIdentifier(touch)] else { return nil }
+            return (id, touch.location(in: view), .moved)
+        }
+        deliver(contacts)
+        state = .changed
+    }
+
+    override func touchesEnded(_ touches: Set<UITouch>, with event: UIEvent) {
+        finish(touches, phase: .ended)
+        if touchIDs.isEmpty {
+            state = .ended
+        }
+    }
+
+    override func touchesCancelled(_ touches: Set<UITouch>, with event: UIEvent) {
+        finish(touches, phase: .cancelled)
+        if touchIDs.isEmpty {
+            state = .cancelled
+        }
+    }
+
+    override func reset() {
+        super.reset()
+        touchIDs.removeAll()
+    }
+
+    // MARK: - 私有方法
+
+    private func allocateID(for touch: UITouch) -> Int? {
+        let used = Set(touchIDs.values)
+        guard let id = (0..<Self.maxContacts).first(where: { !used.contains($0) }) else {
+            return nil
+        }
+        touchIDs[ObjectIdentifier(touch)] = id
+        return id
+    }
+
+    private func finish(_ touches: Set<UITouch>, phase: TouchPhase) {
+        let contacts = touches.compactMap { touch -> Touch? in
+            guard let id = touchIDs.removeValue(forKey: ObjectIdentifier(touch)) else { return nil }
+            return (id, touch.location(in: view), phase)
+        }
+        deliver(contacts)
+    }
+
+    private func deliver(_ contacts: [Touch]) {
+        guard !contacts.isEmpty else { return }
+        onTouches?(contacts)
+    }
+}
@@ -4,11 +4,27 @@
  */
 
 #include "FreeRDPBridge.h"
+#include "ViDeskSendScheduler.h"
+#include "ViDeskThreadRoles.h"
+#include "ViDeskLatencyTracker.h"
+#include "ViDeskInputRecorder.h"
+#include "ViDeskPointerCache.h"
+#include "ViDeskSessionStats.h"
+#include "ViDeskQualityController.h"
+#include "ViDeskSessionDump.h"
+#include "ViDeskTransport.h"
+#include "ViDeskReconnect.h"
+#include "ViDeskPrewarm.h"
+#include "ViDeskLiveness.h"
+#include "ViDeskWanEmulator.h"
+#include "ViDeskChannelStats.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 // FreeRDP 头文件
 #include <freerdp/freerdp.h>
@@ -25,45 +41,99 @@
 #include <freerdp/channels/cliprdr.h>
 #include <freerdp/client/cliprdr.h>
 #include <freerdp/channels/disp.h>
+#include <freerdp/client/disp.h>
 #include <freerdp/channels/drdynvc.h>
+#include <freerdp/channels/ainput.h>
+#include <freerdp/client/ainput.h>
+#include <freerdp/client/rdpei.h>
 #include <freerdp/addin.h>
 #include <freerdp/event.h>
+#include <freerdp/transport_io.h>
 
 #include <winpr/crt.h>
 #include <winpr/string.h>
 #include <winpr/synch.h>
 #include <winpr/thread.h>
 #include <winpr/collections.h>
+#include <winpr/stream.h>
 
 #define TAG "viDesk"
 
 // === 日志系统 ===
-static FILE* g_logFile = NULL;
+// 默认日志路径是进程级配置 (由 FileLogger 在启动时设置)，
+// 每个上下文创建时各自打开一个 FILE*，会话之间不共享可变的日志状态
+static pthread_mutex_t g_logConfigLock = PTHREAD_MUTEX_INITIALIZER;
+static char* g_defaultLogPath = NULL;
+static FILE* g_defaultLogFile = NULL;
 
 void viDesk_setLogFile(const char* path) {
-    if (g_logFile) {
-        fclose(g_logFile);
-        g_logFile = NULL;
+    pthread_mutex_lock(&g_logConfigLock);
+    if (g_defaultLogFile) {
+        fclose(g_defaultLogFile);
+        g_defaultLogFile = NULL;
     }
-    if (path) {
-        g_logFile = fopen(path, "a");
+    free(g_defaultLogPath);
+    g_defaultLogPath = path ? _strdup(path) : NULL;
+    if (g_defaultLogPath) {
+        g_defaultLogFile = fopen(g_defaultLogPath, "a");
     }
+    pthread_mutex_unlock(&g_logConfigLock);
 }
 
-static void viDesk_log(const char* format, ...) {
+static FILE* viDesk_openDefaultLogFile(void) {
+    FILE* file = NULL;
+    pthread_mutex_lock(&g_logConfigLock);
+    if (g_defaultLogPath) {
+        file = fopen(g_defaultLogPath, "a");
+    }
+    pthread_mutex_unlock(&g_logConfigLock);
+    return file;
+}
+
+static void viDesk_lockContext(ViDeskContext* ctx);
+static void viDesk_unlockContext(ViDeskContext* ctx);
+
+static void viDesk_log(ViDeskContext* ctx, const char* format, ...) {
     va_list args;
     va_start(args, format);
     vprintf(format, args);
     va_end(args);
 
-    if (g_logFile) {
+    // 会话的日志句柄可能被 viDesk_setContextLogFile 替换，写入和替换都持有上下文的锁
+    if (ctx) {
+        viDesk_lockContext(ctx);
+        FILE* file = (FILE*)ctx->logFile;
+        if (file) {
+            va_start(args, format);
+            vfprintf(file, format, args);
+            va_end(args);
+            fflush(file);
+        }
+        viDesk_unlockContext(ctx);
+        return;
+    }
+
+    // 无上下文时写入默认日志文件
+    pthread_mutex_lock(&g_logConfigLock);
+    if (g_defaultLogFile) {
         va_start(args, format);
-        vfprintf(g_logFile, format, args);
+        vfprintf(g_defaultLogFile, format, args);
         va_end(args);
-        fflush(g_logFile);
+        fflush(g_defaultLogFile);
     }
+    pthread_mutex_unlock(&g_logConfigLock);
 }
 
+// 触控统计计数器：UI 线程发送触控帧，事件处理线程记录延迟，字段各自原子更新
+typedef struct {
+    _Atomic uint32_t frames;
+    _Atomic uint32_t contacts;
+    _Atomic uint32_t latencySamples;
+    _Atomic uint64_t latencyTotalNs;
+    _Atomic uint64_t latencyMaxNs;
+    _Atomic uint64_t lastLatencyNs;
+} ViDeskTouchCounters;
+
 // 扩展上下文结构 - 继承 rdpClientContext
 typedef struct {
     rdpClientContext common;  // 必须在第一位
@@ -76,49 +146,191 @@ typedef struct {
     char* remoteClipboardText;      // 缓存的远程剪贴板文本
     char* localClipboardText;       // 待发送到远程的本地文本
     UINT32 cliprdrCapabilities;     // 服务器能力标志
+
+    // 保护 viDeskCtx->lastError 和 logFile 的读写 (事件线程写，UI 线程读或替换)
+    CRITICAL_SECTION errorLock;
+
+    // 事件处理线程消耗的 CPU 时间 (纳秒，不含等待)，UI 线程读取
+    _Atomic uint64_t processingCpuNs;
+
+    // 出站发送调度 (大通道消息分片，输入和帧确认优先)
+    ViDeskSendScheduler* sendScheduler;
+
+    // ainput 高级输入通道 (服务器支持时由 DRDYNVC 打开)
+    AInputClientContext* ainput;
+    double relativeResidualX;       // 相对移动不足 1 像素的累积余量
+    double relativeResidualY;
+
+    // RDPEI 多点触控通道 (服务器支持时由 DRDYNVC 打开)
+    RdpeiClientContext* rdpei;
+    ViDeskTouchCounters touchStats;
+    _Atomic uint64_t touchPendingNs;    // 最早一个尚未见到帧更新的触控帧的发送时间 (0 表示无)
+
+    // 输入到上屏延迟跟踪，以及最近一次已知的指针位置 (滚轮等无坐标输入使用)
+    ViDeskLatencyTracker* latencyTracker;
+    // 输入线程和事件处理线程 (服务器移动指针) 都会写，打包成一个原子值保证 x/y 成对：
+    // 第 63 位表示已知，低 32 位为 x << 16 | y (与协议一致，坐标为 16 位)
+    _Atomic uint64_t pointerPosition;
+
+    // 输入录制与回放
+    ViDeskInputRecorder* inputRecorder;
+    atomic_bool replayCancelled;
+    atomic_bool headlessPresentation;   // 无渲染器时帧更新即视为已呈现
+
+    // 服务器光标形状 (按缓存槽保存转换后的图像)
+    ViDeskPointerCache* pointerCache;
+
+    // 帧率、解码字节、往返时间统计，以及被包装的原始回调
+    ViDeskSessionStatsTracker* sessionStats;
+    pcRdpgfxEndFrame gfxEndFrame;
+    pcRdpgfxSurfaceCommand gfxSurfaceCommand;
+    pSurfaceBits surfaceBits;
+    pBitmapUpdate bitmapUpdate;
+    pNetworkCharacteristicsResult networkCharacteristicsResult;
+    pNetworkCharacteristicsSync networkCharacteristicsSync;
+
+    // 自适应画质：控制器决策，桥接层在事件处理线程上应用
+    ViDeskQualityController* qualityController;
+    _Atomic int qualityEnableRequest;       // -1 无请求，0 停用，1 启用
+    DispClientContext* disp;
+    bool dispReady;                         // 已收到 DISP 能力，可以请求分辨率
+    uint32_t qualityBaseWidth;              // 首次连接时请求的分辨率，DISP 缩放的基准
+    uint32_t qualityBaseHeight;
+    uint32_t qualityResolutionPercent;      // 最近一次请求的分辨率比例
+    uint32_t resolutionRequests;
+    bool effectsReduced;                    // 已精简视觉效果，以及精简前的设置
+    bool savedDisableWallpaper;
+    bool savedDisableFullWindowDrag;
+    bool savedDisableMenuAnims;
+
+    // 帧确认节流：渲染器落后超过 frameAckDepth 帧时暂停读取入站数据
+    _Atomic uint32_t frameAckDepth;
+    _Atomic uint64_t lastFrameSequence;     // 最近交给渲染器的帧序号
+    _Atomic uint64_t lastPresentedSequence; // 渲染器已呈现的最大帧序号
+    _Atomic uint64_t throttleSinceNs;       // 开始落后的时刻 (0 表示未落后)
+    _Atomic uint64_t throttledNs;
+
+    // 池化接收缓冲区的传输层
+    ViDeskTransport* transport;
+
+    // 批量压缩级别 (PreConnect 中写入设置)
+    ViDeskCompressionLevel compressionLevel;
+
+    // 会话录制/回放，以及回放基准的时间点 (单调时钟，0 表示尚未到达)
+    ViDeskSessionDumpMode dumpMode;
+    _Atomic uint64_t replayStartNs;
+    _Atomic uint64_t replayConnectedNs;
+    _Atomic uint64_t replayFirstFrameNs;
+    _Atomic uint64_t replayEndNs;
+
+    // 保留上下文的快速重连；reconnecting 期间 viDesk_disconnect 只中止重连
+    ViDeskReconnect* reconnect;
+    atomic_bool reconnecting;
+
+    // 连接存活检测：入站数据和服务器心跳刷新，事件处理时检查
+    ViDeskLiveness* liveness;
+
+    // 虚拟通道统计：收发通道数据时累计，事件处理线程每秒采样
+    ViDeskChannelStatsTracker* channelStats;
+    pReceiveChannelData receiveChannelData;     // freerdp_new 设置的默认实现
 } ViDeskClientContext;
 
-// 全局回调
-static ViDeskCallbacks g_callbacks = {0};
-static char* g_lastError = NULL;
+// 当前线程已消耗的 CPU 时间 (纳秒)
+static uint64_t viDesk_threadCpuTimeNs(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t viDesk_monotonicNs(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 无上下文时 (如创建上下文失败) 的错误消息，按线程保存
+static _Thread_local char t_lastError[VIDESK_MAX_ERROR_LENGTH];
 
 // 辅助函数
-static void setLastError(const char* error) {
-    if (g_lastError) {
-        free(g_lastError);
-        g_lastError = NULL;
-    }
-    if (error) {
-        g_lastError = _strdup(error);
+static ViDeskContext* viDesk_contextFromRdp(rdpContext* context) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
+    return viCtx ? viCtx->viDeskCtx : NULL;
+}
+
+// 上下文的 FreeRDP 部分创建之前 (或已释放) 没有锁，此时也不会有其他线程访问
+static void viDesk_lockContext(ViDeskContext* ctx) {
+    if (ctx && ctx->rdpCtx)
+        EnterCriticalSection(&((ViDeskClientContext*)ctx->rdpCtx)->errorLock);
+}
+
+static void viDesk_unlockContext(ViDeskContext* ctx) {
+    if (ctx && ctx->rdpCtx)
+        LeaveCriticalSection(&((ViDeskClientContext*)ctx->rdpCtx)->errorLock);
+}
+
+static void setLastError(ViDeskContext* ctx, const char* error) {
+    if (!ctx || !ctx->rdpCtx) {
+        snprintf(t_lastError, sizeof(t_lastError), "%s", error ? error : "");
+        return;
     }
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    EnterCriticalSection(&viCtx->errorLock);
+    snprintf(ctx->lastError, sizeof(ctx->lastError), "%s", error ? error : "");
+    LeaveCriticalSection(&viCtx->errorLock);
 }
 
 static void notifyStateChange(ViDeskContext* ctx, int state, const char* message) {
-    if (g_callbacks.onConnectionStateChanged && ctx && ctx->swiftCallbackContext) {
-        g_callbacks.onConnectionStateChanged(ctx->swiftCallbackContext, state, message);
+    if (ctx && ctx->callbacks.onConnectionStateChanged && ctx->swiftCallbackContext) {
+        ctx->callbacks.onConnectionStateChanged(ctx->swiftCallbackContext, state, message);
     }
 }
 
-static void notifyFrameUpdate(ViDeskContext* ctx, int x, int y, int width, int height) {
-    if (g_callbacks.onFrameUpdate && ctx && ctx->swiftCallbackContext) {
-        g_callbacks.onFrameUpdate(ctx->swiftCallbackContext, x, y, width, height);
+static void notifyFrameUpdate(ViDeskContext* ctx, int x, int y, int width, int height, uint64_t sequence) {
+    if (ctx && ctx->callbacks.onFrameUpdate && ctx->swiftCallbackContext) {
+        ctx->callbacks.onFrameUpdate(ctx->swiftCallbackContext, x, y, width, height, sequence);
     }
 }
 
 static void notifyDesktopResize(ViDeskContext* ctx, int width, int height) {
-    if (g_callbacks.onDesktopResize && ctx && ctx->swiftCallbackContext) {
-        g_callbacks.onDesktopResize(ctx->swiftCallbackContext, width, height);
+    if (ctx && ctx->callbacks.onDesktopResize && ctx->swiftCallbackContext) {
+        ctx->callbacks.onDesktopResize(ctx->swiftCallbackContext, width, height);
     }
 }
 
 static void notifyRemoteClipboardChanged(ViDeskContext* ctx, const char* text) {
-    if (g_callbacks.onRemoteClipboardChanged && ctx && ctx->swiftCallbackContext) {
-        g_callbacks.onRemoteClipboardChanged(ctx->swiftCallbackContext, text);
+    if (ctx && ctx->callbacks.onRemoteClipboardChanged && ctx->swiftCallbackContext) {
+        ctx->callbacks.onRemoteClipboardChanged(ctx->swiftCallbackContext, text);
+    }
+}
+
+static void notifyPointerPosition(ViDeskContext* ctx, int x, int y) {
+    if (ctx && ctx->callbacks.onPointerPosition && ctx->swiftCallbackContext) {
+        ctx->callbacks.onPointerPosition(ctx->swiftCallbackContext, x, y);
+    }
+}
+
+static void notifyPointerShape(ViDeskContext* ctx, ViDeskPointerKind kind, const ViDeskPointerImage* image) {
+    if (ctx && ctx->callbacks.onPointerShape && ctx->swiftCallbackContext) {
+        if (image) {
+            ctx->callbacks.onPointerShape(ctx->swiftCallbackContext, kind, image->pixels,
+                                          (int)image->width, (int)image->height,
+                                          (int)image->hotspotX, (int)image->hotspotY);
+        } else {
+            ctx->callbacks.onPointerShape(ctx->swiftCallbackContext, kind, NULL, 0, 0, 0, 0);
+        }
     }
 }
 
 // === cliprdr 剪贴板通道回调 ===
 
+static ViDeskContext* viDesk_contextFromCliprdr(CliprdrClientContext* cliprdr) {
+    ViDeskClientContext* viCtx = cliprdr ? (ViDeskClientContext*)cliprdr->custom : NULL;
+    return viCtx ? viCtx->viDeskCtx : NULL;
+}
+
 static UINT viDesk_cliprdr_send_client_capabilities(CliprdrClientContext* cliprdr) {
     CLIPRDR_CAPABILITIES caps = {0};
     CLIPRDR_GENERAL_CAPABILITY_SET generalCaps = {0};
@@ -166,7 +378,7 @@ static UINT viDesk_cliprdr_ServerCapabilities(CliprdrClientContext* cliprdr,
         }
     }
 
-    viDesk_log("[ViDesk] cliprdr: 接收服务器能力\n");
+    viDesk_log(viDesk_contextFromCliprdr(cliprdr), "[ViDesk] cliprdr: 接收服务器能力\n");
     return CHANNEL_RC_OK;
 }
 
@@ -175,7 +387,7 @@ static UINT viDesk_cliprdr_MonitorReady(CliprdrClientContext* cliprdr,
     if (!cliprdr || !monitorReady)
         return ERROR_INVALID_PARAMETER;
 
-    viDesk_log("[ViDesk] cliprdr: MonitorReady - 发送客户端能力和格式列表\n");
+    viDesk_log(viDesk_contextFromCliprdr(cliprdr), "[ViDesk] cliprdr: MonitorReady - 发送客户端能力和格式列表\n");
 
     UINT rc = viDesk_cliprdr_send_client_capabilities(cliprdr);
     if (rc != CHANNEL_RC_OK)
@@ -207,7 +419,7 @@ static UINT viDesk_cliprdr_ServerFormatList(CliprdrClientContext* cliprdr,
     }
 
     if (requestFormat != 0) {
-        viDesk_log("[ViDesk] cliprdr: 服务器有文本格式 %u，请求数据\n", requestFormat);
+        viDesk_log(viDesk_contextFromCliprdr(cliprdr), "[ViDesk] cliprdr: 服务器有文本格式 %u，请求数据\n", requestFormat);
         CLIPRDR_FORMAT_DATA_REQUEST request = {0};
         request.common.msgType = CB_FORMAT_DATA_REQUEST;
         request.requestedFormatId = requestFormat;
@@ -270,7 +482,7 @@ static UINT viDesk_cliprdr_ServerFormatDataResponse(CliprdrClientContext* cliprd
         return ERROR_INVALID_PARAMETER;
 
     if (response->common.msgFlags & CB_RESPONSE_FAIL) {
-        viDesk_log("[ViDesk] cliprdr: 服务器拒绝提供数据\n");
+        viDesk_log(viDesk_contextFromCliprdr(cliprdr), "[ViDesk] cliprdr: 服务器拒绝提供数据\n");
         return CHANNEL_RC_OK;
     }
 
@@ -304,7 +516,7 @@ static UINT viDesk_cliprdr_ServerFormatDataResponse(CliprdrClientContext* cliprd
     }
 
     if (viCtx->remoteClipboardText && viCtx->viDeskCtx) {
-        viDesk_log("[ViDesk] cliprdr: 收到远程剪贴板文本 (%zu 字节)\n",
+        viDesk_log(viCtx->viDeskCtx, "[ViDesk] cliprdr: 收到远程剪贴板文本 (%zu 字节)\n",
             strlen(viCtx->remoteClipboardText));
         notifyRemoteClipboardChanged(viCtx->viDeskCtx, viCtx->remoteClipboardText);
     }
@@ -342,7 +554,7 @@ static BOOL viDesk_cliprdr_init(ViDeskClientContext* viCtx, CliprdrClientContext
     cliprdr->ServerLockClipboardData = viDesk_cliprdr_ServerLockClipboardData;
     cliprdr->ServerUnlockClipboardData = viDesk_cliprdr_ServerUnlockClipboardData;
 
-    viDesk_log("[ViDesk] cliprdr: 初始化完成\n");
+    viDesk_log(viCtx->viDeskCtx, "[ViDesk] cliprdr: 初始化完成\n");
     return TRUE;
 }
 
@@ -360,7 +572,7 @@ static BOOL viDesk_cliprdr_uninit(ViDeskClientContext* viCtx, CliprdrClientConte
 
     viCtx->cliprdr = NULL;
 
-    viDesk_log("[ViDesk] cliprdr: 清理完成\n");
+    viDesk_log(viCtx->viDeskCtx, "[ViDesk] cliprdr: 清理完成\n");
     return TRUE;
 }
 
@@ -371,6 +583,7 @@ static BOOL viDesk_LoadChannels(freerdp* instance) {
 
     rdpSettings* settings = instance->context->settings;
     rdpChannels* channels = instance->context->channels;
+    ViDeskContext* ctx = viDesk_contextFromRdp(instance->context);
 
     // 添加 RDPGFX 动态通道（GNOME Remote Desktop 必需）
     if (freerdp_settings_get_bool(settings, FreeRDP_SupportGraphicsPipeline)) {
@@ -386,6 +599,21 @@ static BOOL viDesk_LoadChannels(freerdp* instance) {
             return FALSE;
     }
 
+    // ainput 高级输入通道 (相对鼠标移动)，仅在框架包含该插件时注册，
+    // 服务器不支持时不会打开该通道，输入回退到 fast-path 绝对坐标
+    if (freerdp_load_channel_addin_entry(AINPUT_CHANNEL_NAME, NULL, NULL, FREERDP_ADDIN_CHANNEL_DYNAMIC)) {
+        const char* const params[] = { AINPUT_CHANNEL_NAME };
+        if (!freerdp_client_add_dynamic_channel(settings, 1, params))
+            return FALSE;
+    }
+
+    // RDPEI 多点触控通道，同样只在框架包含该插件时注册
+    if (freerdp_load_channel_addin_entry(RDPEI_CHANNEL_NAME, NULL, NULL, FREERDP_ADDIN_CHANNEL_DYNAMIC)) {
+        const char* const params[] = { RDPEI_CHANNEL_NAME };
+        if (!freerdp_client_add_dynamic_channel(settings, 1, params))
+            return FALSE;
+    }
+
     // 如果有动态通道，启用动态通道支持并加载 DRDYNVC SVC
     if (freerdp_settings_get_uint32(settings, FreeRDP_DynamicChannelCount) > 0) {
         if (!freerdp_settings_set_bool(settings, FreeRDP_SupportDynamicChannels, TRUE))
@@ -402,10 +630,10 @@ static BOOL viDesk_LoadChannels(freerdp* instance) {
         if (pvce) {
             PVIRTUALCHANNELENTRYEX pvceex = (PVIRTUALCHANNELENTRYEX)pvce;
             if (freerdp_channels_client_load_ex(channels, settings, pvceex, settings) != 0) {
-                viDesk_log("[ViDesk] LoadChannels: 加载 DRDYNVC (EntryEx) 失败\n");
+                viDesk_log(ctx, "[ViDesk] LoadChannels: 加载 DRDYNVC (EntryEx) 失败\n");
                 return FALSE;
             }
-            viDesk_log("[ViDesk] LoadChannels: DRDYNVC (EntryEx) 加载成功\n");
+            viDesk_log(ctx, "[ViDesk] LoadChannels: DRDYNVC (EntryEx) 加载成功\n");
         } else {
             // 回退到普通入口
             PVIRTUALCHANNELENTRY entry = freerdp_load_channel_addin_entry(
@@ -413,12 +641,12 @@ static BOOL viDesk_LoadChannels(freerdp* instance) {
                 FREERDP_ADDIN_CHANNEL_STATIC);
             if (entry) {
                 if (freerdp_channels_client_load(channels, settings, entry, settings) != 0) {
-                    viDesk_log("[ViDesk] LoadChannels: 加载 DRDYNVC 失败\n");
+                    viDesk_log(ctx, "[ViDesk] LoadChannels: 加载 DRDYNVC 失败\n");
                     return FALSE;
                 }
-                viDesk_log("[ViDesk] LoadChannels: DRDYNVC 加载成功\n");
+                viDesk_log(ctx, "[ViDesk] LoadChannels: DRDYNVC 加载成功\n");
             } else {
-                viDesk_log("[ViDesk] LoadChannels: 找不到 DRDYNVC 通道入口\n");
+                viDesk_log(ctx, "[ViDesk] LoadChannels: 找不到 DRDYNVC 通道入口\n");
                 return FALSE;
             }
         }
@@ -433,9 +661,9 @@ static BOOL viDesk_LoadChannels(freerdp* instance) {
         if (cliprdrEntry) {
             PVIRTUALCHANNELENTRYEX cliprdrEntryEx = (PVIRTUALCHANNELENTRYEX)cliprdrEntry;
             if (freerdp_channels_client_load_ex(channels, settings, cliprdrEntryEx, settings) != 0) {
-                viDesk_log("[ViDesk] LoadChannels: 加载 cliprdr (EntryEx) 失败\n");
+                viDesk_log(ctx, "[ViDesk] LoadChannels: 加载 cliprdr (EntryEx) 失败\n");
             } else {
-                viDesk_log("[ViDesk] LoadChannels: cliprdr (EntryEx) 加载成功\n");
+                viDesk_log(ctx, "[ViDesk] LoadChannels: cliprdr (EntryEx) 加载成功\n");
             }
         } else {
             PVIRTUALCHANNELENTRY entry = freerdp_load_channel_addin_entry(
@@ -443,17 +671,17 @@ static BOOL viDesk_LoadChannels(freerdp* instance) {
                 FREERDP_ADDIN_CHANNEL_STATIC);
             if (entry) {
                 if (freerdp_channels_client_load(channels, settings, entry, settings) != 0) {
-                    viDesk_log("[ViDesk] LoadChannels: 加载 cliprdr 失败\n");
+                    viDesk_log(ctx, "[ViDesk] LoadChannels: 加载 cliprdr 失败\n");
                 } else {
-                    viDesk_log("[ViDesk] LoadChannels: cliprdr 加载成功\n");
+                    viDesk_log(ctx, "[ViDesk] LoadChannels: cliprdr 加载成功\n");
                 }
             } else {
-                viDesk_log("[ViDesk] LoadChannels: 找不到 cliprdr 通道入口\n");
+                viDesk_log(ctx, "[ViDesk] LoadChannels: 找不到 cliprdr 通道入口\n");
             }
         }
     }
 
-    viDesk_log("[ViDesk] LoadChannels: RDPGFX=%d, DISP=%d, DRDYNVC=%d, CLIPRDR=%d\n",
+    viDesk_log(ctx, "[ViDesk] LoadChannels: RDPGFX=%d, DISP=%d, DRDYNVC=%d, CLIPRDR=%d\n",
         freerdp_settings_get_bool(settings, FreeRDP_SupportGraphicsPipeline),
         freerdp_settings_get_bool(settings, FreeRDP_SupportDisplayControl),
         freerdp_settings_get_bool(settings, FreeRDP_SupportDynamicChannels),
@@ -462,20 +690,321 @@ static BOOL viDesk_LoadChannels(freerdp* instance) {
     return TRUE;
 }
 
+// === 统计：包装 GDI 的解码回调，计数后交给原回调 ===
+
+static ViDeskClientContext* viDesk_contextFromGfx(RdpgfxClientContext* gfx) {
+    rdpGdi* gdi = gfx ? (rdpGdi*)gfx->custom : NULL;
+    return gdi ? (ViDeskClientContext*)gdi->context : NULL;
+}
+
+static UINT viDesk_gfxEndFrame(RdpgfxClientContext* gfx, const RDPGFX_END_FRAME_PDU* endFrame) {
+    ViDeskClientContext* viCtx = viDesk_contextFromGfx(gfx);
+    if (!viCtx || !viCtx->gfxEndFrame)
+        return ERROR_INTERNAL_ERROR;
+
+    viDesk_sessionStatsRecordFrame(viCtx->sessionStats);
+    return viCtx->gfxEndFrame(gfx, endFrame);
+}
+
+static UINT viDesk_gfxSurfaceCommand(RdpgfxClientContext* gfx, const RDPGFX_SURFACE_COMMAND* cmd) {
+    ViDeskClientContext* viCtx = viDesk_contextFromGfx(gfx);
+    if (!viCtx || !viCtx->gfxSurfaceCommand)
+        return ERROR_INTERNAL_ERROR;
+
+    if (cmd)
+        viDesk_sessionStatsRecordDecoded(viCtx->sessionStats, cmd->length);
+    return viCtx->gfxSurfaceCommand(gfx, cmd);
+}
+
+static BOOL viDesk_SurfaceBits(rdpContext* context, const SURFACE_BITS_COMMAND* cmd) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
+    if (!viCtx || !viCtx->surfaceBits)
+        return FALSE;
+
+    if (cmd)
+        viDesk_sessionStatsRecordDecoded(viCtx->sessionStats, cmd->bmp.bitmapDataLength);
+    return viCtx->surfaceBits(context, cmd);
+}
+
+static BOOL viDesk_BitmapUpdate(rdpContext* context, const BITMAP_UPDATE* bitmap) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
+    if (!viCtx || !viCtx->bitmapUpdate)
+        return FALSE;
+
+    if (bitmap) {
+        uint64_t bytes = 0;
+        for (UINT32 i = 0; i < bitmap->number; i++)
+            bytes += bitmap->rectangles[i].bitmapLength;
+        viDesk_sessionStatsRecordDecoded(viCtx->sessionStats, bytes);
+    }
+    return viCtx->bitmapUpdate(context, bitmap);
+}
+
+// === 统计：网络自动检测结果 (服务器测得的往返时间和带宽) ===
+
+static BOOL viDesk_NetworkCharacteristicsResult(rdpAutoDetect* autodetect, RDP_TRANSPORT_TYPE transport,
+                                                UINT16 sequenceNumber,
+                                                const rdpNetworkCharacteristicsResult* result) {
+    ViDeskClientContext* viCtx = autodetect ? (ViDeskClientContext*)autodetect->context : NULL;
+    if (!viCtx)
+        return FALSE;
+
+    if (result) {
+        BOOL hasBaseRtt = result->type == RDP_NETCHAR_RESULT_TYPE_BASE_RTT_AVG_RTT ||
+                          result->type == RDP_NETCHAR_RESULT_TYPE_BASE_RTT_BW_AVG_RTT;
+        BOOL hasBandwidth = result->type == RDP_NETCHAR_RESULT_TYPE_BW_AVG_RTT ||
+                            result->type == RDP_NETCHAR_RESULT_TYPE_BASE_RTT_BW_AVG_RTT;
+        viDesk_sessionStatsRecordNetwork(viCtx->sessionStats,
+                                         hasBaseRtt ? result->baseRTT : 0,
+                                         result->averageRTT,
+                                         hasBandwidth ? result->bandwidth : 0);
+    }
+
+    if (viCtx->networkCharacteristicsResult)
+        return viCtx->networkCharacteristicsResult(autodetect, transport, sequenceNumber, result);
+    return TRUE;
+}
+
+static BOOL viDesk_NetworkCharacteristicsSync(rdpAutoDetect* autodetect, RDP_TRANSPORT_TYPE transport,
+                                              UINT16 sequenceNumber, UINT32 bandwidth, UINT32 rtt) {
+    ViDeskClientContext* viCtx = autodetect ? (ViDeskClientContext*)autodetect->context : NULL;
+    if (!viCtx)
+        return FALSE;
+
+    viDesk_sessionStatsRecordNetwork(viCtx->sessionStats, 0, rtt, bandwidth);
+
+    if (viCtx->networkCharacteristicsSync)
+        return viCtx->networkCharacteristicsSync(autodetect, transport, sequenceNumber, bandwidth, rtt);
+    return TRUE;
+}
+
+// === 传输层 ===
+
+static rdpTransportLayer* viDesk_ConnectLayer(rdpTransport* transport, const char* hostname, int port,
+                                              DWORD timeout) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)transport_get_context(transport);
+    return viCtx ? viDesk_transportConnect(viCtx->transport, transport, hostname, port, timeout) : NULL;
+}
+
+static int viDesk_ReadPdu(rdpTransport* transport, wStream* s) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)transport_get_context(transport);
+    if (!viCtx)
+        return -1;
+
+    int status = viDesk_transportReadPdu(viCtx->transport, transport, s);
+    if (status > 0)
+        viDesk_livenessRecordInbound(viCtx->liveness, viDesk_monotonicNs());
+    return status;
+}
+
+// === 存活检测 ===
+
+static BOOL viDesk_ServerHeartbeat(freerdp* instance, BYTE period, BYTE count1, BYTE count2) {
+    ViDeskClientContext* viCtx = instance ? (ViDeskClientContext*)instance->context : NULL;
+    if (!viCtx)
+        return FALSE;
+
+    ViDeskLivenessStats before;
+    viDesk_livenessGetStats(viCtx->liveness, 0, &before);
+    viDesk_livenessRecordHeartbeat(viCtx->liveness, period, count1, count2, viDesk_monotonicNs());
+    if (before.heartbeatPeriod != period || before.missedToReconnect != count2)
+        viDesk_log(viCtx->viDeskCtx, "[ViDesk] 服务器心跳: 周期 %u 秒, 错过 %u 个告警, %u 个重连\n",
+                   period, count1, count2);
+    return TRUE;
+}
+
+// 服务器不发心跳时，静默过久就请求重发左上角一小块画面 (Refresh Rect PDU)，有回应说明连接仍在
+static void viDesk_sendLivenessProbe(ViDeskClientContext* viCtx) {
+    rdpContext* context = &viCtx->common.context;
+    if (!context->update || !context->update->RefreshRect ||
+        !freerdp_settings_get_bool(context->settings, FreeRDP_RefreshRect))
+        return;
+
+    const RECTANGLE_16 area = { 0, 0, 16, 16 };
+    if (context->update->RefreshRect(context, 1, &area))
+        viDesk_log(viCtx->viDeskCtx, "[ViDesk] 长时间没有收到服务器数据，请求刷新画面确认连接\n");
+}
+
+// === 自适应画质 ===
+
+// 渲染器长时间没有呈现 (如应用进入后台) 时不再暂停读取，避免会话因超时断开
+#define VIDESK_THROTTLE_MAX_NS (100ULL * 1000000ULL)
+
+static const char* viDesk_qualityCodecName(ViDeskQualityCodec codec) {
+    return codec == VIDESK_QUALITY_CODEC_AVC444 ? "AVC444" : "AVC420";
+}
+
+// 通过 DISP 请求按比例缩放的分辨率 (相对首次连接时的分辨率)
+static void viDesk_requestQualityResolution(ViDeskClientContext* viCtx, uint32_t percent) {
+    ViDeskContext* ctx = viCtx->viDeskCtx;
+    if (!viCtx->disp || !viCtx->dispReady || !viCtx->disp->SendMonitorLayout ||
+        viCtx->qualityBaseWidth == 0 || viCtx->qualityBaseHeight == 0)
+        return;     // DISP 能力到达时再请求
+    if (percent == viCtx->qualityResolutionPercent)
+        return;
+
+    // 宽度必须为偶数
+    UINT32 width = (viCtx->qualityBaseWidth * percent / 100) & ~1u;
+    UINT32 height = viCtx->qualityBaseHeight * percent / 100;
+    if (width < DISPLAY_CONTROL_MIN_MONITOR_WIDTH) width = DISPLAY_CONTROL_MIN_MONITOR_WIDTH;
+    if (width > DISPLAY_CONTROL_MAX_MONITOR_WIDTH) width = DISPLAY_CONTROL_MAX_MONITOR_WIDTH;
+    if (height < DISPLAY_CONTROL_MIN_MONITOR_HEIGHT) height = DISPLAY_CONTROL_MIN_MONITOR_HEIGHT;
+    if (height > DISPLAY_CONTROL_MAX_MONITOR_HEIGHT) height = DISPLAY_CONTROL_MAX_MONITOR_HEIGHT;
+
+    rdpSettings* settings = viCtx->common.context.settings;
+    UINT32 desktopScale = freerdp_settings_get_uint32(settings, FreeRDP_DesktopScaleFactor);
+    UINT32 deviceScale = freerdp_settings_get_uint32(settings, FreeRDP_DeviceScaleFactor);
+
+    DISPLAY_CONTROL_MONITOR_LAYOUT layout = { 0 };
+    layout.Flags = DISPLAY_CONTROL_MONITOR_PRIMARY;
+    layout.Width = width;
+    layout.Height = height;
+    layout.Orientation = ORIENTATION_LANDSCAPE;
+    layout.DesktopScaleFactor = desktopScale ? desktopScale : 100;
+    layout.DeviceScaleFactor = deviceScale ? deviceScale : 100;
+
+    UINT rc = viCtx->disp->SendMonitorLayout(viCtx->disp, 1, &layout);
+    viDesk_log(ctx, "[ViDesk] 画质: 请求分辨率 %ux%u (%u%%), 结果=%u\n", width, height, percent, rc);
+    if (rc == CHANNEL_RC_OK) {
+        viCtx->qualityResolutionPercent = percent;
+        viCtx->resolutionRequests++;
+    }
+}
+
+// 应用档位参数 (事件处理线程)
+static void viDesk_applyQualityDecision(ViDeskClientContext* viCtx, const ViDeskQualityDecision* decision) {
+    const ViDeskQualityProfile* profile = &decision->profile;
+    rdpSettings* settings = viCtx->common.context.settings;
+
+    viDesk_log(viCtx->viDeskCtx,
+               "[ViDesk] 画质调整 %s (带宽 %u kbps, RTT %u ms): 帧确认深度=%u, 分辨率=%u%%, 编码=%s, 精简视觉效果=%d\n",
+               decision->reason, decision->bandwidthKbps, decision->rttMs, profile->frameAckDepth,
+               profile->resolutionPercent, viDesk_qualityCodecName(profile->codec), profile->reduceVisualEffects);
+
+    atomic_store(&viCtx->frameAckDepth, profile->frameAckDepth);
+
+    // GFX 能力在通道打开时协商，编码偏好和视觉效果在下次连接/重连时生效
+    if (freerdp_settings_get_bool(settings, FreeRDP_GfxH264)) {
+        BOOL avc444 = profile->codec == VIDESK_QUALITY_CODEC_AVC444;
+        freerdp_settings_set_bool(settings, FreeRDP_GfxAVC444, avc444);
+        freerdp_settings_set_bool(settings, FreeRDP_GfxAVC444v2, avc444);
+    }
+
+    if (profile->reduceVisualEffects && !viCtx->effectsReduced) {
+        viCtx->savedDisableWallpaper = freerdp_settings_get_bool(settings, FreeRDP_DisableWallpaper);
+        viCtx->savedDisableFullWindowDrag = freerdp_settings_get_bool(settings, FreeRDP_DisableFullWindowDrag);
+        viCtx->savedDisableMenuAnims = freerdp_settings_get_bool(settings, FreeRDP_DisableMenuAnims);
+        freerdp_settings_set_bool(settings, FreeRDP_DisableWallpaper, TRUE);
+        freerdp_settings_set_bool(settings, FreeRDP_DisableFullWindowDrag, TRUE);
+        freerdp_settings_set_bool(settings, FreeRDP_DisableMenuAnims, TRUE);
+        viCtx->effectsReduced = true;
+    } else if (!profile->reduceVisualEffects && viCtx->effectsReduced) {
+        freerdp_settings_set_bool(settings, FreeRDP_DisableWallpaper, viCtx->savedDisableWallpaper);
+        freerdp_settings_set_bool(settings, FreeRDP_DisableFullWindowDrag, viCtx->savedDisableFullWindowDrag);
+        freerdp_settings_set_bool(settings, FreeRDP_DisableMenuAnims, viCtx->savedDisableMenuAnims);
+        viCtx->effectsReduced = false;
+    }
+
+    viDesk_requestQualityResolution(viCtx, profile->resolutionPercent);
+}
+
+// 每秒评估一次 (事件处理线程)
+static void viDesk_evaluateQuality(ViDeskClientContext* viCtx, uint64_t nowNs) {
+    ViDeskQualityDecision decision;
+    uint64_t nowMs = nowNs / 1000000ULL;
+
+    int request = atomic_exchange(&viCtx->qualityEnableRequest, -1);
+    if (request >= 0 &&
+        viDesk_qualityControllerSetEnabled(viCtx->qualityController, request == 1, nowMs, &decision))
+        viDesk_applyQualityDecision(viCtx, &decision);
+
+    ViDeskSessionStats stats;
+    viDesk_sessionStatsGet(viCtx->sessionStats, &stats);
+    if (viDesk_qualityControllerUpdate(viCtx->qualityController, nowMs,
+                                       stats.detectedBandwidthKbps, stats.averageRttMs, &decision))
+        viDesk_applyQualityDecision(viCtx, &decision);
+}
+
+// 渲染器落后 (已交付未呈现的帧超过 frameAckDepth) 时暂停读取入站数据。
+// GFX 帧确认在处理完帧结束 PDU 后才发出，暂停读取即推迟确认，服务器看到未确认帧堆积会降低发送速率
+static bool viDesk_inboundThrottled(ViDeskClientContext* viCtx, uint64_t now) {
+    uint64_t frames = atomic_load(&viCtx->lastFrameSequence);
+    uint64_t presented = atomic_load(&viCtx->lastPresentedSequence);
+    uint32_t depth = atomic_load(&viCtx->frameAckDepth);
+    bool behind = depth > 0 && !atomic_load(&viCtx->headlessPresentation) && frames > presented + depth;
+
+    uint64_t since = atomic_load(&viCtx->throttleSinceNs);
+    if (!behind) {
+        if (since != 0 && atomic_compare_exchange_strong(&viCtx->throttleSinceNs, &since, 0)) {
+            uint64_t elapsed = now > since ? now - since : 0;
+            atomic_fetch_add(&viCtx->throttledNs, elapsed < VIDESK_THROTTLE_MAX_NS ? elapsed : VIDESK_THROTTLE_MAX_NS);
+        }
+        return false;
+    }
+
+    if (since == 0) {
+        atomic_compare_exchange_strong(&viCtx->throttleSinceNs, &since, now);
+        return true;
+    }
+    return now - since < VIDESK_THROTTLE_MAX_NS;
+}
+
+static UINT viDesk_DisplayControlCaps(DispClientContext* disp, UINT32 maxNumMonitors,
+                                      UINT32 maxMonitorAreaFactorA, UINT32 maxMonitorAreaFactorB) {
+    ViDeskClientContext* viCtx = disp ? (ViDeskClientContext*)disp->custom : NULL;
+    if (!viCtx)
+        return ERROR_INVALID_PARAMETER;
+
+    viDesk_log(viCtx->viDeskCtx, "[ViDesk] DISP 能力: 最多 %u 个显示器, 面积因子 %ux%u\n",
+               maxNumMonitors, maxMonitorAreaFactorA, maxMonitorAreaFactorB);
+    viCtx->dispReady = true;
+
+    // 连接早期已降档时在这里补发分辨率请求
+    ViDeskQualityProfile profile = viDesk_qualityControllerProfile(viCtx->qualityController);
+    viDesk_requestQualityResolution(viCtx, profile.resolutionPercent);
+    return CHANNEL_RC_OK;
+}
+
 // 通道连接事件处理器 - 当通道建立时初始化 GFX/cliprdr 等
 static void viDesk_OnChannelConnectedEventHandler(void* context, const ChannelConnectedEventArgs* e) {
     ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
     if (!viCtx || !e) return;
 
-    viDesk_log("[ViDesk] 通道已连接: %s\n", e->name);
+    ViDeskContext* ctx = viCtx->viDeskCtx;
+    viDesk_log(ctx, "[ViDesk] 通道已连接: %s\n", e->name);
 
     if (strcmp(e->name, CLIPRDR_SVC_CHANNEL_NAME) == 0) {
         CliprdrClientContext* cliprdr = (CliprdrClientContext*)e->pInterface;
         viDesk_cliprdr_init(viCtx, cliprdr);
+    } else if (strcmp(e->name, AINPUT_DVC_CHANNEL_NAME) == 0) {
+        viCtx->ainput = (AInputClientContext*)e->pInterface;
+        viCtx->relativeResidualX = 0;
+        viCtx->relativeResidualY = 0;
+    } else if (strcmp(e->name, RDPEI_DVC_CHANNEL_NAME) == 0) {
+        viCtx->rdpei = (RdpeiClientContext*)e->pInterface;
+        atomic_store(&viCtx->touchPendingNs, 0);
     }
 
     // 委托给 FreeRDP 公共处理器（处理 GFX 管道初始化等）
     freerdp_client_OnChannelConnectedEventHandler(context, e);
+
+    // GFX 管道由上面初始化，之后包装帧结束和表面命令回调用于统计
+    if (strcmp(e->name, RDPGFX_DVC_CHANNEL_NAME) == 0) {
+        RdpgfxClientContext* gfx = (RdpgfxClientContext*)e->pInterface;
+        if (gfx && gfx->EndFrame != viDesk_gfxEndFrame) {
+            viCtx->gfxEndFrame = gfx->EndFrame;
+            viCtx->gfxSurfaceCommand = gfx->SurfaceCommand;
+            gfx->EndFrame = viDesk_gfxEndFrame;
+            gfx->SurfaceCommand = viDesk_gfxSurfaceCommand;
+        }
+    } else if (strcmp(e->name, DISP_DVC_CHANNEL_NAME) == 0) {
+        viCtx->disp = (DispClientContext*)e->pInterface;
+        viCtx->dispReady = false;
+        if (viCtx->disp) {
+            viCtx->disp->custom = viCtx;
+            viCtx->disp->DisplayControlCaps = viDesk_DisplayControlCaps;
+        }
+    }
 }
 
 // 通道断开事件处理器
@@ -483,11 +1012,19 @@ static void viDesk_OnChannelDisconnectedEventHandler(void* context, const Channe
     ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
     if (!viCtx || !e) return;
 
-    viDesk_log("[ViDesk] 通道已断开: %s\n", e->name);
+    ViDeskContext* ctx = viCtx->viDeskCtx;
+    viDesk_log(ctx, "[ViDesk] 通道已断开: %s\n", e->name);
 
     if (strcmp(e->name, CLIPRDR_SVC_CHANNEL_NAME) == 0) {
         CliprdrClientContext* cliprdr = (CliprdrClientContext*)e->pInterface;
         viDesk_cliprdr_uninit(viCtx, cliprdr);
+    } else if (strcmp(e->name, AINPUT_DVC_CHANNEL_NAME) == 0) {
+        viCtx->ainput = NULL;
+    } else if (strcmp(e->name, RDPEI_DVC_CHANNEL_NAME) == 0) {
+        viCtx->rdpei = NULL;
+    } else if (strcmp(e->name, DISP_DVC_CHANNEL_NAME) == 0) {
+        viCtx->disp = NULL;
+        viCtx->dispReady = false;
     }
 
     freerdp_client_OnChannelDisconnectedEventHandler(context, e);
@@ -502,7 +1039,8 @@ static BOOL viDesk_PreConnect(freerdp* instance) {
     if (!settings)
         return FALSE;
 
-    viDesk_log("[ViDesk] PreConnect 开始配置...\n");
+    ViDeskContext* ctx = viDesk_contextFromRdp(instance->context);
+    viDesk_log(ctx, "[ViDesk] PreConnect 开始配置...\n");
 
     // 注册通道连接/断开事件处理器（GFX 管道初始化依赖此事件）
     PubSub_SubscribeChannelConnected(instance->context->pubSub,
@@ -522,8 +1060,72 @@ static BOOL viDesk_PreConnect(freerdp* instance) {
     freerdp_settings_set_bool(settings, FreeRDP_AsyncChannels, FALSE);
     freerdp_settings_set_bool(settings, FreeRDP_AsyncUpdate, FALSE);
 
-    // 超时设置 (毫秒)
-    freerdp_settings_set_uint32(settings, FreeRDP_TcpConnectTimeout, 30000);
+    // 网络自动检测：服务器测量往返时间和带宽并回报客户端 (用于统计)
+    freerdp_settings_set_bool(settings, FreeRDP_NetworkAutoDetect, TRUE);
+    freerdp_settings_set_uint32(settings, FreeRDP_ConnectionType, CONNECTION_TYPE_AUTODETECT);
+
+    rdpAutoDetect* autodetect = instance->context->autodetect;
+    if (autodetect && autodetect->NetworkCharacteristicsResult != viDesk_NetworkCharacteristicsResult) {
+        ViDeskClientContext* viCtx = (ViDeskClientContext*)instance->context;
+        viCtx->networkCharacteristicsResult = autodetect->NetworkCharacteristicsResult;
+        viCtx->networkCharacteristicsSync = autodetect->NetworkCharacteristicsSync;
+        autodetect->NetworkCharacteristicsResult = viDesk_NetworkCharacteristicsResult;
+        autodetect->NetworkCharacteristicsSync = viDesk_NetworkCharacteristicsSync;
+    }
+    viDesk_sessionStatsReset(((ViDeskClientContext*)instance->context)->sessionStats);
+    viDesk_channelStatsReset(((ViDeskClientContext*)instance->context)->channelStats);
+
+    // 传输层：回放会话录制时由 transport dump 接管读写，恢复默认回调供其包装
+    {
+        ViDeskClientContext* viCtx = (ViDeskClientContext*)instance->context;
+        if (freerdp_settings_get_bool(settings, FreeRDP_TransportDumpReplay))
+            viDesk_transportUninstall(viCtx->transport, instance->context);
+        else if (!viDesk_transportInstall(viCtx->transport, instance->context, viDesk_ConnectLayer, viDesk_ReadPdu))
+            viDesk_log(ctx, "[ViDesk] 无法安装池化传输层，使用默认实现\n");
+
+        ViDeskTransportStats transportStats;
+        viDesk_transportGetStats(viCtx->transport, &transportStats);
+        if (viDesk_transportWanEnabled(viCtx->transport) && !transportStats.pooled)
+            viDesk_log(ctx, "[ViDesk] 警告: WAN 模拟只作用于池化传输层，本次连接不生效\n");
+    }
+
+    // === 自适应画质 ===
+    // 显示控制通道用于运行时按档位请求分辨率；基准分辨率取首次连接时的请求值
+    freerdp_settings_set_bool(settings, FreeRDP_SupportDisplayControl, TRUE);
+    {
+        ViDeskClientContext* viCtx = (ViDeskClientContext*)instance->context;
+        if (viCtx->qualityBaseWidth == 0) {
+            viCtx->qualityBaseWidth = freerdp_settings_get_uint32(settings, FreeRDP_DesktopWidth);
+            viCtx->qualityBaseHeight = freerdp_settings_get_uint32(settings, FreeRDP_DesktopHeight);
+        }
+        viCtx->qualityResolutionPercent = 100;
+        viCtx->dispReady = false;
+        viDesk_qualityControllerReset(viCtx->qualityController);
+        atomic_store(&viCtx->frameAckDepth, viDesk_qualityControllerProfile(viCtx->qualityController).frameAckDepth);
+        atomic_store(&viCtx->lastFrameSequence, 0);
+        atomic_store(&viCtx->lastPresentedSequence, 0);
+        atomic_store(&viCtx->throttleSinceNs, 0);
+    }
+
+    // 单个地址的 TCP 连接超时 (毫秒)
+    // 非池化模式由 FreeRDP 按解析顺序逐个尝试地址，每个不通的地址 (如失效的 AAAA 记录) 都要等满这个时间；
+    // 5 秒足够丢包链路上重传几次 SYN。池化传输层的地址竞速按同样的值给每个地址计时
+    freerdp_settings_set_uint32(settings, FreeRDP_TcpConnectTimeout, 5000);
+
+    // === 断线检测 ===
+    // Wi-Fi 静默断开时 TCP 默认要数分钟才超时。空闲时 3 秒无数据开始保活探测，每秒一次，3 次无响应断开；
+    // 有数据未确认时 6 秒内收不到确认即断开。池化传输层按同样的设置配置自己的套接字
+    freerdp_settings_set_bool(settings, FreeRDP_TcpKeepAlive, TRUE);
+    freerdp_settings_set_uint32(settings, FreeRDP_TcpKeepAliveDelay, 3);
+    freerdp_settings_set_uint32(settings, FreeRDP_TcpKeepAliveInterval, 1);
+    freerdp_settings_set_uint32(settings, FreeRDP_TcpKeepAliveRetries, 3);
+    freerdp_settings_set_uint32(settings, FreeRDP_TcpAckTimeout, 6000);
+
+    // 声明支持心跳 PDU，服务器按自己的周期发送，空闲时也能据此判断连接是否还在
+    freerdp_settings_set_bool(settings, FreeRDP_SupportHeartbeatPdu, TRUE);
+    if (instance->heartbeat)
+        instance->heartbeat->ServerHeartbeat = viDesk_ServerHeartbeat;
+    viDesk_livenessReset(((ViDeskClientContext*)instance->context)->liveness, viDesk_monotonicNs());
 
     // === 证书验证配置 (开发阶段自动接受) ===
     freerdp_settings_set_bool(settings, FreeRDP_IgnoreCertificate, TRUE);
@@ -532,13 +1134,46 @@ static BOOL viDesk_PreConnect(freerdp* instance) {
     // === 压缩和性能优化 ===
     freerdp_settings_set_bool(settings, FreeRDP_FastPathOutput, TRUE);
     freerdp_settings_set_bool(settings, FreeRDP_FastPathInput, TRUE);
-    freerdp_settings_set_bool(settings, FreeRDP_CompressionEnabled, TRUE);
+    {
+        // 压缩级别按 PACKET_COMPR_TYPE_* 编号，比 ViDeskCompressionLevel 小 1
+        ViDeskClientContext* viCtx = (ViDeskClientContext*)instance->context;
+        bool compress = viCtx->compressionLevel != VIDESK_COMPRESSION_NONE;
+        freerdp_settings_set_bool(settings, FreeRDP_CompressionEnabled, compress);
+        if (compress)
+            freerdp_settings_set_uint32(settings, FreeRDP_CompressionLevel, (UINT32)viCtx->compressionLevel - 1);
+
+        // 统计按连接计算；快速重连不经过 PreConnect，继续累计
+        if (instance->context->metrics) {
+            instance->context->metrics->TotalCompressedBytes = 0;
+            instance->context->metrics->TotalUncompressedBytes = 0;
+            instance->context->metrics->TotalCompressionRatio = 0;
+        }
+    }
+
+    // === 光标 ===
+    // 声明支持大光标，高分屏上的放大光标不会被服务器回退为位图绘制
+    freerdp_settings_set_uint32(settings, FreeRDP_LargePointerFlag,
+                                LARGE_POINTER_FLAG_96x96 | LARGE_POINTER_FLAG_384x384);
 
     // === GFX 图形管道 - GNOME Remote Desktop 依赖此功能 ===
     freerdp_settings_set_bool(settings, FreeRDP_SupportGraphicsPipeline, TRUE);
 
-    // 禁用 FreeRDP 内部自动重连，由应用层控制重连逻辑
-    freerdp_settings_set_bool(settings, FreeRDP_AutoReconnectionEnabled, FALSE);
+    // 自动重连 cookie 和 GFX 持久缓存，供掉线后 viDesk_reconnect 在原上下文上重连
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)instance->context;
+    if (!viDesk_reconnectPrepare(viCtx->reconnect, instance->context))
+        return FALSE;
+
+    if (viCtx->dumpMode == VIDESK_SESSION_DUMP_REPLAY) {
+        atomic_store(&viCtx->replayConnectedNs, 0);
+        atomic_store(&viCtx->replayFirstFrameNs, 0);
+        atomic_store(&viCtx->replayEndNs, 0);
+        atomic_store(&viCtx->replayStartNs, viDesk_monotonicNs());
+        viDesk_log(ctx, "[ViDesk] 回放会话录制: %s\n",
+                   freerdp_settings_get_string(settings, FreeRDP_TransportDumpFile));
+    } else if (viCtx->dumpMode == VIDESK_SESSION_DUMP_CAPTURE) {
+        viDesk_log(ctx, "[ViDesk] 录制会话到: %s\n",
+                   freerdp_settings_get_string(settings, FreeRDP_TransportDumpFile));
+    }
 
     // === 剪贴板重定向 ===
     freerdp_settings_set_bool(settings, FreeRDP_RedirectClipboard, TRUE);
@@ -550,14 +1185,14 @@ static BOOL viDesk_PreConnect(freerdp* instance) {
     BOOL nla = freerdp_settings_get_bool(settings, FreeRDP_NlaSecurity);
     BOOL tls = freerdp_settings_get_bool(settings, FreeRDP_TlsSecurity);
     BOOL rdp = freerdp_settings_get_bool(settings, FreeRDP_RdpSecurity);
-    viDesk_log("[ViDesk] 安全协议: NLA=%d, TLS=%d, RDP=%d\n", nla, tls, rdp);
+    viDesk_log(ctx, "[ViDesk] 安全协议: NLA=%d, TLS=%d, RDP=%d\n", nla, tls, rdp);
 
-    viDesk_log("[ViDesk] PreConnect 验证: GFX=%d, AutoDetect=%d, Heartbeat=%d\n",
+    viDesk_log(ctx, "[ViDesk] PreConnect 验证: GFX=%d, AutoDetect=%d, Heartbeat=%d\n",
         freerdp_settings_get_bool(settings, FreeRDP_SupportGraphicsPipeline),
         freerdp_settings_get_bool(settings, FreeRDP_NetworkAutoDetect),
         freerdp_settings_get_bool(settings, FreeRDP_SupportHeartbeatPdu));
 
-    viDesk_log("[ViDesk] PreConnect 配置完成\n");
+    viDesk_log(ctx, "[ViDesk] PreConnect 配置完成\n");
 
     return TRUE;
 }
@@ -569,18 +1204,17 @@ static BOOL viDesk_DesktopResize(rdpContext* context) {
 
     rdpGdi* gdi = context->gdi;
     rdpSettings* settings = context->settings;
+    ViDeskContext* ctx = viDesk_contextFromRdp(context);
 
     UINT32 width = freerdp_settings_get_uint32(settings, FreeRDP_DesktopWidth);
     UINT32 height = freerdp_settings_get_uint32(settings, FreeRDP_DesktopHeight);
 
-    viDesk_log("[ViDesk] 桌面分辨率变更: %ux%u\n", width, height);
+    viDesk_log(ctx, "[ViDesk] 桌面分辨率变更: %ux%u\n", width, height);
 
     if (!gdi_resize(gdi, width, height))
         return FALSE;
 
     // 更新 ViDesk 帧缓冲区信息
-    ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
-    ViDeskContext* ctx = viCtx ? viCtx->viDeskCtx : NULL;
     if (ctx) {
         ctx->frameWidth = gdi->width;
         ctx->frameHeight = gdi->height;
@@ -591,6 +1225,159 @@ static BOOL viDesk_DesktopResize(rdpContext* context) {
     return TRUE;
 }
 
+#define VIDESK_POINTER_KNOWN (1ULL << 63)
+
+// 记下最近一次已知的指针位置 (滚轮等无坐标输入按它匹配帧更新)
+static void viDesk_trackPointer(ViDeskClientContext* viCtx, int32_t x, int32_t y) {
+    uint64_t packed = VIDESK_POINTER_KNOWN | (uint64_t)(uint16_t)x << 16 | (uint16_t)y;
+    atomic_store_explicit(&viCtx->pointerPosition, packed, memory_order_relaxed);
+}
+
+static bool viDesk_lastPointer(ViDeskClientContext* viCtx, int32_t* x, int32_t* y) {
+    uint64_t packed = atomic_load_explicit(&viCtx->pointerPosition, memory_order_relaxed);
+    if (!(packed & VIDESK_POINTER_KNOWN))
+        return false;
+
+    *x = (uint16_t)(packed >> 16);
+    *y = (uint16_t)packed;
+    return true;
+}
+
+// FreeRDP 回调 - 服务器移动指针
+// 光标由客户端在预测位置本地绘制，这里只更新已知的指针位置并通知上层校正
+static BOOL viDesk_PointerPosition(rdpContext* context, const POINTER_POSITION_UPDATE* position) {
+    if (!context || !position)
+        return FALSE;
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
+    viDesk_trackPointer(viCtx, (int32_t)position->xPos, (int32_t)position->yPos);
+
+    ViDeskContext* ctx = viCtx->viDeskCtx;
+    if (ctx)
+        notifyPointerPosition(ctx, (int)position->xPos, (int)position->yPos);
+
+    return TRUE;
+}
+
+// 转换服务器下发的光标并存入缓存槽，随后切换到该光标
+// 光标只作为叠加层交给渲染器，不写入帧缓冲区
+static BOOL viDesk_storePointer(rdpContext* context, const ViDeskPointerData* data) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
+    const gdiPalette* palette = context->gdi ? &context->gdi->palette : NULL;
+
+    const ViDeskPointerImage* image = viDesk_pointerCacheStore(viCtx->pointerCache, data, palette);
+    if (!image) {
+        viDesk_log(viCtx->viDeskCtx, "[ViDesk] 光标转换失败: 槽=%u, %ux%u, %u bpp\n",
+                   data->cacheIndex, data->width, data->height, data->xorBpp);
+        return TRUE;    // 忽略无法显示的光标，不中断会话
+    }
+
+    if (viCtx->viDeskCtx)
+        notifyPointerShape(viCtx->viDeskCtx, VIDESK_POINTER_IMAGE, image);
+    return TRUE;
+}
+
+// FreeRDP 回调 - 新光标 (任意色深)
+static BOOL viDesk_PointerNew(rdpContext* context, const POINTER_NEW_UPDATE* pointer) {
+    if (!context || !pointer)
+        return FALSE;
+
+    const POINTER_COLOR_UPDATE* color = &pointer->colorPtrAttr;
+    ViDeskPointerData data = {
+        .cacheIndex = color->cacheIndex,
+        .xorBpp = pointer->xorBpp,
+        .width = color->width,
+        .height = color->height,
+        .hotspotX = color->hotSpotX,
+        .hotspotY = color->hotSpotY,
+        .xorMask = color->xorMaskData,
+        .xorMaskLength = color->lengthXorMask,
+        .andMask = color->andMaskData,
+        .andMaskLength = color->lengthAndMask
+    };
+    return viDesk_storePointer(context, &data);
+}
+
+// FreeRDP 回调 - 24 位色光标
+static BOOL viDesk_PointerColor(rdpContext* context, const POINTER_COLOR_UPDATE* color) {
+    if (!context || !color)
+        return FALSE;
+
+    ViDeskPointerData data = {
+        .cacheIndex = color->cacheIndex,
+        .xorBpp = 24,
+        .width = color->width,
+        .height = color->height,
+        .hotspotX = color->hotSpotX,
+        .hotspotY = color->hotSpotY,
+        .xorMask = color->xorMaskData,
+        .xorMaskLength = color->lengthXorMask,
+        .andMask = color->andMaskData,
+        .andMaskLength = color->lengthAndMask
+    };
+    return viDesk_storePointer(context, &data);
+}
+
+// FreeRDP 回调 - 大光标 (最大 384x384)
+static BOOL viDesk_PointerLarge(rdpContext* context, const POINTER_LARGE_UPDATE* pointer) {
+    if (!context || !pointer)
+        return FALSE;
+
+    ViDeskPointerData data = {
+        .cacheIndex = pointer->cacheIndex,
+        .xorBpp = pointer->xorBpp,
+        .width = pointer->width,
+        .height = pointer->height,
+        .hotspotX = pointer->hotSpotX,
+        .hotspotY = pointer->hotSpotY,
+        .xorMask = pointer->xorMaskData,
+        .xorMaskLength = pointer->lengthXorMask,
+        .andMask = pointer->andMaskData,
+        .andMaskLength = pointer->lengthAndMask
+    };
+    return viDesk_storePointer(context, &data);
+}
+
+// FreeRDP 回调 - 切换到已缓存的光标
+static BOOL viDesk_PointerCached(rdpContext* context, const POINTER_CACHED_UPDATE* pointer) {
+    if (!context || !pointer)
+        return FALSE;
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
+    const ViDeskPointerImage* image = viDesk_pointerCacheGet(viCtx->pointerCache, pointer->cacheIndex);
+    if (!image) {
+        viDesk_log(viCtx->viDeskCtx, "[ViDesk] 光标缓存槽 %u 为空\n", pointer->cacheIndex);
+        return TRUE;
+    }
+
+    if (viCtx->viDeskCtx)
+        notifyPointerShape(viCtx->viDeskCtx, VIDESK_POINTER_IMAGE, image);
+    return TRUE;
+}
+
+// FreeRDP 回调 - 系统光标 (隐藏或默认箭头)
+static BOOL viDesk_PointerSystem(rdpContext* context, const POINTER_SYSTEM_UPDATE* pointer) {
+    if (!context || !pointer)
+        return FALSE;
+
+    ViDeskContext* ctx = viDesk_contextFromRdp(context);
+    if (!ctx)
+        return TRUE;
+
+    switch (pointer->type) {
+        case SYSPTR_NULL:
+            notifyPointerShape(ctx, VIDESK_POINTER_HIDDEN, NULL);
+            break;
+        case SYSPTR_DEFAULT:
+            notifyPointerShape(ctx, VIDESK_POINTER_DEFAULT, NULL);
+            break;
+        default:
+            viDesk_log(ctx, "[ViDesk] 未知系统光标类型: 0x%08X\n", pointer->type);
+            break;
+    }
+    return TRUE;
+}
+
 // FreeRDP 回调 - PostConnect
 static BOOL viDesk_PostConnect(freerdp* instance) {
     if (!instance || !instance->context)
@@ -610,6 +1397,26 @@ static BOOL viDesk_PostConnect(freerdp* instance) {
 
     // 注册 update 回调（gdi_init 之后）
     context->update->DesktopResize = viDesk_DesktopResize;
+    context->update->pointer->PointerPosition = viDesk_PointerPosition;
+    context->update->pointer->PointerNew = viDesk_PointerNew;
+    context->update->pointer->PointerColor = viDesk_PointerColor;
+    context->update->pointer->PointerLarge = viDesk_PointerLarge;
+    context->update->pointer->PointerCached = viDesk_PointerCached;
+    context->update->pointer->PointerSystem = viDesk_PointerSystem;
+
+    // 包装 GDI 的非 GFX 解码回调用于统计解码字节数
+    if (context->update->SurfaceBits != viDesk_SurfaceBits) {
+        viCtx->surfaceBits = context->update->SurfaceBits;
+        viCtx->bitmapUpdate = context->update->BitmapUpdate;
+        context->update->SurfaceBits = viDesk_SurfaceBits;
+        context->update->BitmapUpdate = viDesk_BitmapUpdate;
+    }
+
+    // 按协商结果分配光标缓存槽
+    UINT32 pointerSlots = freerdp_settings_get_uint32(context->settings, FreeRDP_PointerCacheSize);
+    UINT32 colorSlots = freerdp_settings_get_uint32(context->settings, FreeRDP_ColorPointerCacheSize);
+    if (!viDesk_pointerCacheReset(viCtx->pointerCache, pointerSlots > colorSlots ? pointerSlots : colorSlots))
+        return FALSE;
 
     // 更新帧缓冲区信息
     if (ctx) {
@@ -623,7 +1430,10 @@ static BOOL viDesk_PostConnect(freerdp* instance) {
         notifyStateChange(ctx, 3, "Connected");  // 3 = connected
     }
 
-    viDesk_log("[ViDesk] PostConnect 完成: 分辨率=%dx%d, GDI已初始化\n", gdi->width, gdi->height);
+    if (viCtx->dumpMode == VIDESK_SESSION_DUMP_REPLAY)
+        atomic_store(&viCtx->replayConnectedNs, viDesk_monotonicNs());
+
+    viDesk_log(ctx, "[ViDesk] PostConnect 完成: 分辨率=%dx%d, GDI已初始化\n", gdi->width, gdi->height);
 
     return TRUE;
 }
@@ -642,6 +1452,54 @@ static void viDesk_PostDisconnect(freerdp* instance) {
     ViDeskClientContext* viCtx = (ViDeskClientContext*)instance->context;
     ViDeskContext* ctx = viCtx ? viCtx->viDeskCtx : NULL;
 
+    // 未发出的大消息随连接一起作废
+    if (viCtx)
+        viDesk_sendSchedulerClear(viCtx->sendScheduler);
+
+    // 记录本次连接的光标缓存命中情况
+    if (viCtx) {
+        ViDeskPointerCacheStats pointerStats;
+        viDesk_pointerCacheGetStats(viCtx->pointerCache, &pointerStats);
+        uint32_t lookups = pointerStats.shapeUpdates + pointerStats.cachedSelects;
+        if (lookups > 0) {
+            uint32_t hits = pointerStats.contentHits + pointerStats.cachedSelects - pointerStats.cachedMisses;
+            viDesk_log(ctx, "[ViDesk] 光标缓存: %u 次切换, 命中 %u (%.1f%%), 转换 %u 次\n",
+                       lookups, hits, 100.0 * hits / lookups, pointerStats.conversions);
+        }
+
+        // 传输层：每秒系统调用数、每次 recv 取回的 PDU 数、每帧分配次数
+        ViDeskTransportStats transportStats;
+        viDesk_transportGetStats(viCtx->transport, &transportStats);
+        ViDeskSessionStats sessionStats;
+        viDesk_sessionStatsGet(viCtx->sessionStats, &sessionStats);
+        double seconds = transportStats.elapsedNs / 1e9;
+        if (seconds > 0 && transportStats.recvCalls > 0) {
+            uint64_t syscalls = transportStats.recvCalls + transportStats.sendCalls + transportStats.waitCalls;
+            viDesk_log(ctx, "[ViDesk] 传输层 (%s): %.0f 次系统调用/秒, %.2f PDU/recv, %.3f 次分配/帧\n",
+                       transportStats.pooled ? "池化" : "默认", syscalls / seconds,
+                       (double)transportStats.pdus / transportStats.recvCalls,
+                       sessionStats.totalFrames > 0 ? (double)transportStats.allocations / sessionStats.totalFrames : 0.0);
+        }
+    }
+
+    // 回放读完文件后传输层报错断开，记录本次解码吞吐量
+    if (viCtx && viCtx->dumpMode == VIDESK_SESSION_DUMP_REPLAY && atomic_load(&viCtx->replayStartNs) != 0) {
+        atomic_store(&viCtx->replayEndNs, viDesk_monotonicNs());
+        ViDeskSessionReplayStats replay;
+        viDesk_getSessionReplayStats(ctx, &replay);
+        double seconds = replay.elapsedNs / 1e9;
+        if (seconds > 0) {
+            viDesk_log(ctx, "[ViDesk] 会话回放: %.2f 秒, %llu 帧 (%.1f fps), 解码 %.1f MB (%.1f MB/s)\n",
+                       seconds, (unsigned long long)replay.frames, replay.frames / seconds,
+                       replay.decodedBytes / 1e6, replay.decodedBytes / 1e6 / seconds);
+            if (replay.compressedBytes > 0)
+                viDesk_log(ctx, "[ViDesk] 批量压缩: %.1f MB -> %.1f MB (%.2fx), 解压输出 %.1f MB/s\n",
+                           replay.compressedBytes / 1e6, replay.uncompressedBytes / 1e6,
+                           (double)replay.uncompressedBytes / (double)replay.compressedBytes,
+                           replay.uncompressedBytes / 1e6 / seconds);
+        }
+    }
+
     // 清理 GDI
     gdi_free(instance);
 
@@ -649,11 +1507,31 @@ static void viDesk_PostDisconnect(freerdp* instance) {
         ctx->isConnected = FALSE;
         ctx->isAuthenticated = FALSE;
         ctx->frameBuffer = NULL;
+        ctx->frameBufferBytes = 0;
+        ctx->gfxCacheBytes = 0;
 
         notifyStateChange(ctx, 0, "Disconnected");  // 0 = disconnected
     }
 }
 
+// 触控帧之后的第一次帧更新视为服务器对该手势的响应
+static void viDesk_recordTouchLatency(ViDeskClientContext* viCtx) {
+    uint64_t sentNs = atomic_exchange(&viCtx->touchPendingNs, 0);
+    if (sentNs == 0)
+        return;
+
+    uint64_t latency = viDesk_monotonicNs() - sentNs;
+    ViDeskTouchCounters* stats = &viCtx->touchStats;
+    atomic_fetch_add_explicit(&stats->latencySamples, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->latencyTotalNs, latency, memory_order_relaxed);
+    atomic_store_explicit(&stats->lastLatencyNs, latency, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&stats->latencyMaxNs, memory_order_relaxed);
+    while (latency > max &&
+           !atomic_compare_exchange_weak_explicit(&stats->latencyMaxNs, &max, latency,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
 // FreeRDP 回调 - EndPaint (帧更新)
 static BOOL viDesk_EndPaint(rdpContext* context) {
     if (!context || !context->gdi)
@@ -663,6 +1541,9 @@ static BOOL viDesk_EndPaint(rdpContext* context) {
     ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
     ViDeskContext* ctx = viCtx ? viCtx->viDeskCtx : NULL;
 
+    if (viCtx)
+        viDesk_sessionStatsRecordPaint(viCtx->sessionStats);
+
     if (ctx && gdi->primary && gdi->primary->hdc && gdi->primary->hdc->hwnd &&
         gdi->primary->hdc->hwnd->invalid &&
         gdi->primary->hdc->hwnd->invalid->null == FALSE) {
@@ -672,7 +1553,18 @@ static BOOL viDesk_EndPaint(rdpContext* context) {
         int h = gdi->primary->hdc->hwnd->invalid->h;
 
         ctx->frameBuffer = gdi->primary_buffer;
-        notifyFrameUpdate(ctx, x, y, w, h);
+        viDesk_recordTouchLatency(viCtx);
+        uint64_t now = viDesk_monotonicNs();
+        if (viCtx->dumpMode == VIDESK_SESSION_DUMP_REPLAY && atomic_load(&viCtx->replayFirstFrameNs) == 0)
+            atomic_store(&viCtx->replayFirstFrameNs, now);
+        uint64_t dropToFrameNs = 0;
+        if (viDesk_reconnectRecordFrame(viCtx->reconnect, now, &dropToFrameNs))
+            viDesk_log(ctx, "[ViDesk] 重连后第一帧: 掉线 %.0f ms 后恢复\n", dropToFrameNs / 1e6);
+        uint64_t sequence = viDesk_latencyRecordFrame(viCtx->latencyTracker, now, x, y, w, h);
+        atomic_store(&viCtx->lastFrameSequence, sequence);
+        if (atomic_load(&viCtx->headlessPresentation))
+            viDesk_latencyRecordPresent(viCtx->latencyTracker, sequence, now);
+        notifyFrameUpdate(ctx, x, y, w, h, sequence);
     }
 
     return TRUE;
@@ -689,29 +1581,29 @@ static DWORD viDesk_VerifyCertificateEx(freerdp* instance, const char* host, UIN
     ViDeskClientContext* viCtx = (ViDeskClientContext*)instance->context;
     ViDeskContext* ctx = viCtx ? viCtx->viDeskCtx : NULL;
 
-    viDesk_log("[ViDesk] 证书验证: CN=%s, Subject=%s, Issuer=%s\n",
+    viDesk_log(ctx, "[ViDesk] 证书验证: CN=%s, Subject=%s, Issuer=%s\n",
            common_name ? common_name : "N/A",
            subject ? subject : "N/A",
            issuer ? issuer : "N/A");
-    viDesk_log("[ViDesk] 证书指纹: %s\n", fingerprint ? fingerprint : "N/A");
+    viDesk_log(ctx, "[ViDesk] 证书指纹: %s\n", fingerprint ? fingerprint : "N/A");
 
     // 如果配置了忽略证书错误，自动接受
     rdpSettings* settings = instance->context->settings;
     if (settings && freerdp_settings_get_bool(settings, FreeRDP_IgnoreCertificate)) {
-        viDesk_log("[ViDesk] 自动接受证书 (IgnoreCertificate=TRUE)\n");
+        viDesk_log(ctx, "[ViDesk] 自动接受证书 (IgnoreCertificate=TRUE)\n");
         return 1;  // 1 = 永久接受, 2 = 本次会话接受
     }
 
     // 调用 Swift 回调
-    if (g_callbacks.onVerifyCertificate && ctx && ctx->swiftCallbackContext) {
+    if (ctx && ctx->callbacks.onVerifyCertificate && ctx->swiftCallbackContext) {
         BOOL hostMismatch = (flags & VERIFY_CERT_FLAG_MISMATCH) != 0;
-        BOOL accepted = g_callbacks.onVerifyCertificate(ctx->swiftCallbackContext,
+        BOOL accepted = ctx->callbacks.onVerifyCertificate(ctx->swiftCallbackContext,
             common_name, subject, issuer, fingerprint, hostMismatch);
         return accepted ? 1 : 0;
     }
 
     // 默认接受证书（开发阶段）
-    viDesk_log("[ViDesk] 默认接受证书\n");
+    viDesk_log(ctx, "[ViDesk] 默认接受证书\n");
     return 1;
 }
 
@@ -727,10 +1619,11 @@ static DWORD viDesk_VerifyChangedCertificateEx(freerdp* instance, const char* ho
     (void)old_issuer;
     (void)flags;
 
-    viDesk_log("[ViDesk] 证书已变更!\n");
-    viDesk_log("[ViDesk] 旧指纹: %s\n", old_fingerprint ? old_fingerprint : "N/A");
-    viDesk_log("[ViDesk] 新指纹: %s\n", new_fingerprint ? new_fingerprint : "N/A");
-    viDesk_log("[ViDesk] CN=%s, Subject=%s, Issuer=%s\n",
+    ViDeskContext* ctx = viDesk_contextFromRdp(instance->context);
+    viDesk_log(ctx, "[ViDesk] 证书已变更!\n");
+    viDesk_log(ctx, "[ViDesk] 旧指纹: %s\n", old_fingerprint ? old_fingerprint : "N/A");
+    viDesk_log(ctx, "[ViDesk] 新指纹: %s\n", new_fingerprint ? new_fingerprint : "N/A");
+    viDesk_log(ctx, "[ViDesk] CN=%s, Subject=%s, Issuer=%s\n",
            common_name ? common_name : "N/A",
            subject ? subject : "N/A",
            issuer ? issuer : "N/A");
@@ -738,12 +1631,12 @@ static DWORD viDesk_VerifyChangedCertificateEx(freerdp* instance, const char* ho
     // 如果配置了忽略证书错误，自动接受
     rdpSettings* settings = instance->context->settings;
     if (settings && freerdp_settings_get_bool(settings, FreeRDP_IgnoreCertificate)) {
-        viDesk_log("[ViDesk] 自动接受变更的证书 (IgnoreCertificate=TRUE)\n");
+        viDesk_log(ctx, "[ViDesk] 自动接受变更的证书 (IgnoreCertificate=TRUE)\n");
         return 1;
     }
 
     // 默认接受变更的证书（开发阶段）
-    viDesk_log("[ViDesk] 默认接受变更的证书\n");
+    viDesk_log(ctx, "[ViDesk] 默认接受变更的证书\n");
     return 1;
 }
 
@@ -752,9 +1645,9 @@ static BOOL viDesk_AuthenticateEx(freerdp* instance, char** username, char** pas
     ViDeskClientContext* viCtx = (ViDeskClientContext*)instance->context;
     ViDeskContext* ctx = viCtx ? viCtx->viDeskCtx : NULL;
 
-    viDesk_log("[ViDesk] AuthenticateEx 回调被调用 (原因: %s)\n", reason);
-    viDesk_log("[ViDesk] 用户名: %s\n", username && *username ? *username : "(空)");
-    viDesk_log("[ViDesk] 域: %s\n", domain && *domain ? *domain : "(空)");
+    viDesk_log(ctx, "[ViDesk] AuthenticateEx 回调被调用 (原因: %s)\n", reason);
+    viDesk_log(ctx, "[ViDesk] 用户名: %s\n", username && *username ? *username : "(空)");
+    viDesk_log(ctx, "[ViDesk] 域: %s\n", domain && *domain ? *domain : "(空)");
 
     // 从 settings 中读取已设置的凭证
     rdpSettings* settings = instance->context->settings;
@@ -766,15 +1659,15 @@ static BOOL viDesk_AuthenticateEx(freerdp* instance, char** username, char** pas
         settingsUsername = freerdp_settings_get_string(settings, FreeRDP_Username);
         settingsPassword = freerdp_settings_get_string(settings, FreeRDP_Password);
         settingsDomain = freerdp_settings_get_string(settings, FreeRDP_Domain);        
-        viDesk_log("[ViDesk] Settings中的用户名: %s\n", settingsUsername ? settingsUsername : "(空)");
-        viDesk_log("[ViDesk] Settings中的密码长度: %d\n", settingsPassword ? (int)strlen(settingsPassword) : 0);
-        viDesk_log("[ViDesk] Settings中的域: %s\n", settingsDomain ? settingsDomain : "(空)");
+        viDesk_log(ctx, "[ViDesk] Settings中的用户名: %s\n", settingsUsername ? settingsUsername : "(空)");
+        viDesk_log(ctx, "[ViDesk] Settings中的密码长度: %d\n", settingsPassword ? (int)strlen(settingsPassword) : 0);
+        viDesk_log(ctx, "[ViDesk] Settings中的域: %s\n", settingsDomain ? settingsDomain : "(空)");
     }
 
     // 调用 Swift 回调（如果设置了）
     BOOL result = TRUE;
-    if (g_callbacks.onAuthenticate && ctx && ctx->swiftCallbackContext) {
-        result = g_callbacks.onAuthenticate(ctx->swiftCallbackContext, username, password, domain);
+    if (ctx && ctx->callbacks.onAuthenticate && ctx->swiftCallbackContext) {
+        result = ctx->callbacks.onAuthenticate(ctx->swiftCallbackContext, username, password, domain);
     } else {
         // 如果没有设置 Swift 回调，从 settings 中更新指针
         // 这是关键修复：FreeRDP 需要指针指向有效的字符串
@@ -784,7 +1677,7 @@ static BOOL viDesk_AuthenticateEx(freerdp* instance, char** username, char** pas
                 free(*username);
             }
             *username = _strdup(settingsUsername);
-            viDesk_log("[ViDesk] 更新用户名指针: %s\n", *username);
+            viDesk_log(ctx, "[ViDesk] 更新用户名指针: %s\n", *username);
         }
         
         if (settingsPassword && password) {
@@ -793,7 +1686,7 @@ static BOOL viDesk_AuthenticateEx(freerdp* instance, char** username, char** pas
                 free(*password);
             }
             *password = _strdup(settingsPassword);
-            viDesk_log("[ViDesk] 更新密码指针 (长度: %d)\n", (int)strlen(*password));
+            viDesk_log(ctx, "[ViDesk] 更新密码指针 (长度: %d)\n", (int)strlen(*password));
         }
         
         if (settingsDomain && domain) {
@@ -803,12 +1696,12 @@ static BOOL viDesk_AuthenticateEx(freerdp* instance, char** username, char** pas
             }
             *domain = settingsDomain ? _strdup(settingsDomain) : NULL;
             if (*domain) {
-                viDesk_log("[ViDesk] 更新域指针: %s\n", *domain);
+                viDesk_log(ctx, "[ViDesk] 更新域指针: %s\n", *domain);
             }
         }    }    
     // 验证凭证是否有效
     if (result && (!username || !*username || !password || !*password)) {
-        viDesk_log("[ViDesk] 警告: AuthenticateEx 回调返回 TRUE，但凭证为空\n");    }
+        viDesk_log(ctx, "[ViDesk] 警告: AuthenticateEx 回调返回 TRUE，但凭证为空\n");    }
     
     return result;
 }
@@ -818,9 +1711,9 @@ static BOOL viDesk_Authenticate(freerdp* instance, char** username, char** passw
     ViDeskClientContext* viCtx = (ViDeskClientContext*)instance->context;
     ViDeskContext* ctx = viCtx ? viCtx->viDeskCtx : NULL;
 
-    viDesk_log("[ViDesk] 认证回调被调用\n");
-    viDesk_log("[ViDesk] 用户名: %s\n", username && *username ? *username : "(空)");
-    viDesk_log("[ViDesk] 域: %s\n", domain && *domain ? *domain : "(空)");
+    viDesk_log(ctx, "[ViDesk] 认证回调被调用\n");
+    viDesk_log(ctx, "[ViDesk] 用户名: %s\n", username && *username ? *username : "(空)");
+    viDesk_log(ctx, "[ViDesk] 域: %s\n", domain && *domain ? *domain : "(空)");
 
     // 从 settings 中读取已设置的凭证
     rdpSettings* settings = instance->context->settings;
@@ -835,8 +1728,8 @@ static BOOL viDesk_Authenticate(freerdp* instance, char** username, char** passw
 
     // 调用 Swift 回调（如果设置了）
     BOOL result = TRUE;
-    if (g_callbacks.onAuthenticate && ctx && ctx->swiftCallbackContext) {
-        result = g_callbacks.onAuthenticate(ctx->swiftCallbackContext, username, password, domain);
+    if (ctx && ctx->callbacks.onAuthenticate && ctx->swiftCallbackContext) {
+        result = ctx->callbacks.onAuthenticate(ctx->swiftCallbackContext, username, password, domain);
     } else {
         // 如果没有设置 Swift 回调，从 settings 中更新指针
         // 这是关键修复：FreeRDP 需要指针指向有效的字符串
@@ -865,7 +1758,7 @@ static BOOL viDesk_Authenticate(freerdp* instance, char** username, char** passw
         }    }    
     // 验证凭证是否有效
     if (result && (!username || !*username || !password || !*password)) {
-        viDesk_log("[ViDesk] 警告: 认证回调返回 TRUE，但凭证为空\n");    }
+        viDesk_log(ctx, "[ViDesk] 警告: 认证回调返回 TRUE，但凭证为空\n");    }
     
     return result;
 }
@@ -873,21 +1766,126 @@ static BOOL viDesk_Authenticate(freerdp* instance, char** username, char** passw
 // === 公共 API 实现 ===
 
 // freerdp_client_context_new 回调
+// 替代 freerdp_send_channel_data：所有通道消息先经过发送调度器
+static BOOL viDesk_SendChannelData(freerdp* instance, UINT16 channelId, const BYTE* data, size_t size) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)instance->context;
+    viDesk_channelStatsRecord(viCtx->channelStats, freerdp_channels_get_name_by_id(instance, channelId), false,
+                              data, size, true, size);
+    return viDesk_sendSchedulerSubmit(viCtx->sendScheduler, channelId, data, size);
+}
+
+// 替代 freerdp_channels_data：按通道计数后交给默认实现分发给通道插件
+static BOOL viDesk_ReceiveChannelData(freerdp* instance, UINT16 channelId, const BYTE* data, size_t size,
+                                      UINT32 flags, size_t totalSize) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)instance->context;
+    viDesk_channelStatsRecord(viCtx->channelStats, freerdp_channels_get_name_by_id(instance, channelId), true,
+                              data, size, (flags & CHANNEL_FLAG_FIRST) != 0, totalSize);
+    return viCtx->receiveChannelData(instance, channelId, data, size, flags, totalSize);
+}
+
 static BOOL viDesk_ClientNew(freerdp* instance, rdpContext* context) {
-    (void)instance;
-    (void)context;
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
+    if (!InitializeCriticalSectionAndSpinCount(&viCtx->errorLock, 4000))
+        return FALSE;
+
+    // freerdp_new 已设置默认的 SendChannelData，调度器在其之上排队分片
+    viCtx->sendScheduler = viDesk_sendSchedulerNew(instance, instance->SendChannelData);
+    if (!viCtx->sendScheduler) {
+        DeleteCriticalSection(&viCtx->errorLock);
+        return FALSE;
+    }
+    instance->SendChannelData = viDesk_SendChannelData;
+    viCtx->receiveChannelData = instance->ReceiveChannelData ? instance->ReceiveChannelData : freerdp_channels_data;
+    instance->ReceiveChannelData = viDesk_ReceiveChannelData;
+
+    viCtx->latencyTracker = viDesk_latencyTrackerNew();
+    if (!viCtx->latencyTracker) {
+        viDesk_sendSchedulerFree(viCtx->sendScheduler);
+        viCtx->sendScheduler = NULL;
+        DeleteCriticalSection(&viCtx->errorLock);
+        return FALSE;
+    }
+
+    viCtx->inputRecorder = viDesk_inputRecorderNew();
+    if (!viCtx->inputRecorder) {
+        viDesk_latencyTrackerFree(viCtx->latencyTracker);
+        viCtx->latencyTracker = NULL;
+        viDesk_sendSchedulerFree(viCtx->sendScheduler);
+        viCtx->sendScheduler = NULL;
+        DeleteCriticalSection(&viCtx->errorLock);
+        return FALSE;
+    }
+
+    viCtx->pointerCache = viDesk_pointerCacheNew();
+    viCtx->sessionStats = viDesk_sessionStatsNew();
+    viCtx->qualityController = viDesk_qualityControllerNew();
+    viCtx->transport = viDesk_transportNew();
+    viCtx->reconnect = viDesk_reconnectNew();
+    viCtx->liveness = viDesk_livenessNew();
+    viCtx->channelStats = viDesk_channelStatsNew();
+    if (!viCtx->pointerCache || !viCtx->sessionStats || !viCtx->qualityController || !viCtx->transport ||
+        !viCtx->reconnect || !viCtx->liveness || !viCtx->channelStats) {
+        viDesk_pointerCacheFree(viCtx->pointerCache);
+        viCtx->pointerCache = NULL;
+        viDesk_sessionStatsFree(viCtx->sessionStats);
+        viCtx->sessionStats = NULL;
+        viDesk_qualityControllerFree(viCtx->qualityController);
+        viCtx->qualityController = NULL;
+        viDesk_transportFree(viCtx->transport);
+        viCtx->transport = NULL;
+        viDesk_reconnectFree(viCtx->reconnect);
+        viCtx->reconnect = NULL;
+        viDesk_livenessFree(viCtx->liveness);
+        viCtx->liveness = NULL;
+        viDesk_channelStatsFree(viCtx->channelStats);
+        viCtx->channelStats = NULL;
+        viDesk_inputRecorderFree(viCtx->inputRecorder);
+        viCtx->inputRecorder = NULL;
+        viDesk_latencyTrackerFree(viCtx->latencyTracker);
+        viCtx->latencyTracker = NULL;
+        viDesk_sendSchedulerFree(viCtx->sendScheduler);
+        viCtx->sendScheduler = NULL;
+        DeleteCriticalSection(&viCtx->errorLock);
+        return FALSE;
+    }
+
+    atomic_store(&viCtx->qualityEnableRequest, -1);
+    viCtx->compressionLevel = VIDESK_COMPRESSION_XCRUSH;
+
     return TRUE;
 }
 
 static void viDesk_ClientFree(freerdp* instance, rdpContext* context) {
     (void)instance;
-    (void)context;
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
+    viDesk_sendSchedulerFree(viCtx->sendScheduler);
+    viCtx->sendScheduler = NULL;
+    viDesk_latencyTrackerFree(viCtx->latencyTracker);
+    viCtx->latencyTracker = NULL;
+    viDesk_inputRecorderFree(viCtx->inputRecorder);
+    viCtx->inputRecorder = NULL;
+    viDesk_pointerCacheFree(viCtx->pointerCache);
+    viCtx->pointerCache = NULL;
+    viDesk_sessionStatsFree(viCtx->sessionStats);
+    viCtx->sessionStats = NULL;
+    viDesk_qualityControllerFree(viCtx->qualityController);
+    viCtx->qualityController = NULL;
+    viDesk_transportFree(viCtx->transport);
+    viCtx->transport = NULL;
+    viDesk_reconnectFree(viCtx->reconnect);
+    viCtx->reconnect = NULL;
+    viDesk_livenessFree(viCtx->liveness);
+    viCtx->liveness = NULL;
+    viDesk_channelStatsFree(viCtx->channelStats);
+    viCtx->channelStats = NULL;
+    DeleteCriticalSection(&viCtx->errorLock);
 }
 
 ViDeskContext* viDesk_createContext(void) {
     ViDeskContext* ctx = (ViDeskContext*)calloc(1, sizeof(ViDeskContext));
     if (!ctx) {
-        setLastError("Failed to allocate ViDeskContext");
+        setLastError(NULL, "Failed to allocate ViDeskContext");
         return NULL;
     }
 
@@ -902,7 +1900,7 @@ ViDeskContext* viDesk_createContext(void) {
 
     rdpContext* context = freerdp_client_context_new(&clientEntryPoints);
     if (!context) {
-        setLastError("Failed to create FreeRDP client context");
+        setLastError(NULL, "Failed to create FreeRDP client context");
         free(ctx);
         return NULL;
     }
@@ -934,6 +1932,9 @@ ViDeskContext* viDesk_createContext(void) {
     ctx->isConnected = FALSE;
     ctx->isAuthenticated = FALSE;
 
+    // 每个会话独立的日志句柄
+    ctx->logFile = viDesk_openDefaultLogFile();
+
     return ctx;
 }
 
@@ -947,21 +1948,44 @@ void viDesk_destroyContext(ViDeskContext* ctx) {
             freerdp_disconnect(instance);
         }
         freerdp_client_context_free(ctx->rdpCtx);
+        ctx->rdpCtx = NULL;
+    }
+
+    if (ctx->logFile) {
+        fclose((FILE*)ctx->logFile);
+        ctx->logFile = NULL;
     }
 
     free(ctx);
 }
 
 void viDesk_setCallbacks(ViDeskContext* ctx, ViDeskCallbacks callbacks, void* swiftContext) {
-    g_callbacks = callbacks;
-    if (ctx) {
-        ctx->swiftCallbackContext = swiftContext;
-    }
+    if (!ctx)
+        return;
+
+    // 回调只作用于当前上下文，不影响其他会话
+    ctx->callbacks = callbacks;
+    ctx->swiftCallbackContext = swiftContext;
+}
+
+void viDesk_setContextLogFile(ViDeskContext* ctx, const char* path) {
+    if (!ctx)
+        return;
+
+    // 在锁外打开新文件，锁内只交换句柄
+    FILE* file = path ? fopen(path, "a") : NULL;
+    viDesk_lockContext(ctx);
+    FILE* previous = (FILE*)ctx->logFile;
+    ctx->logFile = file;
+    viDesk_unlockContext(ctx);
+
+    if (previous)
+        fclose(previous);
 }
 
 bool viDesk_setServer(ViDeskContext* ctx, const char* hostname, int port) {
     if (!ctx || !ctx->rdpCtx || !hostname) {
-        setLastError("Invalid parameters");
+        setLastError(ctx, "Invalid parameters");
         return false;
     }
 
@@ -980,7 +2004,7 @@ bool viDesk_setServer(ViDeskContext* ctx, const char* hostname, int port) {
 
 bool viDesk_setCredentials(ViDeskContext* ctx, const char* username, const char* password, const char* domain) {
     if (!ctx || !ctx->rdpCtx) {
-        setLastError("Invalid context");
+        setLastError(ctx, "Invalid context");
         return false;
     }
 
@@ -988,10 +2012,10 @@ bool viDesk_setCredentials(ViDeskContext* ctx, const char* username, const char*
     if (!settings)
         return false;
 
-    viDesk_log("[ViDesk] 设置凭证: 用户=%s, 域=%s\n",
+    viDesk_log(ctx, "[ViDesk] 设置凭证: 用户=%s, 域=%s\n",
            username ? username : "(空)",
            domain ? domain : "(空)");
-    viDesk_log("[ViDesk] 密码信息: 指针=%p, 长度=%d\n",
+    viDesk_log(ctx, "[ViDesk] 密码信息: 指针=%p, 长度=%d\n",
            password,
            password ? (int)strlen(password) : 0);
 
@@ -1008,12 +2032,12 @@ bool viDesk_setCredentials(ViDeskContext* ctx, const char* username, const char*
     // 但如果是 NULL，则不设置
     if (password != NULL) {
         passwordSet = freerdp_settings_set_string(settings, FreeRDP_Password, password);
-        viDesk_log("[ViDesk] 设置密码: 长度=%d, 内容=%s\n", 
+        viDesk_log(ctx, "[ViDesk] 设置密码: 长度=%d, 内容=%s\n", 
                (int)strlen(password), 
                strlen(password) > 0 ? "***" : "(空)");
     } else {
         // 如果密码是 NULL，不设置（保持原有值）
-        viDesk_log("[ViDesk] 警告: 密码指针为 NULL，不设置密码\n");
+        viDesk_log(ctx, "[ViDesk] 警告: 密码指针为 NULL，不设置密码\n");
     }
     
     // 设置域（即使为空也设置）
@@ -1028,7 +2052,7 @@ bool viDesk_setCredentials(ViDeskContext* ctx, const char* username, const char*
 
 bool viDesk_setDisplay(ViDeskContext* ctx, int width, int height, int colorDepth) {
     if (!ctx || !ctx->rdpCtx || width <= 0 || height <= 0) {
-        setLastError("Invalid display parameters");
+        setLastError(ctx, "Invalid display parameters");
         return false;
     }
 
@@ -1062,7 +2086,7 @@ bool viDesk_setDisplay(ViDeskContext* ctx, int width, int height, int colorDepth
 bool viDesk_setPerformanceFlags(ViDeskContext* ctx, bool enableWallpaper, bool enableFullWindowDrag,
                                  bool enableMenuAnimations, bool enableThemes, bool enableFontSmoothing) {
     if (!ctx || !ctx->rdpCtx) {
-        setLastError("Invalid context");
+        setLastError(ctx, "Invalid context");
         return false;
     }
 
@@ -1079,9 +2103,42 @@ bool viDesk_setPerformanceFlags(ViDeskContext* ctx, bool enableWallpaper, bool e
     return true;
 }
 
+bool viDesk_setCompressionLevel(ViDeskContext* ctx, ViDeskCompressionLevel level) {
+    if (!ctx || !ctx->rdpCtx) {
+        setLastError(ctx, "Invalid context");
+        return false;
+    }
+
+    if (level < VIDESK_COMPRESSION_NONE || level > VIDESK_COMPRESSION_XCRUSH) {
+        setLastError(ctx, "Invalid compression level");
+        return false;
+    }
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    viCtx->compressionLevel = level;
+    return true;
+}
+
+void viDesk_getCompressionStats(ViDeskContext* ctx, ViDeskCompressionStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (!viCtx)
+        return;
+
+    stats->level = viCtx->compressionLevel;
+    rdpMetrics* metrics = viCtx->common.context.metrics;
+    if (metrics) {
+        stats->compressedBytes = metrics->TotalCompressedBytes;
+        stats->uncompressedBytes = metrics->TotalUncompressedBytes;
+    }
+}
+
 bool viDesk_setSecurity(ViDeskContext* ctx, bool useNLA, bool useTLS, bool ignoreCertErrors) {
     if (!ctx || !ctx->rdpCtx) {
-        setLastError("Invalid context");
+        setLastError(ctx, "Invalid context");
         return false;
     }
 
@@ -1089,7 +2146,7 @@ bool viDesk_setSecurity(ViDeskContext* ctx, bool useNLA, bool useTLS, bool ignor
     if (!settings)
         return false;
 
-    viDesk_log("[ViDesk] 设置安全选项: NLA=%s, TLS=%s, 忽略证书=%s\n",
+    viDesk_log(ctx, "[ViDesk] 设置安全选项: NLA=%s, TLS=%s, 忽略证书=%s\n",
            useNLA ? "是" : "否",
            useTLS ? "是" : "否",
            ignoreCertErrors ? "是" : "否");
@@ -1097,7 +2154,7 @@ bool viDesk_setSecurity(ViDeskContext* ctx, bool useNLA, bool useTLS, bool ignor
     // NLA 要求 TLS 作为传输层，强制启用
     if (useNLA && !useTLS) {
         useTLS = true;
-        viDesk_log("[ViDesk] NLA 要求 TLS，已自动启用 TLS\n");
+        viDesk_log(ctx, "[ViDesk] NLA 要求 TLS，已自动启用 TLS\n");
     }
 
     // 设置安全协议
@@ -1110,11 +2167,11 @@ bool viDesk_setSecurity(ViDeskContext* ctx, bool useNLA, bool useTLS, bool ignor
     if (!useNLA && !useTLS) {
         // 只使用 RDP 安全
         freerdp_settings_set_bool(settings, FreeRDP_RdpSecurity, TRUE);
-        viDesk_log("[ViDesk] 仅启用 RDP 安全层\n");
+        viDesk_log(ctx, "[ViDesk] 仅启用 RDP 安全层\n");
     } else {
         // 启用 RDP 安全作为后备选项
         freerdp_settings_set_bool(settings, FreeRDP_RdpSecurity, TRUE);
-        viDesk_log("[ViDesk] 启用 RDP 安全层作为后备\n");
+        viDesk_log(ctx, "[ViDesk] 启用 RDP 安全层作为后备\n");
     }
 
     // 启用安全层协商
@@ -1135,7 +2192,7 @@ bool viDesk_setSecurity(ViDeskContext* ctx, bool useNLA, bool useTLS, bool ignor
 bool viDesk_setGateway(ViDeskContext* ctx, const char* hostname, int port,
                        const char* username, const char* password, const char* domain) {
     if (!ctx || !ctx->rdpCtx) {
-        setLastError("Invalid context");
+        setLastError(ctx, "Invalid context");
         return false;
     }
 
@@ -1163,13 +2220,13 @@ bool viDesk_setGateway(ViDeskContext* ctx, const char* hostname, int port,
 
 bool viDesk_connect(ViDeskContext* ctx) {
     if (!ctx || !ctx->rdpCtx) {
-        setLastError("Invalid context");
+        setLastError(ctx, "Invalid context");
         return false;
     }
 
     freerdp* instance = ctx->rdpCtx->instance;
     if (!instance) {
-        setLastError("No FreeRDP instance");
+        setLastError(ctx, "No FreeRDP instance");
         return false;
     }
 
@@ -1181,14 +2238,12 @@ bool viDesk_connect(ViDeskContext* ctx) {
         const char* username = freerdp_settings_get_string(settings, FreeRDP_Username);
         const char* password = freerdp_settings_get_string(settings, FreeRDP_Password);
         const char* domain = freerdp_settings_get_string(settings, FreeRDP_Domain);
-        viDesk_log("[ViDesk] 正在连接: %s:%u (用户: %s)\n",
+        viDesk_log(ctx, "[ViDesk] 正在连接: %s:%u (用户: %s)\n",
                hostname ? hostname : "N/A",
                port,
                username ? username : "N/A");    }
 
-    freerdp_settings_set_bool(settings, FreeRDP_AutoReconnectionEnabled, FALSE);
-
-    viDesk_log("[ViDesk] 连接设置: GFX=%d, AutoDetect=%d, Heartbeat=%d\n",
+    viDesk_log(ctx, "[ViDesk] 连接设置: GFX=%d, AutoDetect=%d, Heartbeat=%d\n",
         freerdp_settings_get_bool(settings, FreeRDP_SupportGraphicsPipeline),
         freerdp_settings_get_bool(settings, FreeRDP_NetworkAutoDetect),
         freerdp_settings_get_bool(settings, FreeRDP_SupportHeartbeatPdu));
@@ -1197,7 +2252,7 @@ bool viDesk_connect(ViDeskContext* ctx) {
     notifyStateChange(ctx, 1, "Connecting...");  // 1 = connecting
 
     // 执行连接
-    viDesk_log("[ViDesk] 调用 freerdp_connect()...\n");
+    viDesk_log(ctx, "[ViDesk] 调用 freerdp_connect()...\n");
     BOOL connectResult = freerdp_connect(instance);    if (!connectResult) {
         UINT32 error = freerdp_get_last_error(ctx->rdpCtx);
         const char* errorStr = freerdp_get_last_error_string(error);
@@ -1210,42 +2265,66 @@ bool viDesk_connect(ViDeskContext* ctx) {
                  errorName ? errorName : "UNKNOWN",
                  error);
 
-        viDesk_log("[ViDesk] 连接失败: %s\n", errorMsg);
-        viDesk_log("[ViDesk] 错误码: 0x%08X\n", error);
-        viDesk_log("[ViDesk] 错误名称: %s\n", errorName ? errorName : "UNKNOWN");
-        viDesk_log("[ViDesk] 错误类别: %s\n", errorCategory ? errorCategory : "UNKNOWN");
+        viDesk_log(ctx, "[ViDesk] 连接失败: %s\n", errorMsg);
+        viDesk_log(ctx, "[ViDesk] 错误码: 0x%08X\n", error);
+        viDesk_log(ctx, "[ViDesk] 错误名称: %s\n", errorName ? errorName : "UNKNOWN");
+        viDesk_log(ctx, "[ViDesk] 错误类别: %s\n", errorCategory ? errorCategory : "UNKNOWN");
         
         // 打印详细的认证相关错误信息
         if (error == 0x00020009 || errorName) {
             if (strstr(errorName ? errorName : "", "AUTHENTICATION") != NULL) {
-                viDesk_log("[ViDesk] ========== 认证失败详细信息 ==========\n");
+                viDesk_log(ctx, "[ViDesk] ========== 认证失败详细信息 ==========\n");
                 rdpSettings* settings = ctx->rdpCtx->settings;
                 if (settings) {
                     const char* username = freerdp_settings_get_string(settings, FreeRDP_Username);
                     const char* password = freerdp_settings_get_string(settings, FreeRDP_Password);
                     const char* domain = freerdp_settings_get_string(settings, FreeRDP_Domain);
-                    viDesk_log("[ViDesk] Settings中的用户名: %s\n", username ? username : "(空)");
-                    viDesk_log("[ViDesk] Settings中的密码长度: %d\n", password ? (int)strlen(password) : 0);
-                    viDesk_log("[ViDesk] Settings中的域: %s\n", domain ? domain : "(空)");
+                    viDesk_log(ctx, "[ViDesk] Settings中的用户名: %s\n", username ? username : "(空)");
+                    viDesk_log(ctx, "[ViDesk] Settings中的密码长度: %d\n", password ? (int)strlen(password) : 0);
+                    viDesk_log(ctx, "[ViDesk] Settings中的域: %s\n", domain ? domain : "(空)");
                     BOOL nla = freerdp_settings_get_bool(settings, FreeRDP_NlaSecurity);
                     BOOL tls = freerdp_settings_get_bool(settings, FreeRDP_TlsSecurity);
                     BOOL rdp = freerdp_settings_get_bool(settings, FreeRDP_RdpSecurity);
-                    viDesk_log("[ViDesk] NLA: %s, TLS: %s, RDP: %s\n", nla ? "是" : "否", tls ? "是" : "否", rdp ? "是" : "否");
+                    viDesk_log(ctx, "[ViDesk] NLA: %s, TLS: %s, RDP: %s\n", nla ? "是" : "否", tls ? "是" : "否", rdp ? "是" : "否");
                 }
-                viDesk_log("[ViDesk] =========================================\n");
+                viDesk_log(ctx, "[ViDesk] =========================================\n");
             }
-        }        setLastError(errorMsg);
+        }        setLastError(ctx, errorMsg);
         notifyStateChange(ctx, 5, errorMsg);  // 5 = error
         return false;
     }
 
-    viDesk_log("[ViDesk] 连接成功!\n");    return true;
+    viDesk_log(ctx, "[ViDesk] 连接成功!\n");
+
+    ViDeskTransportStats transportStats;
+    viDesk_transportGetStats(((ViDeskClientContext*)ctx->rdpCtx)->transport, &transportStats);
+    if (transportStats.prewarmSavedNs > 0)
+        viDesk_log(ctx, "[ViDesk] 使用预热的 TCP 连接，省下 %.0f ms\n", transportStats.prewarmSavedNs / 1e6);
+    if (transportStats.remoteAddress[0])
+        viDesk_log(ctx, "[ViDesk] 连接地址: %s (尝试 %u/%u 个地址，比逐个尝试至少省下 %.0f ms)\n",
+                   transportStats.remoteAddress, transportStats.addressAttempts,
+                   transportStats.addressCandidates, transportStats.raceSavedNs / 1e6);
+
+    ViDeskWanEmulationStats wanStats;
+    viDesk_transportGetWanStats(((ViDeskClientContext*)ctx->rdpCtx)->transport, &wanStats);
+    if (wanStats.enabled)
+        viDesk_log(ctx, "[ViDesk] WAN 模拟: 单向延迟 %u±%u ms, 带宽 %u/%u kbps, 断流 每 %u ms 约 %u ms\n",
+                   wanStats.profile.latencyMs, wanStats.profile.jitterMs, wanStats.profile.downlinkKbps,
+                   wanStats.profile.uplinkKbps, wanStats.profile.stallIntervalMs, wanStats.profile.stallMs);
+    return true;
 }
 
 void viDesk_disconnect(ViDeskContext* ctx) {
     if (!ctx || !ctx->rdpCtx)
         return;
 
+    // 重连在另一个线程上进行，不能同时 freerdp_disconnect；中止后由调用方再次断开
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    if (atomic_load(&viCtx->reconnecting)) {
+        freerdp_abort_connect_context(ctx->rdpCtx);
+        return;
+    }
+
     freerdp* instance = ctx->rdpCtx->instance;
     if (instance && ctx->isConnected) {
         freerdp_disconnect(instance);
@@ -1255,10 +2334,183 @@ void viDesk_disconnect(ViDeskContext* ctx) {
     ctx->isAuthenticated = FALSE;
 }
 
+bool viDesk_reconnect(ViDeskContext* ctx) {
+    if (!ctx || !ctx->rdpCtx || !ctx->isConnected) {
+        setLastError(ctx, "Not connected");
+        return false;
+    }
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    ViDeskReconnectStats before;
+    viDesk_reconnectGetStats(viCtx->reconnect, &before);
+    viDesk_log(ctx, "[ViDesk] 快速重连 #%u (自动重连 cookie: %s)\n",
+               before.attempts + 1, before.hasCookie ? "有" : "无");
+
+    atomic_store(&viCtx->reconnecting, true);
+    bool ok = viDesk_reconnectRun(viCtx->reconnect, ctx->rdpCtx);
+    atomic_store(&viCtx->reconnecting, false);
+
+    ViDeskReconnectStats stats;
+    viDesk_reconnectGetStats(viCtx->reconnect, &stats);
+    if (!ok) {
+        UINT32 error = freerdp_get_last_error(ctx->rdpCtx);
+        const char* errorStr = freerdp_get_last_error_string(error);
+        setLastError(ctx, errorStr ? errorStr : "Reconnect failed");
+        viDesk_log(ctx, "[ViDesk] 快速重连失败 (%.0f ms): %s\n", stats.lastAttemptNs / 1e6,
+                   errorStr ? errorStr : "N/A");
+        return false;
+    }
+
+    // 服务器可能以不同的分辨率恢复会话，DesktopResize 已调整 GDI
+    rdpGdi* gdi = ctx->rdpCtx->gdi;
+    if (gdi) {
+        ctx->frameWidth = gdi->width;
+        ctx->frameHeight = gdi->height;
+        ctx->frameBuffer = gdi->primary_buffer;
+    }
+    viDesk_livenessReset(viCtx->liveness, viDesk_monotonicNs());
+    viDesk_log(ctx, "[ViDesk] 快速重连成功: 本次尝试 %.0f ms, 掉线到连接 %.0f ms\n",
+               stats.lastAttemptNs / 1e6, stats.lastDropToConnectNs / 1e6);
+    return true;
+}
+
+void viDesk_getReconnectStats(ViDeskContext* ctx, ViDeskReconnectStats* stats) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    viDesk_reconnectGetStats(viCtx ? viCtx->reconnect : NULL, stats);
+}
+
 bool viDesk_isConnected(ViDeskContext* ctx) {
     return ctx && ctx->isConnected;
 }
 
+bool viDesk_prewarmConnection(const char* hostname, int port, uint32_t windowMs) {
+    return viDesk_prewarmStart(hostname, port, windowMs);
+}
+
+void viDesk_cancelPrewarm(const char* hostname, int port) {
+    viDesk_prewarmCancel(hostname, port);
+}
+
+void viDesk_getPrewarmStats(ViDeskPrewarmStats* stats) {
+    viDesk_prewarmGetStats(stats);
+}
+
+// GFX 缓存上限 (MS-RDPEGFX: 普通 100MB / 4096 槽小缓存 16MB)
+#define VIDESK_GFX_CACHE_LIMIT        (100ULL * 1024 * 1024)
+#define VIDESK_GFX_SMALL_CACHE_LIMIT  (16ULL * 1024 * 1024)
+#define VIDESK_GFX_CACHE_SLOTS        25600
+#define VIDESK_GFX_SMALL_CACHE_SLOTS  4096
+
+// 内存采样间隔 (纳秒)
+#define VIDESK_MEMORY_SAMPLE_INTERVAL_NS 1000000000ULL
+
+// 统计帧缓冲区和 GFX 表面/缓存的实际占用
+// 只能在事件处理线程上调用：GFX 缓存条目由该线程创建和释放
+static void viDesk_sampleMemoryUsage(ViDeskContext* ctx) {
+    uint64_t now = viDesk_monotonicNs();
+    if (now - ctx->lastMemorySampleNs < VIDESK_MEMORY_SAMPLE_INTERVAL_NS)
+        return;
+    ctx->lastMemorySampleNs = now;
+
+    rdpGdi* gdi = ctx->rdpCtx->gdi;
+    if (!gdi) {
+        ctx->frameBufferBytes = 0;
+        ctx->gfxCacheBytes = 0;
+        return;
+    }
+
+    ctx->frameBufferBytes = (uint64_t)gdi->stride * gdi->height;
+
+    uint64_t gfxBytes = 0;
+    RdpgfxClientContext* gfx = gdi->gfx;
+    if (gfx) {
+        UINT16* surfaceIds = NULL;
+        UINT16 surfaceCount = 0;
+        if (gfx->GetSurfaceIds &&
+            gfx->GetSurfaceIds(gfx, &surfaceIds, &surfaceCount) == CHANNEL_RC_OK) {
+            for (UINT16 i = 0; i < surfaceCount; i++) {
+                gdiGfxSurface* surface = (gdiGfxSurface*)gfx->GetSurfaceData(gfx, surfaceIds[i]);
+                if (surface)
+                    gfxBytes += (uint64_t)surface->scanline * surface->height;
+            }
+            free(surfaceIds);
+        }
+
+        if (gfx->GetCacheSlotData) {
+            BOOL small = freerdp_settings_get_bool(ctx->rdpCtx->settings, FreeRDP_GfxSmallCache);
+            UINT32 slots = small ? VIDESK_GFX_SMALL_CACHE_SLOTS : VIDESK_GFX_CACHE_SLOTS;
+            for (UINT32 slot = 1; slot <= slots; slot++) {
+                gdiGfxCacheEntry* entry = (gdiGfxCacheEntry*)gfx->GetCacheSlotData(gfx, (UINT16)slot);
+                if (entry)
+                    gfxBytes += (uint64_t)entry->scanline * entry->height;
+            }
+        }
+    }
+    ctx->gfxCacheBytes = gfxBytes;
+}
+
+// 处理已就绪的事件 (统计本线程在该会话上的 CPU 时间，不含等待)
+static bool viDesk_handleEvents(ViDeskContext* ctx) {
+    rdpContext* context = ctx->rdpCtx;
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)context;
+
+    viDesk_beginThreadRoleWork();
+    uint64_t cpuStart = viDesk_threadCpuTimeNs();
+    uint64_t now = viDesk_monotonicNs();
+    BOOL handled = TRUE;
+    if (!viDesk_inboundThrottled(viCtx, now))
+        handled = freerdp_check_event_handles(context);
+    if (handled) {
+        // 入站处理完后再写出一片排队的大消息，帧确认已在上面发出
+        handled = viDesk_sendSchedulerDrain(viCtx->sendScheduler);
+    }
+    if (handled) {
+        viDesk_sampleMemoryUsage(ctx);
+
+        UINT64 inBytes = 0, outBytes = 0, inPackets = 0, outPackets = 0;
+        if (context->rdp)
+            freerdp_get_stats(context->rdp, &inBytes, &outBytes, &inPackets, &outPackets);
+        if (viDesk_sessionStatsTick(viCtx->sessionStats, now, inBytes, outBytes))
+            viDesk_evaluateQuality(viCtx, now);
+        viDesk_channelStatsTick(viCtx->channelStats, now);
+
+        // 暂停读取期间的静默是自己造成的，不检查
+        uint64_t silenceNs = 0;
+        if (!viDesk_inboundThrottled(viCtx, now) &&
+            viDesk_livenessCheck(viCtx->liveness, viDesk_monotonicNs(), &silenceNs) == VIDESK_LIVENESS_DEAD) {
+            viDesk_log(ctx, "[ViDesk] %.1f 秒没有收到服务器数据，判定连接已断开\n", silenceNs / 1e9);
+            freerdp_set_last_error_if_not(context, FREERDP_ERROR_CONNECT_TRANSPORT_FAILED);
+            handled = FALSE;
+        } else if (viDesk_livenessTakeProbe(viCtx->liveness)) {
+            viDesk_sendLivenessProbe(viCtx);
+        }
+    }
+    atomic_fetch_add_explicit(&viCtx->processingCpuNs, viDesk_threadCpuTimeNs() - cpuStart, memory_order_relaxed);
+    viDesk_endThreadRoleWork();
+
+    if (!handled) {
+        if (freerdp_get_last_error(context) == FREERDP_ERROR_SUCCESS) {
+            // 正常断开
+            return false;
+        }
+        // 错误
+        UINT32 error = freerdp_get_last_error(context);
+        const char* errorStr = freerdp_get_last_error_string(error);
+        setLastError(ctx, errorStr ? errorStr : "Event handling failed");
+
+        // 服务器通过 Error Info 主动结束的会话 (注销、被踢下线等) 不算掉线
+        if (GET_FREERDP_ERROR_CLASS(error) != FREERDP_ERROR_ERRINFO_CLASS) {
+            viDesk_reconnectRecordDrop(viCtx->reconnect, context, viDesk_monotonicNs());
+            viDesk_log(ctx, "[ViDesk] 连接中断: %s (0x%08X)\n", errorStr ? errorStr : "N/A", error);
+            notifyStateChange(ctx, 0, "Connection lost");  // 0 = disconnected
+        }
+        return false;
+    }
+
+    return true;
+}
+
 bool viDesk_processEvents(ViDeskContext* ctx, int timeoutMs) {
     if (!ctx || !ctx->rdpCtx || !ctx->isConnected) {
         return false;
@@ -1275,9 +2527,9 @@ bool viDesk_processEvents(ViDeskContext* ctx, int timeoutMs) {
         return false;
     }
 
-    // 获取事件句柄
+    // 获取事件句柄 (包括发送队列非空事件)
     HANDLE handles[64];
-    DWORD nCount = freerdp_get_event_handles(context, handles, 64);
+    DWORD nCount = viDesk_getEventHandles(ctx, (void**)handles, 64);
     if (nCount == 0) {
         return false;
     }
@@ -1288,24 +2540,113 @@ bool viDesk_processEvents(ViDeskContext* ctx, int timeoutMs) {
         return false;
     }
 
-    // 检查并处理事件
-    if (!freerdp_check_event_handles(context)) {
-        if (freerdp_get_last_error(context) == FREERDP_ERROR_SUCCESS) {
-            // 正常断开
-            return false;
-        }
-        // 错误
-        UINT32 error = freerdp_get_last_error(context);
-        const char* errorStr = freerdp_get_last_error_string(error);
-        setLastError(errorStr ? errorStr : "Event handling failed");
-        return false;
+    return viDesk_handleEvents(ctx);
+}
+
+uint32_t viDesk_getEventHandles(ViDeskContext* ctx, void** handles, uint32_t count) {
+    if (!ctx || !ctx->rdpCtx || !ctx->isConnected || !handles || count < 2)
+        return 0;
+
+    // 暂停读取期间只等待发送队列，等待超时后再检查渲染器是否已赶上
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    if (viDesk_inboundThrottled(viCtx, viDesk_monotonicNs())) {
+        handles[0] = viDesk_sendSchedulerEvent(viCtx->sendScheduler);
+        return 1;
     }
 
-    return true;
+    // 留一个位置给发送队列事件
+    DWORD nCount = freerdp_get_event_handles(ctx->rdpCtx, (HANDLE*)handles, count - 1);
+    if (nCount == 0)
+        return 0;
+
+    handles[nCount++] = viDesk_sendSchedulerEvent(viCtx->sendScheduler);
+    return nCount;
+}
+
+bool viDesk_processPendingEvents(ViDeskContext* ctx) {
+    if (!ctx || !ctx->rdpCtx || !ctx->isConnected)
+        return false;
+
+    if (freerdp_shall_disconnect_context(ctx->rdpCtx))
+        return false;
+
+    return viDesk_handleEvents(ctx);
+}
+
+// === 资源配置 ===
+
+bool viDesk_setSharedWorkers(ViDeskContext* ctx, bool enabled) {
+    if (!ctx || !ctx->rdpCtx || !ctx->rdpCtx->settings)
+        return false;
+
+    rdpSettings* settings = ctx->rdpCtx->settings;
+    UINT32 flags = freerdp_settings_get_uint32(settings, FreeRDP_ThreadingFlags);
+    if (enabled)
+        flags |= THREADING_FLAGS_DISABLE_THREADS;
+    else
+        flags &= ~THREADING_FLAGS_DISABLE_THREADS;
+
+    return freerdp_settings_set_uint32(settings, FreeRDP_ThreadingFlags, flags);
+}
+
+bool viDesk_setGfxSmallCache(ViDeskContext* ctx, bool enabled) {
+    if (!ctx || !ctx->rdpCtx || !ctx->rdpCtx->settings)
+        return false;
+
+    return freerdp_settings_set_bool(ctx->rdpCtx->settings, FreeRDP_GfxSmallCache, enabled);
+}
+
+uint64_t viDesk_getMemoryReservation(ViDeskContext* ctx) {
+    if (!ctx || !ctx->rdpCtx || !ctx->rdpCtx->settings)
+        return 0;
+
+    rdpSettings* settings = ctx->rdpCtx->settings;
+    uint64_t width = freerdp_settings_get_uint32(settings, FreeRDP_DesktopWidth);
+    uint64_t height = freerdp_settings_get_uint32(settings, FreeRDP_DesktopHeight);
+
+    // GDI 主缓冲区 + 渲染侧副本 (BGRA32) + GFX 缓存上限
+    uint64_t frameBytes = width * height * 4 * 2;
+    uint64_t cacheBytes = freerdp_settings_get_bool(settings, FreeRDP_GfxSmallCache)
+        ? VIDESK_GFX_SMALL_CACHE_LIMIT : VIDESK_GFX_CACHE_LIMIT;
+
+    return frameBytes + cacheBytes;
+}
+
+void viDesk_getMemoryUsage(ViDeskContext* ctx, uint64_t* frameBufferBytes, uint64_t* gfxCacheBytes) {
+    if (frameBufferBytes) *frameBufferBytes = ctx ? ctx->frameBufferBytes : 0;
+    if (gfxCacheBytes) *gfxCacheBytes = ctx ? ctx->gfxCacheBytes : 0;
 }
 
 // === 输入事件 ===
 
+// 记录一次输入发送的耗时，用于观察大通道消息对输入的影响
+static void viDesk_recordInputSend(ViDeskContext* ctx, uint64_t startNs) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    viDesk_sendSchedulerRecordInput(viCtx->sendScheduler, viDesk_monotonicNs() - startNs);
+}
+
+// 为延迟跟踪打上输入时间戳，带坐标的输入同时更新指针位置
+static void viDesk_stampInput(ViDeskContext* ctx, uint64_t startNs, bool hasPosition, int32_t x, int32_t y) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    if (hasPosition)
+        viDesk_trackPointer(viCtx, x, y);
+    viDesk_latencyRecordInput(viCtx->latencyTracker, startNs, hasPosition, x, y);
+}
+
+// 无坐标但作用于指针下方内容的输入 (滚轮、相对移动)，按最近的指针位置匹配
+static void viDesk_stampPointerInput(ViDeskContext* ctx, uint64_t startNs) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    int32_t x = 0, y = 0;
+    bool hasPointer = viDesk_lastPointer(viCtx, &x, &y);
+    viDesk_latencyRecordInput(viCtx->latencyTracker, startNs, hasPointer, x, y);
+}
+
+// 录制中时记下这次输入调用 (在真正发送之前，保留调用方的原始参数)
+static void viDesk_recordInputEvent(ViDeskContext* ctx, const ViDeskInputEvent* event) {
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    viDesk_inputRecorderWrite(viCtx->inputRecorder, viDesk_monotonicNs(), event);
+}
+
 bool viDesk_sendMouseMove(ViDeskContext* ctx, int x, int y) {
     if (!ctx || !ctx->rdpCtx || !ctx->isConnected)
         return false;
@@ -1314,7 +2655,136 @@ bool viDesk_sendMouseMove(ViDeskContext* ctx, int x, int y) {
     if (!input)
         return false;
 
-    return freerdp_input_send_mouse_event(input, PTR_FLAGS_MOVE, (UINT16)x, (UINT16)y);
+    ViDeskInputEvent event = { .type = VIDESK_INPUT_EVENT_MOUSE_MOVE, .move = { x, y } };
+    viDesk_recordInputEvent(ctx, &event);
+
+    // 单纯的移动不进延迟跟踪：光标是本地叠加层，服务器通常没有对应的帧更新，
+    // 拖动时大量移动只会挤满待认领队列，挤掉点击和按键
+    uint64_t start = viDesk_monotonicNs();
+    viDesk_trackPointer((ViDeskClientContext*)ctx->rdpCtx, x, y);
+    BOOL result = freerdp_input_send_mouse_event(input, PTR_FLAGS_MOVE, (UINT16)x, (UINT16)y);
+    viDesk_recordInputSend(ctx, start);
+    return result;
+}
+
+bool viDesk_isRelativeMouseAvailable(ViDeskContext* ctx) {
+    if (!ctx || !ctx->rdpCtx || !ctx->isConnected)
+        return false;
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    return viCtx->ainput && viCtx->ainput->AInputSendInputEvent;
+}
+
+bool viDesk_sendMouseRelative(ViDeskContext* ctx, double dx, double dy) {
+    if (!viDesk_isRelativeMouseAvailable(ctx))
+        return false;
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    ViDeskInputEvent event = { .type = VIDESK_INPUT_EVENT_MOUSE_RELATIVE, .relative = { dx, dy } };
+    viDesk_recordInputEvent(ctx, &event);
+
+    // 协议只接受整数增量，小数部分累积到下一次，慢速拖动不会丢失位移
+    double x = dx + viCtx->relativeResidualX;
+    double y = dy + viCtx->relativeResidualY;
+    INT32 ix = (INT32)x;
+    INT32 iy = (INT32)y;
+    viCtx->relativeResidualX = x - ix;
+    viCtx->relativeResidualY = y - iy;
+
+    if (ix == 0 && iy == 0)
+        return true;
+
+    // 与绝对移动一样不进延迟跟踪
+    const UINT64 flags = AINPUT_FLAGS_MOVE | AINPUT_FLAGS_REL | AINPUT_FLAGS_HAVE_REL;
+    uint64_t start = viDesk_monotonicNs();
+    UINT rc = viCtx->ainput->AInputSendInputEvent(viCtx->ainput, flags, ix, iy);
+    viDesk_recordInputSend(ctx, start);
+    return rc == CHANNEL_RC_OK;
+}
+
+bool viDesk_isTouchAvailable(ViDeskContext* ctx) {
+    if (!ctx || !ctx->rdpCtx || !ctx->isConnected)
+        return false;
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    return viCtx->rdpei != NULL;
+}
+
+bool viDesk_sendTouchFrame(ViDeskContext* ctx, const ViDeskTouchContact* contacts, uint32_t count) {
+    if (!viDesk_isTouchAvailable(ctx) || !contacts || count == 0)
+        return false;
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    RdpeiClientContext* rdpei = viCtx->rdpei;
+    ViDeskInputEvent event = { .type = VIDESK_INPUT_EVENT_TOUCH_FRAME, .touch = { contacts, count } };
+    viDesk_recordInputEvent(ctx, &event);
+
+    // RDPEI 客户端把同一时刻提交的各触点合并进一个触控帧发送
+    uint64_t start = viDesk_monotonicNs();
+    viDesk_stampInput(ctx, start, true, contacts[0].x, contacts[0].y);
+    UINT rc = CHANNEL_RC_OK;
+    for (uint32_t i = 0; i < count && rc == CHANNEL_RC_OK; i++) {
+        const ViDeskTouchContact* contact = &contacts[i];
+        INT32 contactId = 0;
+        pcRdpeiTouchEvent handler = NULL;
+
+        switch (contact->phase) {
+            case VIDESK_TOUCH_BEGAN: handler = rdpei->TouchBegin; break;
+            case VIDESK_TOUCH_MOVED: handler = rdpei->TouchUpdate; break;
+            case VIDESK_TOUCH_ENDED: handler = rdpei->TouchEnd; break;
+            case VIDESK_TOUCH_CANCELLED: handler = rdpei->TouchCancel; break;
+        }
+
+        if (!handler)
+            return false;
+
+        rc = handler(rdpei, contact->id, contact->x, contact->y, &contactId);
+    }
+    viDesk_recordInputSend(ctx, start);
+
+    if (rc != CHANNEL_RC_OK)
+        return false;
+
+    atomic_fetch_add_explicit(&viCtx->touchStats.frames, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&viCtx->touchStats.contacts, count, memory_order_relaxed);
+
+    // 只记录最早的未响应触控帧，帧更新到来前的后续触控帧不覆盖起点
+    uint64_t expected = 0;
+    atomic_compare_exchange_strong(&viCtx->touchPendingNs, &expected, start);
+    return true;
+}
+
+void viDesk_getTouchStats(ViDeskContext* ctx, ViDeskTouchStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (!viCtx)
+        return;
+
+    ViDeskTouchCounters* counters = &viCtx->touchStats;
+    stats->frames = atomic_load_explicit(&counters->frames, memory_order_relaxed);
+    stats->contacts = atomic_load_explicit(&counters->contacts, memory_order_relaxed);
+    stats->latencySamples = atomic_load_explicit(&counters->latencySamples, memory_order_relaxed);
+    stats->latencyTotalNs = atomic_load_explicit(&counters->latencyTotalNs, memory_order_relaxed);
+    stats->latencyMaxNs = atomic_load_explicit(&counters->latencyMaxNs, memory_order_relaxed);
+    stats->lastLatencyNs = atomic_load_explicit(&counters->lastLatencyNs, memory_order_relaxed);
+}
+
+void viDesk_resetTouchStats(ViDeskContext* ctx) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (!viCtx)
+        return;
+
+    ViDeskTouchCounters* counters = &viCtx->touchStats;
+    atomic_store(&counters->frames, 0);
+    atomic_store(&counters->contacts, 0);
+    atomic_store(&counters->latencySamples, 0);
+    atomic_store(&counters->latencyTotalNs, 0);
+    atomic_store(&counters->latencyMaxNs, 0);
+    atomic_store(&counters->lastLatencyNs, 0);
+    atomic_store(&viCtx->touchPendingNs, 0);
 }
 
 bool viDesk_sendMouseButton(ViDeskContext* ctx, int button, bool isPressed, int x, int y) {
@@ -1336,31 +2806,51 @@ bool viDesk_sendMouseButton(ViDeskContext* ctx, int button, bool isPressed, int
     if (isPressed)
         flags |= PTR_FLAGS_DOWN;
 
-    return freerdp_input_send_mouse_event(input, flags, (UINT16)x, (UINT16)y);
-}
-
-bool viDesk_sendMouseWheel(ViDeskContext* ctx, int delta, bool isHorizontal) {
-    if (!ctx || !ctx->rdpCtx || !ctx->isConnected)
-        return false;
+    ViDeskInputEvent event = { .type = VIDESK_INPUT_EVENT_MOUSE_BUTTON,
+                               .button = { button, isPressed, x, y } };
+    viDesk_recordInputEvent(ctx, &event);
 
-    rdpInput* input = ctx->rdpCtx->input;
-    if (!input)
-        return false;
+    uint64_t start = viDesk_monotonicNs();
+    viDesk_stampInput(ctx, start, true, x, y);
+    BOOL result = freerdp_input_send_mouse_event(input, flags, (UINT16)x, (UINT16)y);
+    viDesk_recordInputSend(ctx, start);
+    return result;
+}
 
+uint16_t viDesk_wheelFlags(int delta, bool isHorizontal) {
     UINT16 flags = isHorizontal ? PTR_FLAGS_HWHEEL : PTR_FLAGS_WHEEL;
 
     if (delta < 0) {
-        flags |= PTR_FLAGS_WHEEL_NEGATIVE;
-        delta = -delta;
+        // 负值：幅度限制到 0x100，低 8 位为 0x200 - 幅度 (-1 为 0x1FF，-256 为 0x100)
+        int magnitude = delta < -0x100 ? 0x100 : -delta;
+        return flags | PTR_FLAGS_WHEEL_NEGATIVE | (UINT16)((0x200 - magnitude) & 0xFF);
     }
 
     // 限制范围
     if (delta > 0xFF)
         delta = 0xFF;
 
-    flags |= (UINT16)(delta & 0xFF);
+    return flags | (UINT16)(delta & 0xFF);
+}
+
+bool viDesk_sendMouseWheel(ViDeskContext* ctx, int delta, bool isHorizontal) {
+    if (!ctx || !ctx->rdpCtx || !ctx->isConnected)
+        return false;
 
-    return freerdp_input_send_mouse_event(input, flags, 0, 0);
+    rdpInput* input = ctx->rdpCtx->input;
+    if (!input)
+        return false;
+
+    ViDeskInputEvent event = { .type = VIDESK_INPUT_EVENT_MOUSE_WHEEL, .wheel = { delta, isHorizontal } };
+    viDesk_recordInputEvent(ctx, &event);
+
+    UINT16 flags = viDesk_wheelFlags(delta, isHorizontal);
+
+    uint64_t start = viDesk_monotonicNs();
+    viDesk_stampPointerInput(ctx, start);
+    BOOL result = freerdp_input_send_mouse_event(input, flags, 0, 0);
+    viDesk_recordInputSend(ctx, start);
+    return result;
 }
 
 bool viDesk_sendKeyEvent(ViDeskContext* ctx, uint16_t scanCode, bool isPressed, bool isExtended) {
@@ -1375,7 +2865,14 @@ bool viDesk_sendKeyEvent(ViDeskContext* ctx, uint16_t scanCode, bool isPressed,
     if (isExtended)
         flags |= KBD_FLAGS_EXTENDED;
 
-    return freerdp_input_send_keyboard_event(input, flags, (UINT8)scanCode);
+    ViDeskInputEvent event = { .type = VIDESK_INPUT_EVENT_KEY, .key = { scanCode, isPressed, isExtended } };
+    viDesk_recordInputEvent(ctx, &event);
+
+    uint64_t start = viDesk_monotonicNs();
+    viDesk_stampInput(ctx, start, false, 0, 0);
+    BOOL result = freerdp_input_send_keyboard_event(input, flags, (UINT8)scanCode);
+    viDesk_recordInputSend(ctx, start);
+    return result;
 }
 
 bool viDesk_sendUnicodeKey(ViDeskContext* ctx, uint16_t codePoint) {
@@ -1386,12 +2883,131 @@ bool viDesk_sendUnicodeKey(ViDeskContext* ctx, uint16_t codePoint) {
     if (!input)
         return false;
 
+    ViDeskInputEvent event = { .type = VIDESK_INPUT_EVENT_UNICODE_KEY, .unicode = { codePoint } };
+    viDesk_recordInputEvent(ctx, &event);
+
+    uint64_t start = viDesk_monotonicNs();
+    viDesk_stampInput(ctx, start, false, 0, 0);
+
     // 按下
-    if (!freerdp_input_send_unicode_keyboard_event(input, 0, codePoint))
-        return false;
+    BOOL result = freerdp_input_send_unicode_keyboard_event(input, 0, codePoint);
 
     // 释放
-    return freerdp_input_send_unicode_keyboard_event(input, KBD_FLAGS_RELEASE, codePoint);
+    if (result)
+        result = freerdp_input_send_unicode_keyboard_event(input, KBD_FLAGS_RELEASE, codePoint);
+
+    viDesk_recordInputSend(ctx, start);
+    return result;
+}
+
+// fast-path 输入 PDU (MS-RDPBCGR 2.2.8.1.2)，FreeRDP 不公开其内部构造函数
+#define VIDESK_FASTPATH_INPUT_EVENT_UNICODE 0x4
+#define VIDESK_FASTPATH_INPUT_KBDFLAGS_RELEASE 0x01
+#define VIDESK_FASTPATH_MAX_EVENTS 255      // numberEvents 字段为 1 字节
+#define VIDESK_FASTPATH_UNICODE_EVENT_SIZE 3
+
+// 只有未启用 RDP 标准加密 (TLS/NLA) 且已协商 fast-path 输入时才能自行拼装 PDU
+static bool viDesk_canBatchFastPathInput(rdpContext* context) {
+    rdpSettings* settings = context->settings;
+    if (!freerdp_settings_get_bool(settings, FreeRDP_FastPathInput) ||
+        !freerdp_settings_get_bool(settings, FreeRDP_UnicodeInput))
+        return false;
+
+    if (freerdp_settings_get_bool(settings, FreeRDP_UseRdpSecurityLayer) &&
+        freerdp_settings_get_uint32(settings, FreeRDP_EncryptionMethods) != 0)
+        return false;
+
+    const rdpTransportIo* io = freerdp_get_io_callbacks(context);
+    return io && io->WritePdu && freerdp_get_transport(context);
+}
+
+// 把一段 UTF-16 码元 (每个码元按下 + 释放) 写成一个 fast-path 输入 PDU
+static bool viDesk_writeUnicodeFastPathPdu(rdpContext* context, const WCHAR* units, size_t count) {
+    size_t events = count * 2;
+    size_t body = (events > 15 ? 1 : 0) + events * VIDESK_FASTPATH_UNICODE_EVENT_SIZE;
+    size_t total = 1 + 1 + body;
+    if (total > 0x7F)
+        total = 1 + 2 + body;
+
+    wStream* s = Stream_New(NULL, total);
+    if (!s)
+        return false;
+
+    // fpInputHeader: action = FASTPATH (0)，事件数超过 15 时放到 numberEvents 字段
+    Stream_Write_UINT8(s, (BYTE)((events <= 15 ? events : 0) << 2));
+    if (total > 0x7F) {
+        Stream_Write_UINT8(s, (BYTE)(0x80 | (total >> 8)));
+        Stream_Write_UINT8(s, (BYTE)(total & 0xFF));
+    } else {
+        Stream_Write_UINT8(s, (BYTE)total);
+    }
+    if (events > 15)
+        Stream_Write_UINT8(s, (BYTE)events);
+
+    for (size_t i = 0; i < count; i++) {
+        Stream_Write_UINT8(s, VIDESK_FASTPATH_INPUT_EVENT_UNICODE << 5);
+        Stream_Write_UINT16(s, units[i]);
+        Stream_Write_UINT8(s, (VIDESK_FASTPATH_INPUT_EVENT_UNICODE << 5) | VIDESK_FASTPATH_INPUT_KBDFLAGS_RELEASE);
+        Stream_Write_UINT16(s, units[i]);
+    }
+    Stream_SealLength(s);
+
+    // WritePdu 内部持有传输层写锁，与 FreeRDP 自身的发送互不交错
+    const rdpTransportIo* io = freerdp_get_io_callbacks(context);
+    int rc = io->WritePdu(freerdp_get_transport(context), s);
+    Stream_Free(s, TRUE);
+    return rc >= 0;
+}
+
+bool viDesk_sendUnicodeText(ViDeskContext* ctx, const char* utf8, size_t length) {
+    if (!ctx || !ctx->rdpCtx || !ctx->isConnected || !utf8)
+        return false;
+
+    rdpInput* input = ctx->rdpCtx->input;
+    if (!input)
+        return false;
+
+    if (length == 0)
+        return true;
+
+    ViDeskInputEvent event = { .type = VIDESK_INPUT_EVENT_UNICODE_TEXT, .text = { utf8, length } };
+    viDesk_recordInputEvent(ctx, &event);
+
+    // 一次性转换为 UTF-16，U+FFFF 以上的字符成为代理对
+    size_t unitCount = 0;
+    WCHAR* units = ConvertUtf8NToWCharAlloc(utf8, length, &unitCount);
+    if (!units)
+        return false;
+
+    uint64_t start = viDesk_monotonicNs();
+    viDesk_stampInput(ctx, start, false, 0, 0);
+    bool result = true;
+
+    if (viDesk_canBatchFastPathInput(ctx->rdpCtx)) {
+        const size_t maxUnits = VIDESK_FASTPATH_MAX_EVENTS / 2;
+        size_t offset = 0;
+        while (offset < unitCount && result) {
+            size_t count = unitCount - offset;
+            if (count > maxUnits) {
+                count = maxUnits;
+                // 代理对不跨 PDU 拆开
+                if (units[offset + count - 1] >= 0xD800 && units[offset + count - 1] <= 0xDBFF)
+                    count--;
+            }
+            result = viDesk_writeUnicodeFastPathPdu(ctx->rdpCtx, &units[offset], count);
+            offset += count;
+        }
+    } else {
+        // 慢速路径或 RDP 标准加密：逐个码元发送
+        for (size_t i = 0; i < unitCount && result; i++) {
+            result = freerdp_input_send_unicode_keyboard_event(input, 0, units[i]) &&
+                     freerdp_input_send_unicode_keyboard_event(input, KBD_FLAGS_RELEASE, units[i]);
+        }
+    }
+
+    viDesk_recordInputSend(ctx, start);
+    free(units);
+    return result;
 }
 
 // === 剪贴板 ===
@@ -1451,9 +3067,232 @@ uint32_t viDesk_getFrameBytesPerPixel(ViDeskContext* ctx) {
 
 // === 调试 ===
 
-const char* viDesk_getLastError(ViDeskContext* ctx) {
-    (void)ctx;
-    return g_lastError;
+bool viDesk_copyLastError(ViDeskContext* ctx, char* buffer, uint32_t bufferSize) {
+    if (!buffer || bufferSize == 0)
+        return false;
+
+    buffer[0] = '\0';
+    if (!ctx || !ctx->rdpCtx) {
+        snprintf(buffer, bufferSize, "%s", t_lastError);
+        return buffer[0] != '\0';
+    }
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    EnterCriticalSection(&viCtx->errorLock);
+    snprintf(buffer, bufferSize, "%s", ctx->lastError);
+    LeaveCriticalSection(&viCtx->errorLock);
+    return buffer[0] != '\0';
+}
+
+uint64_t viDesk_getProcessingCpuTime(ViDeskContext* ctx) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    return viCtx ? atomic_load_explicit(&viCtx->processingCpuNs, memory_order_relaxed) : 0;
+}
+
+void viDesk_getSendStats(ViDeskContext* ctx, ViDeskSendStats* stats) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    viDesk_sendSchedulerGetStats(viCtx ? viCtx->sendScheduler : NULL, stats);
+}
+
+void viDesk_resetSendStats(ViDeskContext* ctx) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (viCtx)
+        viDesk_sendSchedulerResetStats(viCtx->sendScheduler);
+}
+
+void viDesk_recordFramePresented(ViDeskContext* ctx, uint64_t sequence, uint64_t ageNs) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (!viCtx)
+        return;
+
+    uint64_t now = viDesk_monotonicNs();
+    viDesk_latencyRecordPresent(viCtx->latencyTracker, sequence, now > ageNs ? now - ageNs : now);
+
+    uint64_t presented = atomic_load(&viCtx->lastPresentedSequence);
+    while (sequence > presented &&
+           !atomic_compare_exchange_weak(&viCtx->lastPresentedSequence, &presented, sequence)) {
+    }
+}
+
+void viDesk_getLatencyStats(ViDeskContext* ctx, ViDeskLatencyStats* stats) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    viDesk_latencyGetStats(viCtx ? viCtx->latencyTracker : NULL, stats);
+}
+
+void viDesk_setAdaptiveQuality(ViDeskContext* ctx, bool enabled) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (viCtx)
+        atomic_store(&viCtx->qualityEnableRequest, enabled ? 1 : 0);    // 在事件处理线程上应用
+}
+
+void viDesk_getQualityState(ViDeskContext* ctx, ViDeskQualityState* state) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    viDesk_qualityControllerGetState(viCtx ? viCtx->qualityController : NULL, state);
+    if (viCtx && state) {
+        state->resolutionRequests = viCtx->resolutionRequests;
+        state->throttledNs = atomic_load(&viCtx->throttledNs);
+    }
+}
+
+uint32_t viDesk_getQualityDecisions(ViDeskContext* ctx, ViDeskQualityDecision* decisions, uint32_t capacity) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    return viDesk_qualityControllerDecisions(viCtx ? viCtx->qualityController : NULL, decisions, capacity);
+}
+
+void viDesk_getPointerCacheStats(ViDeskContext* ctx, ViDeskPointerCacheStats* stats) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    viDesk_pointerCacheGetStats(viCtx ? viCtx->pointerCache : NULL, stats);
+}
+
+void viDesk_resetPointerCacheStats(ViDeskContext* ctx) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (viCtx)
+        viDesk_pointerCacheResetStats(viCtx->pointerCache);
+}
+
+void viDesk_resetLatencyStats(ViDeskContext* ctx) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (viCtx)
+        viDesk_latencyReset(viCtx->latencyTracker);
+}
+
+// === 输入录制与回放 ===
+
+bool viDesk_startInputRecording(ViDeskContext* ctx, const char* path) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (!viCtx || !path)
+        return false;
+
+    if (!viDesk_inputRecorderStart(viCtx->inputRecorder, path)) {
+        setLastError(ctx, "无法创建输入录制文件");
+        return false;
+    }
+
+    viDesk_log(ctx, "[ViDesk] 开始录制输入: %s\n", path);
+    return true;
+}
+
+bool viDesk_stopInputRecording(ViDeskContext* ctx, ViDeskInputReplayStats* stats) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (!viCtx) {
+        if (stats)
+            memset(stats, 0, sizeof(*stats));
+        return false;
+    }
+
+    return viDesk_inputRecorderStop(viCtx->inputRecorder, stats);
+}
+
+// 等到单调时钟的 targetNs；分段睡眠以便及时响应取消
+#define VIDESK_REPLAY_MAX_SLEEP_NS (50ULL * 1000000ULL)
+
+static bool viDesk_replayWaitUntil(ViDeskClientContext* viCtx, uint64_t targetNs) {
+    for (;;) {
+        if (atomic_load(&viCtx->replayCancelled))
+            return false;
+
+        uint64_t now = viDesk_monotonicNs();
+        if (now >= targetNs)
+            return true;
+
+        uint64_t remaining = targetNs - now;
+        if (remaining > VIDESK_REPLAY_MAX_SLEEP_NS)
+            remaining = VIDESK_REPLAY_MAX_SLEEP_NS;
+
+        struct timespec ts = { (time_t)(remaining / 1000000000ULL), (long)(remaining % 1000000000ULL) };
+        nanosleep(&ts, NULL);
+    }
+}
+
+// 通过与实时输入相同的入口发送，延迟跟踪和发送统计照常记录
+static bool viDesk_dispatchInputEvent(ViDeskContext* ctx, const ViDeskInputEvent* event) {
+    switch (event->type) {
+        case VIDESK_INPUT_EVENT_MOUSE_MOVE:
+            return viDesk_sendMouseMove(ctx, event->move.x, event->move.y);
+        case VIDESK_INPUT_EVENT_MOUSE_RELATIVE:
+            return viDesk_sendMouseRelative(ctx, event->relative.dx, event->relative.dy);
+        case VIDESK_INPUT_EVENT_MOUSE_BUTTON:
+            return viDesk_sendMouseButton(ctx, event->button.button, event->button.pressed,
+                                          event->button.x, event->button.y);
+        case VIDESK_INPUT_EVENT_MOUSE_WHEEL:
+            return viDesk_sendMouseWheel(ctx, event->wheel.delta, event->wheel.horizontal);
+        case VIDESK_INPUT_EVENT_KEY:
+            return viDesk_sendKeyEvent(ctx, event->key.scanCode, event->key.pressed, event->key.extended);
+        case VIDESK_INPUT_EVENT_UNICODE_KEY:
+            return viDesk_sendUnicodeKey(ctx, event->unicode.codePoint);
+        case VIDESK_INPUT_EVENT_UNICODE_TEXT:
+            return viDesk_sendUnicodeText(ctx, event->text.utf8, event->text.length);
+        case VIDESK_INPUT_EVENT_TOUCH_FRAME:
+            return viDesk_sendTouchFrame(ctx, event->touch.contacts, event->touch.count);
+    }
+    return false;
+}
+
+bool viDesk_replayInputRecording(ViDeskContext* ctx, const char* path, ViDeskInputReplayStats* stats) {
+    ViDeskInputReplayStats local = {0};
+    if (stats)
+        memset(stats, 0, sizeof(*stats));
+
+    if (!ctx || !ctx->rdpCtx || !ctx->isConnected || !path)
+        return false;
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    ViDeskInputReplay* replay = viDesk_inputReplayOpen(path);
+    if (!replay) {
+        setLastError(ctx, "无法读取输入录制文件");
+        return false;
+    }
+
+    atomic_store(&viCtx->replayCancelled, false);
+    local.bytes = viDesk_inputReplaySize(replay);
+    viDesk_log(ctx, "[ViDesk] 开始回放输入: %s (%llu 字节)\n", path, (unsigned long long)local.bytes);
+
+    bool completed = false;
+    uint64_t baseNs = viDesk_monotonicNs();
+    ViDeskInputEvent event;
+
+    for (;;) {
+        if (!viDesk_inputReplayNext(replay, &event)) {
+            completed = viDesk_inputReplayFinished(replay);
+            if (!completed)
+                setLastError(ctx, "输入录制文件已损坏");
+            break;
+        }
+
+        uint64_t targetNs = baseNs + event.timeNs;
+        if (!viDesk_replayWaitUntil(viCtx, targetNs) || !ctx->isConnected)
+            break;
+
+        uint64_t lag = viDesk_monotonicNs() - targetNs;
+        local.totalLagNs += lag;
+        if (lag > local.maxLagNs)
+            local.maxLagNs = lag;
+
+        if (!viDesk_dispatchInputEvent(ctx, &event))
+            local.failedEvents++;
+        local.events++;
+        local.durationNs = event.timeNs;
+    }
+
+    viDesk_inputReplayFree(replay);
+    viDesk_log(ctx, "[ViDesk] 输入回放%s: %u 个事件, 失败 %u, 最大滞后 %.2f ms\n",
+               completed ? "完成" : "中止", local.events, local.failedEvents, local.maxLagNs / 1e6);
+
+    if (stats)
+        *stats = local;
+    return completed;
+}
+
+void viDesk_cancelInputReplay(ViDeskContext* ctx) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (viCtx)
+        atomic_store(&viCtx->replayCancelled, true);
+}
+
+void viDesk_setHeadlessPresentation(ViDeskContext* ctx, bool enabled) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (viCtx)
+        atomic_store(&viCtx->headlessPresentation, enabled);
 }
 
 void viDesk_getStatistics(ViDeskContext* ctx, uint64_t* bytesReceived, uint64_t* bytesSent,
@@ -1466,16 +3305,163 @@ void viDesk_getStatistics(ViDeskContext* ctx, uint64_t* bytesReceived, uint64_t*
         return;
     }
 
-    // 从 FreeRDP 获取统计信息
+    // 字节数直接取 FreeRDP 的累计值，帧率和往返时间取自事件处理线程的每秒样本
     rdpContext* context = ctx->rdpCtx;
-    if (context && context->rdp) {
-        UINT64 inBytes = 0, outBytes = 0, inPackets = 0, outPackets = 0;
+    UINT64 inBytes = 0, outBytes = 0, inPackets = 0, outPackets = 0;
+    if (context->rdp)
         freerdp_get_stats(context->rdp, &inBytes, &outBytes, &inPackets, &outPackets);
 
-        if (bytesReceived) *bytesReceived = inBytes;
-        if (bytesSent) *bytesSent = outBytes;
+    ViDeskSessionStats stats;
+    viDesk_sessionStatsGet(((ViDeskClientContext*)context)->sessionStats, &stats);
+
+    if (bytesReceived) *bytesReceived = inBytes;
+    if (bytesSent) *bytesSent = outBytes;
+    if (frameRate) *frameRate = stats.frameRate;
+    if (latencyMs) *latencyMs = stats.averageRttMs;
+}
+
+void viDesk_getSessionStats(ViDeskContext* ctx, ViDeskSessionStats* stats) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    viDesk_sessionStatsGet(viCtx ? viCtx->sessionStats : NULL, stats);
+}
+
+uint32_t viDesk_getStatsHistory(ViDeskContext* ctx, ViDeskStatsSample* samples, uint32_t capacity) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    return viDesk_sessionStatsHistory(viCtx ? viCtx->sessionStats : NULL, samples, capacity);
+}
+
+uint32_t viDesk_getChannelStats(ViDeskContext* ctx, ViDeskChannelStats* channels, uint32_t capacity) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    return viDesk_channelStatsGet(viCtx ? viCtx->channelStats : NULL, channels, capacity);
+}
+
+uint32_t viDesk_getChannelHistory(ViDeskContext* ctx, const char* name, ViDeskChannelKind kind,
+                                  ViDeskChannelSample* samples, uint32_t capacity) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    return viDesk_channelStatsHistory(viCtx ? viCtx->channelStats : NULL, name, kind, samples, capacity);
+}
+
+void viDesk_setPooledTransport(ViDeskContext* ctx, bool enabled) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (viCtx)
+        viDesk_transportSetPooled(viCtx->transport, enabled);
+}
+
+void viDesk_setWanEmulation(ViDeskContext* ctx, const ViDeskWanProfile* profile) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (viCtx)
+        viDesk_transportSetWanProfile(viCtx->transport, profile);
+}
+
+bool viDesk_getWanPreset(ViDeskWanPreset preset, ViDeskWanProfile* profile) {
+    return viDesk_wanProfilePreset(preset, profile);
+}
+
+void viDesk_getWanEmulationStats(ViDeskContext* ctx, ViDeskWanEmulationStats* stats) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    viDesk_transportGetWanStats(viCtx ? viCtx->transport : NULL, stats);
+}
+
+void viDesk_getLivenessStats(ViDeskContext* ctx, ViDeskLivenessStats* stats) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    viDesk_livenessGetStats(viCtx ? viCtx->liveness : NULL, viDesk_monotonicNs(), stats);
+}
+
+void viDesk_getTransportStats(ViDeskContext* ctx, ViDeskTransportStats* stats) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    viDesk_transportGetStats(viCtx ? viCtx->transport : NULL, stats);
+}
+
+void viDesk_resetTransportStats(ViDeskContext* ctx) {
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (viCtx)
+        viDesk_transportResetStats(viCtx->transport);
+}
+
+bool viDesk_setSessionDump(ViDeskContext* ctx, ViDeskSessionDumpMode mode, const char* path,
+                           ViDeskSessionDumpInfo* info) {
+    if (info)
+        memset(info, 0, sizeof(*info));
+
+    if (!ctx || !ctx->rdpCtx) {
+        setLastError(ctx, "Invalid context");
+        return false;
+    }
+
+    ViDeskClientContext* viCtx = (ViDeskClientContext*)ctx->rdpCtx;
+    if (ctx->isConnected) {
+        setLastError(ctx, "Session dump must be configured before connecting");
+        return false;
+    }
+
+    if (!viDesk_sessionDumpConfigure(ctx->rdpCtx, mode, path)) {
+        setLastError(ctx, "Cannot open session dump file");
+        return false;
+    }
+
+    if (mode == VIDESK_SESSION_DUMP_REPLAY) {
+        ViDeskSessionDumpInfo local;
+        if (!viDesk_sessionDumpInspect(ctx->rdpCtx, &local)) {
+            viDesk_sessionDumpConfigure(ctx->rdpCtx, VIDESK_SESSION_DUMP_OFF, NULL);
+            viCtx->dumpMode = VIDESK_SESSION_DUMP_OFF;
+            setLastError(ctx, "Session dump file is empty or corrupt");
+            return false;
+        }
+        if (info)
+            *info = local;
+
+        // 回放不解析主机名，但 freerdp_connect 要求已设置服务器地址
+        rdpSettings* settings = ctx->rdpCtx->settings;
+        if (!freerdp_settings_get_string(settings, FreeRDP_ServerHostname))
+            freerdp_settings_set_string(settings, FreeRDP_ServerHostname, "replay");
+
+        viDesk_log(ctx, "[ViDesk] 会话录制文件: %u 条记录, 服务器 %u 条 %llu 字节, 客户端 %u 条 %llu 字节\n",
+                   local.records, local.serverRecords, (unsigned long long)local.serverBytes,
+                   local.clientRecords, (unsigned long long)local.clientBytes);
+        viDesk_log(ctx, "[ViDesk] 录制时的压缩级别: %d (%u 个压缩过的快速路径更新)\n",
+                   (int)local.compressionLevel, local.compressedUpdates);
     }
 
-    if (frameRate) *frameRate = 60;  // TODO: 实现实际帧率计算
-    if (latencyMs) *latencyMs = 0;   // TODO: 实现延迟测量
+    viCtx->dumpMode = mode;
+    atomic_store(&viCtx->replayStartNs, 0);
+    return true;
+}
+
+void viDesk_getSessionReplayStats(ViDeskContext* ctx, ViDeskSessionReplayStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    ViDeskClientContext* viCtx = ctx ? (ViDeskClientContext*)ctx->rdpCtx : NULL;
+    if (!viCtx || viCtx->dumpMode != VIDESK_SESSION_DUMP_REPLAY)
+        return;
+
+    uint64_t start = atomic_load(&viCtx->replayStartNs);
+    if (start == 0)
+        return;
+
+    uint64_t end = atomic_load(&viCtx->replayEndNs);
+    uint64_t connected = atomic_load(&viCtx->replayConnectedNs);
+    uint64_t firstFrame = atomic_load(&viCtx->replayFirstFrameNs);
+    stats->running = end == 0;
+    stats->finished = end != 0;
+    stats->elapsedNs = (end ? end : viDesk_monotonicNs()) - start;
+    stats->connectNs = connected ? connected - start : 0;
+    stats->firstFrameNs = firstFrame ? firstFrame - start : 0;
+
+    ViDeskSessionStats session;
+    viDesk_sessionStatsGet(viCtx->sessionStats, &session);
+    stats->frames = session.totalFrames;
+    stats->paints = session.totalPaints;
+    stats->decodedBytes = session.totalDecodedBytes;
+
+    UINT64 inBytes = 0, outBytes = 0, inPackets = 0, outPackets = 0;
+    if (viCtx->common.context.rdp)
+        freerdp_get_stats(viCtx->common.context.rdp, &inBytes, &outBytes, &inPackets, &outPackets);
+    stats->bytesReplayed = inBytes;
+
+    ViDeskCompressionStats compression;
+    viDesk_getCompressionStats(ctx, &compression);
+    stats->compressedBytes = compression.compressedBytes;
+    stats->uncompressedBytes = compression.uncompressedBytes;
 }
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,30 +16,28 @@ typedef struct rdp_freerdp freerdp;
 typedef struct rdp_settings rdpSettings;
 #endif
 
-// ViDesk 自定义上下文结构
-typedef struct {
-    rdpContext* rdpCtx;
-    void* swiftCallbackContext;
-
-    // 帧缓冲区
-    uint8_t* frameBuffer;
-    uint32_t frameWidth;
-    uint32_t frameHeight;
-    uint32_t frameBytesPerPixel;
-
-    // 状态标志
-    bool isConnected;
-    bool isAuthenticated;
-} ViDeskContext;
-
 // 回调函数类型
-typedef void (*FrameUpdateCallback)(void* context, int x, int y, int width, int height);
+// sequence 为该帧更新的序号，渲染器呈现后通过 viDesk_recordFramePresented 回报
+typedef void (*FrameUpdateCallback)(void* context, int x, int y, int width, int height, uint64_t sequence);
 typedef void (*ConnectionStateCallback)(void* context, int state, const char* message);
 typedef void (*DesktopResizeCallback)(void* context, int width, int height);
 typedef bool (*AuthenticateCallback)(void* context, char** username, char** password, char** domain);
 typedef bool (*VerifyCertificateCallback)(void* context, const char* commonName, const char* subject,
                                           const char* issuer, const char* fingerprint, bool hostMismatch);
 typedef void (*ClipboardTextCallback)(void* context, const char* text);
+// 服务器主动移动指针 (桌面坐标)，客户端据此校正本地预测的光标位置
+typedef void (*PointerPositionCallback)(void* context, int x, int y);
+
+// 光标形状类型
+typedef enum {
+    VIDESK_POINTER_IMAGE = 0,       // 服务器下发的图像 (BGRA32，非预乘 alpha)
+    VIDESK_POINTER_HIDDEN = 1,      // 隐藏光标
+    VIDESK_POINTER_DEFAULT = 2      // 系统默认箭头
+} ViDeskPointerKind;
+
+// 服务器切换光标形状；pixels 仅在回调期间有效 (kind 不为 IMAGE 时为 NULL)
+typedef void (*PointerShapeCallback)(void* context, int kind, const uint8_t* pixels, int width, int height,
+                                     int hotspotX, int hotspotY);
 
 // 回调结构
 typedef struct {
@@ -48,8 +47,382 @@ typedef struct {
     AuthenticateCallback onAuthenticate;
     VerifyCertificateCallback onVerifyCertificate;
     ClipboardTextCallback onRemoteClipboardChanged;
+    PointerPositionCallback onPointerPosition;
+    PointerShapeCallback onPointerShape;
 } ViDeskCallbacks;
 
+// 最后错误消息缓冲区大小
+#define VIDESK_MAX_ERROR_LENGTH 512
+
+// 出站发送统计
+// 输入耗时指 freerdp_input_send_* 调用本身的时长 (等待传输层写锁 + 写 socket)
+typedef struct {
+    uint64_t bulkBytesQueued;       // 正在排队的大消息字节数
+    uint64_t bulkBytesSent;         // 已分片写出的大消息字节数
+    uint32_t bulkMessages;          // 进入队列的大消息数
+    uint32_t inputEvents;
+    uint64_t inputSendTotalNs;
+    uint64_t inputSendMaxNs;
+    uint32_t inputEventsDuringBulk; // 大消息排队期间发送的输入数
+    uint64_t inputSendDuringBulkTotalNs;
+    uint64_t inputSendDuringBulkMaxNs;
+} ViDeskSendStats;
+
+// 触控点阶段
+typedef enum {
+    VIDESK_TOUCH_BEGAN = 0,
+    VIDESK_TOUCH_MOVED = 1,
+    VIDESK_TOUCH_ENDED = 2,
+    VIDESK_TOUCH_CANCELLED = 3
+} ViDeskTouchPhase;
+
+// 单个触控点 (桌面坐标)
+typedef struct {
+    int32_t id;             // 手指标识，同一手指在 BEGAN 到 ENDED 之间保持不变
+    int32_t x;
+    int32_t y;
+    ViDeskTouchPhase phase;
+} ViDeskTouchContact;
+
+// 触控统计
+// 延迟指触控帧发出到其后第一次帧更新 (EndPaint) 的时间
+typedef struct {
+    uint32_t frames;            // 已发送的触控帧数
+    uint32_t contacts;          // 已发送的触点数
+    uint32_t latencySamples;
+    uint64_t latencyTotalNs;
+    uint64_t latencyMaxNs;
+    uint64_t lastLatencyNs;
+} ViDeskTouchStats;
+
+// 输入到上屏延迟统计
+// 输入发出 -> 之后第一个脏区域覆盖指针的帧更新 -> 渲染器呈现该帧
+typedef struct {
+    uint32_t samples;           // 百分位窗口内的样本数 (最近 512 个)
+    uint64_t totalSamples;
+    uint64_t p50Ns;             // 输入到呈现
+    uint64_t p95Ns;
+    uint64_t p99Ns;
+    uint64_t maxNs;
+    uint64_t frameP50Ns;        // 输入到帧更新 (不含本地渲染)
+    uint64_t frameP95Ns;
+    uint64_t expiredInputs;     // 超时未见到画面变化的输入
+    uint32_t pendingInputs;
+} ViDeskLatencyStats;
+
+// 输入录制/回放统计
+typedef struct {
+    uint32_t events;
+    uint64_t durationNs;        // 第一条到最后一条记录的时间跨度
+    uint64_t bytes;             // 录制文件大小
+    uint32_t failedEvents;      // 回放时发送失败的事件 (如服务器未打开对应通道)
+    uint64_t maxLagNs;          // 回放时实际发送时刻落后于原始时刻的最大值
+    uint64_t totalLagNs;
+} ViDeskInputReplayStats;
+
+// 传输层统计 (每次连接开始时清零)
+typedef struct {
+    bool pooled;                // 本次连接使用池化传输层 (false 为 FreeRDP 默认实现)
+    uint64_t elapsedNs;         // 统计时长
+    uint64_t recvCalls;         // 套接字读系统调用
+    uint64_t sendCalls;
+    uint64_t waitCalls;         // 阻塞等待 (poll)，连接阶段的同步读写使用
+    uint64_t layerReads;        // TLS 向传输层请求数据的次数
+    uint64_t bytesRead;         // 套接字读到的字节 (TLS 密文)
+    uint64_t pdus;              // 读出的 PDU
+    uint64_t allocations;       // 接收路径上的分配：接收缓冲区、PDU 接收流扩容
+    uint64_t prewarmSavedNs;    // 使用了预热的 TCP 连接时省下的时间 (0 表示未使用)
+    char remoteAddress[46];     // 地址竞速胜出的地址 (使用预热或默认实现时为空)
+    uint32_t addressCandidates; // DNS 解析出的地址数
+    uint32_t addressAttempts;   // 竞速中实际发起连接的地址数
+    uint64_t raceSavedNs;       // 比逐个尝试地址至少省下的时间
+} ViDeskTransportStats;
+
+// 连接预热统计 (进程内所有会话共享)
+typedef struct {
+    uint32_t started;           // 开始预热的次数
+    uint32_t used;              // 被连接取用
+    uint32_t discarded;         // 过期、取消或对端已关闭而丢弃
+    uint32_t failed;            // DNS 或 TCP 连接失败
+    uint32_t pending;           // 正在连接或等待取用的目标数
+    uint64_t lastSavedNs;       // 最近一次取用省下的连接时间
+    uint64_t totalSavedNs;
+} ViDeskPrewarmStats;
+
+// WAN 模拟的预设网络条件 (本地性能测试用，结果可复现)
+typedef enum {
+    VIDESK_WAN_PRESET_NONE = 0,         // 不模拟
+    VIDESK_WAN_PRESET_LTE,              // 移动网络：中等延迟，抖动明显，偶尔断流
+    VIDESK_WAN_PRESET_HOTEL_WIFI,       // 酒店 Wi-Fi：带宽窄，抖动大，频繁断流
+    VIDESK_WAN_PRESET_TRANSATLANTIC     // 跨大西洋有线链路：高延迟，带宽充足
+} ViDeskWanPreset;
+
+// WAN 模拟参数 (延迟为单向，两个方向相同)
+typedef struct {
+    uint32_t latencyMs;                 // 单向延迟
+    uint32_t jitterMs;                  // 延迟在 ±jitterMs 内均匀分布
+    uint32_t downlinkKbps;              // 服务器到客户端的带宽 (0 表示不限)
+    uint32_t uplinkKbps;                // 客户端到服务器的带宽 (0 表示不限)
+    uint32_t stallIntervalMs;           // 断流的平均间隔 (0 表示不断流)
+    uint32_t stallMs;                   // 每次断流的时长
+    uint32_t seed;                      // 抖动和断流的随机种子
+} ViDeskWanProfile;
+
+// WAN 模拟统计 (每次连接开始时清零)
+typedef struct {
+    bool enabled;                       // 本次连接启用了模拟
+    bool running;                       // 转发线程仍在运行
+    ViDeskWanProfile profile;
+    uint64_t bytesDown;                 // 已交付给客户端的字节
+    uint64_t bytesUp;                   // 已交付给服务器的字节
+    uint64_t chunksDown;                // 交付的数据块 (每次读到的数据为一块)
+    uint64_t chunksUp;
+    uint64_t totalDelayDownNs;          // 数据块从读入到交付的时间总和 (含排队)
+    uint64_t totalDelayUpNs;
+    uint64_t peakQueuedDown;            // 排队字节的峰值
+    uint64_t peakQueuedUp;
+    uint32_t stalls;                    // 已结束的断流次数
+    uint64_t stalledNs;                 // 断流总时长
+} ViDeskWanEmulationStats;
+
+// 批量压缩级别 (MS-RDPBCGR 3.1.8)：客户端声明支持的最高级别，服务器可以选用更低的级别
+// 级别越高压缩率越高，两端的 CPU 开销也越大；XCRUSH 为 FreeRDP 的默认值
+typedef enum {
+    VIDESK_COMPRESSION_NONE = 0,        // 不压缩
+    VIDESK_COMPRESSION_MPPC_8K = 1,     // RDP 4.0 MPPC，8 KB 历史缓冲区
+    VIDESK_COMPRESSION_MPPC_64K = 2,    // RDP 5.0 MPPC，64 KB 历史缓冲区
+    VIDESK_COMPRESSION_NCRDP = 3,       // RDP 6.0 NCRUSH (哈夫曼编码)
+    VIDESK_COMPRESSION_XCRUSH = 4       // RDP 6.1 XCRUSH (块匹配 + MPPC)
+} ViDeskCompressionLevel;
+
+// 批量压缩统计 (FreeRDP 在每个压缩过的 PDU 解压后累计，每次连接开始时清零)
+typedef struct {
+    ViDeskCompressionLevel level;       // 本次连接声明的级别
+    uint64_t compressedBytes;           // 压缩过的 PDU 在线路上的字节
+    uint64_t uncompressedBytes;         // 这些 PDU 解压后的字节
+} ViDeskCompressionStats;
+
+// 连接存活检测
+typedef struct {
+    bool heartbeatActive;               // 服务器在发送心跳 PDU (否则使用后备阈值并主动探测)
+    uint8_t heartbeatPeriod;            // 心跳周期 (秒)
+    uint8_t missedToWarn;               // 服务器给出的告警次数 (count1)
+    uint8_t missedToReconnect;          // 服务器给出的重连次数 (count2)
+    bool suspect;                       // 已超过告警阈值仍未收到数据
+    uint32_t heartbeats;                // 收到的心跳 PDU
+    uint32_t suspects;                  // 进入可疑状态的次数
+    uint32_t deadDetections;            // 判定连接已断开的次数
+    uint32_t probes;                    // 未发心跳时因静默发出的探测
+    uint64_t silenceNs;                 // 距上次收到数据的时间
+    uint64_t timeoutNs;                 // 判定断开的阈值
+    uint64_t lastDetectionSilenceNs;    // 最近一次判定断开时的静默时长
+} ViDeskLivenessStats;
+
+// 会话录制/回放模式 (FreeRDP transport dump)
+typedef enum {
+    VIDESK_SESSION_DUMP_OFF = 0,
+    VIDESK_SESSION_DUMP_CAPTURE = 1,    // 连接时把收发的 PDU 写入文件
+    VIDESK_SESSION_DUMP_REPLAY = 2      // 不连接服务器，从文件读入 PDU
+} ViDeskSessionDumpMode;
+
+// 会话录制文件概况
+typedef struct {
+    uint32_t records;
+    uint32_t serverRecords;     // 服务器发出 (入站) 的 PDU
+    uint64_t serverBytes;
+    uint32_t clientRecords;     // 客户端发出的 PDU (回放时丢弃)
+    uint64_t clientBytes;
+    uint32_t compressedUpdates; // 压缩过的快速路径更新
+    ViDeskCompressionLevel compressionLevel;    // 录制时服务器实际使用的压缩级别 (按快速路径更新统计)
+} ViDeskSessionDumpInfo;
+
+// 会话回放解码基准
+typedef struct {
+    bool running;
+    bool finished;              // 回放已结束 (读完文件后断开，或中途出错)
+    uint64_t elapsedNs;         // 开始连接到读完 (进行中为到现在)
+    uint64_t connectNs;         // 开始连接到连接完成
+    uint64_t firstFrameNs;      // 开始连接到第一次帧更新
+    uint64_t frames;
+    uint64_t paints;
+    uint64_t decodedBytes;      // 交给解码器的图像数据
+    uint64_t bytesReplayed;     // 读入的入站字节
+    uint64_t compressedBytes;   // 其中压缩过的 PDU 的字节
+    uint64_t uncompressedBytes; // 这些 PDU 解压后的字节
+} ViDeskSessionReplayStats;
+
+// 快速重连统计 (时间为单调时钟纳秒)
+typedef struct {
+    bool pending;                       // 已掉线，尚未在重连后收到第一帧
+    bool hasCookie;                     // 掉线时已持有服务器下发的自动重连 cookie
+    uint32_t drops;                     // 检测到的掉线次数
+    uint32_t attempts;                  // 重连尝试次数
+    uint32_t reconnects;                // 重连成功次数
+    uint64_t lastAttemptNs;             // 最近一次重连尝试的耗时
+    uint64_t lastDropToConnectNs;       // 最近一次掉线到重连完成
+    uint64_t lastDropToFirstFrameNs;    // 最近一次掉线到重连后第一帧
+    uint64_t totalDropToFirstFrameNs;   // 历次掉线到第一帧之和 (除以恢复次数得平均)
+} ViDeskReconnectStats;
+
+// 光标缓存统计
+// 命中率 = (contentHits + cachedSelects - cachedMisses) / (shapeUpdates + cachedSelects)
+typedef struct {
+    uint32_t shapeUpdates;      // 服务器下发光标 (PointerNew/Color/Large) 的次数
+    uint32_t contentHits;       // 其中内容已转换过 (本会话或之前的会话)，直接复用
+    uint32_t conversions;       // 实际转换掩码的次数
+    uint64_t conversionTotalNs;
+    uint32_t cachedSelects;     // 按缓存槽切换光标 (PointerCached) 的次数
+    uint32_t cachedMisses;      // 其中槽为空
+    uint32_t sharedEntries;     // 进程内共享的已转换光标数
+    uint64_t sharedBytes;
+} ViDeskPointerCacheStats;
+
+// 每秒统计样本 (会话统计历史中的一项)
+typedef struct {
+    uint64_t timestampMs;       // 样本结束时刻 (单调时钟，毫秒)
+    uint32_t frames;            // 本秒帧数：GFX EndFrame，未使用 GFX 时为 EndPaint
+    uint32_t paints;            // 本秒 EndPaint 次数
+    uint64_t decodedBytes;      // 本秒交给解码器的图像数据字节数 (GFX 表面命令、Surface Bits、位图更新)
+    uint64_t bytesReceived;     // 本秒收到的传输层字节数
+    uint64_t bytesSent;
+    uint32_t rttMs;             // 本秒结束时已知的平均往返时间 (未知为 0)
+} ViDeskStatsSample;
+
+// 统计历史保留的秒数
+#define VIDESK_STATS_HISTORY_LENGTH 120
+
+// 会话统计
+typedef struct {
+    uint64_t totalFrames;
+    uint64_t totalPaints;
+    uint64_t totalDecodedBytes;
+    uint64_t bytesReceived;
+    uint64_t bytesSent;
+    uint32_t frameRate;         // 最近一秒的帧数
+    uint32_t bandwidthBps;      // 最近一秒的入站带宽 (bit/s)
+    uint32_t averageRttMs;      // 服务器网络自动检测报告的往返时间 (未知为 0)
+    uint32_t baseRttMs;
+    uint32_t detectedBandwidthKbps;
+    uint32_t rttUpdates;        // 收到网络特征结果的次数
+} ViDeskSessionStats;
+
+// 虚拟通道类型
+typedef enum {
+    VIDESK_CHANNEL_STATIC = 0,          // 静态虚拟通道 (cliprdr、rdpsnd、drdynvc 等)
+    VIDESK_CHANNEL_DYNAMIC = 1          // drdynvc 上的动态虚拟通道 (图形、显示控制、音频等)
+} ViDeskChannelKind;
+
+// 虚拟通道名称的最大长度 (含结尾的 0)，动态通道名称如 Microsoft::Windows::RDS::Graphics
+#define VIDESK_CHANNEL_NAME_LENGTH 64
+
+// 统计的通道数上限 (超过后新出现的通道不再统计)
+#define VIDESK_CHANNEL_STATS_LIMIT 32
+
+// 每个通道的速率历史保留的秒数
+#define VIDESK_CHANNEL_HISTORY_LENGTH 60
+
+// 虚拟通道统计 (每次连接开始时清零)
+// 静态通道按线路上的通道数据计 (drdynvc 包含其上所有动态通道及其协议头)，
+// 动态通道只计数据 PDU 的负载，drdynvc 减去各动态通道之和即为动态通道协议的开销
+typedef struct {
+    char name[VIDESK_CHANNEL_NAME_LENGTH];
+    ViDeskChannelKind kind;
+    bool open;                          // 动态通道当前已打开 (静态通道始终为 true)
+    uint32_t opens;                     // 动态通道被服务器创建的次数
+    uint64_t bytesIn;                   // 服务器到客户端
+    uint64_t bytesOut;
+    uint64_t messagesIn;                // 完整的通道消息 (分片重组后为一个)
+    uint64_t messagesOut;
+    uint64_t bytesInPerSecond;          // 最近一秒
+    uint64_t bytesOutPerSecond;
+} ViDeskChannelStats;
+
+// 虚拟通道每秒样本
+typedef struct {
+    uint64_t timestampMs;               // 样本结束时刻 (单调时钟，毫秒)
+    uint64_t bytesIn;                   // 本秒字节数
+    uint64_t bytesOut;
+    uint32_t messagesIn;                // 本秒消息数
+    uint32_t messagesOut;
+} ViDeskChannelSample;
+
+// 自适应画质档位 (按网络自动检测测得的带宽和往返时间划分)
+typedef enum {
+    VIDESK_QUALITY_LAN = 0,
+    VIDESK_QUALITY_BROADBAND = 1,
+    VIDESK_QUALITY_CONSTRAINED = 2,
+    VIDESK_QUALITY_POOR = 3
+} ViDeskQualityLevel;
+
+// GFX 编码偏好 (GFX 能力只在通道打开时协商，下次连接/重连时生效)
+typedef enum {
+    VIDESK_QUALITY_CODEC_AVC444 = 0,    // 全色度，画质优先
+    VIDESK_QUALITY_CODEC_AVC420 = 1     // 4:2:0，带宽优先
+} ViDeskQualityCodec;
+
+// 档位对应的参数
+typedef struct {
+    ViDeskQualityLevel level;
+    uint32_t frameAckDepth;         // 允许渲染器落后的帧数，超过时暂停读取 (推迟帧确认)，0 表示不限
+    uint32_t resolutionPercent;     // 通过 DISP 请求的分辨率 (相对连接时的分辨率)
+    ViDeskQualityCodec codec;
+    bool reduceVisualEffects;       // 关闭壁纸、拖动显示窗口内容、菜单动画 (下次连接时生效)
+} ViDeskQualityProfile;
+
+// 画质调整记录
+typedef struct {
+    uint64_t timestampMs;           // 单调时钟，毫秒
+    ViDeskQualityLevel from;
+    ViDeskQualityLevel to;
+    uint32_t bandwidthKbps;         // 决策时的平滑带宽 (未知为 0)
+    uint32_t rttMs;                 // 决策时的平滑往返时间 (未知为 0)
+    ViDeskQualityProfile profile;
+    char reason[96];
+} ViDeskQualityDecision;
+
+// 自适应画质状态
+typedef struct {
+    bool enabled;
+    ViDeskQualityProfile profile;
+    uint32_t bandwidthKbps;
+    uint32_t rttMs;
+    uint32_t decisions;             // 档位变化次数
+    uint32_t resolutionRequests;    // 已发出的 DISP 分辨率请求数
+    uint64_t throttledNs;           // 因渲染器落后暂停读取的累计时间
+} ViDeskQualityState;
+
+// ViDesk 自定义上下文结构
+// 回调、错误和日志状态均按上下文保存，多个会话可在各自线程上并发驱动
+typedef struct {
+    rdpContext* rdpCtx;
+    void* swiftCallbackContext;
+
+    // 帧缓冲区
+    uint8_t* frameBuffer;
+    uint32_t frameWidth;
+    uint32_t frameHeight;
+    uint32_t frameBytesPerPixel;
+
+    // 状态标志
+    bool isConnected;
+    bool isAuthenticated;
+
+    // 本会话的回调
+    ViDeskCallbacks callbacks;
+
+    // 本会话的最后错误消息
+    char lastError[VIDESK_MAX_ERROR_LENGTH];
+
+    // 本会话的日志文件 (FILE*，为 NULL 时只输出到 stdout)
+    // 由桥接层加锁读写，调用方通过 viDesk_setContextLogFile 替换
+    void* logFile;
+
+    // 内存占用 (由事件处理线程每秒采样一次)
+    uint64_t frameBufferBytes;
+    uint64_t gfxCacheBytes;
+    uint64_t lastMemorySampleNs;
+} ViDeskContext;
+
 // === 初始化和清理 ===
 
 /// 创建 ViDesk 上下文
@@ -76,6 +449,12 @@ bool viDesk_setDisplay(ViDeskContext* ctx, int width, int height, int colorDepth
 bool viDesk_setPerformanceFlags(ViDeskContext* ctx, bool enableWallpaper, bool enableFullWindowDrag,
                                  bool enableMenuAnimations, bool enableThemes, bool enableFontSmoothing);
 
+/// 设置批量压缩级别 (下次连接生效，默认 XCRUSH)
+bool viDesk_setCompressionLevel(ViDeskContext* ctx, ViDeskCompressionLevel level);
+
+/// 获取批量压缩统计
+void viDesk_getCompressionStats(ViDeskContext* ctx, ViDeskCompressionStats* stats);
+
 /// 设置安全选项
 bool viDesk_setSecurity(ViDeskContext* ctx, bool useNLA, bool useTLS, bool ignoreCertErrors);
 
@@ -88,32 +467,97 @@ bool viDesk_setGateway(ViDeskContext* ctx, const char* hostname, int port,
 /// 发起连接
 bool viDesk_connect(ViDeskContext* ctx);
 
-/// 断开连接
+/// 断开连接 (快速重连进行中时中止重连，返回后需再次调用以释放连接)
 void viDesk_disconnect(ViDeskContext* ctx);
 
+/// 掉线后在原上下文上快速重连 (阻塞，在后台线程调用)
+/// 保留设置、GDI、通道和 GFX 持久缓存，凭服务器下发的自动重连 cookie 回到原会话；
+/// 失败后可再次调用，放弃时调用 viDesk_disconnect 释放连接
+bool viDesk_reconnect(ViDeskContext* ctx);
+
+/// 获取快速重连统计
+void viDesk_getReconnectStats(ViDeskContext* ctx, ViDeskReconnectStats* stats);
+
 /// 检查连接状态
 bool viDesk_isConnected(ViDeskContext* ctx);
 
+/// 预热到 hostname:port 的连接：后台解析 DNS 并建立 TCP，
+/// windowMs 内对同一目标发起的连接 (池化传输层) 直接使用，过期未用则关闭
+bool viDesk_prewarmConnection(const char* hostname, int port, uint32_t windowMs);
+
+/// 取消预热 (hostname 为 NULL 时取消全部)
+void viDesk_cancelPrewarm(const char* hostname, int port);
+
+/// 获取连接预热统计
+void viDesk_getPrewarmStats(ViDeskPrewarmStats* stats);
+
 /// 处理事件循环 (需要在后台线程周期性调用)
 bool viDesk_processEvents(ViDeskContext* ctx, int timeoutMs);
 
+/// 获取会话的事件句柄 (HANDLE)，供共享调度线程统一等待，返回句柄数量
+uint32_t viDesk_getEventHandles(ViDeskContext* ctx, void** handles, uint32_t count);
+
+/// 处理已就绪的事件，不等待 (由共享工作线程调用)
+/// 返回 false 表示会话已断开或出错
+bool viDesk_processPendingEvents(ViDeskContext* ctx);
+
+// === 资源配置 ===
+
+/// 使用共享工作线程驱动本会话 (必须在连接前调用)
+/// 启用后关闭编解码器的会话内线程池，解码统一在共享工作线程上进行
+bool viDesk_setSharedWorkers(ViDeskContext* ctx, bool enabled);
+
+/// 使用 GFX 小缓存 (必须在连接前调用)，用于内存预算紧张时的后台会话
+bool viDesk_setGfxSmallCache(ViDeskContext* ctx, bool enabled);
+
+/// 估算本会话连接后的内存上限 (帧缓冲区 + GFX 缓存，字节)
+uint64_t viDesk_getMemoryReservation(ViDeskContext* ctx);
+
+/// 获取最近一次采样的内存占用 (字节)
+void viDesk_getMemoryUsage(ViDeskContext* ctx, uint64_t* frameBufferBytes, uint64_t* gfxCacheBytes);
+
 // === 输入事件 ===
 
 /// 发送鼠标移动事件
 bool viDesk_sendMouseMove(ViDeskContext* ctx, int x, int y);
 
+/// 服务器是否打开了 ainput 通道 (支持相对鼠标移动)
+bool viDesk_isRelativeMouseAvailable(ViDeskContext* ctx);
+
+/// 通过 ainput 通道发送相对鼠标移动 (像素，可带小数，不足 1 像素的部分累积到下一次)
+/// 通道不可用时返回 false，调用方应回退到 viDesk_sendMouseMove
+bool viDesk_sendMouseRelative(ViDeskContext* ctx, double dx, double dy);
+
+/// 服务器是否打开了 RDPEI 通道 (支持多点触控)
+bool viDesk_isTouchAvailable(ViDeskContext* ctx);
+
+/// 发送一个触控帧 (同一时刻所有发生变化的触点)，通道不可用时返回 false
+bool viDesk_sendTouchFrame(ViDeskContext* ctx, const ViDeskTouchContact* contacts, uint32_t count);
+
+/// 获取/重置触控统计
+void viDesk_getTouchStats(ViDeskContext* ctx, ViDeskTouchStats* stats);
+void viDesk_resetTouchStats(ViDeskContext* ctx);
+
 /// 发送鼠标按钮事件
 bool viDesk_sendMouseButton(ViDeskContext* ctx, int button, bool isPressed, int x, int y);
 
 /// 发送鼠标滚轮事件
 bool viDesk_sendMouseWheel(ViDeskContext* ctx, int delta, bool isHorizontal);
 
+/// 滚轮事件的指针标志：旋转量为 9 位二进制补码 (MS-RDPBCGR 2.2.8.1.1.3.1.1.3)，
+/// 负值的低 8 位是 0x200 减去幅度，不是幅度本身。正值最大 255，负值最大 256
+uint16_t viDesk_wheelFlags(int delta, bool isHorizontal);
+
 /// 发送键盘事件
 bool viDesk_sendKeyEvent(ViDeskContext* ctx, uint16_t scanCode, bool isPressed, bool isExtended);
 
 /// 发送 Unicode 字符
 bool viDesk_sendUnicodeKey(ViDeskContext* ctx, uint16_t codePoint);
 
+/// 发送一段 UTF-8 文本 (length 为字节数)
+/// 支持 U+FFFF 以上的字符 (代理对)；可能时每个 fast-path 输入 PDU 打包最多 127 个码元
+bool viDesk_sendUnicodeText(ViDeskContext* ctx, const char* utf8, size_t length);
+
 // === 剪贴板 ===
 
 /// 设置剪贴板文本
@@ -138,18 +582,113 @@ uint32_t viDesk_getFrameBytesPerPixel(ViDeskContext* ctx);
 
 // === 日志 ===
 
-/// 设置日志文件路径（同时输出到 stdout 和文件）
+/// 设置默认日志文件路径（同时输出到 stdout 和文件）
+/// 之后创建的上下文各自以追加方式打开该文件
 void viDesk_setLogFile(const char* path);
 
+/// 为单个上下文设置日志文件路径 (NULL 表示只输出到 stdout)
+void viDesk_setContextLogFile(ViDeskContext* ctx, const char* path);
+
 // === 调试和统计 ===
 
-/// 获取最后错误消息
-const char* viDesk_getLastError(ViDeskContext* ctx);
+/// 将最后错误消息复制到调用者的缓冲区 (线程安全)，无错误时返回 false
+/// ctx 为 NULL 时复制当前线程上无上下文调用 (如 viDesk_createContext) 的错误
+bool viDesk_copyLastError(ViDeskContext* ctx, char* buffer, uint32_t bufferSize);
+
+/// 获取事件处理线程在本会话上消耗的 CPU 时间 (纳秒)
+uint64_t viDesk_getProcessingCpuTime(ViDeskContext* ctx);
+
+/// 获取出站发送统计
+void viDesk_getSendStats(ViDeskContext* ctx, ViDeskSendStats* stats);
+
+/// 重置出站发送统计 (保留当前排队字节数)
+void viDesk_resetSendStats(ViDeskContext* ctx);
+
+/// 回报帧已呈现：序号不大于 sequence 的帧更新已上屏，ageNs 为呈现时刻距现在的时长
+/// (可在任意线程调用，如 Metal 的 presented handler)
+void viDesk_recordFramePresented(ViDeskContext* ctx, uint64_t sequence, uint64_t ageNs);
+
+/// 获取/重置输入到上屏延迟统计
+void viDesk_getLatencyStats(ViDeskContext* ctx, ViDeskLatencyStats* stats);
+void viDesk_resetLatencyStats(ViDeskContext* ctx);
+
+/// 启用/停用自适应画质 (默认启用)；停用时恢复最高档
+void viDesk_setAdaptiveQuality(ViDeskContext* ctx, bool enabled);
+
+/// 获取自适应画质状态
+void viDesk_getQualityState(ViDeskContext* ctx, ViDeskQualityState* state);
+
+/// 复制最近的画质调整记录 (最旧的在前)，返回复制的个数
+uint32_t viDesk_getQualityDecisions(ViDeskContext* ctx, ViDeskQualityDecision* decisions, uint32_t capacity);
+
+/// 获取/重置光标缓存统计
+void viDesk_getPointerCacheStats(ViDeskContext* ctx, ViDeskPointerCacheStats* stats);
+void viDesk_resetPointerCacheStats(ViDeskContext* ctx);
+
+/// 开始把输入调用 (viDesk_send*) 及其时间戳录制到文件，path 已存在时覆盖
+bool viDesk_startInputRecording(ViDeskContext* ctx, const char* path);
+
+/// 结束录制，未在录制时返回 false
+bool viDesk_stopInputRecording(ViDeskContext* ctx, ViDeskInputReplayStats* stats);
+
+/// 按原始时间间隔回放录制文件 (阻塞到回放结束，需在后台线程调用)
+/// 会话断开、被取消或文件损坏时返回 false，stats 中是已回放部分的统计
+bool viDesk_replayInputRecording(ViDeskContext* ctx, const char* path, ViDeskInputReplayStats* stats);
+
+/// 取消正在进行的回放 (可在任意线程调用)
+void viDesk_cancelInputReplay(ViDeskContext* ctx);
 
-/// 获取连接统计信息
+/// 是否使用池化接收缓冲区的传输层 (默认启用，下次连接生效；关闭时使用 FreeRDP 默认实现以便对比)
+void viDesk_setPooledTransport(ViDeskContext* ctx, bool enabled);
+
+/// 获取连接存活检测统计
+void viDesk_getLivenessStats(ViDeskContext* ctx, ViDeskLivenessStats* stats);
+
+/// 获取/重置传输层统计
+void viDesk_getTransportStats(ViDeskContext* ctx, ViDeskTransportStats* stats);
+void viDesk_resetTransportStats(ViDeskContext* ctx);
+
+/// 设置 WAN 模拟 (下次连接生效，profile 为 NULL 时关闭)
+/// 在池化传输层和服务器之间插入本地转发，加入延迟、抖动、带宽上限和断流；未使用池化传输层时不生效
+void viDesk_setWanEmulation(ViDeskContext* ctx, const ViDeskWanProfile* profile);
+
+/// 获取预设的网络条件，preset 为 NONE 或无效时返回 false
+bool viDesk_getWanPreset(ViDeskWanPreset preset, ViDeskWanProfile* profile);
+
+/// 获取 WAN 模拟统计
+void viDesk_getWanEmulationStats(ViDeskContext* ctx, ViDeskWanEmulationStats* stats);
+
+/// 设置会话录制/回放 (在 viDesk_connect 之前调用，对之后的每次连接生效)
+/// 录制：连接后把收发的 PDU 写入 path (已存在时覆盖)
+/// 回放：viDesk_connect 不连接服务器，不按原始间隔而是尽快把文件中的 PDU 送入解码、GDI 和帧更新回调，
+/// 读完后会话断开；用作不依赖服务器、结果可重复的解码吞吐量基准。info 为文件概况 (可为 NULL)
+bool viDesk_setSessionDump(ViDeskContext* ctx, ViDeskSessionDumpMode mode, const char* path,
+                           ViDeskSessionDumpInfo* info);
+
+/// 获取回放基准结果 (回放进行中也可调用)
+void viDesk_getSessionReplayStats(ViDeskContext* ctx, ViDeskSessionReplayStats* stats);
+
+/// 无界面模式：帧更新即视为已呈现，没有渲染器时延迟统计也能产生样本 (此时为输入到帧更新)
+void viDesk_setHeadlessPresentation(ViDeskContext* ctx, bool enabled);
+
+/// 获取连接统计信息 (frameRate 为最近一秒的帧数，latencyMs 为网络自动检测报告的平均往返时间)
 void viDesk_getStatistics(ViDeskContext* ctx, uint64_t* bytesReceived, uint64_t* bytesSent,
                           uint32_t* frameRate, uint32_t* latencyMs);
 
+/// 获取会话统计
+void viDesk_getSessionStats(ViDeskContext* ctx, ViDeskSessionStats* stats);
+
+/// 复制最近的每秒统计样本 (最旧的在前)，返回复制的个数
+/// 样本由事件处理线程每秒写入一次，调用方按需读取，不需要每帧轮询
+uint32_t viDesk_getStatsHistory(ViDeskContext* ctx, ViDeskStatsSample* samples, uint32_t capacity);
+
+/// 复制各虚拟通道的统计 (按首次出现的顺序)，返回复制的个数
+uint32_t viDesk_getChannelStats(ViDeskContext* ctx, ViDeskChannelStats* channels, uint32_t capacity);
+
+/// 复制某个通道最近的每秒样本 (最旧的在前)，返回复制的个数，通道不存在时返回 0
+uint32_t viDesk_getChannelHistory(ViDeskContext* ctx, const char* name, ViDeskChannelKind kind,
+                                  ViDeskChannelSample* samples, uint32_t capacity);
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,12 +9,14 @@ final class FreeRDPContext: @unchecked Sendable {
     private var callbackContext: UnsafeMutableRawPointer?
 
     // 回调闭包
-    private var onFrameUpdate: ((CGRect) -> Void)?
+    private var onFrameUpdate: ((CGRect, UInt64) -> Void)?
     private var onDesktopResize: ((CGSize) -> Void)?
     private var onStateChange: ((ConnectionState) -> Void)?
     private var onAuthenticationRequired: (() async -> Credentials?)?
     private var onCertificateVerify: ((CertificateInfo) async -> Bool)?
     private var onRemoteClipboardChanged: ((String) -> Void)?
+    private var onPointerPosition: ((CGPoint) -> Void)?
+    private var onPointerShape: ((PointerShape) -> Void)?
 
     /// 连接状态 (从 C 层映射)
     enum ConnectionState: Int {
@@ -33,6 +35,14 @@ final class FreeRDPContext: @unchecked Sendable {
         let domain: String?
     }
 
+    /// 服务器光标形状
+    enum PointerShape {
+        /// BGRA32 图像 (非预乘 alpha)，hotspot 为图像内的点击位置
+        case image(pixels: [UInt8], width: Int, height: Int, hotspot: CGPoint)
+        case hidden
+        case systemDefault
+    }
+
     /// 证书信息
     struct CertificateInfo {
         let commonName: String
@@ -80,8 +90,8 @@ final class FreeRDPContext: @unchecked Sendable {
         }
     }
 
-    /// 设置帧更新回调
-    func setFrameUpdateHandler(_ handler: @escaping (CGRect) -> Void) {
+    /// 设置帧更新回调 (脏区域, 帧序号)
+    func setFrameUpdateHandler(_ handler: @escaping (CGRect, UInt64) -> Void) {
         onFrameUpdate = handler
     }
 
@@ -110,6 +120,16 @@ final class FreeRDPContext: @unchecked Sendable {
         onRemoteClipboardChanged = handler
     }
 
+    /// 设置服务器移动指针回调 (桌面坐标)
+    func setPointerPositionHandler(_ handler: @escaping (CGPoint) -> Void) {
+        onPointerPosition = handler
+    }
+
+    /// 设置服务器切换光标形状回调
+    func setPointerShapeHandler(_ handler: @escaping (PointerShape) -> Void) {
+        onPointerShape = handler
+    }
+
     /// 暴露原始上下文指针，用于后台线程事件处理
     var rawContextPointer: UnsafeMutablePointer<ViDeskContext>? {
         context
@@ -162,6 +182,63 @@ final class FreeRDPContext: @unchecked Sendable {
                                           enableMenuAnimations, enableThemes, enableFontSmoothing)
     }
 
+    /// 批量压缩级别：客户端声明支持的最高级别，级别越高压缩率越高、CPU 开销越大
+    enum CompressionLevel: Int, CaseIterable, Identifiable {
+        case none = 0
+        case mppc8K = 1
+        case mppc64K = 2
+        case ncrdp = 3
+        case xcrush = 4
+
+        var id: Int { rawValue }
+
+        var displayName: String {
+            switch self {
+            case .none: return "不压缩"
+            case .mppc8K: return "MPPC 8K (RDP 4.0)"
+            case .mppc64K: return "MPPC 64K (RDP 5.0)"
+            case .ncrdp: return "NCRDP (RDP 6.0)"
+            case .xcrush: return "XCRUSH (RDP 6.1)"
+            }
+        }
+
+        fileprivate init(_ raw: ViDeskCompressionLevel) {
+            self = CompressionLevel(rawValue: Int(raw.rawValue)) ?? .none
+        }
+    }
+
+    /// 批量压缩统计 (本次连接压缩过的 PDU)
+    struct CompressionStatistics {
+        var level: CompressionLevel = .xcrush
+        var compressedBytes: UInt64 = 0
+        var uncompressedBytes: UInt64 = 0
+
+        /// 压缩率 (解压后 / 线路上)
+        var ratio: Double {
+            compressedBytes > 0 ? Double(uncompressedBytes) / Double(compressedBytes) : 0
+        }
+    }
+
+    /// 设置批量压缩级别 (下次连接生效)
+    @discardableResult
+    func setCompressionLevel(_ level: CompressionLevel) -> Bool {
+        guard let ctx = context else { return false }
+        return viDesk_setCompressionLevel(ctx, ViDeskCompressionLevel(rawValue: UInt32(level.rawValue)))
+    }
+
+    /// 获取批量压缩统计
+    func compressionStatistics() -> CompressionStatistics {
+        var stats = CompressionStatistics()
+        guard let ctx = context else { return stats }
+        var raw = ViDeskCompressionStats()
+        viDesk_getCompressionStats(ctx, &raw)
+
+        stats.level = CompressionLevel(raw.level)
+        stats.compressedBytes = raw.compressedBytes
+        stats.uncompressedBytes = raw.uncompressedBytes
+        return stats
+    }
+
     /// 设置安全选项
     func setSecurity(useNLA: Bool = true, useTLS: Bool = true, ignoreCertErrors: Bool = false) -> Bool {
         guard let ctx = context else { return false }
@@ -202,6 +279,63 @@ final class FreeRDPContext: @unchecked Sendable {
         viDesk_disconnect(ctx)
     }
 
+    /// 掉线后在原上下文上快速重连（在后台线程执行）
+    func reconnect() async -> Bool {
+        guard let ctx = context else { return false }
+        return await withCheckedContinuation { continuation in
+            DispatchQueue.global(qos: .userInitiated).async {
+                let result = viDesk_reconnect(ctx)
+                continuation.resume(returning: result)
+            }
+        }
+    }
+
+    // MARK: - 连接预热
+
+    /// 连接预热统计 (进程内所有会话共享)
+    struct PrewarmStatistics {
+        var started: UInt32 = 0
+        var used: UInt32 = 0
+        var discarded: UInt32 = 0
+        var failed: UInt32 = 0
+        var pending: UInt32 = 0
+        var lastSaved: TimeInterval = 0
+        var totalSaved: TimeInterval = 0
+    }
+
+    /// 预热到主机的连接 (后台解析 DNS 并建立 TCP)，window 内发起的连接直接使用，过期未用则关闭
+    @discardableResult
+    static func prewarm(hostname: String, port: Int, window: TimeInterval) -> Bool {
+        hostname.withCString { hostnamePtr in
+            viDesk_prewarmConnection(hostnamePtr, Int32(port), UInt32(window * 1000))
+        }
+    }
+
+    /// 取消预热 (hostname 为 nil 时取消全部)
+    static func cancelPrewarm(hostname: String? = nil, port: Int = 0) {
+        if let hostname = hostname {
+            hostname.withCString { viDesk_cancelPrewarm($0, Int32(port)) }
+        } else {
+            viDesk_cancelPrewarm(nil, 0)
+        }
+    }
+
+    /// 获取连接预热统计
+    static func prewarmStatistics() -> PrewarmStatistics {
+        var raw = ViDeskPrewarmStats()
+        viDesk_getPrewarmStats(&raw)
+
+        var stats = PrewarmStatistics()
+        stats.started = raw.started
+        stats.used = raw.used
+        stats.discarded = raw.discarded
+        stats.failed = raw.failed
+        stats.pending = raw.pending
+        stats.lastSaved = TimeInterval(raw.lastSavedNs) / 1_000_000_000
+        stats.totalSaved = TimeInterval(raw.totalSavedNs) / 1_000_000_000
+        return stats
+    }
+
     /// 检查是否已连接
     var isConnected: Bool {
         guard let ctx = context else { return false }
@@ -222,6 +356,45 @@ final class FreeRDPContext: @unchecked Sendable {
         return viDesk_sendMouseMove(ctx, Int32(x), Int32(y))
     }
 
+    /// 服务器是否支持相对鼠标移动 (ainput 通道已打开)
+    var isRelativeMouseAvailable: Bool {
+        guard let ctx = context else { return false }
+        return viDesk_isRelativeMouseAvailable(ctx)
+    }
+
+    /// 发送相对鼠标移动 (像素，可带小数)
+    func sendMouseRelative(dx: Double, dy: Double) -> Bool {
+        guard let ctx = context else { return false }
+        return viDesk_sendMouseRelative(ctx, dx, dy)
+    }
+
+    /// 服务器是否支持多点触控 (RDPEI 通道已打开)
+    var isTouchAvailable: Bool {
+        guard let ctx = context else { return false }
+        return viDesk_isTouchAvailable(ctx)
+    }
+
+    /// 发送一个触控帧
+    func sendTouchFrame(_ contacts: [TouchContact]) -> Bool {
+        guard let ctx = context, !contacts.isEmpty else { return false }
+        let raw = contacts.map { contact -> ViDeskTouchContact in
+            let phase: ViDeskTouchPhase
+            switch contact.phase {
+            case .began: phase = VIDESK_TOUCH_BEGAN
+            case .moved: phase = VIDESK_TOUCH_MOVED
+            case .ended: phase = VIDESK_TOUCH_ENDED
+            case .cancelled: phase = VIDESK_TOUCH_CANCELLED
+            }
+            return ViDeskTouchContact(id: Int32(contact.id),
+                                      x: Int32(contact.location.x),
+                                      y: Int32(contact.location.y),
+                                      phase: phase)
+        }
+        return raw.withUnsafeBufferPointer { buffer in
+            viDesk_sendTouchFrame(ctx, buffer.baseAddress, UInt32(buffer.count))
+        }
+    }
+
     /// 发送鼠标按钮
     func sendMouseButton(_ button: MouseButton, pressed: Bool, x: Int, y: Int) -> Bool {
         guard let ctx = context else { return false }
@@ -246,6 +419,14 @@ final class FreeRDPContext: @unchecked Sendable {
         return viDesk_sendUnicodeKey(ctx, codePoint)
     }
 
+    /// 发送一段文本 (桥接层一次转换为 UTF-16 并批量打包)
+    func sendUnicodeText(_ text: String) -> Bool {
+        guard let ctx = context else { return false }
+        return text.withCString { textPtr in
+            viDesk_sendUnicodeText(ctx, textPtr, strlen(textPtr))
+        }
+    }
+
     // MARK: - 剪贴板
 
     /// 设置剪贴板文本
@@ -288,11 +469,875 @@ final class FreeRDPContext: @unchecked Sendable {
         return Int(viDesk_getFrameBytesPerPixel(ctx))
     }
 
-    /// 获取最后错误
+    /// 获取最后错误 (按上下文隔离，多会话互不覆盖)
     var lastError: String? {
+        var buffer = [CChar](repeating: 0, count: Int(VIDESK_MAX_ERROR_LENGTH))
+        guard viDesk_copyLastError(context, &buffer, UInt32(buffer.count)) else { return nil }
+        return String(cString: buffer)
+    }
+
+    // MARK: - 统计
+
+    /// 连接统计快照
+    struct Statistics {
+        var bytesReceived: UInt64 = 0
+        var bytesSent: UInt64 = 0
+        var frameRate: UInt32 = 0
+        var latencyMs: UInt32 = 0
+    }
+
+    /// 获取连接统计
+    func statistics() -> Statistics {
+        var stats = Statistics()
+        guard let ctx = context else { return stats }
+        viDesk_getStatistics(ctx, &stats.bytesReceived, &stats.bytesSent, &stats.frameRate, &stats.latencyMs)
+        return stats
+    }
+
+    /// 会话统计 (帧、解码字节、网络自动检测结果)
+    struct SessionCounters {
+        var totalFrames: UInt64 = 0
+        var totalDecodedBytes: UInt64 = 0
+        /// 最近一秒
+        var frameRate: Int = 0
+        var bandwidth: Int = 0
+        /// 服务器测得的往返时间 (未知为 0)
+        var averageRTT: TimeInterval = 0
+        var baseRTT: TimeInterval = 0
+        /// 服务器测得的带宽 (bit/s，未知为 0)
+        var detectedBandwidth: Int = 0
+    }
+
+    /// 每秒统计样本
+    struct StatisticsSample {
+        /// 单调时钟时间
+        var timestamp: TimeInterval
+        var frames: Int
+        var decodedBytes: UInt64
+        var bytesReceived: UInt64
+        var bytesSent: UInt64
+        var rtt: TimeInterval
+    }
+
+    /// 获取会话统计
+    func sessionCounters() -> SessionCounters {
+        var counters = SessionCounters()
+        guard let ctx = context else { return counters }
+        var raw = ViDeskSessionStats()
+        viDesk_getSessionStats(ctx, &raw)
+
+        counters.totalFrames = raw.totalFrames
+        counters.totalDecodedBytes = raw.totalDecodedBytes
+        counters.frameRate = Int(raw.frameRate)
+        counters.bandwidth = Int(raw.bandwidthBps)
+        counters.averageRTT = TimeInterval(raw.averageRttMs) / 1000
+        counters.baseRTT = TimeInterval(raw.baseRttMs) / 1000
+        counters.detectedBandwidth = Int(raw.detectedBandwidthKbps) * 1000
+        return counters
+    }
+
+    /// 获取最近的每秒统计样本 (最旧的在前，最多 VIDESK_STATS_HISTORY_LENGTH 个)
+    func statisticsHistory() -> [StatisticsSample] {
+        guard let ctx = context else { return [] }
+        var raw = [ViDeskStatsSample](repeating: ViDeskStatsSample(), count: Int(VIDESK_STATS_HISTORY_LENGTH))
+        let count = Int(viDesk_getStatsHistory(ctx, &raw, UInt32(raw.count)))
+
+        return raw.prefix(count).map { sample in
+            StatisticsSample(timestamp: TimeInterval(sample.timestampMs) / 1000,
+                             frames: Int(sample.frames),
+                             decodedBytes: sample.decodedBytes,
+                             bytesReceived: sample.bytesReceived,
+                             bytesSent: sample.bytesSent,
+                             rtt: TimeInterval(sample.rttMs) / 1000)
+        }
+    }
+
+    /// 虚拟通道统计 (本次连接)
+    /// drdynvc 为线路上的全部动态通道数据，动态通道只计数据负载，二者之差为动态通道协议的开销
+    struct ChannelStatistics: Identifiable {
+        var name: String
+        var isDynamic: Bool
+        /// 动态通道当前已打开 (静态通道始终为 true)
+        var isOpen: Bool
+        /// 动态通道被服务器创建的次数
+        var opens: Int
+        var bytesIn: UInt64
+        var bytesOut: UInt64
+        var messagesIn: UInt64
+        var messagesOut: UInt64
+        /// 最近一秒 (字节/秒)
+        var bytesInPerSecond: UInt64
+        var bytesOutPerSecond: UInt64
+
+        var id: String { (isDynamic ? "dvc:" : "svc:") + name }
+
+        /// 常见动态通道用 FreeRDP 插件名显示，其余为原名
+        var displayName: String {
+            guard isDynamic else { return name }
+            switch name {
+            case "Microsoft::Windows::RDS::Graphics": return "rdpgfx"
+            case "Microsoft::Windows::RDS::DisplayControl": return "disp"
+            case "Microsoft::Windows::RDS::Input": return "rdpei"
+            case "Microsoft::Windows::RDS::Geometry::v08.01": return "geometry"
+            case "Microsoft::Windows::RDS::Video::Control::v08.01",
+                 "Microsoft::Windows::RDS::Video::Data::v08.01": return "video"
+            case "AUDIO_PLAYBACK_DVC", "AUDIO_PLAYBACK_LOSSY_DVC": return "rdpsnd (dvc)"
+            case "AUDIO_INPUT": return "audin"
+            default: return name
+            }
+        }
+    }
+
+    /// 虚拟通道每秒样本
+    struct ChannelSample {
+        /// 单调时钟时间
+        var timestamp: TimeInterval
+        var bytesIn: UInt64
+        var bytesOut: UInt64
+        var messagesIn: Int
+        var messagesOut: Int
+    }
+
+    /// 获取各虚拟通道的统计 (按首次出现的顺序)
+    func channelStatistics() -> [ChannelStatistics] {
+        guard let ctx = context else { return [] }
+        var raw = [ViDeskChannelStats](repeating: ViDeskChannelStats(), count: Int(VIDESK_CHANNEL_STATS_LIMIT))
+        let count = Int(viDesk_getChannelStats(ctx, &raw, UInt32(raw.count)))
+
+        return raw.prefix(count).map { channel in
+            var copy = channel
+            let name = withUnsafeBytes(of: &copy.name) { String(cString: $0.bindMemory(to: CChar.self).baseAddress!) }
+            return ChannelStatistics(name: name,
+                                     isDynamic: channel.kind == VIDESK_CHANNEL_DYNAMIC,
+                                     isOpen: channel.open,
+                                     opens: Int(channel.opens),
+                                     bytesIn: channel.bytesIn,
+                                     bytesOut: channel.bytesOut,
+                                     messagesIn: channel.messagesIn,
+                                     messagesOut: channel.messagesOut,
+                                     bytesInPerSecond: channel.bytesInPerSecond,
+                                     bytesOutPerSecond: channel.bytesOutPerSecond)
+        }
+    }
+
+    /// 获取某个通道最近的每秒样本 (最旧的在前，最多 VIDESK_CHANNEL_HISTORY_LENGTH 个)
+    func channelHistory(for channel: ChannelStatistics) -> [ChannelSample] {
+        guard let ctx = context else { return [] }
+        var raw = [ViDeskChannelSample](repeating: ViDeskChannelSample(), count: Int(VIDESK_CHANNEL_HISTORY_LENGTH))
+        let kind = channel.isDynamic ? VIDESK_CHANNEL_DYNAMIC : VIDESK_CHANNEL_STATIC
+        let count = Int(viDesk_getChannelHistory(ctx, channel.name, kind, &raw, UInt32(raw.count)))
+
+        return raw.prefix(count).map { sample in
+            ChannelSample(timestamp: TimeInterval(sample.timestampMs) / 1000,
+                          bytesIn: sample.bytesIn,
+                          bytesOut: sample.bytesOut,
+                          messagesIn: Int(sample.messagesIn),
+                          messagesOut: Int(sample.messagesOut))
+        }
+    }
+
+    /// 事件处理线程在本会话上消耗的 CPU 时间
+    var processingCPUTime: TimeInterval {
+        guard let ctx = context else { return 0 }
+        return TimeInterval(viDesk_getProcessingCpuTime(ctx)) / 1_000_000_000
+    }
+
+    /// 出站发送统计
+    struct SendStatistics {
+        /// 正在排队分片发送的字节数
+        var bulkBytesQueued: UInt64 = 0
+        var bulkBytesSent: UInt64 = 0
+        var inputEvents: Int = 0
+        var averageInputSend: TimeInterval = 0
+        var maxInputSend: TimeInterval = 0
+        /// 大消息排队期间的输入发送耗时
+        var inputEventsDuringBulk: Int = 0
+        var averageInputSendDuringBulk: TimeInterval = 0
+        var maxInputSendDuringBulk: TimeInterval = 0
+    }
+
+    /// 获取出站发送统计
+    func sendStatistics() -> SendStatistics {
+        var stats = SendStatistics()
+        guard let ctx = context else { return stats }
+        var raw = ViDeskSendStats()
+        viDesk_getSendStats(ctx, &raw)
+
+        stats.bulkBytesQueued = raw.bulkBytesQueued
+        stats.bulkBytesSent = raw.bulkBytesSent
+        stats.inputEvents = Int(raw.inputEvents)
+        stats.maxInputSend = TimeInterval(raw.inputSendMaxNs) / 1_000_000_000
+        if raw.inputEvents > 0 {
+            stats.averageInputSend = TimeInterval(raw.inputSendTotalNs) / Double(raw.inputEvents) / 1_000_000_000
+        }
+        stats.inputEventsDuringBulk = Int(raw.inputEventsDuringBulk)
+        stats.maxInputSendDuringBulk = TimeInterval(raw.inputSendDuringBulkMaxNs) / 1_000_000_000
+        if raw.inputEventsDuringBulk > 0 {
+            stats.averageInputSendDuringBulk = TimeInterval(raw.inputSendDuringBulkTotalNs)
+                / Double(raw.inputEventsDuringBulk) / 1_000_000_000
+        }
+        return stats
+    }
+
+    /// 重置出站发送统计
+    func resetSendStatistics() {
+        guard let ctx = context else { return }
+        viDesk_resetSendStats(ctx)
+    }
+
+    /// 传输层统计
+    struct TransportStatistics {
+        /// 是否使用池化传输层 (false 为 FreeRDP 默认实现)
+        var pooled: Bool = false
+        var duration: TimeInterval = 0
+        var recvCalls: UInt64 = 0
+        var sendCalls: UInt64 = 0
+        var waitCalls: UInt64 = 0
+        var layerReads: UInt64 = 0
+        var bytesRead: UInt64 = 0
+        var pdus: UInt64 = 0
+        var allocations: UInt64 = 0
+        /// 使用了预热的 TCP 连接时省下的时间 (0 表示未使用)
+        var prewarmSaved: TimeInterval = 0
+        /// 地址竞速胜出的地址 (使用预热或默认实现时为空)
+        var remoteAddress: String = ""
+        var addressCandidates: UInt32 = 0
+        var addressAttempts: UInt32 = 0
+        /// 比逐个尝试地址至少省下的时间
+        var raceSaved: TimeInterval = 0
+
+        /// 每秒系统调用数 (recv + send + poll)
+        var syscallsPerSecond: Double {
+            duration > 0 ? Double(recvCalls + sendCalls + waitCalls) / duration : 0
+        }
+
+        /// 平均每次 recv 取回的 PDU 数
+        var pdusPerRecv: Double {
+            recvCalls > 0 ? Double(pdus) / Double(recvCalls) : 0
+        }
+    }
+
+    /// 是否使用池化传输层 (下次连接生效)
+    func setPooledTransport(_ enabled: Bool) {
+        guard let ctx = context else { return }
+        viDesk_setPooledTransport(ctx, enabled)
+    }
+
+    /// WAN 模拟参数 (延迟为单向，两个方向相同)
+    struct WanProfile: Equatable {
+        var latencyMs: UInt32 = 0
+        /// 延迟在 ±jitterMs 内均匀分布
+        var jitterMs: UInt32 = 0
+        /// 带宽 (0 表示不限)
+        var downlinkKbps: UInt32 = 0
+        var uplinkKbps: UInt32 = 0
+        /// 断流的平均间隔 (0 表示不断流) 和每次的时长
+        var stallIntervalMs: UInt32 = 0
+        var stallMs: UInt32 = 0
+        /// 抖动和断流的随机种子，相同种子的测试条件相同
+        var seed: UInt32 = 1
+
+        fileprivate init(_ raw: ViDeskWanProfile) {
+            latencyMs = raw.latencyMs
+            jitterMs = raw.jitterMs
+            downlinkKbps = raw.downlinkKbps
+            uplinkKbps = raw.uplinkKbps
+            stallIntervalMs = raw.stallIntervalMs
+            stallMs = raw.stallMs
+            seed = raw.seed
+        }
+
+        init() {}
+
+        fileprivate var raw: ViDeskWanProfile {
+            ViDeskWanProfile(latencyMs: latencyMs, jitterMs: jitterMs, downlinkKbps: downlinkKbps,
+                             uplinkKbps: uplinkKbps, stallIntervalMs: stallIntervalMs, stallMs: stallMs, seed: seed)
+        }
+    }
+
+    /// 预设的网络条件，用于可复现的编解码、帧确认和输入性能对比
+    enum WanPreset: Int, CaseIterable, Identifiable {
+        case none = 0
+        case lte = 1
+        case hotelWiFi = 2
+        case transatlantic = 3
+
+        var id: Int { rawValue }
+
+        var displayName: String {
+            switch self {
+            case .none: return "不模拟"
+            case .lte: return "LTE"
+            case .hotelWiFi: return "酒店 Wi-Fi"
+            case .transatlantic: return "跨大西洋"
+            }
+        }
+
+        /// 预设的参数 (.none 为 nil)
+        var profile: WanProfile? {
+            var raw = ViDeskWanProfile()
+            guard viDesk_getWanPreset(ViDeskWanPreset(rawValue: UInt32(rawValue)), &raw) else { return nil }
+            return WanProfile(raw)
+        }
+    }
+
+    /// WAN 模拟统计 (本次连接)
+    struct WanEmulationStatistics {
+        var isEnabled: Bool = false
+        /// 转发线程仍在运行
+        var isRunning: Bool = false
+        var profile = WanProfile()
+        var bytesDown: UInt64 = 0
+        var bytesUp: UInt64 = 0
+        var chunksDown: UInt64 = 0
+        var chunksUp: UInt64 = 0
+        /// 数据块从读入到交付的平均时间 (含排队)
+        var averageDelayDown: TimeInterval = 0
+        var averageDelayUp: TimeInterval = 0
+        var peakQueuedDown: UInt64 = 0
+        var peakQueuedUp: UInt64 = 0
+        var stalls: UInt32 = 0
+        var stalledTime: TimeInterval = 0
+    }
+
+    /// 设置 WAN 模拟 (下次连接生效，nil 为关闭；只作用于池化传输层)
+    func setWanEmulation(_ profile: WanProfile?) {
+        guard let ctx = context else { return }
+        if var raw = profile?.raw {
+            viDesk_setWanEmulation(ctx, &raw)
+        } else {
+            viDesk_setWanEmulation(ctx, nil)
+        }
+    }
+
+    /// 获取 WAN 模拟统计
+    func wanEmulationStatistics() -> WanEmulationStatistics {
+        var stats = WanEmulationStatistics()
+        guard let ctx = context else { return stats }
+        var raw = ViDeskWanEmulationStats()
+        viDesk_getWanEmulationStats(ctx, &raw)
+
+        stats.isEnabled = raw.enabled
+        stats.isRunning = raw.running
+        stats.profile = WanProfile(raw.profile)
+        stats.bytesDown = raw.bytesDown
+        stats.bytesUp = raw.bytesUp
+        stats.chunksDown = raw.chunksDown
+        stats.chunksUp = raw.chunksUp
+        if raw.chunksDown > 0 {
+            stats.averageDelayDown = TimeInterval(raw.totalDelayDownNs) / TimeInterval(raw.chunksDown) / 1_000_000_000
+        }
+        if raw.chunksUp > 0 {
+            stats.averageDelayUp = TimeInterval(raw.totalDelayUpNs) / TimeInterval(raw.chunksUp) / 1_000_000_000
+        }
+        stats.peakQueuedDown = raw.peakQueuedDown
+        stats.peakQueuedUp = raw.peakQueuedUp
+        stats.stalls = raw.stalls
+        stats.stalledTime = TimeInterval(raw.stalledNs) / 1_000_000_000
+        return stats
+    }
+
+    /// 获取传输层统计
+    func transportStatistics() -> TransportStatistics {
+        var stats = TransportStatistics()
+        guard let ctx = context else { return stats }
+        var raw = ViDeskTransportStats()
+        viDesk_getTransportStats(ctx, &raw)
+
+        stats.pooled = raw.pooled
+        stats.duration = TimeInterval(raw.elapsedNs) / 1_000_000_000
+        stats.recvCalls = raw.recvCalls
+        stats.sendCalls = raw.sendCalls
+        stats.waitCalls = raw.waitCalls
+        stats.layerReads = raw.layerReads
+        stats.bytesRead = raw.bytesRead
+        stats.pdus = raw.pdus
+        stats.allocations = raw.allocations
+        stats.prewarmSaved = TimeInterval(raw.prewarmSavedNs) / 1_000_000_000
+        var copy = raw
+        stats.remoteAddress = withUnsafeBytes(of: &copy.remoteAddress) { buffer in
+            String(cString: buffer.bindMemory(to: CChar.self).baseAddress!)
+        }
+        stats.addressCandidates = raw.addressCandidates
+        stats.addressAttempts = raw.addressAttempts
+        stats.raceSaved = TimeInterval(raw.raceSavedNs) / 1_000_000_000
+        return stats
+    }
+
+    /// 重置传输层统计
+    func resetTransportStatistics() {
+        guard let ctx = context else { return }
+        viDesk_resetTransportStats(ctx)
+    }
+
+    /// 触控统计
+    struct TouchStatistics {
+        var frames: Int = 0
+        var contacts: Int = 0
+        /// 触控帧到其后第一次帧更新的延迟
+        var latencySamples: Int = 0
+        var averageLatency: TimeInterval = 0
+        var maxLatency: TimeInterval = 0
+        var lastLatency: TimeInterval = 0
+    }
+
+    /// 获取触控统计
+    func touchStatistics() -> TouchStatistics {
+        var stats = TouchStatistics()
+        guard let ctx = context else { return stats }
+        var raw = ViDeskTouchStats()
+        viDesk_getTouchStats(ctx, &raw)
+
+        stats.frames = Int(raw.frames)
+        stats.contacts = Int(raw.contacts)
+        stats.latencySamples = Int(raw.latencySamples)
+        stats.maxLatency = TimeInterval(raw.latencyMaxNs) / 1_000_000_000
+        stats.lastLatency = TimeInterval(raw.lastLatencyNs) / 1_000_000_000
+        if raw.latencySamples > 0 {
+            stats.averageLatency = TimeInterval(raw.latencyTotalNs) / Double(raw.latencySamples) / 1_000_000_000
+        }
+        return stats
+    }
+
+    /// 重置触控统计
+    func resetTouchStatistics() {
+        guard let ctx = context else { return }
+        viDesk_resetTouchStats(ctx)
+    }
+
+    /// 输入到上屏延迟统计
+    struct LatencyStatistics {
+        var samples: Int = 0
+        var totalSamples: UInt64 = 0
+        /// 输入到呈现
+        var p50: TimeInterval = 0
+        var p95: TimeInterval = 0
+        var p99: TimeInterval = 0
+        var max: TimeInterval = 0
+        /// 输入到帧更新 (不含本地渲染)
+        var frameP50: TimeInterval = 0
+        var frameP95: TimeInterval = 0
+        var expiredInputs: UInt64 = 0
+    }
+
+    /// 回报帧已呈现
+    /// - Parameters:
+    ///   - sequence: 已呈现画面包含的最新帧序号
+    ///   - age: 呈现时刻距现在的时长
+    func recordFramePresented(sequence: UInt64, age: TimeInterval) {
+        guard let ctx = context else { return }
+        viDesk_recordFramePresented(ctx, sequence, UInt64(max(0, age) * 1_000_000_000))
+    }
+
+    /// 获取输入到上屏延迟统计
+    func latencyStatistics() -> LatencyStatistics {
+        var stats = LatencyStatistics()
+        guard let ctx = context else { return stats }
+        var raw = ViDeskLatencyStats()
+        viDesk_getLatencyStats(ctx, &raw)
+
+        stats.samples = Int(raw.samples)
+        stats.totalSamples = raw.totalSamples
+        stats.p50 = TimeInterval(raw.p50Ns) / 1_000_000_000
+        stats.p95 = TimeInterval(raw.p95Ns) / 1_000_000_000
+        stats.p99 = TimeInterval(raw.p99Ns) / 1_000_000_000
+        stats.max = TimeInterval(raw.maxNs) / 1_000_000_000
+        stats.frameP50 = TimeInterval(raw.frameP50Ns) / 1_000_000_000
+        stats.frameP95 = TimeInterval(raw.frameP95Ns) / 1_000_000_000
+        stats.expiredInputs = raw.expiredInputs
+        return stats
+    }
+
+    /// 重置输入到上屏延迟统计
+    func resetLatencyStatistics() {
+        guard let ctx = context else { return }
+        viDesk_resetLatencyStats(ctx)
+    }
+
+    /// 自适应画质状态
+    struct QualityState {
+        var enabled: Bool = true
+        /// 0 局域网 / 1 宽带 / 2 受限 / 3 较差
+        var level: Int = 0
+        /// 允许渲染器落后的帧数 (0 表示不限)
+        var frameAckDepth: Int = 0
+        var resolutionPercent: Int = 100
+        var prefersFullChroma: Bool = true
+        var reducesVisualEffects: Bool = false
+        /// 平滑后的测量值 (未知为 0)
+        var bandwidthKbps: Int = 0
+        var rtt: TimeInterval = 0
+        var decisions: Int = 0
+        var resolutionRequests: Int = 0
+        var throttledTime: TimeInterval = 0
+    }
+
+    /// 画质调整记录
+    struct QualityDecision {
+        /// 单调时钟时间
+        var timestamp: TimeInterval
+        var fromLevel: Int
+        var toLevel: Int
+        var bandwidthKbps: Int
+        var rtt: TimeInterval
+        var reason: String
+    }
+
+    /// 启用/停用自适应画质
+    func setAdaptiveQuality(_ enabled: Bool) {
+        guard let ctx = context else { return }
+        viDesk_setAdaptiveQuality(ctx, enabled)
+    }
+
+    /// 获取自适应画质状态
+    func qualityState() -> QualityState {
+        var state = QualityState()
+        guard let ctx = context else { return state }
+        var raw = ViDeskQualityState()
+        viDesk_getQualityState(ctx, &raw)
+
+        state.enabled = raw.enabled
+        state.level = Int(raw.profile.level.rawValue)
+        state.frameAckDepth = Int(raw.profile.frameAckDepth)
+        state.resolutionPercent = Int(raw.profile.resolutionPercent)
+        state.prefersFullChroma = raw.profile.codec == VIDESK_QUALITY_CODEC_AVC444
+        state.reducesVisualEffects = raw.profile.reduceVisualEffects
+        state.bandwidthKbps = Int(raw.bandwidthKbps)
+        state.rtt = TimeInterval(raw.rttMs) / 1000
+        state.decisions = Int(raw.decisions)
+        state.resolutionRequests = Int(raw.resolutionRequests)
+        state.throttledTime = TimeInterval(raw.throttledNs) / 1_000_000_000
+        return state
+    }
+
+    /// 获取最近的画质调整记录 (最旧的在前)
+    func qualityDecisions() -> [QualityDecision] {
+        guard let ctx = context else { return [] }
+        var raw = [ViDeskQualityDecision](repeating: ViDeskQualityDecision(), count: 32)
+        let count = Int(viDesk_getQualityDecisions(ctx, &raw, UInt32(raw.count)))
+
+        return raw.prefix(count).map { decision in
+            var copy = decision
+            let reason = withUnsafeBytes(of: &copy.reason) { buffer in
+                String(cString: buffer.bindMemory(to: CChar.self).baseAddress!)
+            }
+            return QualityDecision(timestamp: TimeInterval(decision.timestampMs) / 1000,
+                                   fromLevel: Int(decision.from.rawValue),
+                                   toLevel: Int(decision.to.rawValue),
+                                   bandwidthKbps: Int(decision.bandwidthKbps),
+                                   rtt: TimeInterval(decision.rttMs) / 1000,
+                                   reason: reason)
+        }
+    }
+
+    /// 光标缓存统计
+    struct PointerCacheStatistics {
+        /// 服务器下发光标次数及其中内容已转换过的次数
+        var shapeUpdates: Int = 0
+        var contentHits: Int = 0
+        var conversions: Int = 0
+        var averageConversion: TimeInterval = 0
+        /// 按缓存槽切换光标的次数及其中槽为空的次数
+        var cachedSelects: Int = 0
+        var cachedMisses: Int = 0
+        /// 进程内共享的已转换光标
+        var sharedEntries: Int = 0
+        var sharedBytes: UInt64 = 0
+
+        /// 命中率 (0...1)，没有光标切换时为 0
+        var hitRate: Double {
+            let lookups = shapeUpdates + cachedSelects
+            guard lookups > 0 else { return 0 }
+            return Double(contentHits + cachedSelects - cachedMisses) / Double(lookups)
+        }
+    }
+
+    /// 获取光标缓存统计
+    func pointerCacheStatistics() -> PointerCacheStatistics {
+        var stats = PointerCacheStatistics()
+        guard let ctx = context else { return stats }
+        var raw = ViDeskPointerCacheStats()
+        viDesk_getPointerCacheStats(ctx, &raw)
+
+        stats.shapeUpdates = Int(raw.shapeUpdates)
+        stats.contentHits = Int(raw.contentHits)
+        stats.conversions = Int(raw.conversions)
+        if raw.conversions > 0 {
+            stats.averageConversion = TimeInterval(raw.conversionTotalNs) / Double(raw.conversions) / 1_000_000_000
+        }
+        stats.cachedSelects = Int(raw.cachedSelects)
+        stats.cachedMisses = Int(raw.cachedMisses)
+        stats.sharedEntries = Int(raw.sharedEntries)
+        stats.sharedBytes = raw.sharedBytes
+        return stats
+    }
+
+    /// 重置光标缓存统计
+    func resetPointerCacheStatistics() {
+        guard let ctx = context else { return }
+        viDesk_resetPointerCacheStats(ctx)
+    }
+
+    // MARK: - 输入录制与回放
+
+    /// 输入录制/回放统计
+    struct InputReplayStatistics {
+        var events: Int = 0
+        var duration: TimeInterval = 0
+        var bytes: UInt64 = 0
+        /// 回放时发送失败的事件 (如服务器未打开对应通道)
+        var failedEvents: Int = 0
+        /// 回放时实际发送时刻落后于原始时刻的程度
+        var maxLag: TimeInterval = 0
+        var averageLag: TimeInterval = 0
+
+        fileprivate init() {}
+
+        fileprivate init(_ raw: ViDeskInputReplayStats) {
+            events = Int(raw.events)
+            duration = TimeInterval(raw.durationNs) / 1_000_000_000
+            bytes = raw.bytes
+            failedEvents = Int(raw.failedEvents)
+            maxLag = TimeInterval(raw.maxLagNs) / 1_000_000_000
+            averageLag = raw.events > 0 ? TimeInterval(raw.totalLagNs) / TimeInterval(raw.events) / 1_000_000_000 : 0
+        }
+    }
+
+    /// 开始把输入调用录制到文件 (覆盖已有文件)
+    func startInputRecording(to url: URL) -> Bool {
+        guard let ctx = context else { return false }
+        return url.path.withCString { viDesk_startInputRecording(ctx, $0) }
+    }
+
+    /// 结束录制，未在录制时返回 nil
+    func stopInputRecording() -> InputReplayStatistics? {
         guard let ctx = context else { return nil }
-        guard let cString = viDesk_getLastError(ctx) else { return nil }
-        return String(cString: cString)
+        var raw = ViDeskInputReplayStats()
+        guard viDesk_stopInputRecording(ctx, &raw) else { return nil }
+        return InputReplayStatistics(raw)
+    }
+
+    /// 按原始时间间隔回放录制文件，回放在后台线程进行
+    /// - Returns: 是否完整回放，以及已回放部分的统计
+    func replayInput(from url: URL) async -> (completed: Bool, statistics: InputReplayStatistics) {
+        guard let ctx = context else { return (false, InputReplayStatistics()) }
+        let path = url.path
+        return await withCheckedContinuation { continuation in
+            DispatchQueue.global(qos: .userInitiated).async {
+                var raw = ViDeskInputReplayStats()
+                let completed = path.withCString { viDesk_replayInputRecording(ctx, $0, &raw) }
+                continuation.resume(returning: (completed, InputReplayStatistics(raw)))
+            }
+        }
+    }
+
+    /// 取消正在进行的回放
+    func cancelInputReplay() {
+        guard let ctx = context else { return }
+        viDesk_cancelInputReplay(ctx)
+    }
+
+    /// 无界面模式：帧更新即视为已呈现 (没有渲染器时延迟统计为输入到帧更新)
+    func setHeadlessPresentation(_ enabled: Bool) {
+        guard let ctx = context else { return }
+        viDesk_setHeadlessPresentation(ctx, enabled)
+    }
+
+    // MARK: - 会话录制与回放
+
+    /// 会话录制/回放模式
+    enum SessionDumpMode {
+        case off
+        /// 连接时把收发的 PDU 写入文件
+        case capture
+        /// 不连接服务器，尽快回放文件中的 PDU (解码吞吐量基准)
+        case replay
+
+        fileprivate var rawValue: ViDeskSessionDumpMode {
+            switch self {
+            case .off: return VIDESK_SESSION_DUMP_OFF
+            case .capture: return VIDESK_SESSION_DUMP_CAPTURE
+            case .replay: return VIDESK_SESSION_DUMP_REPLAY
+            }
+        }
+    }
+
+    /// 会话录制文件概况
+    struct SessionDumpInfo {
+        var records: Int = 0
+        var serverRecords: Int = 0
+        var serverBytes: UInt64 = 0
+        var clientRecords: Int = 0
+        var clientBytes: UInt64 = 0
+        /// 压缩过的快速路径更新数
+        var compressedUpdates: Int = 0
+        /// 录制时服务器实际使用的压缩级别
+        var compressionLevel: CompressionLevel = .none
+    }
+
+    /// 会话回放解码基准
+    struct SessionReplayStatistics {
+        var isRunning: Bool = false
+        var finished: Bool = false
+        var elapsed: TimeInterval = 0
+        /// 开始回放到连接完成 / 第一次帧更新
+        var connectTime: TimeInterval = 0
+        var firstFrameTime: TimeInterval = 0
+        var frames: UInt64 = 0
+        var paints: UInt64 = 0
+        var decodedBytes: UInt64 = 0
+        var bytesReplayed: UInt64 = 0
+        /// 压缩过的 PDU 在线路上的字节 / 解压后的字节
+        var compressedBytes: UInt64 = 0
+        var uncompressedBytes: UInt64 = 0
+
+        var framesPerSecond: Double {
+            elapsed > 0 ? Double(frames) / elapsed : 0
+        }
+
+        /// 解码吞吐量 (MB/s)
+        var decodedMegabytesPerSecond: Double {
+            elapsed > 0 ? Double(decodedBytes) / 1_000_000 / elapsed : 0
+        }
+
+        /// 压缩率 (解压后 / 线路上)
+        var compressionRatio: Double {
+            compressedBytes > 0 ? Double(uncompressedBytes) / Double(compressedBytes) : 0
+        }
+
+        /// 解码流水线吞吐量 (MB/s)：解压后的字节 / 整个回放 (解压、解码和 GDI) 的时间
+        var pipelineMegabytesPerSecond: Double {
+            elapsed > 0 ? Double(uncompressedBytes) / 1_000_000 / elapsed : 0
+        }
+    }
+
+    /// 设置会话录制/回放 (连接之前调用)，回放时返回录制文件概况
+    /// - Returns: 失败 (文件无法打开、回放文件为空或损坏) 时返回 nil
+    func setSessionDump(_ mode: SessionDumpMode, url: URL?) -> SessionDumpInfo? {
+        guard let ctx = context else { return nil }
+        var raw = ViDeskSessionDumpInfo()
+        let ok: Bool
+        if let url = url {
+            ok = url.path.withCString { viDesk_setSessionDump(ctx, mode.rawValue, $0, &raw) }
+        } else {
+            ok = viDesk_setSessionDump(ctx, mode.rawValue, nil, &raw)
+        }
+        guard ok else { return nil }
+
+        return SessionDumpInfo(records: Int(raw.records),
+                               serverRecords: Int(raw.serverRecords),
+                               serverBytes: raw.serverBytes,
+                               clientRecords: Int(raw.clientRecords),
+                               clientBytes: raw.clientBytes,
+                               compressedUpdates: Int(raw.compressedUpdates),
+                               compressionLevel: CompressionLevel(raw.compressionLevel))
+    }
+
+    /// 获取回放基准结果 (回放进行中也可调用)
+    func sessionReplayStatistics() -> SessionReplayStatistics {
+        var stats = SessionReplayStatistics()
+        guard let ctx = context else { return stats }
+        var raw = ViDeskSessionReplayStats()
+        viDesk_getSessionReplayStats(ctx, &raw)
+
+        stats.isRunning = raw.running
+        stats.finished = raw.finished
+        stats.elapsed = TimeInterval(raw.elapsedNs) / 1_000_000_000
+        stats.connectTime = TimeInterval(raw.connectNs) / 1_000_000_000
+        stats.firstFrameTime = TimeInterval(raw.firstFrameNs) / 1_000_000_000
+        stats.frames = raw.frames
+        stats.paints = raw.paints
+        stats.decodedBytes = raw.decodedBytes
+        stats.bytesReplayed = raw.bytesReplayed
+        stats.compressedBytes = raw.compressedBytes
+        stats.uncompressedBytes = raw.uncompressedBytes
+        return stats
+    }
+
+    /// 快速重连统计
+    struct ReconnectStatistics {
+        /// 已掉线，尚未在重连后收到第一帧
+        var isPending: Bool = false
+        /// 掉线时已持有服务器下发的自动重连 cookie
+        var hasCookie: Bool = false
+        var drops: UInt32 = 0
+        var attempts: UInt32 = 0
+        var reconnects: UInt32 = 0
+        var lastAttemptTime: TimeInterval = 0
+        var lastDropToConnect: TimeInterval = 0
+        var lastDropToFirstFrame: TimeInterval = 0
+        var totalDropToFirstFrame: TimeInterval = 0
+    }
+
+    /// 获取快速重连统计
+    func reconnectStatistics() -> ReconnectStatistics {
+        var stats = ReconnectStatistics()
+        guard let ctx = context else { return stats }
+        var raw = ViDeskReconnectStats()
+        viDesk_getReconnectStats(ctx, &raw)
+
+        stats.isPending = raw.pending
+        stats.hasCookie = raw.hasCookie
+        stats.drops = raw.drops
+        stats.attempts = raw.attempts
+        stats.reconnects = raw.reconnects
+        stats.lastAttemptTime = TimeInterval(raw.lastAttemptNs) / 1_000_000_000
+        stats.lastDropToConnect = TimeInterval(raw.lastDropToConnectNs) / 1_000_000_000
+        stats.lastDropToFirstFrame = TimeInterval(raw.lastDropToFirstFrameNs) / 1_000_000_000
+        stats.totalDropToFirstFrame = TimeInterval(raw.totalDropToFirstFrameNs) / 1_000_000_000
+        return stats
+    }
+
+    /// 连接存活检测统计
+    struct LivenessStatistics {
+        /// 服务器在发送心跳 PDU (否则使用后备阈值并主动探测)
+        var heartbeatActive: Bool = false
+        var heartbeatPeriod: TimeInterval = 0
+        var missedToWarn: Int = 0
+        var missedToReconnect: Int = 0
+        /// 已超过告警阈值仍未收到数据
+        var isSuspect: Bool = false
+        var heartbeats: UInt32 = 0
+        var suspects: UInt32 = 0
+        var deadDetections: UInt32 = 0
+        /// 未发心跳时因静默发出的探测
+        var probes: UInt32 = 0
+        /// 距上次收到数据的时间
+        var silence: TimeInterval = 0
+        /// 判定断开的阈值
+        var timeout: TimeInterval = 0
+        var lastDetectionSilence: TimeInterval = 0
+    }
+
+    /// 获取连接存活检测统计
+    func livenessStatistics() -> LivenessStatistics {
+        var stats = LivenessStatistics()
+        guard let ctx = context else { return stats }
+        var raw = ViDeskLivenessStats()
+        viDesk_getLivenessStats(ctx, &raw)
+
+        stats.heartbeatActive = raw.heartbeatActive
+        stats.heartbeatPeriod = TimeInterval(raw.heartbeatPeriod)
+        stats.missedToWarn = Int(raw.missedToWarn)
+        stats.missedToReconnect = Int(raw.missedToReconnect)
+        stats.isSuspect = raw.suspect
+        stats.heartbeats = raw.heartbeats
+        stats.suspects = raw.suspects
+        stats.deadDetections = raw.deadDetections
+        stats.probes = raw.probes
+        stats.silence = TimeInterval(raw.silenceNs) / 1_000_000_000
+        stats.timeout = TimeInterval(raw.timeoutNs) / 1_000_000_000
+        stats.lastDetectionSilence = TimeInterval(raw.lastDetectionSilenceNs) / 1_000_000_000
+        return stats
+    }
+
+    /// 最近一次采样的内存占用 (GDI 主缓冲区, GFX 表面和缓存)
+    var memoryUsage: (frameBuffer: UInt64, gfxCache: UInt64) {
+        guard let ctx = context else { return (0, 0) }
+        var frameBytes: UInt64 = 0
+        var gfxBytes: UInt64 = 0
+        viDesk_getMemoryUsage(ctx, &frameBytes, &gfxBytes)
+        return (frameBytes, gfxBytes)
     }
 
     // MARK: - 私有方法
@@ -303,12 +1348,12 @@ final class FreeRDPContext: @unchecked Sendable {
         // 保持对 self 的引用
         callbackContext = Unmanaged.passRetained(self).toOpaque()
 
-        callbacks.onFrameUpdate = { (context, x, y, width, height) in
+        callbacks.onFrameUpdate = { (context, x, y, width, height, sequence) in
             guard let context = context else { return }
             let wrapper = Unmanaged<FreeRDPContext>.fromOpaque(context).takeUnretainedValue()
             let rect = CGRect(x: CGFloat(x), y: CGFloat(y), width: CGFloat(width), height: CGFloat(height))
             Task { @MainActor in
-                wrapper.onFrameUpdate?(rect)
+                wrapper.onFrameUpdate?(rect, sequence)
             }
         }
 
@@ -358,6 +1403,38 @@ final class FreeRDPContext: @unchecked Sendable {
             }
         }
 
+        callbacks.onPointerPosition = { (context, x, y) in
+            guard let context = context else { return }
+            let wrapper = Unmanaged<FreeRDPContext>.fromOpaque(context).takeUnretainedValue()
+            let point = CGPoint(x: CGFloat(x), y: CGFloat(y))
+            Task { @MainActor in
+                wrapper.onPointerPosition?(point)
+            }
+        }
+
+        callbacks.onPointerShape = { (context, kind, pixels, width, height, hotspotX, hotspotY) in
+            guard let context = context else { return }
+            let wrapper = Unmanaged<FreeRDPContext>.fromOpaque(context).takeUnretainedValue()
+
+            // 像素只在回调期间有效，切换线程前先复制
+            let shape: PointerShape
+            switch Int(kind) {
+            case Int(VIDESK_POINTER_IMAGE.rawValue):
+                guard let pixels = pixels, width > 0, height > 0 else { return }
+                let bytes = Array(UnsafeBufferPointer(start: pixels, count: Int(width) * Int(height) * 4))
+                shape = .image(pixels: bytes, width: Int(width), height: Int(height),
+                               hotspot: CGPoint(x: CGFloat(hotspotX), y: CGFloat(hotspotY)))
+            case Int(VIDESK_POINTER_HIDDEN.rawValue):
+                shape = .hidden
+            default:
+                shape = .systemDefault
+            }
+
+            Task { @MainActor in
+                wrapper.onPointerShape?(shape)
+            }
+        }
+
         viDesk_setCallbacks(ctx, callbacks, callbackContext)
     }
 }
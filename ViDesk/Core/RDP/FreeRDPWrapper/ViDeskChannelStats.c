@@ -0,0 +1,314 @@
+/**
+ * ViDeskChannelStats.c - 虚拟通道统计
+ */
+
+#include "ViDeskChannelStats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define VIDESK_CHANNEL_SAMPLE_INTERVAL_NS 1000000000ULL
+
+// 同时打开的动态通道数上限
+#define VIDESK_CHANNEL_OPEN_LIMIT 64
+
+// MS-RDPEDYC 2.2 的命令 (PDU 头的高 4 位)
+#define VIDESK_DVC_CMD_CREATE                   0x01
+#define VIDESK_DVC_CMD_DATA_FIRST               0x02
+#define VIDESK_DVC_CMD_DATA                     0x03
+#define VIDESK_DVC_CMD_CLOSE                    0x04
+#define VIDESK_DVC_CMD_DATA_FIRST_COMPRESSED    0x06
+#define VIDESK_DVC_CMD_DATA_COMPRESSED          0x07
+
+typedef struct {
+    ViDeskChannelStats stats;
+
+    // 以下由事件处理线程在采样时使用：上一个样本时的累计值
+    uint64_t lastBytesIn;
+    uint64_t lastBytesOut;
+    uint64_t lastMessagesIn;
+    uint64_t lastMessagesOut;
+
+    ViDeskChannelSample samples[VIDESK_CHANNEL_HISTORY_LENGTH];
+    uint32_t sampleCount;
+    uint32_t sampleNext;
+} ViDeskChannelEntry;
+
+// 已打开的动态通道：服务器分配的编号到统计项
+typedef struct {
+    uint32_t channelId;
+    ViDeskChannelEntry* entry;
+    uint64_t remaining[2];          // 分片消息 (DATA_FIRST 之后的 DATA) 尚未到齐的字节，[0] 入站 [1] 出站
+} ViDeskOpenChannel;
+
+struct ViDeskChannelStatsTracker {
+    pthread_mutex_t lock;
+    ViDeskChannelEntry entries[VIDESK_CHANNEL_STATS_LIMIT];
+    uint32_t entryCount;
+    ViDeskOpenChannel open[VIDESK_CHANNEL_OPEN_LIMIT];
+    uint32_t openCount;
+    uint64_t lastSampleNs;
+};
+
+// 按名称和类型查找统计项，不存在时创建 (调用方持有 lock)；超过上限时返回 NULL
+static ViDeskChannelEntry* viDesk_channelEntry(ViDeskChannelStatsTracker* tracker, const char* name,
+                                               size_t nameLength, ViDeskChannelKind kind) {
+    if (nameLength >= VIDESK_CHANNEL_NAME_LENGTH)
+        nameLength = VIDESK_CHANNEL_NAME_LENGTH - 1;
+
+    for (uint32_t i = 0; i < tracker->entryCount; i++) {
+        ViDeskChannelEntry* entry = &tracker->entries[i];
+        if (entry->stats.kind == kind && strncmp(entry->stats.name, name, nameLength) == 0 &&
+            entry->stats.name[nameLength] == '\0')
+            return entry;
+    }
+
+    if (tracker->entryCount >= VIDESK_CHANNEL_STATS_LIMIT)
+        return NULL;
+
+    ViDeskChannelEntry* entry = &tracker->entries[tracker->entryCount++];
+    memset(entry, 0, sizeof(*entry));
+    memcpy(entry->stats.name, name, nameLength);
+    entry->stats.kind = kind;
+    entry->stats.open = kind == VIDESK_CHANNEL_STATIC;
+    return entry;
+}
+
+static ViDeskOpenChannel* viDesk_channelFindOpen(ViDeskChannelStatsTracker* tracker, uint32_t channelId) {
+    for (uint32_t i = 0; i < tracker->openCount; i++) {
+        if (tracker->open[i].channelId == channelId)
+            return &tracker->open[i];
+    }
+    return NULL;
+}
+
+static void viDesk_channelRemoveOpen(ViDeskChannelStatsTracker* tracker, ViDeskOpenChannel* open) {
+    if (open->entry)
+        open->entry->stats.open = false;
+    *open = tracker->open[--tracker->openCount];
+}
+
+static inline void viDesk_channelCount(ViDeskChannelEntry* entry, bool inbound, uint64_t bytes, bool message) {
+    if (inbound) {
+        entry->stats.bytesIn += bytes;
+        if (message)
+            entry->stats.messagesIn++;
+    } else {
+        entry->stats.bytesOut += bytes;
+        if (message)
+            entry->stats.messagesOut++;
+    }
+}
+
+// 小端整数，width 为 1/2/4 字节
+static uint32_t viDesk_dvcReadUint(const uint8_t* data, size_t width) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < width; i++)
+        value |= (uint32_t)data[i] << (8 * i);
+    return value;
+}
+
+// cbChId / Sp / Len 字段的编码：0、1、2 分别为 1、2、4 字节
+static size_t viDesk_dvcFieldWidth(uint8_t code) {
+    return code == 0 ? 1 : code == 1 ? 2 : 4;
+}
+
+// 解析 drdynvc 上一个完整 PDU 的头 (data 为第一个分片，totalSize 为整个 PDU)，把负载归到对应的动态通道
+static void viDesk_channelRecordDvc(ViDeskChannelStatsTracker* tracker, bool inbound, const uint8_t* data,
+                                    size_t size, size_t totalSize) {
+    if (size < 1)
+        return;
+
+    uint8_t cmd = data[0] >> 4;
+    size_t idWidth = viDesk_dvcFieldWidth(data[0] & 0x03);
+    size_t lengthWidth = viDesk_dvcFieldWidth((data[0] >> 2) & 0x03);
+    if (size < 1 + idWidth)
+        return;
+    uint32_t channelId = viDesk_dvcReadUint(data + 1, idWidth);
+    size_t header = 1 + idWidth;
+    int direction = inbound ? 0 : 1;
+
+    switch (cmd) {
+        case VIDESK_DVC_CMD_CREATE: {
+            // 服务器的创建请求带通道名称，客户端的响应只有状态
+            if (!inbound)
+                return;
+            const char* name = (const char*)data + header;
+            size_t available = size - header;
+            size_t nameLength = strnlen(name, available);
+            if (nameLength == 0 || nameLength == available)
+                return;
+
+            ViDeskOpenChannel* open = viDesk_channelFindOpen(tracker, channelId);
+            if (!open) {
+                if (tracker->openCount >= VIDESK_CHANNEL_OPEN_LIMIT)
+                    return;
+                open = &tracker->open[tracker->openCount++];
+            }
+            memset(open, 0, sizeof(*open));
+            open->channelId = channelId;
+            open->entry = viDesk_channelEntry(tracker, name, nameLength, VIDESK_CHANNEL_DYNAMIC);
+            if (open->entry) {
+                open->entry->stats.open = true;
+                open->entry->stats.opens++;
+            }
+            return;
+        }
+        case VIDESK_DVC_CMD_CLOSE: {
+            ViDeskOpenChannel* open = viDesk_channelFindOpen(tracker, channelId);
+            if (open)
+                viDesk_channelRemoveOpen(tracker, open);
+            return;
+        }
+        case VIDESK_DVC_CMD_DATA_FIRST:
+        case VIDESK_DVC_CMD_DATA_FIRST_COMPRESSED: {
+            ViDeskOpenChannel* open = viDesk_channelFindOpen(tracker, channelId);
+            if (!open || !open->entry || size < header + lengthWidth || totalSize < header + lengthWidth)
+                return;
+            uint64_t length = viDesk_dvcReadUint(data + header, lengthWidth);
+            uint64_t payload = totalSize - header - lengthWidth;
+            viDesk_channelCount(open->entry, inbound, payload, true);
+            // 压缩的负载长度与解压后不同，只用来判断后续的 DATA 是否属于同一消息
+            open->remaining[direction] = length > payload ? length - payload : 0;
+            return;
+        }
+        case VIDESK_DVC_CMD_DATA:
+        case VIDESK_DVC_CMD_DATA_COMPRESSED: {
+            ViDeskOpenChannel* open = viDesk_channelFindOpen(tracker, channelId);
+            if (!open || !open->entry || totalSize < header)
+                return;
+            uint64_t payload = totalSize - header;
+            bool continuation = open->remaining[direction] > 0;
+            viDesk_channelCount(open->entry, inbound, payload, !continuation);
+            if (continuation)
+                open->remaining[direction] -= payload < open->remaining[direction] ? payload : open->remaining[direction];
+            return;
+        }
+        default:
+            // 能力协商、软同步等只计入 drdynvc
+            return;
+    }
+}
+
+ViDeskChannelStatsTracker* viDesk_channelStatsNew(void) {
+    ViDeskChannelStatsTracker* tracker = calloc(1, sizeof(ViDeskChannelStatsTracker));
+    if (!tracker)
+        return NULL;
+
+    pthread_mutex_init(&tracker->lock, NULL);
+    return tracker;
+}
+
+void viDesk_channelStatsFree(ViDeskChannelStatsTracker* tracker) {
+    if (!tracker)
+        return;
+
+    pthread_mutex_destroy(&tracker->lock);
+    free(tracker);
+}
+
+void viDesk_channelStatsReset(ViDeskChannelStatsTracker* tracker) {
+    if (!tracker)
+        return;
+
+    pthread_mutex_lock(&tracker->lock);
+    tracker->entryCount = 0;
+    tracker->openCount = 0;
+    tracker->lastSampleNs = 0;
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+void viDesk_channelStatsRecord(ViDeskChannelStatsTracker* tracker, const char* name, bool inbound,
+                               const uint8_t* data, size_t size, bool first, size_t totalSize) {
+    if (!tracker || !name)
+        return;
+
+    pthread_mutex_lock(&tracker->lock);
+    ViDeskChannelEntry* entry = viDesk_channelEntry(tracker, name, strlen(name), VIDESK_CHANNEL_STATIC);
+    if (entry)
+        viDesk_channelCount(entry, inbound, size, first);
+    if (first && data && strcmp(name, "drdynvc") == 0)
+        viDesk_channelRecordDvc(tracker, inbound, data, size, totalSize);
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+void viDesk_channelStatsTick(ViDeskChannelStatsTracker* tracker, uint64_t nowNs) {
+    if (!tracker)
+        return;
+
+    pthread_mutex_lock(&tracker->lock);
+    if (tracker->lastSampleNs == 0 || nowNs < tracker->lastSampleNs) {
+        // 第一次调用只建立基准
+        tracker->lastSampleNs = nowNs;
+        pthread_mutex_unlock(&tracker->lock);
+        return;
+    }
+
+    uint64_t elapsed = nowNs - tracker->lastSampleNs;
+    if (elapsed < VIDESK_CHANNEL_SAMPLE_INTERVAL_NS) {
+        pthread_mutex_unlock(&tracker->lock);
+        return;
+    }
+
+    // 事件循环卡顿时间隔可能超过一秒，按实际间隔折算成每秒
+    for (uint32_t i = 0; i < tracker->entryCount; i++) {
+        ViDeskChannelEntry* entry = &tracker->entries[i];
+        ViDeskChannelSample sample = { 0 };
+        sample.timestampMs = nowNs / 1000000ULL;
+        sample.bytesIn = (entry->stats.bytesIn - entry->lastBytesIn) * VIDESK_CHANNEL_SAMPLE_INTERVAL_NS / elapsed;
+        sample.bytesOut = (entry->stats.bytesOut - entry->lastBytesOut) * VIDESK_CHANNEL_SAMPLE_INTERVAL_NS / elapsed;
+        sample.messagesIn = (uint32_t)((entry->stats.messagesIn - entry->lastMessagesIn) *
+                                       VIDESK_CHANNEL_SAMPLE_INTERVAL_NS / elapsed);
+        sample.messagesOut = (uint32_t)((entry->stats.messagesOut - entry->lastMessagesOut) *
+                                        VIDESK_CHANNEL_SAMPLE_INTERVAL_NS / elapsed);
+
+        entry->lastBytesIn = entry->stats.bytesIn;
+        entry->lastBytesOut = entry->stats.bytesOut;
+        entry->lastMessagesIn = entry->stats.messagesIn;
+        entry->lastMessagesOut = entry->stats.messagesOut;
+        entry->stats.bytesInPerSecond = sample.bytesIn;
+        entry->stats.bytesOutPerSecond = sample.bytesOut;
+
+        entry->samples[entry->sampleNext] = sample;
+        entry->sampleNext = (entry->sampleNext + 1) % VIDESK_CHANNEL_HISTORY_LENGTH;
+        if (entry->sampleCount < VIDESK_CHANNEL_HISTORY_LENGTH)
+            entry->sampleCount++;
+    }
+    tracker->lastSampleNs = nowNs;
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+uint32_t viDesk_channelStatsGet(ViDeskChannelStatsTracker* tracker, ViDeskChannelStats* channels,
+                                uint32_t capacity) {
+    if (!tracker || !channels || capacity == 0)
+        return 0;
+
+    pthread_mutex_lock(&tracker->lock);
+    uint32_t count = tracker->entryCount < capacity ? tracker->entryCount : capacity;
+    for (uint32_t i = 0; i < count; i++)
+        channels[i] = tracker->entries[i].stats;
+    pthread_mutex_unlock(&tracker->lock);
+    return count;
+}
+
+uint32_t viDesk_channelStatsHistory(ViDeskChannelStatsTracker* tracker, const char* name, ViDeskChannelKind kind,
+                                    ViDeskChannelSample* samples, uint32_t capacity) {
+    if (!tracker || !name || !samples || capacity == 0)
+        return 0;
+
+    uint32_t count = 0;
+    pthread_mutex_lock(&tracker->lock);
+    for (uint32_t i = 0; i < tracker->entryCount; i++) {
+        ViDeskChannelEntry* entry = &tracker->entries[i];
+        if (entry->stats.kind != kind || strcmp(entry->stats.name, name) != 0)
+            continue;
+
+        count = entry->sampleCount < capacity ? entry->sampleCount : capacity;
+        uint32_t start = (entry->sampleNext + VIDESK_CHANNEL_HISTORY_LENGTH - count) % VIDESK_CHANNEL_HISTORY_LENGTH;
+        for (uint32_t j = 0; j < count; j++)
+            samples[j] = entry->samples[(start + j) % VIDESK_CHANNEL_HISTORY_LENGTH];
+        break;
+    }
+    pthread_mutex_unlock(&tracker->lock);
+    return count;
+}
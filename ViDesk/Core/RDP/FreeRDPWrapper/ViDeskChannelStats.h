@@ -0,0 +1,44 @@
+#ifndef ViDeskChannelStats_h
+#define ViDeskChannelStats_h
+
+#include "FreeRDPBridge.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 虚拟通道统计 (桥接层内部使用)
+/// freerdp_get_stats 只有总字节数，看不出慢在图形、剪贴板、音频还是 drdynvc 本身。
+/// 桥接层在 ReceiveChannelData / SendChannelData 上按通道累计字节和消息数；
+/// drdynvc 的消息再解析 MS-RDPEDYC 的 PDU 头，按服务器创建通道时给出的名称归到各动态通道。
+/// 事件处理线程每秒为每个通道生成一个样本，写入各自的环形历史
+typedef struct ViDeskChannelStatsTracker ViDeskChannelStatsTracker;
+
+ViDeskChannelStatsTracker* viDesk_channelStatsNew(void);
+void viDesk_channelStatsFree(ViDeskChannelStatsTracker* tracker);
+
+/// 清空统计、历史和动态通道编号 (新连接开始时调用)
+void viDesk_channelStatsReset(ViDeskChannelStatsTracker* tracker);
+
+/// 记录一段静态通道数据 (任意线程)
+/// inbound 为服务器到客户端；first 表示这是一个通道消息的第一个分片，totalSize 为整个消息的长度。
+/// 出站的消息是完整的 (first 为 true，totalSize 等于 size)
+void viDesk_channelStatsRecord(ViDeskChannelStatsTracker* tracker, const char* name, bool inbound,
+                               const uint8_t* data, size_t size, bool first, size_t totalSize);
+
+/// 距上一个样本满一秒时为每个通道生成新样本 (事件处理线程调用)
+void viDesk_channelStatsTick(ViDeskChannelStatsTracker* tracker, uint64_t nowNs);
+
+/// 复制各通道的统计 (线程安全)，返回复制的个数
+uint32_t viDesk_channelStatsGet(ViDeskChannelStatsTracker* tracker, ViDeskChannelStats* channels,
+                                uint32_t capacity);
+
+/// 复制某个通道最近的样本 (最旧的在前，线程安全)，返回复制的个数
+uint32_t viDesk_channelStatsHistory(ViDeskChannelStatsTracker* tracker, const char* name, ViDeskChannelKind kind,
+                                    ViDeskChannelSample* samples, uint32_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskChannelStats_h */
@@ -0,0 +1,412 @@
+/**
+ * ViDeskInputRecorder.c - 输入录制与回放
+ */
+
+#include "ViDeskInputRecorder.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define VIDESK_INPUT_MAGIC "VDIR"
+#define VIDESK_INPUT_VERSION 1
+#define VIDESK_INPUT_HEADER_SIZE 5
+
+// 单条记录编码后的上限 (文本除外，文本单独写出)
+#define VIDESK_INPUT_RECORD_MAX 64
+
+// 相对移动按 1/256 像素定点保存
+#define VIDESK_INPUT_RELATIVE_SCALE 256.0
+
+struct ViDeskInputRecorder {
+    pthread_mutex_t lock;
+    atomic_bool active;
+    FILE* file;
+    uint64_t startNs;
+    uint64_t lastNs;
+    uint32_t events;
+    uint64_t bytes;
+};
+
+struct ViDeskInputReplay {
+    uint8_t* data;
+    size_t size;
+    size_t offset;
+    uint64_t timeNs;
+    ViDeskTouchContact* contacts;
+    uint32_t contactCapacity;
+};
+
+// === 编码 ===
+
+static size_t viDesk_putVarint(uint8_t* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static size_t viDesk_putSigned(uint8_t* out, int64_t value) {
+    return viDesk_putVarint(out, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static bool viDesk_getVarint(ViDeskInputReplay* replay, uint64_t* value) {
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (replay->offset >= replay->size)
+            return false;
+        uint8_t byte = replay->data[replay->offset++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool viDesk_getSigned(ViDeskInputReplay* replay, int64_t* value) {
+    uint64_t raw;
+    if (!viDesk_getVarint(replay, &raw))
+        return false;
+    *value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+    return true;
+}
+
+// === 录制 ===
+
+ViDeskInputRecorder* viDesk_inputRecorderNew(void) {
+    ViDeskInputRecorder* recorder = calloc(1, sizeof(ViDeskInputRecorder));
+    if (!recorder)
+        return NULL;
+
+    pthread_mutex_init(&recorder->lock, NULL);
+    atomic_init(&recorder->active, false);
+    return recorder;
+}
+
+void viDesk_inputRecorderFree(ViDeskInputRecorder* recorder) {
+    if (!recorder)
+        return;
+
+    viDesk_inputRecorderStop(recorder, NULL);
+    pthread_mutex_destroy(&recorder->lock);
+    free(recorder);
+}
+
+bool viDesk_inputRecorderStart(ViDeskInputRecorder* recorder, const char* path) {
+    if (!recorder || !path)
+        return false;
+
+    viDesk_inputRecorderStop(recorder, NULL);
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    uint8_t header[VIDESK_INPUT_HEADER_SIZE];
+    memcpy(header, VIDESK_INPUT_MAGIC, 4);
+    header[4] = VIDESK_INPUT_VERSION;
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+        fclose(file);
+        return false;
+    }
+
+    pthread_mutex_lock(&recorder->lock);
+    recorder->file = file;
+    recorder->startNs = 0;
+    recorder->lastNs = 0;
+    recorder->events = 0;
+    recorder->bytes = sizeof(header);
+    atomic_store(&recorder->active, true);
+    pthread_mutex_unlock(&recorder->lock);
+    return true;
+}
+
+bool viDesk_inputRecorderStop(ViDeskInputRecorder* recorder, ViDeskInputReplayStats* stats) {
+    if (stats)
+        memset(stats, 0, sizeof(*stats));
+    if (!recorder)
+        return false;
+
+    pthread_mutex_lock(&recorder->lock);
+    bool wasActive = recorder->file != NULL;
+    if (wasActive) {
+        atomic_store(&recorder->active, false);
+        fclose(recorder->file);
+        recorder->file = NULL;
+
+        if (stats) {
+            stats->events = recorder->events;
+            stats->durationNs = recorder->events > 0 ? recorder->lastNs - recorder->startNs : 0;
+            stats->bytes = recorder->bytes;
+        }
+    }
+    pthread_mutex_unlock(&recorder->lock);
+    return wasActive;
+}
+
+void viDesk_inputRecorderWrite(ViDeskInputRecorder* recorder, uint64_t nowNs, const ViDeskInputEvent* event) {
+    if (!recorder || !event || !atomic_load_explicit(&recorder->active, memory_order_relaxed))
+        return;
+
+    pthread_mutex_lock(&recorder->lock);
+    if (!recorder->file) {
+        pthread_mutex_unlock(&recorder->lock);
+        return;
+    }
+
+    if (recorder->events == 0) {
+        recorder->startNs = nowNs;
+        recorder->lastNs = nowNs;
+    }
+
+    uint8_t buffer[VIDESK_INPUT_RECORD_MAX];
+    size_t n = 0;
+    buffer[n++] = (uint8_t)event->type;
+    n += viDesk_putVarint(&buffer[n], (nowNs - recorder->lastNs) / 1000);
+
+    const void* tail = NULL;
+    size_t tailLength = 0;
+
+    switch (event->type) {
+        case VIDESK_INPUT_EVENT_MOUSE_MOVE:
+            n += viDesk_putSigned(&buffer[n], event->move.x);
+            n += viDesk_putSigned(&buffer[n], event->move.y);
+            break;
+        case VIDESK_INPUT_EVENT_MOUSE_RELATIVE:
+            n += viDesk_putSigned(&buffer[n], (int64_t)(event->relative.dx * VIDESK_INPUT_RELATIVE_SCALE));
+            n += viDesk_putSigned(&buffer[n], (int64_t)(event->relative.dy * VIDESK_INPUT_RELATIVE_SCALE));
+            break;
+        case VIDESK_INPUT_EVENT_MOUSE_BUTTON:
+            buffer[n++] = (uint8_t)((event->button.button << 1) | (event->button.pressed ? 1 : 0));
+            n += viDesk_putSigned(&buffer[n], event->button.x);
+            n += viDesk_putSigned(&buffer[n], event->button.y);
+            break;
+        case VIDESK_INPUT_EVENT_MOUSE_WHEEL:
+            n += viDesk_putSigned(&buffer[n], event->wheel.delta);
+            buffer[n++] = event->wheel.horizontal ? 1 : 0;
+            break;
+        case VIDESK_INPUT_EVENT_KEY:
+            n += viDesk_putVarint(&buffer[n], event->key.scanCode);
+            buffer[n++] = (uint8_t)((event->key.pressed ? 1 : 0) | (event->key.extended ? 2 : 0));
+            break;
+        case VIDESK_INPUT_EVENT_UNICODE_KEY:
+            n += viDesk_putVarint(&buffer[n], event->unicode.codePoint);
+            break;
+        case VIDESK_INPUT_EVENT_UNICODE_TEXT:
+            n += viDesk_putVarint(&buffer[n], event->text.length);
+            tail = event->text.utf8;
+            tailLength = event->text.length;
+            break;
+        case VIDESK_INPUT_EVENT_TOUCH_FRAME:
+            // 触点数受 RDPEI 限制 (最多 10 个)，每个触点最多 17 字节，分段写出
+            n += viDesk_putVarint(&buffer[n], event->touch.count);
+            break;
+    }
+
+    bool ok = fwrite(buffer, 1, n, recorder->file) == n;
+    recorder->bytes += n;
+
+    if (ok && tailLength > 0) {
+        ok = fwrite(tail, 1, tailLength, recorder->file) == tailLength;
+        recorder->bytes += tailLength;
+    }
+
+    if (ok && event->type == VIDESK_INPUT_EVENT_TOUCH_FRAME) {
+        for (uint32_t i = 0; i < event->touch.count && ok; i++) {
+            const ViDeskTouchContact* contact = &event->touch.contacts[i];
+            size_t m = 0;
+            m += viDesk_putVarint(&buffer[m], (uint32_t)contact->id);
+            m += viDesk_putSigned(&buffer[m], contact->x);
+            m += viDesk_putSigned(&buffer[m], contact->y);
+            buffer[m++] = (uint8_t)contact->phase;
+            ok = fwrite(buffer, 1, m, recorder->file) == m;
+            recorder->bytes += m;
+        }
+    }
+
+    recorder->events++;
+    recorder->lastNs = nowNs;
+
+    // 写入失败 (如磁盘已满) 时停止录制，避免留下半条记录之后继续追加
+    if (!ok) {
+        atomic_store(&recorder->active, false);
+        fclose(recorder->file);
+        recorder->file = NULL;
+    }
+
+    pthread_mutex_unlock(&recorder->lock);
+}
+
+// === 回放 ===
+
+ViDeskInputReplay* viDesk_inputReplayOpen(const char* path) {
+    if (!path)
+        return NULL;
+
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+
+    ViDeskInputReplay* replay = NULL;
+    uint8_t* data = NULL;
+    long size = 0;
+
+    if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < VIDESK_INPUT_HEADER_SIZE ||
+        fseek(file, 0, SEEK_SET) != 0)
+        goto fail;
+
+    data = malloc((size_t)size);
+    if (!data || fread(data, 1, (size_t)size, file) != (size_t)size)
+        goto fail;
+
+    if (memcmp(data, VIDESK_INPUT_MAGIC, 4) != 0 || data[4] != VIDESK_INPUT_VERSION)
+        goto fail;
+
+    replay = calloc(1, sizeof(ViDeskInputReplay));
+    if (!replay)
+        goto fail;
+
+    replay->data = data;
+    replay->size = (size_t)size;
+    replay->offset = VIDESK_INPUT_HEADER_SIZE;
+    fclose(file);
+    return replay;
+
+fail:
+    free(data);
+    fclose(file);
+    return NULL;
+}
+
+void viDesk_inputReplayFree(ViDeskInputReplay* replay) {
+    if (!replay)
+        return;
+
+    free(replay->contacts);
+    free(replay->data);
+    free(replay);
+}
+
+bool viDesk_inputReplayFinished(ViDeskInputReplay* replay) {
+    return !replay || replay->offset >= replay->size;
+}
+
+uint64_t viDesk_inputReplaySize(ViDeskInputReplay* replay) {
+    return replay ? replay->size : 0;
+}
+
+static bool viDesk_getByte(ViDeskInputReplay* replay, uint8_t* value) {
+    if (replay->offset >= replay->size)
+        return false;
+    *value = replay->data[replay->offset++];
+    return true;
+}
+
+bool viDesk_inputReplayNext(ViDeskInputReplay* replay, ViDeskInputEvent* event) {
+    if (!replay || !event || replay->offset >= replay->size)
+        return false;
+
+    memset(event, 0, sizeof(*event));
+
+    uint8_t type;
+    uint64_t deltaUs;
+    if (!viDesk_getByte(replay, &type) || !viDesk_getVarint(replay, &deltaUs))
+        return false;
+
+    replay->timeNs += deltaUs * 1000;
+    event->type = (ViDeskInputEventType)type;
+    event->timeNs = replay->timeNs;
+
+    int64_t a, b;
+    uint64_t u;
+    uint8_t flags;
+
+    switch (event->type) {
+        case VIDESK_INPUT_EVENT_MOUSE_MOVE:
+            if (!viDesk_getSigned(replay, &a) || !viDesk_getSigned(replay, &b))
+                return false;
+            event->move.x = (int32_t)a;
+            event->move.y = (int32_t)b;
+            return true;
+
+        case VIDESK_INPUT_EVENT_MOUSE_RELATIVE:
+            if (!viDesk_getSigned(replay, &a) || !viDesk_getSigned(replay, &b))
+                return false;
+            event->relative.dx = (double)a / VIDESK_INPUT_RELATIVE_SCALE;
+            event->relative.dy = (double)b / VIDESK_INPUT_RELATIVE_SCALE;
+            return true;
+
+        case VIDESK_INPUT_EVENT_MOUSE_BUTTON:
+            if (!viDesk_getByte(replay, &flags) || !viDesk_getSigned(replay, &a) || !viDesk_getSigned(replay, &b))
+                return false;
+            event->button.button = flags >> 1;
+            event->button.pressed = flags & 1;
+            event->button.x = (int32_t)a;
+            event->button.y = (int32_t)b;
+            return true;
+
+        case VIDESK_INPUT_EVENT_MOUSE_WHEEL:
+            if (!viDesk_getSigned(replay, &a) || !viDesk_getByte(replay, &flags))
+                return false;
+            event->wheel.delta = (int32_t)a;
+            event->wheel.horizontal = flags != 0;
+            return true;
+
+        case VIDESK_INPUT_EVENT_KEY:
+            if (!viDesk_getVarint(replay, &u) || !viDesk_getByte(replay, &flags))
+                return false;
+            event->key.scanCode = (uint16_t)u;
+            event->key.pressed = flags & 1;
+            event->key.extended = (flags & 2) != 0;
+            return true;
+
+        case VIDESK_INPUT_EVENT_UNICODE_KEY:
+            if (!viDesk_getVarint(replay, &u))
+                return false;
+            event->unicode.codePoint = (uint16_t)u;
+            return true;
+
+        case VIDESK_INPUT_EVENT_UNICODE_TEXT:
+            if (!viDesk_getVarint(replay, &u) || u > replay->size - replay->offset)
+                return false;
+            event->text.utf8 = (const char*)&replay->data[replay->offset];
+            event->text.length = (size_t)u;
+            replay->offset += (size_t)u;
+            return true;
+
+        case VIDESK_INPUT_EVENT_TOUCH_FRAME:
+            if (!viDesk_getVarint(replay, &u) || u == 0 || u > replay->size - replay->offset)
+                return false;
+
+            if (u > replay->contactCapacity) {
+                ViDeskTouchContact* contacts = realloc(replay->contacts, (size_t)u * sizeof(ViDeskTouchContact));
+                if (!contacts)
+                    return false;
+                replay->contacts = contacts;
+                replay->contactCapacity = (uint32_t)u;
+            }
+
+            for (uint64_t i = 0; i < u; i++) {
+                uint64_t id;
+                if (!viDesk_getVarint(replay, &id) || !viDesk_getSigned(replay, &a) ||
+                    !viDesk_getSigned(replay, &b) || !viDesk_getByte(replay, &flags))
+                    return false;
+                replay->contacts[i].id = (int32_t)id;
+                replay->contacts[i].x = (int32_t)a;
+                replay->contacts[i].y = (int32_t)b;
+                replay->contacts[i].phase = (ViDeskTouchPhase)flags;
+            }
+            event->touch.contacts = replay->contacts;
+            event->touch.count = (uint32_t)u;
+            return true;
+    }
+
+    // 未知类型：无法确定记录长度，停止回放
+    return false;
+}
@@ -0,0 +1,76 @@
+#ifndef ViDeskInputRecorder_h
+#define ViDeskInputRecorder_h
+
+#include "FreeRDPBridge.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 输入录制与回放 (桥接层内部使用)
+/// 录制 viDesk_send* 调用及其时间戳，回放时按原始时间间隔重新调用，
+/// 用于在同一服务器上重复同一段输入，比较不同版本的输入延迟
+///
+/// 文件格式：4 字节魔数 "VDIR" + 1 字节版本，之后逐条记录：
+/// 1 字节类型 + 距上一条的微秒数 (varint) + 按类型的参数 (有符号数用 zigzag varint)
+typedef struct ViDeskInputRecorder ViDeskInputRecorder;
+typedef struct ViDeskInputReplay ViDeskInputReplay;
+
+typedef enum {
+    VIDESK_INPUT_EVENT_MOUSE_MOVE = 1,
+    VIDESK_INPUT_EVENT_MOUSE_RELATIVE = 2,
+    VIDESK_INPUT_EVENT_MOUSE_BUTTON = 3,
+    VIDESK_INPUT_EVENT_MOUSE_WHEEL = 4,
+    VIDESK_INPUT_EVENT_KEY = 5,
+    VIDESK_INPUT_EVENT_UNICODE_KEY = 6,
+    VIDESK_INPUT_EVENT_UNICODE_TEXT = 7,
+    VIDESK_INPUT_EVENT_TOUCH_FRAME = 8
+} ViDeskInputEventType;
+
+/// 一次输入调用的参数
+typedef struct {
+    ViDeskInputEventType type;
+    uint64_t timeNs;            // 回放时：距录制开始的时间
+    union {
+        struct { int32_t x, y; } move;
+        struct { double dx, dy; } relative;
+        struct { int32_t button; bool pressed; int32_t x, y; } button;
+        struct { int32_t delta; bool horizontal; } wheel;
+        struct { uint16_t scanCode; bool pressed; bool extended; } key;
+        struct { uint16_t codePoint; } unicode;
+        struct { const char* utf8; size_t length; } text;
+        struct { const ViDeskTouchContact* contacts; uint32_t count; } touch;
+    };
+} ViDeskInputEvent;
+
+ViDeskInputRecorder* viDesk_inputRecorderNew(void);
+void viDesk_inputRecorderFree(ViDeskInputRecorder* recorder);
+
+/// 开始录制到 path (覆盖已有文件)，已在录制时先结束上一次
+bool viDesk_inputRecorderStart(ViDeskInputRecorder* recorder, const char* path);
+
+/// 结束录制，stats 中填写 events / durationNs / bytes；未在录制时返回 false
+bool viDesk_inputRecorderStop(ViDeskInputRecorder* recorder, ViDeskInputReplayStats* stats);
+
+/// 记录一次输入 (未在录制时立即返回)
+void viDesk_inputRecorderWrite(ViDeskInputRecorder* recorder, uint64_t nowNs, const ViDeskInputEvent* event);
+
+/// 打开录制文件 (整个读入内存)，格式不符时返回 NULL
+ViDeskInputReplay* viDesk_inputReplayOpen(const char* path);
+void viDesk_inputReplayFree(ViDeskInputReplay* replay);
+
+/// 读取下一条记录；文本和触点指向回放对象内部，下次调用前有效
+/// 到达末尾或记录损坏时返回 false
+bool viDesk_inputReplayNext(ViDeskInputReplay* replay, ViDeskInputEvent* event);
+
+/// 是否已读完所有记录 (用于区分正常结束和记录损坏)
+bool viDesk_inputReplayFinished(ViDeskInputReplay* replay);
+
+/// 文件大小 (字节)
+uint64_t viDesk_inputReplaySize(ViDeskInputReplay* replay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskInputRecorder_h */
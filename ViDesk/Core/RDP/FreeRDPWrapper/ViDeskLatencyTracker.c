@@ -0,0 +1,218 @@
+/**
+ * ViDeskLatencyTracker.c - 输入到上屏延迟跟踪
+ */
+
+#include "ViDeskLatencyTracker.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// 同时等待匹配的输入上限，超出时丢弃最旧的 (120Hz 鼠标移动约 0.5 秒)
+#define VIDESK_LATENCY_MAX_PENDING 64
+
+// 超过该时间仍未被帧认领的输入视为没有可见效果
+#define VIDESK_LATENCY_EXPIRE_NS (2ULL * 1000000000ULL)
+
+// 计算百分位的样本窗口
+#define VIDESK_LATENCY_WINDOW 512
+
+// 判断脏区域是否覆盖指针时，指针周围留出的余量 (像素)
+#define VIDESK_LATENCY_POINTER_MARGIN 16
+
+typedef struct {
+    uint64_t inputNs;
+    uint64_t frameNs;       // 被认领时的帧更新时刻 (0 表示尚未认领)
+    uint64_t sequence;      // 认领该输入的帧序号
+    int32_t x;
+    int32_t y;
+    bool hasPosition;
+} ViDeskPendingInput;
+
+struct ViDeskLatencyTracker {
+    pthread_mutex_t lock;
+
+    ViDeskPendingInput pending[VIDESK_LATENCY_MAX_PENDING];
+    uint32_t pendingCount;
+    uint64_t sequence;
+
+    // 输入到呈现、输入到帧更新的最近样本 (环形)
+    uint64_t photonSamples[VIDESK_LATENCY_WINDOW];
+    uint64_t frameSamples[VIDESK_LATENCY_WINDOW];
+    uint32_t sampleCount;
+    uint32_t sampleNext;
+
+    uint64_t totalSamples;
+    uint64_t maxNs;
+    uint64_t expiredInputs;
+};
+
+ViDeskLatencyTracker* viDesk_latencyTrackerNew(void) {
+    ViDeskLatencyTracker* tracker = calloc(1, sizeof(ViDeskLatencyTracker));
+    if (!tracker)
+        return NULL;
+
+    pthread_mutex_init(&tracker->lock, NULL);
+    return tracker;
+}
+
+void viDesk_latencyTrackerFree(ViDeskLatencyTracker* tracker) {
+    if (!tracker)
+        return;
+
+    pthread_mutex_destroy(&tracker->lock);
+    free(tracker);
+}
+
+static void viDesk_latencyRemoveAt(ViDeskLatencyTracker* tracker, uint32_t index) {
+    memmove(&tracker->pending[index], &tracker->pending[index + 1],
+            (tracker->pendingCount - index - 1) * sizeof(ViDeskPendingInput));
+    tracker->pendingCount--;
+}
+
+void viDesk_latencyRecordInput(ViDeskLatencyTracker* tracker, uint64_t nowNs,
+                               bool hasPosition, int32_t x, int32_t y) {
+    if (!tracker)
+        return;
+
+    pthread_mutex_lock(&tracker->lock);
+
+    if (tracker->pendingCount == VIDESK_LATENCY_MAX_PENDING) {
+        viDesk_latencyRemoveAt(tracker, 0);
+        tracker->expiredInputs++;
+    }
+
+    ViDeskPendingInput* input = &tracker->pending[tracker->pendingCount++];
+    memset(input, 0, sizeof(*input));
+    input->inputNs = nowNs;
+    input->hasPosition = hasPosition;
+    input->x = x;
+    input->y = y;
+
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+uint64_t viDesk_latencyRecordFrame(ViDeskLatencyTracker* tracker, uint64_t nowNs,
+                                   int32_t x, int32_t y, int32_t width, int32_t height) {
+    if (!tracker)
+        return 0;
+
+    pthread_mutex_lock(&tracker->lock);
+    uint64_t sequence = ++tracker->sequence;
+
+    uint32_t i = 0;
+    while (i < tracker->pendingCount) {
+        ViDeskPendingInput* input = &tracker->pending[i];
+
+        if (input->frameNs == 0) {
+            if (nowNs - input->inputNs > VIDESK_LATENCY_EXPIRE_NS) {
+                viDesk_latencyRemoveAt(tracker, i);
+                tracker->expiredInputs++;
+                continue;
+            }
+
+            const int32_t m = VIDESK_LATENCY_POINTER_MARGIN;
+            bool covered = !input->hasPosition ||
+                (input->x + m >= x && input->x - m < x + width &&
+                 input->y + m >= y && input->y - m < y + height);
+            if (covered) {
+                input->frameNs = nowNs;
+                input->sequence = sequence;
+            }
+        }
+        i++;
+    }
+
+    pthread_mutex_unlock(&tracker->lock);
+    return sequence;
+}
+
+void viDesk_latencyRecordPresent(ViDeskLatencyTracker* tracker, uint64_t sequence, uint64_t presentNs) {
+    if (!tracker || sequence == 0)
+        return;
+
+    pthread_mutex_lock(&tracker->lock);
+
+    uint32_t i = 0;
+    while (i < tracker->pendingCount) {
+        ViDeskPendingInput* input = &tracker->pending[i];
+        if (input->frameNs == 0 || input->sequence > sequence) {
+            i++;
+            continue;
+        }
+
+        uint64_t photon = presentNs > input->inputNs ? presentNs - input->inputNs : 0;
+        tracker->photonSamples[tracker->sampleNext] = photon;
+        tracker->frameSamples[tracker->sampleNext] = input->frameNs - input->inputNs;
+        tracker->sampleNext = (tracker->sampleNext + 1) % VIDESK_LATENCY_WINDOW;
+        if (tracker->sampleCount < VIDESK_LATENCY_WINDOW)
+            tracker->sampleCount++;
+        tracker->totalSamples++;
+        if (photon > tracker->maxNs)
+            tracker->maxNs = photon;
+
+        viDesk_latencyRemoveAt(tracker, i);
+    }
+
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+static int viDesk_compareU64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// 最近邻秩百分位
+static uint64_t viDesk_percentile(const uint64_t* sorted, uint32_t count, uint32_t percent) {
+    if (count == 0)
+        return 0;
+
+    uint32_t rank = (count * percent + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+void viDesk_latencyGetStats(ViDeskLatencyTracker* tracker, ViDeskLatencyStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!tracker)
+        return;
+
+    uint64_t photon[VIDESK_LATENCY_WINDOW];
+    uint64_t frame[VIDESK_LATENCY_WINDOW];
+
+    pthread_mutex_lock(&tracker->lock);
+    uint32_t count = tracker->sampleCount;
+    memcpy(photon, tracker->photonSamples, count * sizeof(uint64_t));
+    memcpy(frame, tracker->frameSamples, count * sizeof(uint64_t));
+    stats->totalSamples = tracker->totalSamples;
+    stats->maxNs = tracker->maxNs;
+    stats->expiredInputs = tracker->expiredInputs;
+    stats->pendingInputs = tracker->pendingCount;
+    pthread_mutex_unlock(&tracker->lock);
+
+    qsort(photon, count, sizeof(uint64_t), viDesk_compareU64);
+    qsort(frame, count, sizeof(uint64_t), viDesk_compareU64);
+
+    stats->samples = count;
+    stats->p50Ns = viDesk_percentile(photon, count, 50);
+    stats->p95Ns = viDesk_percentile(photon, count, 95);
+    stats->p99Ns = viDesk_percentile(photon, count, 99);
+    stats->frameP50Ns = viDesk_percentile(frame, count, 50);
+    stats->frameP95Ns = viDesk_percentile(frame, count, 95);
+}
+
+void viDesk_latencyReset(ViDeskLatencyTracker* tracker) {
+    if (!tracker)
+        return;
+
+    pthread_mutex_lock(&tracker->lock);
+    tracker->pendingCount = 0;
+    tracker->sampleCount = 0;
+    tracker->sampleNext = 0;
+    tracker->totalSamples = 0;
+    tracker->maxNs = 0;
+    tracker->expiredInputs = 0;
+    pthread_mutex_unlock(&tracker->lock);
+}
@@ -0,0 +1,39 @@
+#ifndef ViDeskLatencyTracker_h
+#define ViDeskLatencyTracker_h
+
+#include "FreeRDPBridge.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 输入到上屏延迟跟踪 (桥接层内部使用)
+/// 每个输入事件在发送时打上时间戳；之后第一个脏区域覆盖指针位置的帧更新 (EndPaint)
+/// 认领该输入并记下帧序号；渲染器呈现了包含该序号的画面后得到一个延迟样本。
+/// 没有位置的输入 (键盘、文本) 由其后第一个帧更新认领。
+/// 单纯的指针移动不记录：光标由本地叠加层绘制，移动通常没有对应的帧更新
+typedef struct ViDeskLatencyTracker ViDeskLatencyTracker;
+
+ViDeskLatencyTracker* viDesk_latencyTrackerNew(void);
+void viDesk_latencyTrackerFree(ViDeskLatencyTracker* tracker);
+
+/// 记录一次输入 (hasPosition 为 false 时忽略 x/y)
+void viDesk_latencyRecordInput(ViDeskLatencyTracker* tracker, uint64_t nowNs,
+                               bool hasPosition, int32_t x, int32_t y);
+
+/// 记录一次帧更新的脏区域，返回分配给该帧的序号
+uint64_t viDesk_latencyRecordFrame(ViDeskLatencyTracker* tracker, uint64_t nowNs,
+                                   int32_t x, int32_t y, int32_t width, int32_t height);
+
+/// 记录序号不大于 sequence 的帧已呈现 (presentNs 为呈现时刻)
+void viDesk_latencyRecordPresent(ViDeskLatencyTracker* tracker, uint64_t sequence, uint64_t presentNs);
+
+/// 获取/重置统计
+void viDesk_latencyGetStats(ViDeskLatencyTracker* tracker, ViDeskLatencyStats* stats);
+void viDesk_latencyReset(ViDeskLatencyTracker* tracker);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskLatencyTracker_h */
@@ -0,0 +1,157 @@
+/**
+ * ViDeskLiveness.c - 连接存活检测
+ */
+
+#include "ViDeskLiveness.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+// 心跳到达时间的抖动余量
+#define VIDESK_LIVENESS_GRACE_NS (500ULL * 1000000ULL)
+
+// 服务器没有给出 count2 时，连续错过这么多个心跳判定断开
+#define VIDESK_LIVENESS_DEFAULT_MISSED 3
+
+// 服务器未发心跳时的后备阈值：静默 15 秒后探测一次，探测后再等 30 秒
+#define VIDESK_LIVENESS_FALLBACK_SUSPECT_NS (15ULL * 1000000000ULL)
+#define VIDESK_LIVENESS_FALLBACK_DEAD_NS (45ULL * 1000000000ULL)
+
+struct ViDeskLiveness {
+    _Atomic uint64_t lastInboundNs;
+    _Atomic uint32_t heartbeatParams;   // period | count1 << 8 | count2 << 16，0 表示服务器未发心跳
+    atomic_bool suspect;
+    atomic_bool reported;               // 本次连接已报告过断开
+    atomic_bool probePending;           // 后备阈值下进入可疑状态，等待调用方探测
+
+    _Atomic uint32_t heartbeats;
+    _Atomic uint32_t suspects;
+    _Atomic uint32_t deadDetections;
+    _Atomic uint32_t probes;
+    _Atomic uint64_t lastDetectionSilenceNs;
+};
+
+// 由心跳参数算出告警/断开阈值，服务器未发心跳时给出后备阈值并返回 false
+static bool viDesk_livenessThresholds(uint32_t params, uint64_t* suspectNs, uint64_t* deadNs) {
+    uint32_t period = params & 0xFF;
+    if (period == 0) {
+        *suspectNs = VIDESK_LIVENESS_FALLBACK_SUSPECT_NS;
+        *deadNs = VIDESK_LIVENESS_FALLBACK_DEAD_NS;
+        return false;
+    }
+
+    uint32_t count1 = (params >> 8) & 0xFF;
+    uint32_t count2 = (params >> 16) & 0xFF;
+    if (count2 == 0)
+        count2 = count1 > 0 ? count1 + 1 : VIDESK_LIVENESS_DEFAULT_MISSED;
+    if (count1 == 0 || count1 >= count2)
+        count1 = count2 > 1 ? count2 - 1 : 1;
+
+    uint64_t periodNs = (uint64_t)period * 1000000000ULL;
+    *suspectNs = periodNs * count1 + VIDESK_LIVENESS_GRACE_NS;
+    *deadNs = periodNs * count2 + VIDESK_LIVENESS_GRACE_NS;
+    return true;
+}
+
+ViDeskLiveness* viDesk_livenessNew(void) {
+    return (ViDeskLiveness*)calloc(1, sizeof(ViDeskLiveness));
+}
+
+void viDesk_livenessFree(ViDeskLiveness* liveness) {
+    free(liveness);
+}
+
+void viDesk_livenessReset(ViDeskLiveness* liveness, uint64_t nowNs) {
+    if (!liveness)
+        return;
+
+    atomic_store(&liveness->lastInboundNs, nowNs);
+    atomic_store(&liveness->heartbeatParams, 0);
+    atomic_store(&liveness->suspect, false);
+    atomic_store(&liveness->reported, false);
+    atomic_store(&liveness->probePending, false);
+}
+
+void viDesk_livenessRecordInbound(ViDeskLiveness* liveness, uint64_t nowNs) {
+    if (liveness)
+        atomic_store_explicit(&liveness->lastInboundNs, nowNs, memory_order_relaxed);
+}
+
+void viDesk_livenessRecordHeartbeat(ViDeskLiveness* liveness, uint8_t period, uint8_t count1, uint8_t count2,
+                                    uint64_t nowNs) {
+    if (!liveness)
+        return;
+
+    atomic_store(&liveness->heartbeatParams, (uint32_t)period | (uint32_t)count1 << 8 | (uint32_t)count2 << 16);
+    atomic_fetch_add(&liveness->heartbeats, 1);
+    viDesk_livenessRecordInbound(liveness, nowNs);
+}
+
+ViDeskLivenessState viDesk_livenessCheck(ViDeskLiveness* liveness, uint64_t nowNs, uint64_t* silenceNs) {
+    if (silenceNs)
+        *silenceNs = 0;
+    if (!liveness)
+        return VIDESK_LIVENESS_ALIVE;
+
+    uint64_t last = atomic_load_explicit(&liveness->lastInboundNs, memory_order_relaxed);
+    uint64_t silence = nowNs > last ? nowNs - last : 0;
+    if (silenceNs)
+        *silenceNs = silence;
+
+    uint64_t suspectNs = 0, deadNs = 0;
+    bool heartbeat = viDesk_livenessThresholds(atomic_load(&liveness->heartbeatParams), &suspectNs, &deadNs);
+    if (silence < suspectNs) {
+        atomic_store(&liveness->suspect, false);
+        atomic_store(&liveness->probePending, false);
+        return VIDESK_LIVENESS_ALIVE;
+    }
+
+    if (silence < deadNs) {
+        if (!atomic_exchange(&liveness->suspect, true)) {
+            atomic_fetch_add(&liveness->suspects, 1);
+            if (!heartbeat)
+                atomic_store(&liveness->probePending, true);
+        }
+        return VIDESK_LIVENESS_SUSPECT;
+    }
+
+    if (atomic_exchange(&liveness->reported, true))
+        return VIDESK_LIVENESS_SUSPECT;
+
+    atomic_fetch_add(&liveness->deadDetections, 1);
+    atomic_store(&liveness->lastDetectionSilenceNs, silence);
+    return VIDESK_LIVENESS_DEAD;
+}
+
+bool viDesk_livenessTakeProbe(ViDeskLiveness* liveness) {
+    if (!liveness || !atomic_exchange(&liveness->probePending, false))
+        return false;
+
+    atomic_fetch_add(&liveness->probes, 1);
+    return true;
+}
+
+void viDesk_livenessGetStats(ViDeskLiveness* liveness, uint64_t nowNs, ViDeskLivenessStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!liveness)
+        return;
+
+    uint32_t params = atomic_load(&liveness->heartbeatParams);
+    uint64_t last = atomic_load(&liveness->lastInboundNs);
+    uint64_t suspectNs = 0, deadNs = 0;
+    stats->heartbeatActive = viDesk_livenessThresholds(params, &suspectNs, &deadNs);
+    stats->heartbeatPeriod = params & 0xFF;
+    stats->missedToWarn = (params >> 8) & 0xFF;
+    stats->missedToReconnect = (params >> 16) & 0xFF;
+    stats->suspect = atomic_load(&liveness->suspect);
+    stats->heartbeats = atomic_load(&liveness->heartbeats);
+    stats->suspects = atomic_load(&liveness->suspects);
+    stats->deadDetections = atomic_load(&liveness->deadDetections);
+    stats->probes = atomic_load(&liveness->probes);
+    stats->silenceNs = last && nowNs > last ? nowNs - last : 0;
+    stats->timeoutNs = deadNs;
+    stats->lastDetectionSilenceNs = atomic_load(&liveness->lastDetectionSilenceNs);
+}
@@ -0,0 +1,51 @@
+#ifndef ViDeskLiveness_h
+#define ViDeskLiveness_h
+
+#include "FreeRDPBridge.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 连接存活检测 (桥接层内部使用)
+/// 每读到一个入站 PDU 刷新一次最近收到数据的时间。服务器发送心跳 PDU (MS-RDPBCGR 2.2.16.1) 时，
+/// 按它给出的周期和次数判断：连续 count1 个周期没有任何入站数据标记为可疑，count2 个周期判定连接已断开，
+/// 由事件处理线程按掉线处理，触发快速重连。
+/// 不发心跳的服务器空闲时本来就没有数据，静默本身不能说明断开：此时使用后备阈值，
+/// 静默超过告警阈值后请求一次探测 (viDesk_livenessTakeProbe)，由桥接层让服务器重发一小块画面，
+/// 探测之后仍然静默到断开阈值才判定断开
+typedef struct ViDeskLiveness ViDeskLiveness;
+
+typedef enum {
+    VIDESK_LIVENESS_ALIVE = 0,
+    VIDESK_LIVENESS_SUSPECT,        // 超过告警阈值
+    VIDESK_LIVENESS_DEAD            // 超过断开阈值 (每次连接只报告一次)
+} ViDeskLivenessState;
+
+ViDeskLiveness* viDesk_livenessNew(void);
+void viDesk_livenessFree(ViDeskLiveness* liveness);
+
+/// 新连接或重连完成时调用：清除心跳参数，从 nowNs 开始计时
+void viDesk_livenessReset(ViDeskLiveness* liveness, uint64_t nowNs);
+
+/// 收到入站 PDU (任意线程，只写一个原子变量)
+void viDesk_livenessRecordInbound(ViDeskLiveness* liveness, uint64_t nowNs);
+
+/// 收到服务器心跳 PDU (period 为秒)
+void viDesk_livenessRecordHeartbeat(ViDeskLiveness* liveness, uint8_t period, uint8_t count1, uint8_t count2,
+                                    uint64_t nowNs);
+
+/// 事件处理线程定期调用；silenceNs 为距上次收到数据的时间 (可为 NULL)
+ViDeskLivenessState viDesk_livenessCheck(ViDeskLiveness* liveness, uint64_t nowNs, uint64_t* silenceNs);
+
+/// 服务器未发心跳且刚进入可疑状态时返回 true (每次静默只返回一次)，调用方应发送一个会得到回应的请求
+bool viDesk_livenessTakeProbe(ViDeskLiveness* liveness);
+
+/// 获取统计 (线程安全)
+void viDesk_livenessGetStats(ViDeskLiveness* liveness, uint64_t nowNs, ViDeskLivenessStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskLiveness_h */
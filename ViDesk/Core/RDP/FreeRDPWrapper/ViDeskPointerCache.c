@@ -0,0 +1,295 @@
+/**
+ * ViDeskPointerCache.c - 指针缓存
+ */
+
+#include "ViDeskPointerCache.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// 大光标最大 384x384 (LARGE_POINTER_FLAG_384x384)
+#define VIDESK_POINTER_MAX_SIZE 384
+
+// 共享图像的内存上限；超出时淘汰最久未用且没有槽引用的图像
+// 一个 384x384 大光标约 576 KB，常规 32x32 光标 4 KB
+#define VIDESK_POINTER_SHARED_BUDGET (8u * 1024u * 1024u)
+
+// 进程内共享的已转换图像，按原始数据的内容哈希查找
+typedef struct ViDeskPointerEntry {
+    ViDeskPointerImage image;
+    uint64_t hash;
+    uint32_t xorBpp;
+    uint32_t refs;          // 引用该图像的缓存槽数
+    uint64_t lastUse;
+    struct ViDeskPointerEntry* next;
+} ViDeskPointerEntry;
+
+static pthread_mutex_t g_sharedLock = PTHREAD_MUTEX_INITIALIZER;
+static ViDeskPointerEntry* g_sharedEntries;
+static uint32_t g_sharedCount;
+static uint64_t g_sharedBytes;
+static uint64_t g_useClock;
+
+// 统计由事件处理线程更新，UI 线程读取和重置
+typedef struct {
+    _Atomic uint32_t shapeUpdates;
+    _Atomic uint32_t contentHits;
+    _Atomic uint32_t conversions;
+    _Atomic uint64_t conversionTotalNs;
+    _Atomic uint32_t cachedSelects;
+    _Atomic uint32_t cachedMisses;
+} ViDeskPointerCacheCounters;
+
+struct ViDeskPointerCache {
+    ViDeskPointerEntry** slots;
+    uint32_t slotCount;
+    ViDeskPointerCacheCounters stats;
+};
+
+static void viDesk_pointerCount32(_Atomic uint32_t* counter, uint32_t value) {
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+static uint64_t viDesk_pointerNowNs(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// FNV-1a 64
+static uint64_t viDesk_hashBytes(uint64_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// 内容哈希覆盖尺寸、热点、色深和两个掩码；调色板光标 (<= 8 bpp) 还包括调色板
+static uint64_t viDesk_pointerHash(const ViDeskPointerData* data, const gdiPalette* palette) {
+    uint32_t header[5] = { data->xorBpp, data->width, data->height, data->hotspotX, data->hotspotY };
+    uint64_t hash = viDesk_hashBytes(0xcbf29ce484222325ULL, header, sizeof(header));
+    if (data->xorMask)
+        hash = viDesk_hashBytes(hash, data->xorMask, data->xorMaskLength);
+    hash = viDesk_hashBytes(hash, &data->xorMaskLength, sizeof(data->xorMaskLength));
+    if (data->andMask)
+        hash = viDesk_hashBytes(hash, data->andMask, data->andMaskLength);
+    hash = viDesk_hashBytes(hash, &data->andMaskLength, sizeof(data->andMaskLength));
+    if (data->xorBpp <= 8 && palette)
+        hash = viDesk_hashBytes(hash, palette->palette, sizeof(palette->palette));
+    return hash;
+}
+
+// 以下 viDesk_shared* 均需持有 g_sharedLock
+
+static ViDeskPointerEntry* viDesk_sharedFind(uint64_t hash, const ViDeskPointerData* data) {
+    for (ViDeskPointerEntry* entry = g_sharedEntries; entry; entry = entry->next) {
+        if (entry->hash == hash && entry->xorBpp == data->xorBpp &&
+            entry->image.width == data->width && entry->image.height == data->height)
+            return entry;
+    }
+    return NULL;
+}
+
+static void viDesk_sharedRelease(ViDeskPointerEntry* entry) {
+    if (entry && entry->refs > 0)
+        entry->refs--;
+}
+
+static void viDesk_sharedEvict(void) {
+    while (g_sharedBytes > VIDESK_POINTER_SHARED_BUDGET) {
+        ViDeskPointerEntry** victim = NULL;
+        for (ViDeskPointerEntry** link = &g_sharedEntries; *link; link = &(*link)->next) {
+            if ((*link)->refs == 0 && (!victim || (*link)->lastUse < (*victim)->lastUse))
+                victim = link;
+        }
+        if (!victim)
+            return;     // 剩余图像都在使用中
+
+        ViDeskPointerEntry* entry = *victim;
+        *victim = entry->next;
+        g_sharedBytes -= (uint64_t)entry->image.width * entry->image.height * 4;
+        g_sharedCount--;
+        free(entry->image.pixels);
+        free(entry);
+    }
+}
+
+static ViDeskPointerEntry* viDesk_pointerConvert(const ViDeskPointerData* data, uint64_t hash,
+                                                 const gdiPalette* palette) {
+    size_t stride = (size_t)data->width * 4;
+    uint8_t* pixels = malloc(stride * data->height);
+    if (!pixels)
+        return NULL;
+
+    // XOR/AND 掩码合成为带 alpha 的 BGRA；反色像素按 FreeRDP 的约定以半透明黑白呈现
+    if (!freerdp_image_copy_from_pointer_data(pixels, PIXEL_FORMAT_BGRA32, (UINT32)stride, 0, 0,
+                                              data->width, data->height,
+                                              data->xorMask, data->xorMaskLength,
+                                              data->andMask, data->andMaskLength,
+                                              data->xorBpp, palette)) {
+        free(pixels);
+        return NULL;
+    }
+
+    ViDeskPointerEntry* entry = calloc(1, sizeof(ViDeskPointerEntry));
+    if (!entry) {
+        free(pixels);
+        return NULL;
+    }
+
+    entry->image.pixels = pixels;
+    entry->image.width = data->width;
+    entry->image.height = data->height;
+    entry->image.hotspotX = data->hotspotX < data->width ? data->hotspotX : 0;
+    entry->image.hotspotY = data->hotspotY < data->height ? data->hotspotY : 0;
+    entry->hash = hash;
+    entry->xorBpp = data->xorBpp;
+    return entry;
+}
+
+ViDeskPointerCache* viDesk_pointerCacheNew(void) {
+    return calloc(1, sizeof(ViDeskPointerCache));
+}
+
+static void viDesk_pointerCacheClear(ViDeskPointerCache* cache) {
+    pthread_mutex_lock(&g_sharedLock);
+    for (uint32_t i = 0; i < cache->slotCount; i++)
+        viDesk_sharedRelease(cache->slots[i]);
+    viDesk_sharedEvict();
+    pthread_mutex_unlock(&g_sharedLock);
+
+    free(cache->slots);
+    cache->slots = NULL;
+    cache->slotCount = 0;
+}
+
+void viDesk_pointerCacheFree(ViDeskPointerCache* cache) {
+    if (!cache)
+        return;
+
+    viDesk_pointerCacheClear(cache);
+    free(cache);
+}
+
+bool viDesk_pointerCacheReset(ViDeskPointerCache* cache, uint32_t slots) {
+    if (!cache)
+        return false;
+
+    viDesk_pointerCacheClear(cache);
+    if (slots == 0)
+        return true;
+
+    cache->slots = calloc(slots, sizeof(ViDeskPointerEntry*));
+    if (!cache->slots)
+        return false;
+
+    cache->slotCount = slots;
+    return true;
+}
+
+const ViDeskPointerImage* viDesk_pointerCacheStore(ViDeskPointerCache* cache, const ViDeskPointerData* data,
+                                                   const gdiPalette* palette) {
+    if (!cache || !data || data->cacheIndex >= cache->slotCount)
+        return NULL;
+
+    if (data->width == 0 || data->height == 0 ||
+        data->width > VIDESK_POINTER_MAX_SIZE || data->height > VIDESK_POINTER_MAX_SIZE)
+        return NULL;
+
+    viDesk_pointerCount32(&cache->stats.shapeUpdates, 1);
+    uint64_t hash = viDesk_pointerHash(data, palette);
+
+    pthread_mutex_lock(&g_sharedLock);
+    ViDeskPointerEntry* entry = viDesk_sharedFind(hash, data);
+    if (entry) {
+        viDesk_pointerCount32(&cache->stats.contentHits, 1);
+    } else {
+        // 转换不持锁，其他会话的光标更新不必等待
+        pthread_mutex_unlock(&g_sharedLock);
+        uint64_t start = viDesk_pointerNowNs();
+        ViDeskPointerEntry* converted = viDesk_pointerConvert(data, hash, palette);
+        uint64_t elapsed = viDesk_pointerNowNs() - start;
+        if (!converted)
+            return NULL;
+
+        viDesk_pointerCount32(&cache->stats.conversions, 1);
+        atomic_fetch_add_explicit(&cache->stats.conversionTotalNs, elapsed, memory_order_relaxed);
+
+        pthread_mutex_lock(&g_sharedLock);
+        entry = viDesk_sharedFind(hash, data);
+        if (entry) {
+            // 另一会话同时转换了同一光标
+            free(converted->image.pixels);
+            free(converted);
+        } else {
+            entry = converted;
+            entry->next = g_sharedEntries;
+            g_sharedEntries = entry;
+            g_sharedCount++;
+            g_sharedBytes += (uint64_t)entry->image.width * entry->image.height * 4;
+        }
+    }
+
+    entry->refs++;
+    entry->lastUse = ++g_useClock;
+    viDesk_sharedRelease(cache->slots[data->cacheIndex]);
+    cache->slots[data->cacheIndex] = entry;
+    viDesk_sharedEvict();
+    pthread_mutex_unlock(&g_sharedLock);
+
+    return &entry->image;
+}
+
+const ViDeskPointerImage* viDesk_pointerCacheGet(ViDeskPointerCache* cache, uint32_t cacheIndex) {
+    if (!cache)
+        return NULL;
+
+    viDesk_pointerCount32(&cache->stats.cachedSelects, 1);
+    ViDeskPointerEntry* entry = cacheIndex < cache->slotCount ? cache->slots[cacheIndex] : NULL;
+    if (!entry) {
+        viDesk_pointerCount32(&cache->stats.cachedMisses, 1);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_sharedLock);
+    entry->lastUse = ++g_useClock;
+    pthread_mutex_unlock(&g_sharedLock);
+    return &entry->image;
+}
+
+void viDesk_pointerCacheGetStats(ViDeskPointerCache* cache, ViDeskPointerCacheStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (cache) {
+        stats->shapeUpdates = atomic_load_explicit(&cache->stats.shapeUpdates, memory_order_relaxed);
+        stats->contentHits = atomic_load_explicit(&cache->stats.contentHits, memory_order_relaxed);
+        stats->conversions = atomic_load_explicit(&cache->stats.conversions, memory_order_relaxed);
+        stats->conversionTotalNs = atomic_load_explicit(&cache->stats.conversionTotalNs, memory_order_relaxed);
+        stats->cachedSelects = atomic_load_explicit(&cache->stats.cachedSelects, memory_order_relaxed);
+        stats->cachedMisses = atomic_load_explicit(&cache->stats.cachedMisses, memory_order_relaxed);
+    }
+
+    pthread_mutex_lock(&g_sharedLock);
+    stats->sharedEntries = g_sharedCount;
+    stats->sharedBytes = g_sharedBytes;
+    pthread_mutex_unlock(&g_sharedLock);
+}
+
+void viDesk_pointerCacheResetStats(ViDeskPointerCache* cache) {
+    if (!cache)
+        return;
+
+    atomic_store(&cache->stats.shapeUpdates, 0);
+    atomic_store(&cache->stats.contentHits, 0);
+    atomic_store(&cache->stats.conversions, 0);
+    atomic_store(&cache->stats.conversionTotalNs, 0);
+    atomic_store(&cache->stats.cachedSelects, 0);
+    atomic_store(&cache->stats.cachedMisses, 0);
+}
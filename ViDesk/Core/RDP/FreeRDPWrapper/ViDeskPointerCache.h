@@ -0,0 +1,62 @@
+#ifndef ViDeskPointerCache_h
+#define ViDeskPointerCache_h
+
+#include "FreeRDPBridge.h"
+#include <freerdp/codec/color.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 指针缓存 (桥接层内部使用)
+/// 服务器用 PointerNew/Color/Large 下发光标并指定缓存槽，之后用 PointerCached 按槽号切换；
+/// 这里保存每个槽转换后的 BGRA 图像，切换光标时不需要重新转换。
+/// 转换后的图像按原始数据的内容哈希在进程内共享：服务器重新下发同一光标、
+/// 或重连到同一主机的新会话再次收到相同光标时，直接复用已转换的图像
+typedef struct ViDeskPointerCache ViDeskPointerCache;
+
+/// 转换后的光标图像 (BGRA32，非预乘 alpha)
+typedef struct {
+    uint8_t* pixels;
+    uint32_t width;
+    uint32_t height;
+    uint32_t hotspotX;
+    uint32_t hotspotY;
+} ViDeskPointerImage;
+
+/// 服务器下发的原始光标数据
+typedef struct {
+    uint32_t cacheIndex;
+    uint32_t xorBpp;
+    uint32_t width;
+    uint32_t height;
+    uint32_t hotspotX;
+    uint32_t hotspotY;
+    const uint8_t* xorMask;
+    uint32_t xorMaskLength;
+    const uint8_t* andMask;
+    uint32_t andMaskLength;
+} ViDeskPointerData;
+
+ViDeskPointerCache* viDesk_pointerCacheNew(void);
+void viDesk_pointerCacheFree(ViDeskPointerCache* cache);
+
+/// 按协商的指针缓存大小分配槽位 (连接完成后调用)，清空已有内容
+bool viDesk_pointerCacheReset(ViDeskPointerCache* cache, uint32_t slots);
+
+/// 保存到 data->cacheIndex 槽 (内容已转换过时直接复用)，返回保存的图像 (在该槽被覆盖前有效)
+const ViDeskPointerImage* viDesk_pointerCacheStore(ViDeskPointerCache* cache, const ViDeskPointerData* data,
+                                                   const gdiPalette* palette);
+
+/// 取出槽中的图像，槽为空或越界时返回 NULL
+const ViDeskPointerImage* viDesk_pointerCacheGet(ViDeskPointerCache* cache, uint32_t cacheIndex);
+
+/// 获取/重置本会话的命中统计 (共享条目数和字节数为进程内全局值)
+void viDesk_pointerCacheGetStats(ViDeskPointerCache* cache, ViDeskPointerCacheStats* stats);
+void viDesk_pointerCacheResetStats(ViDeskPointerCache* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskPointerCache_h */
@@ -0,0 +1,293 @@
+/**
+ * ViDeskPrewarm.c - 连接预热池
+ */
+
+#include "ViDeskPrewarm.h"
+#include "ViDeskTransport.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <poll.h>
+
+// 同时预热的目标数
+#define VIDESK_PREWARM_SLOTS 4
+
+#define VIDESK_PREWARM_HOST_LENGTH 256
+
+typedef enum {
+    VIDESK_PREWARM_FREE = 0,
+    VIDESK_PREWARM_CONNECTING,
+    VIDESK_PREWARM_READY
+} ViDeskPrewarmState;
+
+typedef struct {
+    ViDeskPrewarmState state;
+    uint64_t generation;            // 每次占用/释放都递增，后台线程据此判断槽位是否已被取走或取消
+    char hostname[VIDESK_PREWARM_HOST_LENGTH];
+    int port;
+    int fd;
+    struct sockaddr_storage local;
+    uint64_t startedNs;
+    uint64_t readyNs;
+    uint64_t expiresNs;
+} ViDeskPrewarmSlot;
+
+typedef struct {
+    uint32_t index;
+    uint64_t generation;
+    char hostname[VIDESK_PREWARM_HOST_LENGTH];
+    int port;
+    DWORD timeoutMs;
+} ViDeskPrewarmJob;
+
+static pthread_mutex_t g_prewarmLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_prewarmCond = PTHREAD_COND_INITIALIZER;
+static ViDeskPrewarmSlot g_slots[VIDESK_PREWARM_SLOTS];
+static uint64_t g_generation;
+static ViDeskPrewarmStats g_stats;
+
+static uint64_t viDesk_prewarmNowNs(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 条件变量按实时时钟计时，把单调时钟的截止时间换算过去 (需持有锁)
+static void viDesk_prewarmWaitUntil(uint64_t deadlineNs) {
+    uint64_t now = viDesk_prewarmNowNs();
+    if (now >= deadlineNs)
+        return;
+
+    uint64_t remaining = deadlineNs - now;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t nsec = (uint64_t)ts.tv_nsec + remaining % 1000000000ULL;
+    ts.tv_sec += (time_t)(remaining / 1000000000ULL + nsec / 1000000000ULL);
+    ts.tv_nsec = (long)(nsec % 1000000000ULL);
+    pthread_cond_timedwait(&g_prewarmCond, &g_prewarmLock, &ts);
+}
+
+// 释放槽位并关闭尚未交出的套接字 (需持有锁)
+static void viDesk_prewarmRelease(ViDeskPrewarmSlot* slot) {
+    if (slot->fd >= 0)
+        close(slot->fd);
+    slot->fd = -1;
+    slot->state = VIDESK_PREWARM_FREE;
+    slot->generation = ++g_generation;
+    pthread_cond_broadcast(&g_prewarmCond);
+}
+
+static ViDeskPrewarmSlot* viDesk_prewarmFind(const char* hostname, int port) {
+    for (uint32_t i = 0; i < VIDESK_PREWARM_SLOTS; i++) {
+        ViDeskPrewarmSlot* slot = &g_slots[i];
+        if (slot->state != VIDESK_PREWARM_FREE && slot->port == port &&
+            strcasecmp(slot->hostname, hostname) == 0)
+            return slot;
+    }
+    return NULL;
+}
+
+// 服务器在收到 X.224 连接请求前不会发送数据，此时可读说明对端已关闭或出错
+static bool viDesk_prewarmAlive(int fd) {
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    if (poll(&pfd, 1, 0) == 0)
+        return true;
+
+    char byte;
+    ssize_t status = recv(fd, &byte, 1, MSG_PEEK);
+    return status > 0 || (status < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+}
+
+static void* viDesk_prewarmThread(void* arg) {
+    ViDeskPrewarmJob* job = arg;
+
+    struct sockaddr_storage local;
+    int fd = viDesk_transportOpenSocket(job->hostname, job->port, job->timeoutMs, &local, NULL);
+
+    pthread_mutex_lock(&g_prewarmLock);
+    ViDeskPrewarmSlot* slot = &g_slots[job->index];
+    if (slot->generation != job->generation || slot->state != VIDESK_PREWARM_CONNECTING) {
+        // 连接期间被取消或替换
+        pthread_mutex_unlock(&g_prewarmLock);
+        if (fd >= 0)
+            close(fd);
+        free(job);
+        return NULL;
+    }
+
+    if (fd < 0) {
+        g_stats.failed++;
+        viDesk_prewarmRelease(slot);
+        pthread_mutex_unlock(&g_prewarmLock);
+        free(job);
+        return NULL;
+    }
+
+    slot->fd = fd;
+    slot->local = local;
+    slot->readyNs = viDesk_prewarmNowNs();
+    slot->state = VIDESK_PREWARM_READY;
+    pthread_cond_broadcast(&g_prewarmCond);
+
+    // 等到被取走、取消或窗口结束；再次预热同一目标会延长 expiresNs
+    while (slot->generation == job->generation && viDesk_prewarmNowNs() < slot->expiresNs)
+        viDesk_prewarmWaitUntil(slot->expiresNs);
+
+    if (slot->generation == job->generation) {
+        g_stats.discarded++;
+        viDesk_prewarmRelease(slot);
+    }
+    pthread_mutex_unlock(&g_prewarmLock);
+    free(job);
+    return NULL;
+}
+
+bool viDesk_prewarmStart(const char* hostname, int port, uint32_t windowMs) {
+    if (!hostname || !*hostname || hostname[0] == '/' || port <= 0 || windowMs == 0 ||
+        strlen(hostname) >= VIDESK_PREWARM_HOST_LENGTH)
+        return false;
+
+    uint64_t now = viDesk_prewarmNowNs();
+    uint64_t expires = now + (uint64_t)windowMs * 1000000ULL;
+
+    pthread_mutex_lock(&g_prewarmLock);
+    ViDeskPrewarmSlot* slot = viDesk_prewarmFind(hostname, port);
+    if (slot) {
+        if (expires > slot->expiresNs)
+            slot->expiresNs = expires;
+        pthread_mutex_unlock(&g_prewarmLock);
+        return true;
+    }
+
+    // 空闲槽位，没有时替换最早就绪的；全部仍在连接时放弃
+    ViDeskPrewarmSlot* oldest = NULL;
+    for (uint32_t i = 0; i < VIDESK_PREWARM_SLOTS && !slot; i++) {
+        ViDeskPrewarmSlot* candidate = &g_slots[i];
+        if (candidate->state == VIDESK_PREWARM_FREE)
+            slot = candidate;
+        else if (candidate->state == VIDESK_PREWARM_READY && (!oldest || candidate->readyNs < oldest->readyNs))
+            oldest = candidate;
+    }
+    if (!slot && oldest) {
+        g_stats.discarded++;
+        viDesk_prewarmRelease(oldest);
+        slot = oldest;
+    }
+
+    ViDeskPrewarmJob* job = slot ? calloc(1, sizeof(ViDeskPrewarmJob)) : NULL;
+    if (!job) {
+        pthread_mutex_unlock(&g_prewarmLock);
+        return false;
+    }
+
+    slot->state = VIDESK_PREWARM_CONNECTING;
+    slot->generation = ++g_generation;
+    strcpy(slot->hostname, hostname);
+    slot->port = port;
+    slot->fd = -1;
+    slot->startedNs = now;
+    slot->readyNs = 0;
+    slot->expiresNs = expires;
+
+    job->index = (uint32_t)(slot - g_slots);
+    job->generation = slot->generation;
+    strcpy(job->hostname, hostname);
+    job->port = port;
+    job->timeoutMs = windowMs;  // 连接比窗口还长就没有意义了
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, viDesk_prewarmThread, job) != 0) {
+        viDesk_prewarmRelease(slot);
+        pthread_mutex_unlock(&g_prewarmLock);
+        free(job);
+        return false;
+    }
+    pthread_detach(thread);
+    g_stats.started++;
+    pthread_mutex_unlock(&g_prewarmLock);
+    return true;
+}
+
+void viDesk_prewarmCancel(const char* hostname, int port) {
+    pthread_mutex_lock(&g_prewarmLock);
+    for (uint32_t i = 0; i < VIDESK_PREWARM_SLOTS; i++) {
+        ViDeskPrewarmSlot* slot = &g_slots[i];
+        if (slot->state == VIDESK_PREWARM_FREE)
+            continue;
+        if (hostname && (slot->port != port || strcasecmp(slot->hostname, hostname) != 0))
+            continue;
+        g_stats.discarded++;
+        viDesk_prewarmRelease(slot);
+    }
+    pthread_mutex_unlock(&g_prewarmLock);
+}
+
+int viDesk_prewarmTake(const char* hostname, int port, DWORD timeoutMs,
+                       struct sockaddr_storage* local, uint64_t* savedNs) {
+    if (!hostname || !local)
+        return -1;
+
+    uint64_t start = viDesk_prewarmNowNs();
+    uint64_t deadline = start + (uint64_t)timeoutMs * 1000000ULL;
+
+    pthread_mutex_lock(&g_prewarmLock);
+    ViDeskPrewarmSlot* slot = viDesk_prewarmFind(hostname, port);
+    if (!slot || start >= slot->expiresNs) {
+        pthread_mutex_unlock(&g_prewarmLock);
+        return -1;
+    }
+
+    uint64_t generation = slot->generation;
+    while (slot->generation == generation && slot->state == VIDESK_PREWARM_CONNECTING &&
+           viDesk_prewarmNowNs() < deadline)
+        viDesk_prewarmWaitUntil(deadline);
+
+    if (slot->generation != generation || slot->state != VIDESK_PREWARM_READY) {
+        pthread_mutex_unlock(&g_prewarmLock);
+        return -1;
+    }
+
+    if (!viDesk_prewarmAlive(slot->fd)) {
+        g_stats.discarded++;
+        viDesk_prewarmRelease(slot);
+        pthread_mutex_unlock(&g_prewarmLock);
+        return -1;
+    }
+
+    // 重新连接需要 readyNs - startedNs，实际只等了 now - start
+    int fd = slot->fd;
+    uint64_t connectNs = slot->readyNs - slot->startedNs;
+    uint64_t waitedNs = viDesk_prewarmNowNs() - start;
+    uint64_t saved = connectNs > waitedNs ? connectNs - waitedNs : 0;
+    *local = slot->local;
+    slot->fd = -1;
+    viDesk_prewarmRelease(slot);
+
+    g_stats.used++;
+    g_stats.lastSavedNs = saved;
+    g_stats.totalSavedNs += saved;
+    pthread_mutex_unlock(&g_prewarmLock);
+
+    if (savedNs)
+        *savedNs = saved;
+    return fd;
+}
+
+void viDesk_prewarmGetStats(ViDeskPrewarmStats* stats) {
+    if (!stats)
+        return;
+
+    pthread_mutex_lock(&g_prewarmLock);
+    *stats = g_stats;
+    stats->pending = 0;
+    for (uint32_t i = 0; i < VIDESK_PREWARM_SLOTS; i++) {
+        if (g_slots[i].state != VIDESK_PREWARM_FREE)
+            stats->pending++;
+    }
+    pthread_mutex_unlock(&g_prewarmLock);
+}
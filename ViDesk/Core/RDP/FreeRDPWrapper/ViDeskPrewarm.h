@@ -0,0 +1,37 @@
+#ifndef ViDeskPrewarm_h
+#define ViDeskPrewarm_h
+
+#include "FreeRDPBridge.h"
+#include <winpr/wtypes.h>
+#include <sys/socket.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 连接预热池 (进程内共享，桥接层内部使用)
+/// 用户可能马上连接某台主机时 (连接卡片悬停/获得焦点)，在后台线程解析 DNS 并建立 TCP 连接。
+/// 窗口期内池化传输层连接同一目标时直接取走这个套接字；过期未用由后台线程关闭。
+/// 只预热到 TCP：RDP 先在明文上交换 X.224 连接请求/确认，协商出安全协议后才在同一连接上开始 TLS，
+/// 而 TLS 和 NLA 的状态属于具体的 rdpContext，无法提前完成
+
+/// 开始预热 hostname:port，windowMs 内未被使用则关闭
+/// 同一目标已在预热时只延长窗口；槽位用完时替换最早就绪的一个
+bool viDesk_prewarmStart(const char* hostname, int port, uint32_t windowMs);
+
+/// 取消预热并关闭套接字 (hostname 为 NULL 时取消全部)
+void viDesk_prewarmCancel(const char* hostname, int port);
+
+/// 取出预热好的套接字，没有、已过期或对端已关闭时返回 -1
+/// 预热仍在进行时最多等待 timeoutMs (等它比重新连接更快)；savedNs 为因预热省下的连接时间
+int viDesk_prewarmTake(const char* hostname, int port, DWORD timeoutMs,
+                       struct sockaddr_storage* local, uint64_t* savedNs);
+
+/// 获取统计 (线程安全)
+void viDesk_prewarmGetStats(ViDeskPrewarmStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskPrewarm_h */
@@ -0,0 +1,275 @@
+/**
+ * ViDeskQualityController.c - 自适应画质控制器
+ */
+
+#include "ViDeskQualityController.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#define VIDESK_QUALITY_LEVEL_COUNT 4
+
+// 保留的调整记录数
+#define VIDESK_QUALITY_DECISION_HISTORY 32
+
+// 连续多少次测量满足条件才调整
+#define VIDESK_QUALITY_DOWNGRADE_SAMPLES 3
+#define VIDESK_QUALITY_UPGRADE_SAMPLES 10
+
+// 两次调整的最小间隔
+#define VIDESK_QUALITY_MIN_DWELL_MS 5000
+
+// 升档余量：带宽需高出阈值 25%，往返时间需低于阈值 20%
+#define VIDESK_QUALITY_UPGRADE_BANDWIDTH_MARGIN 125
+#define VIDESK_QUALITY_UPGRADE_RTT_MARGIN 80
+
+// 平滑系数 (新样本权重，百分比)
+#define VIDESK_QUALITY_SMOOTHING 30
+
+// 各档位的准入条件：带宽不低于 minBandwidthKbps 且往返时间不高于 maxRttMs
+typedef struct {
+    uint32_t minBandwidthKbps;
+    uint32_t maxRttMs;
+    const char* name;
+} ViDeskQualityThreshold;
+
+static const ViDeskQualityThreshold kThresholds[VIDESK_QUALITY_LEVEL_COUNT] = {
+    { 20000, 20,  "局域网" },
+    { 5000,  60,  "宽带" },
+    { 1500,  150, "受限" },
+    { 0,     UINT32_MAX, "较差" }
+};
+
+static const ViDeskQualityProfile kProfiles[VIDESK_QUALITY_LEVEL_COUNT] = {
+    { VIDESK_QUALITY_LAN,         0, 100, VIDESK_QUALITY_CODEC_AVC444, false },
+    { VIDESK_QUALITY_BROADBAND,   4, 100, VIDESK_QUALITY_CODEC_AVC420, false },
+    { VIDESK_QUALITY_CONSTRAINED, 2, 100, VIDESK_QUALITY_CODEC_AVC420, true },
+    { VIDESK_QUALITY_POOR,        1, 75,  VIDESK_QUALITY_CODEC_AVC420, true }
+};
+
+struct ViDeskQualityController {
+    pthread_mutex_t lock;
+
+    bool enabled;
+    ViDeskQualityLevel level;
+    uint32_t bandwidthKbps;     // 平滑值，0 表示未知
+    uint32_t rttMs;
+    ViDeskQualityLevel candidate;
+    uint32_t candidateSamples;
+    uint64_t lastChangeMs;
+
+    ViDeskQualityDecision decisions[VIDESK_QUALITY_DECISION_HISTORY];
+    uint32_t decisionCount;
+    uint32_t decisionNext;
+    uint32_t totalDecisions;
+};
+
+ViDeskQualityController* viDesk_qualityControllerNew(void) {
+    ViDeskQualityController* controller = calloc(1, sizeof(ViDeskQualityController));
+    if (!controller)
+        return NULL;
+
+    pthread_mutex_init(&controller->lock, NULL);
+    controller->enabled = true;
+    controller->level = VIDESK_QUALITY_LAN;
+    controller->candidate = VIDESK_QUALITY_LAN;
+    return controller;
+}
+
+void viDesk_qualityControllerFree(ViDeskQualityController* controller) {
+    if (!controller)
+        return;
+
+    pthread_mutex_destroy(&controller->lock);
+    free(controller);
+}
+
+void viDesk_qualityControllerReset(ViDeskQualityController* controller) {
+    if (!controller)
+        return;
+
+    pthread_mutex_lock(&controller->lock);
+    controller->level = VIDESK_QUALITY_LAN;
+    controller->bandwidthKbps = 0;
+    controller->rttMs = 0;
+    controller->candidate = VIDESK_QUALITY_LAN;
+    controller->candidateSamples = 0;
+    controller->lastChangeMs = 0;
+    pthread_mutex_unlock(&controller->lock);
+}
+
+static uint32_t viDesk_smooth(uint32_t current, uint32_t sample) {
+    if (sample == 0)
+        return current;
+    if (current == 0)
+        return sample;
+    return (uint32_t)(((uint64_t)current * (100 - VIDESK_QUALITY_SMOOTHING) +
+                       (uint64_t)sample * VIDESK_QUALITY_SMOOTHING) / 100);
+}
+
+// 测量是否满足档位 level 的条件；upgrade 时要求留出余量。未知的测量不参与判断
+static bool viDesk_meetsLevel(ViDeskQualityLevel level, uint32_t bandwidthKbps, uint32_t rttMs, bool upgrade) {
+    const ViDeskQualityThreshold* t = &kThresholds[level];
+
+    if (bandwidthKbps > 0) {
+        uint64_t required = upgrade
+            ? (uint64_t)t->minBandwidthKbps * VIDESK_QUALITY_UPGRADE_BANDWIDTH_MARGIN / 100
+            : t->minBandwidthKbps;
+        if (bandwidthKbps < required)
+            return false;
+    }
+    if (rttMs > 0 && t->maxRttMs != UINT32_MAX) {
+        uint64_t allowed = upgrade
+            ? (uint64_t)t->maxRttMs * VIDESK_QUALITY_UPGRADE_RTT_MARGIN / 100
+            : t->maxRttMs;
+        if (rttMs > allowed)
+            return false;
+    }
+    return true;
+}
+
+// 需持有锁
+static void viDesk_recordDecision(ViDeskQualityController* controller, uint64_t nowMs,
+                                  ViDeskQualityLevel to, const char* reason, ViDeskQualityDecision* out) {
+    ViDeskQualityDecision decision;
+    memset(&decision, 0, sizeof(decision));
+    decision.timestampMs = nowMs;
+    decision.from = controller->level;
+    decision.to = to;
+    decision.bandwidthKbps = controller->bandwidthKbps;
+    decision.rttMs = controller->rttMs;
+    decision.profile = kProfiles[to];
+    snprintf(decision.reason, sizeof(decision.reason), "%s -> %s: %s",
+             kThresholds[controller->level].name, kThresholds[to].name, reason);
+
+    controller->level = to;
+    controller->candidate = to;
+    controller->candidateSamples = 0;
+    controller->lastChangeMs = nowMs;
+
+    controller->decisions[controller->decisionNext] = decision;
+    controller->decisionNext = (controller->decisionNext + 1) % VIDESK_QUALITY_DECISION_HISTORY;
+    if (controller->decisionCount < VIDESK_QUALITY_DECISION_HISTORY)
+        controller->decisionCount++;
+    controller->totalDecisions++;
+
+    if (out)
+        *out = decision;
+}
+
+bool viDesk_qualityControllerSetEnabled(ViDeskQualityController* controller, bool enabled, uint64_t nowMs,
+                                        ViDeskQualityDecision* decision) {
+    if (!controller)
+        return false;
+
+    pthread_mutex_lock(&controller->lock);
+    controller->enabled = enabled;
+    bool changed = false;
+    if (!enabled && controller->level != VIDESK_QUALITY_LAN) {
+        viDesk_recordDecision(controller, nowMs, VIDESK_QUALITY_LAN, "自适应画质已停用", decision);
+        changed = true;
+    }
+    pthread_mutex_unlock(&controller->lock);
+    return changed;
+}
+
+bool viDesk_qualityControllerUpdate(ViDeskQualityController* controller, uint64_t nowMs,
+                                    uint32_t bandwidthKbps, uint32_t rttMs, ViDeskQualityDecision* decision) {
+    if (!controller)
+        return false;
+
+    pthread_mutex_lock(&controller->lock);
+    controller->bandwidthKbps = viDesk_smooth(controller->bandwidthKbps, bandwidthKbps);
+    controller->rttMs = viDesk_smooth(controller->rttMs, rttMs);
+
+    if (!controller->enabled || (controller->bandwidthKbps == 0 && controller->rttMs == 0)) {
+        pthread_mutex_unlock(&controller->lock);
+        return false;
+    }
+
+    // 当前档位不再满足时降到满足条件的最高档；否则看更高一档是否明显满足
+    ViDeskQualityLevel current = controller->level;
+    ViDeskQualityLevel target = current;
+    if (!viDesk_meetsLevel(current, controller->bandwidthKbps, controller->rttMs, false)) {
+        target = current;
+        while (target < VIDESK_QUALITY_POOR &&
+               !viDesk_meetsLevel(target, controller->bandwidthKbps, controller->rttMs, false))
+            target++;
+    } else if (current > VIDESK_QUALITY_LAN &&
+               viDesk_meetsLevel(current - 1, controller->bandwidthKbps, controller->rttMs, true)) {
+        target = current - 1;
+    }
+
+    if (target == current) {
+        controller->candidate = current;
+        controller->candidateSamples = 0;
+        pthread_mutex_unlock(&controller->lock);
+        return false;
+    }
+
+    if (target != controller->candidate) {
+        controller->candidate = target;
+        controller->candidateSamples = 0;
+    }
+    controller->candidateSamples++;
+
+    bool downgrade = target > current;
+    uint32_t required = downgrade ? VIDESK_QUALITY_DOWNGRADE_SAMPLES : VIDESK_QUALITY_UPGRADE_SAMPLES;
+    bool dwellElapsed = controller->lastChangeMs == 0 ||
+                        nowMs - controller->lastChangeMs >= VIDESK_QUALITY_MIN_DWELL_MS;
+
+    bool changed = false;
+    if (controller->candidateSamples >= required && dwellElapsed) {
+        char reason[64];
+        snprintf(reason, sizeof(reason), "连续 %u 秒%s", controller->candidateSamples,
+                 downgrade ? "低于当前档位" : "优于目标档位");
+        viDesk_recordDecision(controller, nowMs, target, reason, decision);
+        changed = true;
+    }
+    pthread_mutex_unlock(&controller->lock);
+    return changed;
+}
+
+ViDeskQualityProfile viDesk_qualityControllerProfile(ViDeskQualityController* controller) {
+    if (!controller)
+        return kProfiles[VIDESK_QUALITY_LAN];
+
+    pthread_mutex_lock(&controller->lock);
+    ViDeskQualityProfile profile = kProfiles[controller->level];
+    pthread_mutex_unlock(&controller->lock);
+    return profile;
+}
+
+void viDesk_qualityControllerGetState(ViDeskQualityController* controller, ViDeskQualityState* state) {
+    if (!state)
+        return;
+
+    memset(state, 0, sizeof(*state));
+    state->profile = kProfiles[VIDESK_QUALITY_LAN];
+    if (!controller)
+        return;
+
+    pthread_mutex_lock(&controller->lock);
+    state->enabled = controller->enabled;
+    state->profile = kProfiles[controller->level];
+    state->bandwidthKbps = controller->bandwidthKbps;
+    state->rttMs = controller->rttMs;
+    state->decisions = controller->totalDecisions;
+    pthread_mutex_unlock(&controller->lock);
+}
+
+uint32_t viDesk_qualityControllerDecisions(ViDeskQualityController* controller,
+                                           ViDeskQualityDecision* decisions, uint32_t capacity) {
+    if (!controller || !decisions || capacity == 0)
+        return 0;
+
+    pthread_mutex_lock(&controller->lock);
+    uint32_t count = controller->decisionCount < capacity ? controller->decisionCount : capacity;
+    uint32_t start = (controller->decisionNext + VIDESK_QUALITY_DECISION_HISTORY - count) %
+                     VIDESK_QUALITY_DECISION_HISTORY;
+    for (uint32_t i = 0; i < count; i++)
+        decisions[i] = controller->decisions[(start + i) % VIDESK_QUALITY_DECISION_HISTORY];
+    pthread_mutex_unlock(&controller->lock);
+    return count;
+}
@@ -0,0 +1,45 @@
+#ifndef ViDeskQualityController_h
+#define ViDeskQualityController_h
+
+#include "FreeRDPBridge.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 自适应画质控制器 (桥接层内部使用)
+/// 每秒输入一次测得的带宽和往返时间，平滑后按阈值划分档位。
+/// 降档需要连续 3 秒低于当前档位，升档需要连续 10 秒明显好于目标档位 (带宽高 25%、往返时间低 20%)，
+/// 两次调整之间至少间隔 5 秒，网络在阈值附近波动时档位不会来回切换。
+/// 控制器只做决策，参数由桥接层应用
+typedef struct ViDeskQualityController ViDeskQualityController;
+
+ViDeskQualityController* viDesk_qualityControllerNew(void);
+void viDesk_qualityControllerFree(ViDeskQualityController* controller);
+
+/// 回到最高档并清空平滑值 (新连接开始时调用，保留调整记录)
+void viDesk_qualityControllerReset(ViDeskQualityController* controller);
+
+/// 启用/停用；停用时回到最高档，返回档位是否因此改变 (改变时 decision 中是该次调整)
+bool viDesk_qualityControllerSetEnabled(ViDeskQualityController* controller, bool enabled, uint64_t nowMs,
+                                        ViDeskQualityDecision* decision);
+
+/// 输入一次测量 (为 0 表示未知)，档位改变时返回 true 并填写 decision
+bool viDesk_qualityControllerUpdate(ViDeskQualityController* controller, uint64_t nowMs,
+                                    uint32_t bandwidthKbps, uint32_t rttMs, ViDeskQualityDecision* decision);
+
+/// 当前档位的参数
+ViDeskQualityProfile viDesk_qualityControllerProfile(ViDeskQualityController* controller);
+
+/// 获取状态 (线程安全；resolutionRequests 和 throttledNs 由桥接层填写)
+void viDesk_qualityControllerGetState(ViDeskQualityController* controller, ViDeskQualityState* state);
+
+/// 复制最近的调整记录 (最旧的在前，线程安全)
+uint32_t viDesk_qualityControllerDecisions(ViDeskQualityController* controller,
+                                           ViDeskQualityDecision* decisions, uint32_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskQualityController_h */
@@ -0,0 +1,166 @@
+/**
+ * ViDeskReconnect.c - 保留上下文的快速重连
+ */
+
+#include "ViDeskReconnect.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <winpr/path.h>
+#include <freerdp/settings.h>
+
+struct ViDeskReconnect {
+    char* cacheFile;                    // GFX 持久缓存文件 (本会话独占，释放时删除)
+
+    atomic_bool hasCookie;
+    _Atomic uint32_t drops;
+    _Atomic uint32_t attempts;
+    _Atomic uint32_t reconnects;
+
+    _Atomic uint64_t dropNs;            // 本次掉线的时刻 (0 表示连接正常)
+    _Atomic uint64_t connectedNs;       // 重连完成、等待第一帧的时刻 (0 表示不在等待)
+    _Atomic uint64_t lastAttemptNs;
+    _Atomic uint64_t lastDropToConnectNs;
+    _Atomic uint64_t lastDropToFirstFrameNs;
+    _Atomic uint64_t totalDropToFirstFrameNs;
+};
+
+static uint64_t viDesk_reconnectNowNs(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+ViDeskReconnect* viDesk_reconnectNew(void) {
+    return (ViDeskReconnect*)calloc(1, sizeof(ViDeskReconnect));
+}
+
+void viDesk_reconnectFree(ViDeskReconnect* reconnect) {
+    if (!reconnect)
+        return;
+
+    if (reconnect->cacheFile) {
+        winpr_DeleteFile(reconnect->cacheFile);
+        free(reconnect->cacheFile);
+    }
+    free(reconnect);
+}
+
+bool viDesk_reconnectPrepare(ViDeskReconnect* reconnect, rdpContext* context) {
+    if (!reconnect || !context || !context->settings)
+        return false;
+
+    rdpSettings* settings = context->settings;
+
+    // 新的连接：丢弃上一次未恢复的掉线计时
+    atomic_store(&reconnect->dropNs, 0);
+    atomic_store(&reconnect->connectedNs, 0);
+
+    // 只是让服务器下发 cookie 并在重连时发回；FreeRDP 不会自己重连，
+    // 重连由应用层调用 viDesk_reconnectRun 触发
+    if (!freerdp_settings_set_bool(settings, FreeRDP_AutoReconnectionEnabled, TRUE))
+        return false;
+
+    // 缓存文件按会话区分，放在临时目录；只在同一上下文的重连之间复用，新建上下文从空缓存开始
+    if (!reconnect->cacheFile) {
+        char* temp = GetKnownPath(KNOWN_PATH_TEMP);
+        if (!temp)
+            return false;
+
+        char name[64];
+        snprintf(name, sizeof(name), "videsk-gfx-%d-%p.cache", (int)getpid(), (void*)reconnect);
+        reconnect->cacheFile = GetCombinedPath(temp, name);
+        free(temp);
+        if (!reconnect->cacheFile)
+            return false;
+        winpr_DeleteFile(reconnect->cacheFile);
+    }
+
+    if (!freerdp_settings_set_string(settings, FreeRDP_BitmapCachePersistFile, reconnect->cacheFile))
+        return false;
+    return freerdp_settings_set_bool(settings, FreeRDP_BitmapCachePersistEnabled, TRUE);
+}
+
+void viDesk_reconnectRecordDrop(ViDeskReconnect* reconnect, rdpContext* context, uint64_t nowNs) {
+    if (!reconnect)
+        return;
+
+    uint64_t expected = 0;
+    if (!atomic_compare_exchange_strong(&reconnect->dropNs, &expected, nowNs))
+        return;
+
+    atomic_fetch_add(&reconnect->drops, 1);
+    atomic_store(&reconnect->connectedNs, 0);
+
+    // 服务器在 Save Session Info (登录信息扩展) 中下发 cookie，没有时重连会重新登录
+    bool hasCookie = false;
+    if (context && context->settings) {
+        const ARC_SC_PRIVATE_PACKET* cookie = (const ARC_SC_PRIVATE_PACKET*)freerdp_settings_get_pointer(
+            context->settings, FreeRDP_ServerAutoReconnectCookie);
+        hasCookie = cookie && cookie->cbLen > 0;
+    }
+    atomic_store(&reconnect->hasCookie, hasCookie);
+}
+
+bool viDesk_reconnectRun(ViDeskReconnect* reconnect, rdpContext* context) {
+    if (!reconnect || !context || !context->instance)
+        return false;
+
+    uint64_t start = viDesk_reconnectNowNs();
+
+    // 没有检测到掉线 (如手动触发) 时从现在开始计时
+    uint64_t expected = 0;
+    atomic_compare_exchange_strong(&reconnect->dropNs, &expected, start);
+    atomic_fetch_add(&reconnect->attempts, 1);
+
+    BOOL ok = freerdp_reconnect(context->instance);
+
+    uint64_t end = viDesk_reconnectNowNs();
+    atomic_store(&reconnect->lastAttemptNs, end - start);
+    if (!ok)
+        return false;
+
+    atomic_fetch_add(&reconnect->reconnects, 1);
+    atomic_store(&reconnect->lastDropToConnectNs, end - atomic_load(&reconnect->dropNs));
+    atomic_store(&reconnect->connectedNs, end);
+    return true;
+}
+
+bool viDesk_reconnectRecordFrame(ViDeskReconnect* reconnect, uint64_t nowNs, uint64_t* dropToFrameNs) {
+    if (!reconnect || atomic_load_explicit(&reconnect->connectedNs, memory_order_relaxed) == 0)
+        return false;
+
+    if (atomic_exchange(&reconnect->connectedNs, 0) == 0)
+        return false;
+
+    uint64_t drop = atomic_exchange(&reconnect->dropNs, 0);
+    uint64_t elapsed = drop && nowNs > drop ? nowNs - drop : 0;
+    atomic_store(&reconnect->lastDropToFirstFrameNs, elapsed);
+    atomic_fetch_add(&reconnect->totalDropToFirstFrameNs, elapsed);
+    if (dropToFrameNs)
+        *dropToFrameNs = elapsed;
+    return true;
+}
+
+void viDesk_reconnectGetStats(ViDeskReconnect* reconnect, ViDeskReconnectStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!reconnect)
+        return;
+
+    stats->pending = atomic_load(&reconnect->dropNs) != 0;
+    stats->hasCookie = atomic_load(&reconnect->hasCookie);
+    stats->drops = atomic_load(&reconnect->drops);
+    stats->attempts = atomic_load(&reconnect->attempts);
+    stats->reconnects = atomic_load(&reconnect->reconnects);
+    stats->lastAttemptNs = atomic_load(&reconnect->lastAttemptNs);
+    stats->lastDropToConnectNs = atomic_load(&reconnect->lastDropToConnectNs);
+    stats->lastDropToFirstFrameNs = atomic_load(&reconnect->lastDropToFirstFrameNs);
+    stats->totalDropToFirstFrameNs = atomic_load(&reconnect->totalDropToFirstFrameNs);
+}
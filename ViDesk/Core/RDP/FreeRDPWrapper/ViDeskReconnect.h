@@ -0,0 +1,42 @@
+#ifndef ViDeskReconnect_h
+#define ViDeskReconnect_h
+
+#include "FreeRDPBridge.h"
+#include <freerdp/freerdp.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 掉线后的快速重连 (桥接层内部使用)
+/// 不销毁 rdpContext，直接调用 freerdp_reconnect 在原上下文上重新建立连接：
+/// - 设置、GDI 帧缓冲区和通道插件都保留，不重新走 PreConnect/PostConnect
+/// - 服务器在登录时下发的自动重连 cookie 保存在设置中，重连时随 Client Info 发回，服务器直接恢复原会话
+/// - 打开 GFX 持久缓存：通道关闭时 rdpgfx 把缓存槽写入本会话的临时文件，
+///   重新打开后通过 Cache Import Offer 告诉服务器哪些位图仍在客户端，服务器不必重发
+/// 同时记录掉线、重连完成和重连后第一帧的时间
+typedef struct ViDeskReconnect ViDeskReconnect;
+
+ViDeskReconnect* viDesk_reconnectNew(void);
+void viDesk_reconnectFree(ViDeskReconnect* reconnect);
+
+/// 打开自动重连 cookie 和 GFX 持久缓存 (PreConnect 中调用)
+bool viDesk_reconnectPrepare(ViDeskReconnect* reconnect, rdpContext* context);
+
+/// 记录掉线 (事件处理线程检测到连接错误时调用)，恢复前重复调用只保留第一次的时间
+void viDesk_reconnectRecordDrop(ViDeskReconnect* reconnect, rdpContext* context, uint64_t nowNs);
+
+/// 在原上下文上重连一次 (阻塞到连接完成或失败)
+bool viDesk_reconnectRun(ViDeskReconnect* reconnect, rdpContext* context);
+
+/// 帧更新时调用：重连后的第一帧结束本次掉线的计时，返回 true 并给出掉线到第一帧的时间
+bool viDesk_reconnectRecordFrame(ViDeskReconnect* reconnect, uint64_t nowNs, uint64_t* dropToFrameNs);
+
+/// 获取统计 (线程安全)
+void viDesk_reconnectGetStats(ViDeskReconnect* reconnect, ViDeskReconnectStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskReconnect_h */
@@ -0,0 +1,278 @@
+/**
+ * ViDeskSendScheduler.c - 出站发送调度实现
+ *
+ * FreeRDP 默认在一次 SendChannelData 调用中把整条消息按 VCChunkSize 切片后连续写出，
+ * 50 MB 的剪贴板数据会长时间占住传输层写锁和 socket 发送缓冲，输入和帧确认只能排在后面。
+ * 这里把大消息放入队列，事件线程每轮通过 SendChannelPacket 只写出一个分片，
+ * 分片之间事件线程会处理入站数据 (帧确认随之发出)，输入线程也能拿到写锁。
+ */
+
+#include "ViDeskSendScheduler.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include <freerdp/settings.h>
+#include <freerdp/channels/channels.h>
+#include <winpr/wtsapi.h>
+
+// 超过此大小的消息进入队列分片发送
+#define VIDESK_BULK_THRESHOLD (16 * 1024)
+
+// 每轮事件循环最多写出的字节数
+#define VIDESK_BULK_SLICE_BYTES (16 * 1024)
+
+typedef struct ViDeskOutboundMessage {
+    struct ViDeskOutboundMessage* next;
+    UINT16 channelId;
+    UINT32 channelFlags;    // CHANNEL_FLAG_SHOW_PROTOCOL 等按通道固定的标志
+    BYTE* data;
+    size_t size;
+    size_t offset;          // 已发送字节数
+} ViDeskOutboundMessage;
+
+struct ViDeskSendScheduler {
+    freerdp* instance;
+    pSendChannelData next;
+
+    // 队列锁：分片写出期间一直持有，只有事件线程和断开路径会竞争
+    CRITICAL_SECTION lock;
+    HANDLE pendingEvent;
+    ViDeskOutboundMessage* head;
+    ViDeskOutboundMessage* tail;
+
+    // 统计单独加锁，输入线程记录耗时时不必等待正在写出的分片
+    CRITICAL_SECTION statsLock;
+    ViDeskSendStats stats;
+};
+
+// 与 freerdp_channel_send 一致：声明了 SHOW_PROTOCOL 的通道每个分片都带该标志
+static UINT32 viDesk_channelFlags(freerdp* instance, UINT16 channelId) {
+    const char* name = freerdp_channels_get_name_by_id(instance, channelId);
+    rdpSettings* settings = instance->context ? instance->context->settings : NULL;
+    if (!name || !settings)
+        return 0;
+
+    UINT32 count = freerdp_settings_get_uint32(settings, FreeRDP_ChannelCount);
+    for (UINT32 i = 0; i < count; i++) {
+        const CHANNEL_DEF* def = freerdp_settings_get_pointer_array(settings, FreeRDP_ChannelDefArray, i);
+        if (def && strncmp(def->name, name, CHANNEL_NAME_LEN) == 0)
+            return (def->options & CHANNEL_OPTION_SHOW_PROTOCOL) ? CHANNEL_FLAG_SHOW_PROTOCOL : 0;
+    }
+    return 0;
+}
+
+// 调用者持有锁
+static BOOL viDesk_channelHasPending(ViDeskSendScheduler* scheduler, UINT16 channelId) {
+    for (ViDeskOutboundMessage* msg = scheduler->head; msg; msg = msg->next) {
+        if (msg->channelId == channelId)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+ViDeskSendScheduler* viDesk_sendSchedulerNew(freerdp* instance, pSendChannelData next) {
+    if (!instance || !next)
+        return NULL;
+
+    ViDeskSendScheduler* scheduler = (ViDeskSendScheduler*)calloc(1, sizeof(ViDeskSendScheduler));
+    if (!scheduler)
+        return NULL;
+
+    scheduler->pendingEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (!scheduler->pendingEvent ||
+        !InitializeCriticalSectionAndSpinCount(&scheduler->lock, 4000)) {
+        if (scheduler->pendingEvent)
+            CloseHandle(scheduler->pendingEvent);
+        free(scheduler);
+        return NULL;
+    }
+    if (!InitializeCriticalSectionAndSpinCount(&scheduler->statsLock, 4000)) {
+        DeleteCriticalSection(&scheduler->lock);
+        CloseHandle(scheduler->pendingEvent);
+        free(scheduler);
+        return NULL;
+    }
+
+    scheduler->instance = instance;
+    scheduler->next = next;
+    return scheduler;
+}
+
+void viDesk_sendSchedulerFree(ViDeskSendScheduler* scheduler) {
+    if (!scheduler)
+        return;
+
+    viDesk_sendSchedulerClear(scheduler);
+    DeleteCriticalSection(&scheduler->statsLock);
+    DeleteCriticalSection(&scheduler->lock);
+    CloseHandle(scheduler->pendingEvent);
+    free(scheduler);
+}
+
+BOOL viDesk_sendSchedulerSubmit(ViDeskSendScheduler* scheduler, UINT16 channelId,
+                                const BYTE* data, size_t size) {
+    if (!scheduler)
+        return FALSE;
+
+    EnterCriticalSection(&scheduler->lock);
+
+    // 小消息直接发送；同一通道上已有排队消息时必须排在其后，保证通道内顺序
+    if (size <= VIDESK_BULK_THRESHOLD && !viDesk_channelHasPending(scheduler, channelId)) {
+        LeaveCriticalSection(&scheduler->lock);
+        return scheduler->next(scheduler->instance, channelId, data, size);
+    }
+
+    ViDeskOutboundMessage* msg = (ViDeskOutboundMessage*)calloc(1, sizeof(ViDeskOutboundMessage));
+    BYTE* copy = size > 0 ? (BYTE*)malloc(size) : NULL;
+    if (!msg || (size > 0 && !copy)) {
+        LeaveCriticalSection(&scheduler->lock);
+        free(msg);
+        free(copy);
+        return FALSE;
+    }
+
+    if (size > 0)
+        memcpy(copy, data, size);
+    msg->channelId = channelId;
+    msg->channelFlags = viDesk_channelFlags(scheduler->instance, channelId);
+    msg->data = copy;
+    msg->size = size;
+
+    if (scheduler->tail)
+        scheduler->tail->next = msg;
+    else
+        scheduler->head = msg;
+    scheduler->tail = msg;
+
+    EnterCriticalSection(&scheduler->statsLock);
+    scheduler->stats.bulkMessages++;
+    scheduler->stats.bulkBytesQueued += size;
+    LeaveCriticalSection(&scheduler->statsLock);
+    SetEvent(scheduler->pendingEvent);
+
+    LeaveCriticalSection(&scheduler->lock);
+    return TRUE;
+}
+
+BOOL viDesk_sendSchedulerDrain(ViDeskSendScheduler* scheduler) {
+    if (!scheduler)
+        return TRUE;
+
+    rdpSettings* settings = scheduler->instance->context->settings;
+    size_t chunkSize = freerdp_settings_get_uint32(settings, FreeRDP_VCChunkSize);
+    if (chunkSize == 0)
+        chunkSize = CHANNEL_CHUNK_LENGTH;
+
+    size_t budget = VIDESK_BULK_SLICE_BYTES;
+    BOOL result = TRUE;
+
+    EnterCriticalSection(&scheduler->lock);
+    while (scheduler->head && budget > 0) {
+        ViDeskOutboundMessage* msg = scheduler->head;
+
+        size_t remaining = msg->size - msg->offset;
+        size_t length = remaining > chunkSize ? chunkSize : remaining;
+
+        UINT32 flags = msg->channelFlags;
+        if (msg->offset == 0)
+            flags |= CHANNEL_FLAG_FIRST;
+        if (length == remaining)
+            flags |= CHANNEL_FLAG_LAST;
+
+        if (!scheduler->instance->SendChannelPacket(scheduler->instance, msg->channelId, msg->size,
+                                                    flags, msg->data + msg->offset, length)) {
+            result = FALSE;
+            break;
+        }
+
+        msg->offset += length;
+        budget = budget > length ? budget - length : 0;
+        EnterCriticalSection(&scheduler->statsLock);
+        scheduler->stats.bulkBytesQueued -= length;
+        scheduler->stats.bulkBytesSent += length;
+        LeaveCriticalSection(&scheduler->statsLock);
+
+        if (msg->offset >= msg->size) {
+            scheduler->head = msg->next;
+            if (!scheduler->head)
+                scheduler->tail = NULL;
+            free(msg->data);
+            free(msg);
+        }
+    }
+
+    if (!scheduler->head)
+        ResetEvent(scheduler->pendingEvent);
+    LeaveCriticalSection(&scheduler->lock);
+
+    return result;
+}
+
+void viDesk_sendSchedulerClear(ViDeskSendScheduler* scheduler) {
+    if (!scheduler)
+        return;
+
+    EnterCriticalSection(&scheduler->lock);
+    ViDeskOutboundMessage* msg = scheduler->head;
+    while (msg) {
+        ViDeskOutboundMessage* next = msg->next;
+        free(msg->data);
+        free(msg);
+        msg = next;
+    }
+    scheduler->head = NULL;
+    scheduler->tail = NULL;
+    EnterCriticalSection(&scheduler->statsLock);
+    scheduler->stats.bulkBytesQueued = 0;
+    LeaveCriticalSection(&scheduler->statsLock);
+    ResetEvent(scheduler->pendingEvent);
+    LeaveCriticalSection(&scheduler->lock);
+}
+
+HANDLE viDesk_sendSchedulerEvent(ViDeskSendScheduler* scheduler) {
+    return scheduler ? scheduler->pendingEvent : NULL;
+}
+
+void viDesk_sendSchedulerRecordInput(ViDeskSendScheduler* scheduler, uint64_t elapsedNs) {
+    if (!scheduler)
+        return;
+
+    EnterCriticalSection(&scheduler->statsLock);
+    ViDeskSendStats* stats = &scheduler->stats;
+    stats->inputEvents++;
+    stats->inputSendTotalNs += elapsedNs;
+    if (elapsedNs > stats->inputSendMaxNs)
+        stats->inputSendMaxNs = elapsedNs;
+
+    if (stats->bulkBytesQueued > 0) {
+        stats->inputEventsDuringBulk++;
+        stats->inputSendDuringBulkTotalNs += elapsedNs;
+        if (elapsedNs > stats->inputSendDuringBulkMaxNs)
+            stats->inputSendDuringBulkMaxNs = elapsedNs;
+    }
+    LeaveCriticalSection(&scheduler->statsLock);
+}
+
+void viDesk_sendSchedulerGetStats(ViDeskSendScheduler* scheduler, ViDeskSendStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!scheduler)
+        return;
+
+    EnterCriticalSection(&scheduler->statsLock);
+    *stats = scheduler->stats;
+    LeaveCriticalSection(&scheduler->statsLock);
+}
+
+void viDesk_sendSchedulerResetStats(ViDeskSendScheduler* scheduler) {
+    if (!scheduler)
+        return;
+
+    EnterCriticalSection(&scheduler->statsLock);
+    uint64_t queued = scheduler->stats.bulkBytesQueued;
+    memset(&scheduler->stats, 0, sizeof(scheduler->stats));
+    scheduler->stats.bulkBytesQueued = queued;
+    LeaveCriticalSection(&scheduler->statsLock);
+}
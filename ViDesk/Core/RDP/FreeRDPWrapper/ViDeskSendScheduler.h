@@ -0,0 +1,49 @@
+#ifndef ViDeskSendScheduler_h
+#define ViDeskSendScheduler_h
+
+#include "FreeRDPBridge.h"
+
+#include <freerdp/freerdp.h>
+#include <winpr/synch.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 出站发送调度器 (桥接层内部使用)
+/// 小消息 (输入之外的所有控制 PDU、DRDYNVC 上的 GFX 帧确认等) 直接发送；
+/// 超过阈值的静态虚拟通道消息 (如大段剪贴板数据) 进入队列，
+/// 由事件线程每轮只发送一小片，输入和帧确认得以穿插在分片之间
+typedef struct ViDeskSendScheduler ViDeskSendScheduler;
+
+/// 创建调度器，next 为 FreeRDP 默认的 SendChannelData
+ViDeskSendScheduler* viDesk_sendSchedulerNew(freerdp* instance, pSendChannelData next);
+
+/// 销毁调度器并丢弃未发送的数据
+void viDesk_sendSchedulerFree(ViDeskSendScheduler* scheduler);
+
+/// 提交一条通道消息 (替代 instance->SendChannelData)
+BOOL viDesk_sendSchedulerSubmit(ViDeskSendScheduler* scheduler, UINT16 channelId,
+                                const BYTE* data, size_t size);
+
+/// 发送一个分片，队列为空时什么都不做
+BOOL viDesk_sendSchedulerDrain(ViDeskSendScheduler* scheduler);
+
+/// 丢弃所有排队的消息 (断开连接时调用)
+void viDesk_sendSchedulerClear(ViDeskSendScheduler* scheduler);
+
+/// 队列非空时处于有信号状态，供事件循环等待
+HANDLE viDesk_sendSchedulerEvent(ViDeskSendScheduler* scheduler);
+
+/// 记录一次输入发送耗时 (从调用 freerdp_input_send_* 到返回)
+void viDesk_sendSchedulerRecordInput(ViDeskSendScheduler* scheduler, uint64_t elapsedNs);
+
+/// 获取/重置统计
+void viDesk_sendSchedulerGetStats(ViDeskSendScheduler* scheduler, ViDeskSendStats* stats);
+void viDesk_sendSchedulerResetStats(ViDeskSendScheduler* scheduler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskSendScheduler_h */
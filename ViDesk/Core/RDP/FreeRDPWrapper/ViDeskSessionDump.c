@@ -0,0 +1,139 @@
+/**
+ * ViDeskSessionDump.c - 会话录制与回放
+ */
+
+#include "ViDeskSessionDump.h"
+#include <stdio.h>
+#include <string.h>
+#include <freerdp/settings.h>
+#include <freerdp/streamdump.h>
+#include <freerdp/codec/bulk.h>
+#include <winpr/stream.h>
+
+// 单条记录的初始缓冲区，stream_dump_get 按需扩容
+#define VIDESK_SESSION_DUMP_INITIAL_CAPACITY (64u * 1024u)
+
+bool viDesk_sessionDumpConfigure(rdpContext* context, ViDeskSessionDumpMode mode, const char* path) {
+    if (!context || !context->settings)
+        return false;
+
+    rdpSettings* settings = context->settings;
+    if (mode == VIDESK_SESSION_DUMP_OFF) {
+        freerdp_settings_set_bool(settings, FreeRDP_TransportDump, FALSE);
+        freerdp_settings_set_bool(settings, FreeRDP_TransportDumpReplay, FALSE);
+        return true;
+    }
+
+    if (!path || !*path)
+        return false;
+
+    if (mode == VIDESK_SESSION_DUMP_CAPTURE) {
+        // stream_dump_append 以追加方式打开文件，先截断，避免和上一次录制混在一起
+        FILE* fp = fopen(path, "wb");
+        if (!fp)
+            return false;
+        fclose(fp);
+    } else {
+        FILE* fp = fopen(path, "rb");
+        if (!fp)
+            return false;
+        fclose(fp);
+    }
+
+    if (!freerdp_settings_set_string(settings, FreeRDP_TransportDumpFile, path))
+        return false;
+
+    bool replay = mode == VIDESK_SESSION_DUMP_REPLAY;
+    freerdp_settings_set_bool(settings, FreeRDP_TransportDump, !replay);
+    freerdp_settings_set_bool(settings, FreeRDP_TransportDumpReplay, replay);
+    // 回放不按录制时的时间戳等待，测的是解码吞吐量而不是原始会话的节奏
+    freerdp_settings_set_bool(settings, FreeRDP_TransportDumpReplayNodelay, replay);
+    return true;
+}
+
+// 快速路径输出 (MS-RDPBCGR 2.2.9.1.2)：fpOutputHeader 低 2 位为 0，高 2 位为安全标志；
+// 长度 1~2 字节，之后是若干更新，每个更新的头字节高 2 位为压缩标志，使用压缩时后跟 compressionFlags
+#define VIDESK_FASTPATH_ACTION_MASK         0x03
+#define VIDESK_FASTPATH_OUTPUT_ENCRYPTED    0x80
+#define VIDESK_FASTPATH_COMPRESSION_USED    0x02
+#define VIDESK_BULK_TYPE_MASK               0x0F
+
+// 统计一个服务器 PDU 中压缩过的快速路径更新，按 PACKET_COMPR_TYPE_* 计数
+// 慢速路径 PDU 和加密的快速路径 PDU (标准 RDP 安全层) 不解析
+static void viDesk_sessionDumpCountCompression(const BYTE* data, size_t length, uint32_t counts[4]) {
+    if (length < 2 || (data[0] & VIDESK_FASTPATH_ACTION_MASK) != 0 || (data[0] & VIDESK_FASTPATH_OUTPUT_ENCRYPTED))
+        return;
+
+    size_t offset = 2;
+    if (data[1] & 0x80) {
+        if (length < 3)
+            return;
+        offset = 3;
+    }
+
+    while (offset + 1 <= length) {
+        BYTE header = data[offset++];
+        BYTE compressionFlags = 0;
+        if ((header >> 6) & VIDESK_FASTPATH_COMPRESSION_USED) {
+            if (offset + 1 > length)
+                return;
+            compressionFlags = data[offset++];
+        }
+        if (offset + 2 > length)
+            return;
+        size_t size = (size_t)data[offset] | ((size_t)data[offset + 1] << 8);
+        offset += 2 + size;
+
+        BYTE type = compressionFlags & VIDESK_BULK_TYPE_MASK;
+        if ((compressionFlags & PACKET_COMPRESSED) && type <= PACKET_COMPR_TYPE_RDP61)
+            counts[type]++;
+    }
+}
+
+bool viDesk_sessionDumpInspect(rdpContext* context, ViDeskSessionDumpInfo* info) {
+    if (!info)
+        return false;
+
+    memset(info, 0, sizeof(*info));
+    if (!context || !context->dump)
+        return false;
+
+    wStream* s = Stream_New(NULL, VIDESK_SESSION_DUMP_INITIAL_CAPACITY);
+    if (!s)
+        return false;
+
+    uint32_t compressionCounts[4] = { 0 };
+    size_t offset = 0;
+    for (;;) {
+        UINT32 flags = 0;
+        UINT64 pts = 0;
+        Stream_SetPosition(s, 0);
+        if (stream_dump_get(context, &flags, s, &offset, &pts) < 0)
+            break;
+
+        uint64_t length = Stream_GetPosition(s);
+        info->records++;
+        if (flags & STREAM_MSG_SRV_TX) {
+            info->serverRecords++;
+            info->serverBytes += length;
+            viDesk_sessionDumpCountCompression(Stream_Buffer(s), length, compressionCounts);
+        } else {
+            info->clientRecords++;
+            info->clientBytes += length;
+        }
+    }
+
+    Stream_Free(s, TRUE);
+
+    // 服务器在一次连接中只用一种算法，取出现最多的那种
+    info->compressionLevel = VIDESK_COMPRESSION_NONE;
+    uint32_t most = 0;
+    for (uint32_t type = 0; type < 4; type++) {
+        info->compressedUpdates += compressionCounts[type];
+        if (compressionCounts[type] > most) {
+            most = compressionCounts[type];
+            info->compressionLevel = (ViDeskCompressionLevel)(type + 1);
+        }
+    }
+    return info->serverRecords > 0;
+}
@@ -0,0 +1,29 @@
+#ifndef ViDeskSessionDump_h
+#define ViDeskSessionDump_h
+
+#include "FreeRDPBridge.h"
+#include <freerdp/freerdp.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 会话录制与回放 (桥接层内部使用)
+/// 基于 FreeRDP 的 transport dump：设置 TransportDump / TransportDumpReplay 后，
+/// freerdp_connect 内部调用 stream_dump_register_handlers 替换传输层的读写回调。
+/// 录制时每个 PDU 连同时间戳和方向追加到文件；回放时 TCP/TLS 连接为空操作，
+/// 读取改为从文件按顺序取出服务器发出的 PDU，客户端发出的 PDU 直接丢弃。
+/// 桥接层不自己注册回调，否则会把 dump 回调再包装一层
+
+/// 写入录制/回放设置；录制时清空 path 已有的内容，回放时检查文件可读
+bool viDesk_sessionDumpConfigure(rdpContext* context, ViDeskSessionDumpMode mode, const char* path);
+
+/// 用 stream_dump_get 逐条读取已配置的录制文件，统计各方向的 PDU 数和字节数
+/// 文件为空或第一条记录就无法读取时返回 false
+bool viDesk_sessionDumpInspect(rdpContext* context, ViDeskSessionDumpInfo* info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskSessionDump_h */
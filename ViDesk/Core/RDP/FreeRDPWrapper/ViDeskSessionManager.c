@@ -0,0 +1,420 @@
+/**
+ * ViDeskSessionManager.c - 多会话共享调度实现
+ *
+ * 调度线程统一等待所有空闲会话的事件句柄，句柄就绪后把会话放入就绪队列；
+ * 工作线程从队列中取会话执行 viDesk_processPendingEvents。
+ * 同一会话同一时刻只在一个工作线程上处理，因此 FreeRDP 的单线程假设保持不变。
+ */
+
+#include "ViDeskSessionManager.h"
+#include "ViDeskThreadRoles.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <winpr/synch.h>
+
+// 调度线程的等待超时 (毫秒)，超时后所有会话都会被调度一次以处理定时任务
+#define VIDESK_DISPATCH_TIMEOUT_MS 100
+
+// 句柄放不下时，未参与等待的会话按此间隔轮询 (毫秒)
+#define VIDESK_DISPATCH_POLL_MS 10
+
+// 有后台会话在排队时，焦点会话最多连续被调度这么多次，之后让出一次给最早就绪的后台会话，
+// 避免焦点会话持续有数据时 (如播放视频) 后台会话饿死
+#define VIDESK_FOCUSED_BURST 4
+
+typedef struct {
+    ViDeskContext* ctx;
+    uint64_t reservation;   // 接纳时预留的内存上限
+    bool used;
+    bool running;           // 已连接，参与调度
+    bool queued;            // 在就绪队列中
+    bool busy;              // 正在某个工作线程上处理
+    bool waiting;           // 句柄正在被调度线程等待
+    bool closed;            // 会话已断开，不再调度
+    uint64_t readySinceNs;  // 进入就绪队列的时间，用于同优先级 FIFO
+} ViDeskManagedSession;
+
+struct ViDeskSessionManager {
+    pthread_mutex_t lock;
+    pthread_cond_t workCond;    // 有会话进入就绪队列
+    pthread_cond_t idleCond;    // 有会话离开 busy/waiting 状态
+    HANDLE wakeEvent;           // 唤醒调度线程重新收集句柄
+
+    pthread_t dispatcher;
+    pthread_t* workers;
+    uint32_t workerCount;
+    bool dispatcherStarted;
+    uint32_t workersStarted;
+    bool stopping;
+
+    ViDeskManagedSession sessions[VIDESK_MAX_MANAGED_SESSIONS];
+    ViDeskContext* focused;
+
+    uint64_t memoryBudget;
+    uint64_t reservedBytes;
+    uint64_t dispatchCount;
+    uint64_t focusedDispatchCount;
+    uint32_t focusedStreak;     // 后台会话排队期间焦点会话连续被调度的次数
+};
+
+static uint64_t viDesk_managerNowNs(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static ViDeskManagedSession* viDesk_findSession(ViDeskSessionManager* mgr, ViDeskContext* ctx) {
+    for (int i = 0; i < VIDESK_MAX_MANAGED_SESSIONS; i++) {
+        if (mgr->sessions[i].used && mgr->sessions[i].ctx == ctx)
+            return &mgr->sessions[i];
+    }
+    return NULL;
+}
+
+// 调用者持有锁
+static void viDesk_enqueueSession(ViDeskSessionManager* mgr, ViDeskManagedSession* session, uint64_t now) {
+    if (!session->running || session->closed || session->queued || session->busy)
+        return;
+
+    session->queued = true;
+    session->readySinceNs = now;
+    pthread_cond_signal(&mgr->workCond);
+}
+
+// 选出下一个要处理的会话：焦点会话优先，但有后台会话排队时连续 VIDESK_FOCUSED_BURST 次后
+// 让给最早就绪的后台会话；后台会话之间按就绪先后。调用者持有锁
+static ViDeskManagedSession* viDesk_nextReadySession(ViDeskSessionManager* mgr) {
+    ViDeskManagedSession* focused = NULL;
+    ViDeskManagedSession* oldest = NULL;
+    for (int i = 0; i < VIDESK_MAX_MANAGED_SESSIONS; i++) {
+        ViDeskManagedSession* session = &mgr->sessions[i];
+        if (!session->used || !session->queued)
+            continue;
+        if (session->ctx == mgr->focused)
+            focused = session;
+        else if (!oldest || session->readySinceNs < oldest->readySinceNs)
+            oldest = session;
+    }
+
+    if (!oldest) {
+        mgr->focusedStreak = 0;
+        return focused;
+    }
+    if (focused && mgr->focusedStreak < VIDESK_FOCUSED_BURST) {
+        mgr->focusedStreak++;
+        return focused;
+    }
+    mgr->focusedStreak = 0;
+    return oldest;
+}
+
+static void* viDesk_dispatcherThread(void* arg) {
+    ViDeskSessionManager* mgr = (ViDeskSessionManager*)arg;
+
+    HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+    ViDeskManagedSession* owners[MAXIMUM_WAIT_OBJECTS];
+
+    viDesk_enterThreadRole(VIDESK_THREAD_ROLE_NETWORK, true);
+
+    pthread_mutex_lock(&mgr->lock);
+    while (!mgr->stopping) {
+        // 收集所有空闲会话的句柄，0 号句柄固定为唤醒事件
+        DWORD count = 1;
+        bool overflow = false;
+        handles[0] = mgr->wakeEvent;
+        owners[0] = NULL;
+
+        for (int i = 0; i < VIDESK_MAX_MANAGED_SESSIONS; i++) {
+            ViDeskManagedSession* session = &mgr->sessions[i];
+            if (!session->used || !session->running || session->closed ||
+                session->queued || session->busy)
+                continue;
+
+            uint32_t n = viDesk_getEventHandles(session->ctx, (void**)&handles[count],
+                                                MAXIMUM_WAIT_OBJECTS - count);
+            if (n == 0) {
+                // 句柄数组已满，该会话改为轮询
+                overflow = true;
+                continue;
+            }
+            for (uint32_t j = 0; j < n; j++)
+                owners[count + j] = session;
+            count += n;
+            session->waiting = true;
+        }
+        pthread_mutex_unlock(&mgr->lock);
+
+        DWORD timeout = overflow ? VIDESK_DISPATCH_POLL_MS : VIDESK_DISPATCH_TIMEOUT_MS;
+        DWORD status = WaitForMultipleObjects(count, handles, FALSE, timeout);
+
+        pthread_mutex_lock(&mgr->lock);
+        uint64_t now = viDesk_managerNowNs();
+        for (int i = 0; i < VIDESK_MAX_MANAGED_SESSIONS; i++) {
+            ViDeskManagedSession* session = &mgr->sessions[i];
+            if (!session->used || !session->waiting)
+                continue;
+            session->waiting = false;
+
+            // 超时或失败时所有会话都处理一次 (定时器、保活等)
+            if (status == WAIT_TIMEOUT || status == WAIT_FAILED)
+                viDesk_enqueueSession(mgr, session, now);
+        }
+
+        if (status >= WAIT_OBJECT_0 + 1 && status < WAIT_OBJECT_0 + count) {
+            viDesk_enqueueSession(mgr, owners[status - WAIT_OBJECT_0], now);
+        }
+
+        if (overflow) {
+            for (int i = 0; i < VIDESK_MAX_MANAGED_SESSIONS; i++) {
+                if (mgr->sessions[i].used)
+                    viDesk_enqueueSession(mgr, &mgr->sessions[i], now);
+            }
+        }
+
+        pthread_cond_broadcast(&mgr->idleCond);
+    }
+    pthread_mutex_unlock(&mgr->lock);
+
+    viDesk_leaveThreadRole();
+    return NULL;
+}
+
+static void* viDesk_workerThread(void* arg) {
+    ViDeskSessionManager* mgr = (ViDeskSessionManager*)arg;
+
+    viDesk_enterThreadRole(VIDESK_THREAD_ROLE_DECODE, true);
+
+    pthread_mutex_lock(&mgr->lock);
+    while (!mgr->stopping) {
+        ViDeskManagedSession* session = viDesk_nextReadySession(mgr);
+        if (!session) {
+            pthread_cond_wait(&mgr->workCond, &mgr->lock);
+            continue;
+        }
+
+        session->queued = false;
+        session->busy = true;
+        mgr->dispatchCount++;
+        if (session->ctx == mgr->focused)
+            mgr->focusedDispatchCount++;
+        ViDeskContext* ctx = session->ctx;
+        uint64_t readySinceNs = session->readySinceNs;
+        pthread_mutex_unlock(&mgr->lock);
+
+        // 从就绪到被工作线程取走的时间即解码角色的排队等待
+        viDesk_recordThreadRoleWait(VIDESK_THREAD_ROLE_DECODE, viDesk_managerNowNs() - readySinceNs);
+
+        bool alive = viDesk_processPendingEvents(ctx);
+
+        pthread_mutex_lock(&mgr->lock);
+        session->busy = false;
+        if (!alive)
+            session->closed = true;
+        pthread_cond_broadcast(&mgr->idleCond);
+        SetEvent(mgr->wakeEvent);
+    }
+    pthread_mutex_unlock(&mgr->lock);
+
+    viDesk_leaveThreadRole();
+    return NULL;
+}
+
+ViDeskSessionManager* viDesk_createSessionManager(uint32_t workerCount, uint64_t memoryBudget) {
+    if (workerCount == 0)
+        workerCount = 1;
+
+    ViDeskSessionManager* mgr = (ViDeskSessionManager*)calloc(1, sizeof(ViDeskSessionManager));
+    if (!mgr)
+        return NULL;
+
+    mgr->workers = (pthread_t*)calloc(workerCount, sizeof(pthread_t));
+    mgr->wakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (!mgr->workers || !mgr->wakeEvent) {
+        if (mgr->wakeEvent)
+            CloseHandle(mgr->wakeEvent);
+        free(mgr->workers);
+        free(mgr);
+        return NULL;
+    }
+
+    pthread_mutex_init(&mgr->lock, NULL);
+    pthread_cond_init(&mgr->workCond, NULL);
+    pthread_cond_init(&mgr->idleCond, NULL);
+    mgr->workerCount = workerCount;
+    mgr->memoryBudget = memoryBudget;
+
+    if (pthread_create(&mgr->dispatcher, NULL, viDesk_dispatcherThread, mgr) != 0) {
+        viDesk_destroySessionManager(mgr);
+        return NULL;
+    }
+    mgr->dispatcherStarted = true;
+
+    for (uint32_t i = 0; i < workerCount; i++) {
+        if (pthread_create(&mgr->workers[i], NULL, viDesk_workerThread, mgr) != 0) {
+            viDesk_destroySessionManager(mgr);
+            return NULL;
+        }
+        mgr->workersStarted++;
+    }
+
+    return mgr;
+}
+
+void viDesk_destroySessionManager(ViDeskSessionManager* mgr) {
+    if (!mgr)
+        return;
+
+    pthread_mutex_lock(&mgr->lock);
+    mgr->stopping = true;
+    pthread_cond_broadcast(&mgr->workCond);
+    pthread_mutex_unlock(&mgr->lock);
+    SetEvent(mgr->wakeEvent);
+
+    if (mgr->dispatcherStarted)
+        pthread_join(mgr->dispatcher, NULL);
+    for (uint32_t i = 0; i < mgr->workersStarted; i++)
+        pthread_join(mgr->workers[i], NULL);
+
+    CloseHandle(mgr->wakeEvent);
+    pthread_cond_destroy(&mgr->idleCond);
+    pthread_cond_destroy(&mgr->workCond);
+    pthread_mutex_destroy(&mgr->lock);
+    free(mgr->workers);
+    free(mgr);
+}
+
+bool viDesk_sessionManagerAdd(ViDeskSessionManager* mgr, ViDeskContext* ctx, bool focused) {
+    if (!mgr || !ctx)
+        return false;
+
+    pthread_mutex_lock(&mgr->lock);
+
+    if (viDesk_findSession(mgr, ctx)) {
+        pthread_mutex_unlock(&mgr->lock);
+        return true;
+    }
+
+    ViDeskManagedSession* slot = NULL;
+    uint32_t sessionCount = 0;
+    for (int i = 0; i < VIDESK_MAX_MANAGED_SESSIONS; i++) {
+        if (mgr->sessions[i].used)
+            sessionCount++;
+        else if (!slot)
+            slot = &mgr->sessions[i];
+    }
+    if (!slot) {
+        pthread_mutex_unlock(&mgr->lock);
+        return false;
+    }
+
+    // 解码在共享工作线程上进行，不再为每个会话创建编解码线程池
+    viDesk_setSharedWorkers(ctx, true);
+    viDesk_setGfxSmallCache(ctx, false);
+
+    uint64_t reservation = viDesk_getMemoryReservation(ctx);
+    if (mgr->reservedBytes + reservation > mgr->memoryBudget) {
+        viDesk_setGfxSmallCache(ctx, true);
+        reservation = viDesk_getMemoryReservation(ctx);
+    }
+    if (mgr->reservedBytes + reservation > mgr->memoryBudget && !focused && sessionCount > 0) {
+        viDesk_setGfxSmallCache(ctx, false);
+        pthread_mutex_unlock(&mgr->lock);
+        return false;
+    }
+
+    memset(slot, 0, sizeof(*slot));
+    slot->used = true;
+    slot->ctx = ctx;
+    slot->reservation = reservation;
+    mgr->reservedBytes += reservation;
+
+    pthread_mutex_unlock(&mgr->lock);
+    return true;
+}
+
+bool viDesk_sessionManagerStart(ViDeskSessionManager* mgr, ViDeskContext* ctx) {
+    if (!mgr || !ctx)
+        return false;
+
+    pthread_mutex_lock(&mgr->lock);
+    ViDeskManagedSession* session = viDesk_findSession(mgr, ctx);
+    if (session) {
+        session->running = true;
+        session->closed = false;
+    }
+    pthread_mutex_unlock(&mgr->lock);
+
+    if (session)
+        SetEvent(mgr->wakeEvent);
+    return session != NULL;
+}
+
+void viDesk_sessionManagerRemove(ViDeskSessionManager* mgr, ViDeskContext* ctx) {
+    if (!mgr || !ctx)
+        return;
+
+    pthread_mutex_lock(&mgr->lock);
+    ViDeskManagedSession* session = viDesk_findSession(mgr, ctx);
+    if (session) {
+        session->running = false;
+        session->queued = false;
+
+        // 等待工作线程处理完毕、调度线程放开其句柄
+        while (session->busy || session->waiting) {
+            SetEvent(mgr->wakeEvent);
+            pthread_cond_wait(&mgr->idleCond, &mgr->lock);
+        }
+
+        mgr->reservedBytes -= session->reservation;
+        memset(session, 0, sizeof(*session));
+    }
+    if (mgr->focused == ctx)
+        mgr->focused = NULL;
+    pthread_mutex_unlock(&mgr->lock);
+}
+
+void viDesk_sessionManagerSetFocused(ViDeskSessionManager* mgr, ViDeskContext* ctx) {
+    if (!mgr)
+        return;
+
+    pthread_mutex_lock(&mgr->lock);
+    mgr->focused = ctx;
+    pthread_mutex_unlock(&mgr->lock);
+}
+
+void viDesk_sessionManagerGetStats(ViDeskSessionManager* mgr, ViDeskSessionManagerStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!mgr)
+        return;
+
+    pthread_mutex_lock(&mgr->lock);
+    stats->workerCount = mgr->workerCount;
+    stats->memoryBudget = mgr->memoryBudget;
+    stats->reservedBytes = mgr->reservedBytes;
+    stats->dispatchCount = mgr->dispatchCount;
+    stats->focusedDispatchCount = mgr->focusedDispatchCount;
+
+    for (int i = 0; i < VIDESK_MAX_MANAGED_SESSIONS; i++) {
+        ViDeskManagedSession* session = &mgr->sessions[i];
+        if (!session->used)
+            continue;
+
+        stats->sessionCount++;
+        if (session->running && !session->closed)
+            stats->runningCount++;
+
+        uint64_t frameBytes = 0, gfxBytes = 0;
+        viDesk_getMemoryUsage(session->ctx, &frameBytes, &gfxBytes);
+        stats->frameBufferBytes += frameBytes;
+        stats->gfxCacheBytes += gfxBytes;
+        stats->processingCpuNs += viDesk_getProcessingCpuTime(session->ctx);
+    }
+    pthread_mutex_unlock(&mgr->lock);
+}
@@ -0,0 +1,59 @@
+#ifndef ViDeskSessionManager_h
+#define ViDeskSessionManager_h
+
+#include "FreeRDPBridge.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 同时管理的最大会话数
+#define VIDESK_MAX_MANAGED_SESSIONS 16
+
+/// 多会话管理器
+/// 所有会话共享一个调度线程和一组工作线程 (事件处理和解码都在工作线程上)，
+/// 并按统一的内存预算 (帧缓冲区 + GFX 缓存) 接纳会话。焦点会话优先调度，
+/// 但有后台会话排队时连续调度几次后会让出一次，后台会话不会饿死
+typedef struct ViDeskSessionManager ViDeskSessionManager;
+
+/// 管理器统计快照
+typedef struct {
+    uint32_t sessionCount;      // 已接纳的会话数
+    uint32_t runningCount;      // 正在调度的会话数
+    uint32_t workerCount;       // 共享工作线程数
+    uint64_t memoryBudget;      // 内存预算 (字节)
+    uint64_t reservedBytes;     // 已预留的内存上限 (字节)
+    uint64_t frameBufferBytes;  // 帧缓冲区实际占用 (字节，仅 GDI 主缓冲区)
+    uint64_t gfxCacheBytes;     // GFX 表面和缓存实际占用 (字节)
+    uint64_t processingCpuNs;   // 所有会话的事件处理 CPU 时间 (纳秒)
+    uint64_t dispatchCount;     // 累计调度次数
+    uint64_t focusedDispatchCount;  // 其中焦点会话的调度次数
+} ViDeskSessionManagerStats;
+
+/// 创建管理器并启动调度线程和 workerCount 个工作线程
+ViDeskSessionManager* viDesk_createSessionManager(uint32_t workerCount, uint64_t memoryBudget);
+
+/// 停止所有线程并销毁管理器 (调用前应移除所有会话)
+void viDesk_destroySessionManager(ViDeskSessionManager* mgr);
+
+/// 接纳会话并预留内存 (在 viDesk_connect 之前调用)
+/// 超出预算时后台会话改用 GFX 小缓存，仍超出则拒绝；焦点会话和第一个会话总是接纳
+bool viDesk_sessionManagerAdd(ViDeskSessionManager* mgr, ViDeskContext* ctx, bool focused);
+
+/// 连接成功后开始由共享线程驱动该会话
+bool viDesk_sessionManagerStart(ViDeskSessionManager* mgr, ViDeskContext* ctx);
+
+/// 停止调度并释放预留，阻塞直到工作线程不再访问该会话
+void viDesk_sessionManagerRemove(ViDeskSessionManager* mgr, ViDeskContext* ctx);
+
+/// 设置焦点会话 (NULL 表示无焦点)
+void viDesk_sessionManagerSetFocused(ViDeskSessionManager* mgr, ViDeskContext* ctx);
+
+/// 获取统计快照
+void viDesk_sessionManagerGetStats(ViDeskSessionManager* mgr, ViDeskSessionManagerStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskSessionManager_h */
@@ -0,0 +1,214 @@
+/**
+ * ViDeskSessionStats.c - 会话统计
+ */
+
+#include "ViDeskSessionStats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define VIDESK_STATS_SAMPLE_INTERVAL_NS 1000000000ULL
+
+struct ViDeskSessionStatsTracker {
+    // 事件处理线程累加，其他线程读取
+    _Atomic uint64_t frames;
+    _Atomic uint64_t paints;
+    _Atomic uint64_t decodedBytes;
+    _Atomic uint32_t baseRttMs;
+    _Atomic uint32_t averageRttMs;
+    _Atomic uint32_t bandwidthKbps;
+    _Atomic uint32_t networkUpdates;
+
+    // 以下仅事件处理线程访问：上一个样本时的累计值
+    uint64_t lastSampleNs;
+    uint64_t lastFrames;
+    uint64_t lastPaints;
+    uint64_t lastDecodedBytes;
+    uint64_t lastBytesReceived;
+    uint64_t lastBytesSent;
+
+    // 每秒样本 (环形)，由 lock 保护
+    pthread_mutex_t lock;
+    ViDeskStatsSample samples[VIDESK_STATS_HISTORY_LENGTH];
+    uint32_t sampleCount;
+    uint32_t sampleNext;
+    uint64_t bytesReceived;
+    uint64_t bytesSent;
+};
+
+ViDeskSessionStatsTracker* viDesk_sessionStatsNew(void) {
+    ViDeskSessionStatsTracker* tracker = calloc(1, sizeof(ViDeskSessionStatsTracker));
+    if (!tracker)
+        return NULL;
+
+    pthread_mutex_init(&tracker->lock, NULL);
+    return tracker;
+}
+
+void viDesk_sessionStatsFree(ViDeskSessionStatsTracker* tracker) {
+    if (!tracker)
+        return;
+
+    pthread_mutex_destroy(&tracker->lock);
+    free(tracker);
+}
+
+void viDesk_sessionStatsReset(ViDeskSessionStatsTracker* tracker) {
+    if (!tracker)
+        return;
+
+    atomic_store(&tracker->frames, 0);
+    atomic_store(&tracker->paints, 0);
+    atomic_store(&tracker->decodedBytes, 0);
+    atomic_store(&tracker->baseRttMs, 0);
+    atomic_store(&tracker->averageRttMs, 0);
+    atomic_store(&tracker->bandwidthKbps, 0);
+    atomic_store(&tracker->networkUpdates, 0);
+
+    tracker->lastSampleNs = 0;
+    tracker->lastFrames = 0;
+    tracker->lastPaints = 0;
+    tracker->lastDecodedBytes = 0;
+    tracker->lastBytesReceived = 0;
+    tracker->lastBytesSent = 0;
+
+    pthread_mutex_lock(&tracker->lock);
+    tracker->sampleCount = 0;
+    tracker->sampleNext = 0;
+    tracker->bytesReceived = 0;
+    tracker->bytesSent = 0;
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+void viDesk_sessionStatsRecordFrame(ViDeskSessionStatsTracker* tracker) {
+    if (tracker)
+        atomic_fetch_add_explicit(&tracker->frames, 1, memory_order_relaxed);
+}
+
+void viDesk_sessionStatsRecordPaint(ViDeskSessionStatsTracker* tracker) {
+    if (tracker)
+        atomic_fetch_add_explicit(&tracker->paints, 1, memory_order_relaxed);
+}
+
+void viDesk_sessionStatsRecordDecoded(ViDeskSessionStatsTracker* tracker, uint64_t bytes) {
+    if (tracker)
+        atomic_fetch_add_explicit(&tracker->decodedBytes, bytes, memory_order_relaxed);
+}
+
+void viDesk_sessionStatsRecordNetwork(ViDeskSessionStatsTracker* tracker, uint32_t baseRttMs,
+                                      uint32_t averageRttMs, uint32_t bandwidthKbps) {
+    if (!tracker)
+        return;
+
+    if (baseRttMs > 0)
+        atomic_store(&tracker->baseRttMs, baseRttMs);
+    if (averageRttMs > 0)
+        atomic_store(&tracker->averageRttMs, averageRttMs);
+    if (bandwidthKbps > 0)
+        atomic_store(&tracker->bandwidthKbps, bandwidthKbps);
+    atomic_fetch_add(&tracker->networkUpdates, 1);
+}
+
+bool viDesk_sessionStatsTick(ViDeskSessionStatsTracker* tracker, uint64_t nowNs,
+                             uint64_t bytesReceived, uint64_t bytesSent) {
+    if (!tracker)
+        return false;
+
+    if (tracker->lastSampleNs == 0) {
+        // 第一次调用只建立基准
+        tracker->lastSampleNs = nowNs;
+        tracker->lastFrames = atomic_load(&tracker->frames);
+        tracker->lastPaints = atomic_load(&tracker->paints);
+        tracker->lastDecodedBytes = atomic_load(&tracker->decodedBytes);
+        tracker->lastBytesReceived = bytesReceived;
+        tracker->lastBytesSent = bytesSent;
+        return false;
+    }
+
+    uint64_t elapsed = nowNs - tracker->lastSampleNs;
+    if (elapsed < VIDESK_STATS_SAMPLE_INTERVAL_NS)
+        return false;
+
+    uint64_t frames = atomic_load(&tracker->frames);
+    uint64_t paints = atomic_load(&tracker->paints);
+    uint64_t decoded = atomic_load(&tracker->decodedBytes);
+
+    // 事件循环卡顿时间隔可能超过一秒，按实际间隔折算成每秒
+    ViDeskStatsSample sample = { 0 };
+    sample.timestampMs = nowNs / 1000000ULL;
+    uint64_t gfxFrames = frames - tracker->lastFrames;
+    sample.paints = (uint32_t)((paints - tracker->lastPaints) * VIDESK_STATS_SAMPLE_INTERVAL_NS / elapsed);
+    sample.frames = gfxFrames > 0
+        ? (uint32_t)(gfxFrames * VIDESK_STATS_SAMPLE_INTERVAL_NS / elapsed)
+        : sample.paints;
+    sample.decodedBytes = (decoded - tracker->lastDecodedBytes) * VIDESK_STATS_SAMPLE_INTERVAL_NS / elapsed;
+    if (bytesReceived >= tracker->lastBytesReceived)
+        sample.bytesReceived = (bytesReceived - tracker->lastBytesReceived) * VIDESK_STATS_SAMPLE_INTERVAL_NS / elapsed;
+    if (bytesSent >= tracker->lastBytesSent)
+        sample.bytesSent = (bytesSent - tracker->lastBytesSent) * VIDESK_STATS_SAMPLE_INTERVAL_NS / elapsed;
+    sample.rttMs = atomic_load(&tracker->averageRttMs);
+
+    tracker->lastSampleNs = nowNs;
+    tracker->lastFrames = frames;
+    tracker->lastPaints = paints;
+    tracker->lastDecodedBytes = decoded;
+    tracker->lastBytesReceived = bytesReceived;
+    tracker->lastBytesSent = bytesSent;
+
+    pthread_mutex_lock(&tracker->lock);
+    tracker->samples[tracker->sampleNext] = sample;
+    tracker->sampleNext = (tracker->sampleNext + 1) % VIDESK_STATS_HISTORY_LENGTH;
+    if (tracker->sampleCount < VIDESK_STATS_HISTORY_LENGTH)
+        tracker->sampleCount++;
+    tracker->bytesReceived = bytesReceived;
+    tracker->bytesSent = bytesSent;
+    pthread_mutex_unlock(&tracker->lock);
+    return true;
+}
+
+void viDesk_sessionStatsGet(ViDeskSessionStatsTracker* tracker, ViDeskSessionStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!tracker)
+        return;
+
+    stats->totalFrames = atomic_load(&tracker->frames);
+    stats->totalPaints = atomic_load(&tracker->paints);
+    stats->totalDecodedBytes = atomic_load(&tracker->decodedBytes);
+    stats->averageRttMs = atomic_load(&tracker->averageRttMs);
+    stats->baseRttMs = atomic_load(&tracker->baseRttMs);
+    stats->detectedBandwidthKbps = atomic_load(&tracker->bandwidthKbps);
+    stats->rttUpdates = atomic_load(&tracker->networkUpdates);
+
+    // 没有 GFX 帧时 totalFrames 按 EndPaint 计
+    if (stats->totalFrames == 0)
+        stats->totalFrames = stats->totalPaints;
+
+    pthread_mutex_lock(&tracker->lock);
+    stats->bytesReceived = tracker->bytesReceived;
+    stats->bytesSent = tracker->bytesSent;
+    if (tracker->sampleCount > 0) {
+        uint32_t last = (tracker->sampleNext + VIDESK_STATS_HISTORY_LENGTH - 1) % VIDESK_STATS_HISTORY_LENGTH;
+        stats->frameRate = tracker->samples[last].frames;
+        uint64_t bps = tracker->samples[last].bytesReceived * 8;
+        stats->bandwidthBps = bps > UINT32_MAX ? UINT32_MAX : (uint32_t)bps;
+    }
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+uint32_t viDesk_sessionStatsHistory(ViDeskSessionStatsTracker* tracker, ViDeskStatsSample* samples,
+                                    uint32_t capacity) {
+    if (!tracker || !samples || capacity == 0)
+        return 0;
+
+    pthread_mutex_lock(&tracker->lock);
+    uint32_t count = tracker->sampleCount < capacity ? tracker->sampleCount : capacity;
+    uint32_t start = (tracker->sampleNext + VIDESK_STATS_HISTORY_LENGTH - count) % VIDESK_STATS_HISTORY_LENGTH;
+    for (uint32_t i = 0; i < count; i++)
+        samples[i] = tracker->samples[(start + i) % VIDESK_STATS_HISTORY_LENGTH];
+    pthread_mutex_unlock(&tracker->lock);
+    return count;
+}
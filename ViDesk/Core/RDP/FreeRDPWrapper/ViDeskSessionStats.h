@@ -0,0 +1,49 @@
+#ifndef ViDeskSessionStats_h
+#define ViDeskSessionStats_h
+
+#include "FreeRDPBridge.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 会话统计 (桥接层内部使用)
+/// 帧、解码字节和往返时间由事件处理线程在各回调中累加；
+/// 事件处理线程每秒把累计值折算成一个样本写入固定长度的环形历史，其他线程随时读取
+typedef struct ViDeskSessionStatsTracker ViDeskSessionStatsTracker;
+
+ViDeskSessionStatsTracker* viDesk_sessionStatsNew(void);
+void viDesk_sessionStatsFree(ViDeskSessionStatsTracker* tracker);
+
+/// 清空计数和历史 (新连接开始时调用)
+void viDesk_sessionStatsReset(ViDeskSessionStatsTracker* tracker);
+
+/// 记录一帧 (GFX EndFrame)
+void viDesk_sessionStatsRecordFrame(ViDeskSessionStatsTracker* tracker);
+
+/// 记录一次 EndPaint
+void viDesk_sessionStatsRecordPaint(ViDeskSessionStatsTracker* tracker);
+
+/// 记录交给解码器的图像数据字节数
+void viDesk_sessionStatsRecordDecoded(ViDeskSessionStatsTracker* tracker, uint64_t bytes);
+
+/// 记录网络自动检测结果 (为 0 的字段表示本次结果中无效，保留之前的值)
+void viDesk_sessionStatsRecordNetwork(ViDeskSessionStatsTracker* tracker, uint32_t baseRttMs,
+                                      uint32_t averageRttMs, uint32_t bandwidthKbps);
+
+/// 距上一个样本满一秒时生成新样本并返回 true；bytesReceived/bytesSent 为传输层的累计字节数
+bool viDesk_sessionStatsTick(ViDeskSessionStatsTracker* tracker, uint64_t nowNs,
+                             uint64_t bytesReceived, uint64_t bytesSent);
+
+/// 获取统计 (线程安全)
+void viDesk_sessionStatsGet(ViDeskSessionStatsTracker* tracker, ViDeskSessionStats* stats);
+
+/// 复制最近的样本 (最旧的在前，线程安全)，返回复制的个数
+uint32_t viDesk_sessionStatsHistory(ViDeskSessionStatsTracker* tracker, ViDeskStatsSample* samples,
+                                    uint32_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskSessionStats_h */
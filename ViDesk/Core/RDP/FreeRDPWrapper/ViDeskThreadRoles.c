@@ -0,0 +1,258 @@
+/**
+ * ViDeskThreadRoles.c - 线程角色、调度策略和调度延迟统计
+ */
+
+#define _GNU_SOURCE
+#include "ViDeskThreadRoles.h"
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#if defined(__APPLE__)
+#include <pthread/qos.h>
+#elif defined(__linux__)
+#include <sched.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+typedef struct {
+    _Atomic int priority;
+    _Atomic uint64_t affinityMask;
+} ViDeskThreadPolicy;
+
+typedef struct {
+    _Atomic uint32_t threadCount;
+    _Atomic uint64_t workItems;
+    _Atomic uint64_t busyNs;
+    _Atomic uint64_t cpuNs;
+    _Atomic uint64_t waitNs;
+    _Atomic uint64_t maxWaitNs;
+    _Atomic uint64_t runDelayNs;
+    _Atomic uint64_t maxRunDelayNs;
+} ViDeskThreadRoleCounters;
+
+// 默认策略：网络和合成在交互路径上，解码略低以免饿死网络线程
+static ViDeskThreadPolicy g_policies[VIDESK_THREAD_ROLE_COUNT] = {
+    [VIDESK_THREAD_ROLE_NETWORK] = { VIDESK_THREAD_PRIORITY_USER_INTERACTIVE, 0 },
+    [VIDESK_THREAD_ROLE_DECODE] = { VIDESK_THREAD_PRIORITY_USER_INITIATED, 0 },
+    [VIDESK_THREAD_ROLE_COMPOSITION] = { VIDESK_THREAD_PRIORITY_USER_INTERACTIVE, 0 },
+};
+
+static ViDeskThreadRoleCounters g_counters[VIDESK_THREAD_ROLE_COUNT];
+
+// 当前线程的角色 (-1 表示未进入) 和工作区间起点
+static _Thread_local int t_role = -1;
+static _Thread_local bool t_inWork = false;
+static _Thread_local uint64_t t_workStartNs;
+static _Thread_local uint64_t t_workStartCpuNs;
+
+#if defined(__linux__)
+// 当前线程的 schedstat (进入角色时打开，-1 表示不可用) 和工作区间起点的 run_delay
+static _Thread_local int t_schedstatFd = -1;
+static _Thread_local uint64_t t_workStartRunDelayNs;
+
+// /proc/thread-self/schedstat 为 "CPU 时间 run_delay 时间片数"，第二个字段是累计的运行队列等待 (纳秒)
+static bool viDesk_readRunDelay(uint64_t* runDelayNs) {
+    if (t_schedstatFd < 0)
+        return false;
+
+    char buffer[96];
+    ssize_t length = pread(t_schedstatFd, buffer, sizeof(buffer) - 1, 0);
+    if (length <= 0)
+        return false;
+    buffer[length] = '\0';
+
+    char* end = NULL;
+    strtoull(buffer, &end, 10);
+    if (end == buffer)
+        return false;
+    char* field = end;
+    *runDelayNs = strtoull(field, &end, 10);
+    return end != field;
+}
+#endif
+
+static uint64_t viDesk_roleClockNs(clockid_t clock) {
+    struct timespec ts;
+    if (clock_gettime(clock, &ts) != 0)
+        return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool viDesk_validRole(ViDeskThreadRole role) {
+    return (int)role >= 0 && role < VIDESK_THREAD_ROLE_COUNT;
+}
+
+static void viDesk_updateMax(_Atomic uint64_t* target, uint64_t value) {
+    uint64_t current = atomic_load(target);
+    while (value > current && !atomic_compare_exchange_weak(target, &current, value)) {
+    }
+}
+
+static void viDesk_addWait(ViDeskThreadRole role, uint64_t waitNs) {
+    atomic_fetch_add(&g_counters[role].waitNs, waitNs);
+    viDesk_updateMax(&g_counters[role].maxWaitNs, waitNs);
+}
+
+static bool viDesk_applyThreadPolicy(ViDeskThreadRole role) {
+    int priority = atomic_load(&g_policies[role].priority);
+    uint64_t affinityMask = atomic_load(&g_policies[role].affinityMask);
+    bool ok = true;
+
+#if defined(__APPLE__)
+    (void)affinityMask;  // Apple 平台不支持线程绑核
+    qos_class_t qos;
+    switch (priority) {
+        case VIDESK_THREAD_PRIORITY_BACKGROUND: qos = QOS_CLASS_BACKGROUND; break;
+        case VIDESK_THREAD_PRIORITY_UTILITY: qos = QOS_CLASS_UTILITY; break;
+        case VIDESK_THREAD_PRIORITY_USER_INITIATED: qos = QOS_CLASS_USER_INITIATED; break;
+        default: qos = QOS_CLASS_USER_INTERACTIVE; break;
+    }
+    ok = pthread_set_qos_class_self_np(qos, 0) == 0;
+#elif defined(__linux__)
+    // 负 nice 值需要 CAP_SYS_NICE，失败时保持原优先级
+    static const int niceValues[] = { 10, 5, 0, -5 };
+    int nice = niceValues[priority >= 0 && priority <= 3 ? priority : 3];
+    pid_t tid = (pid_t)syscall(SYS_gettid);
+    ok = setpriority(PRIO_PROCESS, (id_t)tid, nice) == 0;
+
+    if (affinityMask != 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; cpu++) {
+            if (affinityMask & (1ULL << cpu))
+                CPU_SET(cpu, &set);
+        }
+        ok = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 && ok;
+    }
+#else
+    (void)priority;
+    (void)affinityMask;
+#endif
+
+    return ok;
+}
+
+void viDesk_setThreadPolicy(ViDeskThreadRole role, ViDeskThreadPriority priority, uint64_t affinityMask) {
+    if (!viDesk_validRole(role))
+        return;
+
+    atomic_store(&g_policies[role].priority, (int)priority);
+    atomic_store(&g_policies[role].affinityMask, affinityMask);
+}
+
+bool viDesk_enterThreadRole(ViDeskThreadRole role, bool applyPolicy) {
+    if (!viDesk_validRole(role))
+        return false;
+
+    if (t_role == (int)role && !applyPolicy)
+        return true;
+
+    viDesk_leaveThreadRole();
+    t_role = (int)role;
+    atomic_fetch_add(&g_counters[role].threadCount, 1);
+#if defined(__linux__)
+    t_schedstatFd = open("/proc/thread-self/schedstat", O_RDONLY | O_CLOEXEC);
+#endif
+
+    return applyPolicy ? viDesk_applyThreadPolicy(role) : true;
+}
+
+void viDesk_leaveThreadRole(void) {
+    if (t_role < 0)
+        return;
+
+    atomic_fetch_sub(&g_counters[t_role].threadCount, 1);
+    t_role = -1;
+    t_inWork = false;
+#if defined(__linux__)
+    if (t_schedstatFd >= 0) {
+        close(t_schedstatFd);
+        t_schedstatFd = -1;
+    }
+#endif
+}
+
+void viDesk_beginThreadRoleWork(void) {
+    if (t_role < 0 || t_inWork)
+        return;
+
+    t_inWork = true;
+    t_workStartNs = viDesk_roleClockNs(CLOCK_MONOTONIC);
+    t_workStartCpuNs = viDesk_roleClockNs(CLOCK_THREAD_CPUTIME_ID);
+#if defined(__linux__)
+    if (!viDesk_readRunDelay(&t_workStartRunDelayNs))
+        t_workStartRunDelayNs = UINT64_MAX;
+#endif
+}
+
+void viDesk_endThreadRoleWork(void) {
+    if (t_role < 0 || !t_inWork)
+        return;
+
+    t_inWork = false;
+    uint64_t wall = viDesk_roleClockNs(CLOCK_MONOTONIC) - t_workStartNs;
+    uint64_t cpu = viDesk_roleClockNs(CLOCK_THREAD_CPUTIME_ID) - t_workStartCpuNs;
+
+    ViDeskThreadRoleCounters* counters = &g_counters[t_role];
+    atomic_fetch_add(&counters->workItems, 1);
+    atomic_fetch_add(&counters->busyNs, wall);
+    atomic_fetch_add(&counters->cpuNs, cpu);
+
+#if defined(__linux__)
+    // 只取 run_delay 的增量：区间内阻塞 I/O 的时间不在运行队列里，不计入
+    uint64_t runDelay = 0;
+    if (t_workStartRunDelayNs != UINT64_MAX && viDesk_readRunDelay(&runDelay) &&
+        runDelay >= t_workStartRunDelayNs) {
+        atomic_fetch_add(&counters->runDelayNs, runDelay - t_workStartRunDelayNs);
+        viDesk_updateMax(&counters->maxRunDelayNs, runDelay - t_workStartRunDelayNs);
+    }
+#endif
+}
+
+void viDesk_recordThreadRoleWait(ViDeskThreadRole role, uint64_t waitNs) {
+    if (!viDesk_validRole(role))
+        return;
+
+    viDesk_addWait(role, waitNs);
+}
+
+void viDesk_getThreadRoleStats(ViDeskThreadRole role, ViDeskThreadRoleStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!viDesk_validRole(role))
+        return;
+
+    ViDeskThreadRoleCounters* counters = &g_counters[role];
+    stats->threadCount = atomic_load(&counters->threadCount);
+    stats->workItems = atomic_load(&counters->workItems);
+    stats->busyNs = atomic_load(&counters->busyNs);
+    stats->cpuNs = atomic_load(&counters->cpuNs);
+    stats->waitNs = atomic_load(&counters->waitNs);
+    stats->maxWaitNs = atomic_load(&counters->maxWaitNs);
+#if defined(__linux__)
+    stats->runDelayAvailable = true;
+#endif
+    stats->runDelayNs = atomic_load(&counters->runDelayNs);
+    stats->maxRunDelayNs = atomic_load(&counters->maxRunDelayNs);
+}
+
+void viDesk_resetThreadRoleStats(void) {
+    for (int role = 0; role < VIDESK_THREAD_ROLE_COUNT; role++) {
+        ViDeskThreadRoleCounters* counters = &g_counters[role];
+        atomic_store(&counters->workItems, 0);
+        atomic_store(&counters->busyNs, 0);
+        atomic_store(&counters->cpuNs, 0);
+        atomic_store(&counters->waitNs, 0);
+        atomic_store(&counters->maxWaitNs, 0);
+        atomic_store(&counters->runDelayNs, 0);
+        atomic_store(&counters->maxRunDelayNs, 0);
+    }
+}
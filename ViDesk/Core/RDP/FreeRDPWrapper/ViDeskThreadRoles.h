@@ -0,0 +1,69 @@
+#ifndef ViDeskThreadRoles_h
+#define ViDeskThreadRoles_h
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 线程角色
+typedef enum {
+    VIDESK_THREAD_ROLE_NETWORK = 0,     // 网络 I/O：等待 socket/通道事件 (会话事件线程、共享调度线程)
+    VIDESK_THREAD_ROLE_DECODE = 1,      // 解码：处理 PDU 并解码到 GDI 缓冲区 (共享工作线程)
+    VIDESK_THREAD_ROLE_COMPOSITION = 2, // 合成：上传纹理并绘制 (MTKView 绘制线程)
+    VIDESK_THREAD_ROLE_COUNT = 3
+} ViDeskThreadRole;
+
+/// 调度优先级 (Apple 平台映射到 QoS 类，Linux 映射到 nice 值)
+typedef enum {
+    VIDESK_THREAD_PRIORITY_BACKGROUND = 0,
+    VIDESK_THREAD_PRIORITY_UTILITY = 1,
+    VIDESK_THREAD_PRIORITY_USER_INITIATED = 2,
+    VIDESK_THREAD_PRIORITY_USER_INTERACTIVE = 3
+} ViDeskThreadPriority;
+
+/// 单个角色的调度统计
+/// waitNs 为工作已就绪到工作线程开始处理的排队时间；
+/// runDelayNs 为工作区间内线程可运行却在运行队列里等 CPU 的时间，取自 /proc/thread-self/schedstat 的
+/// run_delay (仅 Linux)。墙钟减 CPU 时间还包含阻塞 I/O，不能当作调度延迟。
+/// Apple 平台没有按线程的运行队列延迟，runDelayAvailable 为 false，只有排队等待可用
+typedef struct {
+    uint32_t threadCount;   // 当前处于该角色的线程数
+    uint64_t workItems;     // 工作区间数
+    uint64_t busyNs;        // 工作区间墙钟时间
+    uint64_t cpuNs;         // 工作区间 CPU 时间
+    uint64_t waitNs;        // 排队等待工作线程的时间
+    uint64_t maxWaitNs;     // 单次最长排队
+    bool runDelayAvailable; // 当前平台能否测量运行队列延迟
+    uint64_t runDelayNs;    // 工作区间内在运行队列中等待 CPU 的时间
+    uint64_t maxRunDelayNs; // 单个工作区间最长的运行队列等待
+} ViDeskThreadRoleStats;
+
+/// 设置角色的调度策略，对之后进入该角色的线程生效
+/// affinityMask 为 CPU 位掩码，0 表示不限制 (仅 Linux 支持)
+void viDesk_setThreadPolicy(ViDeskThreadRole role, ViDeskThreadPriority priority, uint64_t affinityMask);
+
+/// 当前线程进入角色，applyPolicy 为 false 时只参与统计 (如主线程上的合成)
+bool viDesk_enterThreadRole(ViDeskThreadRole role, bool applyPolicy);
+
+/// 当前线程退出角色
+void viDesk_leaveThreadRole(void);
+
+/// 标记当前线程一个工作区间的开始/结束 (未进入角色时为空操作)
+void viDesk_beginThreadRoleWork(void);
+void viDesk_endThreadRoleWork(void);
+
+/// 记录一次排队等待 (工作已就绪到线程开始处理)
+void viDesk_recordThreadRoleWait(ViDeskThreadRole role, uint64_t waitNs);
+
+/// 获取/重置统计
+void viDesk_getThreadRoleStats(ViDeskThreadRole role, ViDeskThreadRoleStats* stats);
+void viDesk_resetThreadRoleStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskThreadRoles_h */
@@ -0,0 +1,958 @@
+/**
+ * ViDeskTransport.c - 池化接收缓冲区的传输层
+ */
+
+#include "ViDeskTransport.h"
+#include "ViDeskPrewarm.h"
+#include "ViDeskWanEmulator.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <winpr/synch.h>
+#include <winpr/handle.h>
+#include <freerdp/settings.h>
+#include <freerdp/error.h>
+
+// 接收缓冲区大小：足够容纳数个最大长度 (16 KB) 的 TLS 记录
+#define VIDESK_TRANSPORT_BUFFER_SIZE (64u * 1024u)
+
+// 进程内保留的空闲缓冲区上限
+#define VIDESK_TRANSPORT_POOL_LIMIT 8
+
+// 请求不小于缓冲区一半时直接读入调用方的内存，省去一次复制
+#define VIDESK_TRANSPORT_DIRECT_READ (VIDESK_TRANSPORT_BUFFER_SIZE / 2)
+
+typedef struct ViDeskTransportBuffer {
+    struct ViDeskTransportBuffer* next;
+    uint8_t data[VIDESK_TRANSPORT_BUFFER_SIZE];
+} ViDeskTransportBuffer;
+
+static pthread_mutex_t g_bufferLock = PTHREAD_MUTEX_INITIALIZER;
+static ViDeskTransportBuffer* g_freeBuffers;
+static uint32_t g_freeBufferCount;
+
+struct ViDeskTransport {
+    atomic_bool pooled;
+    bool activePooled;              // 本次连接实际使用的模式
+
+    bool haveDefaults;
+    rdpTransportIo defaults;        // FreeRDP 的默认回调
+
+    _Atomic uint64_t sinceNs;
+    _Atomic uint64_t recvCalls;
+    _Atomic uint64_t sendCalls;
+    _Atomic uint64_t waitCalls;
+    _Atomic uint64_t layerReads;
+    _Atomic uint64_t bytesRead;
+    _Atomic uint64_t pdus;
+    _Atomic uint64_t allocations;
+    _Atomic uint64_t prewarmSavedNs;    // 本次连接使用预热套接字省下的时间
+
+    pthread_mutex_t raceLock;           // 保护 race
+    ViDeskConnectRace race;             // 本次连接的地址竞速结果
+
+    pthread_mutex_t wanLock;            // 保护以下 WAN 模拟状态
+    bool wanEnabled;
+    ViDeskWanProfile wanProfile;        // 下次连接使用的参数
+    ViDeskWanEmulator* wan;             // 本次连接的模拟器 (持有一个引用，用于统计)
+};
+
+// 传输层上下文 (transport_layer_new 分配，随传输层释放)
+typedef struct {
+    ViDeskTransport* owner;
+    rdpTransportLayer* inner;       // 计数模式：FreeRDP 默认的套接字层
+    int fd;
+    HANDLE event;
+    ViDeskTransportBuffer* buffer;
+    size_t offset;                  // buffer 中尚未交给 TLS 的数据
+    size_t length;
+    ViDeskWanEmulator* wan;         // 启用 WAN 模拟时 fd 为转发线程的本地套接字
+} ViDeskTransportLayer;
+
+static uint64_t viDesk_transportNowNs(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline void viDesk_count(_Atomic uint64_t* counter, uint64_t value) {
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+// MARK: - 缓冲区池
+
+static ViDeskTransportBuffer* viDesk_bufferTake(ViDeskTransport* owner) {
+    pthread_mutex_lock(&g_bufferLock);
+    ViDeskTransportBuffer* buffer = g_freeBuffers;
+    if (buffer) {
+        g_freeBuffers = buffer->next;
+        g_freeBufferCount--;
+    }
+    pthread_mutex_unlock(&g_bufferLock);
+
+    if (!buffer) {
+        buffer = malloc(sizeof(ViDeskTransportBuffer));
+        if (buffer)
+            viDesk_count(&owner->allocations, 1);
+    }
+    return buffer;
+}
+
+static void viDesk_bufferReturn(ViDeskTransportBuffer* buffer) {
+    if (!buffer)
+        return;
+
+    pthread_mutex_lock(&g_bufferLock);
+    if (g_freeBufferCount < VIDESK_TRANSPORT_POOL_LIMIT) {
+        buffer->next = g_freeBuffers;
+        g_freeBuffers = buffer;
+        g_freeBufferCount++;
+        buffer = NULL;
+    }
+    pthread_mutex_unlock(&g_bufferLock);
+    free(buffer);
+}
+
+// MARK: - 池化传输层
+
+static int viDesk_layerRead(void* userContext, void* data, int bytes) {
+    ViDeskTransportLayer* layer = userContext;
+    if (!layer || layer->fd < 0 || !data || bytes <= 0)
+        return -1;
+
+    ViDeskTransport* owner = layer->owner;
+    viDesk_count(&owner->layerReads, 1);
+
+    if (layer->offset < layer->length) {
+        size_t available = layer->length - layer->offset;
+        size_t n = available < (size_t)bytes ? available : (size_t)bytes;
+        memcpy(data, layer->buffer->data + layer->offset, n);
+        layer->offset += n;
+        return (int)n;
+    }
+
+    // 大块请求直接读入调用方内存，小请求 (TLS 记录头、短记录) 先读满缓冲区
+    bool direct = (size_t)bytes >= VIDESK_TRANSPORT_DIRECT_READ;
+    uint8_t* target = direct ? data : layer->buffer->data;
+    size_t capacity = direct ? (size_t)bytes : VIDESK_TRANSPORT_BUFFER_SIZE;
+
+    for (;;) {
+        viDesk_count(&owner->recvCalls, 1);
+        ssize_t status = recv(layer->fd, target, capacity, 0);
+        if (status > 0) {
+            viDesk_count(&owner->bytesRead, (uint64_t)status);
+            if (direct)
+                return (int)status;
+
+            size_t n = (size_t)status < (size_t)bytes ? (size_t)status : (size_t)bytes;
+            memcpy(data, layer->buffer->data, n);
+            layer->offset = n;
+            layer->length = (size_t)status;
+            return (int)n;
+        }
+        if (status == 0) {
+            errno = ECONNRESET;     // 对端关闭：不能留下 EAGAIN 让 BIO 误判为重试
+            return -1;
+        }
+        if (errno == EINTR)
+            continue;
+        // EAGAIN 时同样返回 -1 并保留 errno，BIO 据此设置重试标志 (返回 0 会被当作连接关闭)
+        return -1;
+    }
+}
+
+static int viDesk_layerWrite(void* userContext, const void* data, int bytes) {
+    ViDeskTransportLayer* layer = userContext;
+    if (!layer || layer->fd < 0 || !data || bytes < 0)
+        return -1;
+
+    for (;;) {
+        viDesk_count(&layer->owner->sendCalls, 1);
+#ifdef MSG_NOSIGNAL
+        ssize_t status = send(layer->fd, data, (size_t)bytes, MSG_NOSIGNAL);
+#else
+        ssize_t status = send(layer->fd, data, (size_t)bytes, 0);
+#endif
+        if (status >= 0)
+            return (int)status;
+        if (errno == EINTR)
+            continue;
+        // EAGAIN 时保留 errno，BIO 据此设置重试标志
+        return -1;
+    }
+}
+
+static BOOL viDesk_layerWait(void* userContext, BOOL waitWrite, DWORD timeout) {
+    ViDeskTransportLayer* layer = userContext;
+    if (!layer || layer->fd < 0)
+        return FALSE;
+
+    // 缓冲区中还有数据时不必等待套接字
+    if (!waitWrite && layer->offset < layer->length)
+        return TRUE;
+
+    struct pollfd pfd = { .fd = layer->fd, .events = waitWrite ? POLLOUT : POLLIN };
+    int status;
+    do {
+        viDesk_count(&layer->owner->waitCalls, 1);
+        status = poll(&pfd, 1, (int)timeout);
+    } while (status < 0 && errno == EINTR);
+    return status > 0;
+}
+
+static HANDLE viDesk_layerGetEvent(void* userContext) {
+    ViDeskTransportLayer* layer = userContext;
+    return layer ? layer->event : NULL;
+}
+
+// 不访问 owner：会话释放时传输层可能晚于桥接层的模块释放
+static BOOL viDesk_layerClose(void* userContext) {
+    ViDeskTransportLayer* layer = userContext;
+    if (!layer)
+        return FALSE;
+
+    if (layer->event) {
+        CloseHandle(layer->event);
+        layer->event = NULL;
+    }
+    if (layer->fd >= 0) {
+        close(layer->fd);
+        layer->fd = -1;
+    }
+    if (layer->wan) {
+        viDesk_wanEmulatorStop(layer->wan);
+        viDesk_wanEmulatorRelease(layer->wan);
+        layer->wan = NULL;
+    }
+    viDesk_bufferReturn(layer->buffer);
+    layer->buffer = NULL;
+    layer->offset = layer->length = 0;
+    return TRUE;
+}
+
+// MARK: - 计数模式 (包装 FreeRDP 默认的套接字层，每次读写对应一次系统调用)
+
+static int viDesk_countingRead(void* userContext, void* data, int bytes) {
+    ViDeskTransportLayer* layer = userContext;
+    if (!layer || !layer->inner || !layer->inner->Read)
+        return -1;
+
+    viDesk_count(&layer->owner->layerReads, 1);
+    viDesk_count(&layer->owner->recvCalls, 1);
+    int status = layer->inner->Read(layer->inner->userContext, data, bytes);
+    if (status > 0)
+        viDesk_count(&layer->owner->bytesRead, (uint64_t)status);
+    return status;
+}
+
+static int viDesk_countingWrite(void* userContext, const void* data, int bytes) {
+    ViDeskTransportLayer* layer = userContext;
+    if (!layer || !layer->inner || !layer->inner->Write)
+        return -1;
+
+    viDesk_count(&layer->owner->sendCalls, 1);
+    return layer->inner->Write(layer->inner->userContext, data, bytes);
+}
+
+static BOOL viDesk_countingWait(void* userContext, BOOL waitWrite, DWORD timeout) {
+    ViDeskTransportLayer* layer = userContext;
+    if (!layer || !layer->inner || !layer->inner->Wait)
+        return FALSE;
+
+    viDesk_count(&layer->owner->waitCalls, 1);
+    return layer->inner->Wait(layer->inner->userContext, waitWrite, timeout);
+}
+
+static HANDLE viDesk_countingGetEvent(void* userContext) {
+    ViDeskTransportLayer* layer = userContext;
+    if (!layer || !layer->inner || !layer->inner->GetEvent)
+        return NULL;
+    return layer->inner->GetEvent(layer->inner->userContext);
+}
+
+static BOOL viDesk_countingClose(void* userContext) {
+    ViDeskTransportLayer* layer = userContext;
+    if (!layer)
+        return FALSE;
+
+    // transport_layer_free 会先关闭内层再释放
+    transport_layer_free(layer->inner);
+    layer->inner = NULL;
+    return TRUE;
+}
+
+// MARK: - 连接
+
+// 地址竞速 (RFC 8305 Happy Eyeballs)：IPv6/IPv4 交替排列，前一个地址未完成时每隔一段时间启动下一个，
+// 前一个失败或超时时立即启动下一个，第一个建立的连接胜出，其余关闭。超时按每个地址分别计算
+#define VIDESK_CONNECT_ATTEMPT_DELAY_MS 250
+#define VIDESK_CONNECT_MAX_ADDRESSES    16
+
+typedef enum {
+    VIDESK_ATTEMPT_IDLE = 0,
+    VIDESK_ATTEMPT_PENDING,
+    VIDESK_ATTEMPT_FAILED,
+    VIDESK_ATTEMPT_CONNECTED
+} ViDeskAttemptState;
+
+typedef struct {
+    const struct addrinfo* ai;
+    uint32_t resolverOrder;         // getaddrinfo 返回的顺序 (逐个尝试时的顺序)
+    ViDeskAttemptState state;
+    int fd;
+    uint64_t startNs;
+    uint64_t endNs;
+} ViDeskConnectAttempt;
+
+// 按 RFC 8305 第 4 节交替排列地址族，首个地址族沿用解析结果的第一个
+static uint32_t viDesk_orderAddresses(const struct addrinfo* result, ViDeskConnectAttempt* attempts) {
+    const struct addrinfo* byFamily[2][VIDESK_CONNECT_MAX_ADDRESSES];
+    uint32_t orderByFamily[2][VIDESK_CONNECT_MAX_ADDRESSES];
+    uint32_t counts[2] = { 0, 0 };
+    int firstFamily = result ? result->ai_family : AF_INET6;
+
+    uint32_t order = 0;
+    for (const struct addrinfo* ai = result; ai; ai = ai->ai_next, order++) {
+        if (ai->ai_family != AF_INET && ai->ai_family != AF_INET6)
+            continue;
+        int group = ai->ai_family == firstFamily ? 0 : 1;
+        if (counts[group] >= VIDESK_CONNECT_MAX_ADDRESSES)
+            continue;
+        byFamily[group][counts[group]] = ai;
+        orderByFamily[group][counts[group]] = order;
+        counts[group]++;
+    }
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; count < VIDESK_CONNECT_MAX_ADDRESSES && (i < counts[0] || i < counts[1]); i++) {
+        for (int group = 0; group < 2 && count < VIDESK_CONNECT_MAX_ADDRESSES; group++) {
+            if (i >= counts[group])
+                continue;
+            memset(&attempts[count], 0, sizeof(attempts[count]));
+            attempts[count].ai = byFamily[group][i];
+            attempts[count].resolverOrder = orderByFamily[group][i];
+            attempts[count].fd = -1;
+            count++;
+        }
+    }
+    return count;
+}
+
+static void viDesk_startAttempt(ViDeskConnectAttempt* attempt, uint64_t now) {
+    attempt->startNs = now;
+    attempt->state = VIDESK_ATTEMPT_FAILED;
+
+    const struct addrinfo* ai = attempt->ai;
+    int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) {
+        attempt->endNs = now;
+        return;
+    }
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+        attempt->state = VIDESK_ATTEMPT_CONNECTED;
+        attempt->endNs = viDesk_transportNowNs();
+        attempt->fd = fd;
+    } else if (errno == EINPROGRESS) {
+        attempt->state = VIDESK_ATTEMPT_PENDING;
+        attempt->fd = fd;
+    } else {
+        attempt->endNs = viDesk_transportNowNs();
+        close(fd);
+    }
+}
+
+static void viDesk_formatAddress(const struct sockaddr* address, char* buffer, size_t size) {
+    buffer[0] = '\0';
+    if (address->sa_family == AF_INET6)
+        inet_ntop(AF_INET6, &((const struct sockaddr_in6*)address)->sin6_addr, buffer, (socklen_t)size);
+    else if (address->sa_family == AF_INET)
+        inet_ntop(AF_INET, &((const struct sockaddr_in*)address)->sin_addr, buffer, (socklen_t)size);
+}
+
+// 逐个尝试时胜出地址之前的每个地址都要等到失败 (或超时) 才轮到下一个：
+// 已失败的按实际耗时计，竞速结束时仍未完成的按已等待的时间计，得到的是省下时间的下限
+static uint64_t viDesk_raceSavedNs(const ViDeskConnectAttempt* attempts, uint32_t count,
+                                   const ViDeskConnectAttempt* winner, uint64_t raceStartNs) {
+    uint64_t sequential = winner->endNs - winner->startNs;
+    for (uint32_t i = 0; i < count; i++) {
+        const ViDeskConnectAttempt* attempt = &attempts[i];
+        if (attempt == winner || attempt->resolverOrder > winner->resolverOrder)
+            continue;
+        if (attempt->state == VIDESK_ATTEMPT_FAILED)
+            sequential += attempt->endNs - attempt->startNs;
+        else if (attempt->state == VIDESK_ATTEMPT_PENDING)
+            sequential += winner->endNs - attempt->startNs;
+    }
+    uint64_t actual = winner->endNs - raceStartNs;
+    return sequential > actual ? sequential - actual : 0;
+}
+
+int viDesk_transportOpenSocket(const char* hostname, int port, DWORD timeoutMs,
+                               struct sockaddr_storage* local, ViDeskConnectRace* race) {
+    if (race)
+        memset(race, 0, sizeof(*race));
+
+    char service[16];
+    snprintf(service, sizeof(service), "%d", port);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+
+    struct addrinfo* result = NULL;
+    if (getaddrinfo(hostname, service, &hints, &result) != 0 || !result)
+        return -1;
+
+    ViDeskConnectAttempt attempts[VIDESK_CONNECT_MAX_ADDRESSES];
+    uint32_t count = viDesk_orderAddresses(result, attempts);
+
+    uint64_t raceStart = viDesk_transportNowNs();
+    uint64_t attemptTimeoutNs = (uint64_t)timeoutMs * 1000000ULL;
+    uint64_t nextStartNs = raceStart;
+    uint32_t next = 0;
+    ViDeskConnectAttempt* winner = NULL;
+
+    while (!winner) {
+        uint64_t now = viDesk_transportNowNs();
+
+        // 超时的地址按失败处理，立即启动下一个；记下最早到期的进行中尝试
+        uint32_t pending = 0;
+        uint64_t expiryNs = UINT64_MAX;
+        for (uint32_t i = 0; i < next; i++) {
+            ViDeskConnectAttempt* attempt = &attempts[i];
+            if (attempt->state != VIDESK_ATTEMPT_PENDING)
+                continue;
+            if (now >= attempt->startNs + attemptTimeoutNs) {
+                attempt->state = VIDESK_ATTEMPT_FAILED;
+                attempt->endNs = now;
+                close(attempt->fd);
+                attempt->fd = -1;
+                nextStartNs = now;
+                continue;
+            }
+            pending++;
+            if (attempt->startNs + attemptTimeoutNs < expiryNs)
+                expiryNs = attempt->startNs + attemptTimeoutNs;
+        }
+
+        // 到了启动间隔，或者没有进行中的尝试时，启动下一个地址
+        if (next < count && (now >= nextStartNs || pending == 0)) {
+            ViDeskConnectAttempt* attempt = &attempts[next++];
+            viDesk_startAttempt(attempt, now);
+            if (attempt->state == VIDESK_ATTEMPT_CONNECTED)
+                winner = attempt;
+            nextStartNs = attempt->state == VIDESK_ATTEMPT_PENDING
+                              ? now + VIDESK_CONNECT_ATTEMPT_DELAY_MS * 1000000ULL
+                              : now;
+            continue;
+        }
+        if (pending == 0)
+            break;  // 所有地址都已失败
+
+        struct pollfd pfds[VIDESK_CONNECT_MAX_ADDRESSES];
+        ViDeskConnectAttempt* polled[VIDESK_CONNECT_MAX_ADDRESSES];
+        nfds_t nfds = 0;
+        for (uint32_t i = 0; i < next; i++) {
+            if (attempts[i].state != VIDESK_ATTEMPT_PENDING)
+                continue;
+            pfds[nfds].fd = attempts[i].fd;
+            pfds[nfds].events = POLLOUT;
+            pfds[nfds].revents = 0;
+            polled[nfds++] = &attempts[i];
+        }
+
+        uint64_t wakeNs = next < count && nextStartNs < expiryNs ? nextStartNs : expiryNs;
+        int waitMs = (int)((wakeNs - now + 999999ULL) / 1000000ULL);
+        int status = poll(pfds, nfds, waitMs);
+        if (status < 0 && errno != EINTR)
+            break;
+        if (status <= 0)
+            continue;
+
+        now = viDesk_transportNowNs();
+        for (nfds_t i = 0; i < nfds; i++) {
+            if (pfds[i].revents == 0)
+                continue;
+
+            ViDeskConnectAttempt* attempt = polled[i];
+            int error = 0;
+            socklen_t length = sizeof(error);
+            attempt->endNs = now;
+            if (getsockopt(attempt->fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) {
+                attempt->state = VIDESK_ATTEMPT_CONNECTED;
+                if (!winner)
+                    winner = attempt;
+            } else {
+                attempt->state = VIDESK_ATTEMPT_FAILED;
+                close(attempt->fd);
+                attempt->fd = -1;
+                nextStartNs = now;  // 失败后立即尝试下一个地址
+            }
+        }
+    }
+
+    // 关闭落选的连接
+    for (uint32_t i = 0; i < next; i++) {
+        if (&attempts[i] != winner && attempts[i].fd >= 0) {
+            close(attempts[i].fd);
+            attempts[i].fd = -1;
+        }
+    }
+
+    int fd = winner ? winner->fd : -1;
+    if (race) {
+        race->candidates = count;
+        race->attempts = next;
+        if (winner) {
+            viDesk_formatAddress(winner->ai->ai_addr, race->address, sizeof(race->address));
+            race->elapsedNs = winner->endNs - raceStart;
+            race->savedNs = viDesk_raceSavedNs(attempts, next, winner, raceStart);
+        }
+    }
+    freeaddrinfo(result);
+
+    if (fd < 0)
+        return -1;
+
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+#ifdef SO_NOSIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+    socklen_t localLength = sizeof(*local);
+    if (getsockname(fd, (struct sockaddr*)local, &localLength) != 0)
+        memset(local, 0, sizeof(*local));
+    return fd;
+}
+
+// 客户端地址写入 Client Info PDU，与 FreeRDP 默认连接的行为一致
+static void viDesk_storeClientAddress(rdpSettings* settings, const struct sockaddr_storage* local) {
+    char address[INET6_ADDRSTRLEN] = { 0 };
+    if (local->ss_family == AF_INET6) {
+        inet_ntop(AF_INET6, &((const struct sockaddr_in6*)local)->sin6_addr, address, sizeof(address));
+        freerdp_settings_set_bool(settings, FreeRDP_IPv6Enabled, TRUE);
+    } else if (local->ss_family == AF_INET) {
+        inet_ntop(AF_INET, &((const struct sockaddr_in*)local)->sin_addr, address, sizeof(address));
+        freerdp_settings_set_bool(settings, FreeRDP_IPv6Enabled, FALSE);
+    }
+    if (address[0])
+        freerdp_settings_set_string(settings, FreeRDP_ClientAddress, address);
+}
+
+// 按 FreeRDP 的保活设置配置套接字 (与默认实现的 freerdp_tcp_set_keep_alive_mode 一致)，
+// 另外设置重传超时：有数据未确认时超过 TcpAckTimeout 即断开，不再等系统默认的数分钟
+static void viDesk_configureKeepAlive(int fd, rdpSettings* settings) {
+    if (!settings || !freerdp_settings_get_bool(settings, FreeRDP_TcpKeepAlive))
+        return;
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+
+    int idle = (int)freerdp_settings_get_uint32(settings, FreeRDP_TcpKeepAliveDelay);
+    if (idle > 0) {
+#if defined(TCP_KEEPIDLE)
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+#elif defined(TCP_KEEPALIVE)
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPALIVE, &idle, sizeof(idle));
+#endif
+    }
+#ifdef TCP_KEEPINTVL
+    int interval = (int)freerdp_settings_get_uint32(settings, FreeRDP_TcpKeepAliveInterval);
+    if (interval > 0)
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+#endif
+#ifdef TCP_KEEPCNT
+    int retries = (int)freerdp_settings_get_uint32(settings, FreeRDP_TcpKeepAliveRetries);
+    if (retries > 0)
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &retries, sizeof(retries));
+#endif
+
+    UINT32 ackTimeoutMs = freerdp_settings_get_uint32(settings, FreeRDP_TcpAckTimeout);
+    if (ackTimeoutMs > 0) {
+#if defined(TCP_USER_TIMEOUT)
+        unsigned int timeout = ackTimeoutMs;
+        setsockopt(fd, IPPROTO_TCP, TCP_USER_TIMEOUT, &timeout, sizeof(timeout));
+#elif defined(TCP_RXT_CONNDROPTIME)
+        int seconds = (int)((ackTimeoutMs + 999) / 1000);
+        setsockopt(fd, IPPROTO_TCP, TCP_RXT_CONNDROPTIME, &seconds, sizeof(seconds));
+#endif
+    }
+}
+
+static rdpTransportLayer* viDesk_connectPooled(ViDeskTransport* transport, rdpTransport* rdpTransport,
+                                               const char* hostname, int port, DWORD timeoutMs) {
+    rdpContext* context = transport_get_context(rdpTransport);
+
+    // 连接卡片预热过同一目标时直接取用，省下 DNS 和 TCP 握手
+    struct sockaddr_storage local;
+    uint64_t savedNs = 0;
+    int fd = viDesk_prewarmTake(hostname, port, timeoutMs, &local, &savedNs);
+    ViDeskConnectRace race = { 0 };
+    if (fd < 0)
+        fd = viDesk_transportOpenSocket(hostname, port, timeoutMs, &local, &race);
+    atomic_store(&transport->prewarmSavedNs, savedNs);
+    pthread_mutex_lock(&transport->raceLock);
+    transport->race = race;
+    pthread_mutex_unlock(&transport->raceLock);
+    if (fd < 0) {
+        if (context)
+            freerdp_set_last_error_if_not(context, FREERDP_ERROR_CONNECT_FAILED);
+        return NULL;
+    }
+
+    // 预热的套接字建立时还没有会话设置，在这里统一配置
+    if (context)
+        viDesk_configureKeepAlive(fd, context->settings);
+
+    // WAN 模拟：服务器套接字交给转发线程，传输层改为读写本地套接字
+    ViDeskWanEmulator* wan = NULL;
+    pthread_mutex_lock(&transport->wanLock);
+    bool wanEnabled = transport->wanEnabled;
+    ViDeskWanProfile wanProfile = transport->wanProfile;
+    pthread_mutex_unlock(&transport->wanLock);
+    if (wanEnabled) {
+        int clientFd = -1;
+        wan = viDesk_wanEmulatorStart(fd, &wanProfile, &clientFd);
+        if (!wan) {
+            close(fd);
+            if (context)
+                freerdp_set_last_error_if_not(context, FREERDP_ERROR_CONNECT_FAILED);
+            return NULL;
+        }
+        fd = clientFd;
+
+        viDesk_wanEmulatorRetain(wan);
+        pthread_mutex_lock(&transport->wanLock);
+        ViDeskWanEmulator* previous = transport->wan;
+        transport->wan = wan;
+        pthread_mutex_unlock(&transport->wanLock);
+        viDesk_wanEmulatorRelease(previous);
+    }
+
+    rdpTransportLayer* layer = transport_layer_new(rdpTransport, sizeof(ViDeskTransportLayer));
+    if (!layer) {
+        close(fd);
+        if (wan) {
+            viDesk_wanEmulatorStop(wan);
+            viDesk_wanEmulatorRelease(wan);
+        }
+        return NULL;
+    }
+
+    ViDeskTransportLayer* state = layer->userContext;
+    state->owner = transport;
+    state->fd = fd;
+    state->wan = wan;
+    state->buffer = viDesk_bufferTake(transport);
+    state->event = CreateFileDescriptorEvent(NULL, FALSE, FALSE, fd, WINPR_FD_READ);
+    if (!state->buffer || !state->event) {
+        viDesk_layerClose(state);
+        transport_layer_free(layer);
+        return NULL;
+    }
+
+    layer->Read = viDesk_layerRead;
+    layer->Write = viDesk_layerWrite;
+    layer->Wait = viDesk_layerWait;
+    layer->GetEvent = viDesk_layerGetEvent;
+    layer->Close = viDesk_layerClose;
+
+    if (context)
+        viDesk_storeClientAddress(context->settings, &local);
+    return layer;
+}
+
+static rdpTransportLayer* viDesk_connectCounting(ViDeskTransport* transport, rdpTransport* rdpTransport,
+                                                 const char* hostname, int port, DWORD timeoutMs) {
+    if (!transport->defaults.ConnectLayer)
+        return NULL;
+
+    rdpTransportLayer* inner = transport->defaults.ConnectLayer(rdpTransport, hostname, port, timeoutMs);
+    if (!inner)
+        return NULL;
+
+    rdpTransportLayer* layer = transport_layer_new(rdpTransport, sizeof(ViDeskTransportLayer));
+    if (!layer) {
+        transport_layer_free(inner);
+        return NULL;
+    }
+
+    ViDeskTransportLayer* state = layer->userContext;
+    state->owner = transport;
+    state->inner = inner;
+    state->fd = -1;
+
+    layer->Read = viDesk_countingRead;
+    layer->Write = viDesk_countingWrite;
+    layer->Wait = viDesk_countingWait;
+    layer->GetEvent = viDesk_countingGetEvent;
+    layer->Close = viDesk_countingClose;
+    return layer;
+}
+
+// MARK: - 公共接口
+
+ViDeskTransport* viDesk_transportNew(void) {
+    ViDeskTransport* transport = calloc(1, sizeof(ViDeskTransport));
+    if (!transport)
+        return NULL;
+
+    if (pthread_mutex_init(&transport->raceLock, NULL) != 0) {
+        free(transport);
+        return NULL;
+    }
+    if (pthread_mutex_init(&transport->wanLock, NULL) != 0) {
+        pthread_mutex_destroy(&transport->raceLock);
+        free(transport);
+        return NULL;
+    }
+    atomic_store(&transport->pooled, true);
+    return transport;
+}
+
+void viDesk_transportFree(ViDeskTransport* transport) {
+    if (!transport)
+        return;
+
+    viDesk_wanEmulatorRelease(transport->wan);
+    pthread_mutex_destroy(&transport->wanLock);
+    pthread_mutex_destroy(&transport->raceLock);
+    free(transport);
+}
+
+void viDesk_transportSetPooled(ViDeskTransport* transport, bool pooled) {
+    if (transport)
+        atomic_store(&transport->pooled, pooled);
+}
+
+void viDesk_transportSetWanProfile(ViDeskTransport* transport, const ViDeskWanProfile* profile) {
+    if (!transport)
+        return;
+
+    pthread_mutex_lock(&transport->wanLock);
+    transport->wanEnabled = profile != NULL;
+    if (profile)
+        transport->wanProfile = *profile;
+    pthread_mutex_unlock(&transport->wanLock);
+}
+
+bool viDesk_transportWanEnabled(ViDeskTransport* transport) {
+    if (!transport)
+        return false;
+
+    pthread_mutex_lock(&transport->wanLock);
+    bool enabled = transport->wanEnabled;
+    pthread_mutex_unlock(&transport->wanLock);
+    return enabled;
+}
+
+void viDesk_transportGetWanStats(ViDeskTransport* transport, ViDeskWanEmulationStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!transport)
+        return;
+
+    pthread_mutex_lock(&transport->wanLock);
+    ViDeskWanEmulator* wan = transport->wan;
+    viDesk_wanEmulatorRetain(wan);
+    pthread_mutex_unlock(&transport->wanLock);
+
+    viDesk_wanEmulatorGetStats(wan, stats);
+    viDesk_wanEmulatorRelease(wan);
+}
+
+bool viDesk_transportInstall(ViDeskTransport* transport, rdpContext* context,
+                             pTransportConnectLayer connectLayer, pTransportRWFkt readPdu) {
+    if (!transport || !context)
+        return false;
+
+    if (!transport->haveDefaults) {
+        const rdpTransportIo* current = freerdp_get_io_callbacks(context);
+        if (!current)
+            return false;
+        transport->defaults = *current;
+        transport->haveDefaults = true;
+    }
+
+    // 代理、AAD 认证等由 FreeRDP 自己处理：代理握手需要默认的连接流程，
+    // AAD 的 PDU 没有长度字段，只能用默认实现逐字节读到结束符
+    rdpSettings* settings = context->settings;
+    bool pooled = atomic_load(&transport->pooled) &&
+                  freerdp_settings_get_uint32(settings, FreeRDP_ProxyType) == PROXY_TYPE_NONE &&
+                  !freerdp_settings_get_bool(settings, FreeRDP_AadSecurity) &&
+                  transport->defaults.ReadBytes != NULL;
+    transport->activePooled = pooled;
+
+    rdpTransportIo io = transport->defaults;
+    if (transport->defaults.ConnectLayer)
+        io.ConnectLayer = connectLayer;
+    io.ReadPdu = readPdu;
+
+    viDesk_transportResetStats(transport);
+    atomic_store(&transport->prewarmSavedNs, 0);
+    pthread_mutex_lock(&transport->raceLock);
+    memset(&transport->race, 0, sizeof(transport->race));
+    pthread_mutex_unlock(&transport->raceLock);
+    pthread_mutex_lock(&transport->wanLock);
+    ViDeskWanEmulator* previous = transport->wan;
+    transport->wan = NULL;
+    pthread_mutex_unlock(&transport->wanLock);
+    viDesk_wanEmulatorRelease(previous);
+    return freerdp_set_io_callbacks(context, &io);
+}
+
+void viDesk_transportUninstall(ViDeskTransport* transport, rdpContext* context) {
+    if (!transport || !context || !transport->haveDefaults)
+        return;
+
+    freerdp_set_io_callbacks(context, &transport->defaults);
+}
+
+rdpTransportLayer* viDesk_transportConnect(ViDeskTransport* transport, rdpTransport* rdpTransport,
+                                           const char* hostname, int port, DWORD timeoutMs) {
+    if (!transport || !rdpTransport || !hostname)
+        return NULL;
+
+    // Unix 套接字等非 TCP 目标交给默认实现
+    if (!transport->activePooled || hostname[0] == '/')
+        return viDesk_connectCounting(transport, rdpTransport, hostname, port, timeoutMs);
+    return viDesk_connectPooled(transport, rdpTransport, hostname, port, timeoutMs);
+}
+
+int viDesk_transportReadPdu(ViDeskTransport* transport, rdpTransport* rdpTransport, wStream* s) {
+    if (!transport || !rdpTransport || !s)
+        return -1;
+
+    size_t capacity = Stream_Capacity(s);
+
+    if (!transport->activePooled) {
+        if (!transport->defaults.ReadPdu)
+            return -1;
+        int status = transport->defaults.ReadPdu(rdpTransport, s);
+        if (Stream_Capacity(s) != capacity)
+            viDesk_count(&transport->allocations, 1);
+        if (status > 0)
+            viDesk_count(&transport->pdus, 1);
+        return status;
+    }
+
+    int status = viDesk_transportReadPooledPdu(rdpTransport, s, transport_parse_pdu,
+                                               transport->defaults.ReadBytes);
+    if (Stream_Capacity(s) != capacity)
+        viDesk_count(&transport->allocations, 1);
+    if (status > 0)
+        viDesk_count(&transport->pdus, 1);
+    return status;
+}
+
+int viDesk_transportReadPooledPdu(rdpTransport* rdpTransport, wStream* s, ViDeskParsePdu parse,
+                                  pTransportRead readBytes) {
+    if (!s || !parse || !readBytes)
+        return -1;
+
+    // PDU 头：所有 PDU 至少 2 字节，之后按 parse 的需要逐字节补齐 (最多再读 2 字节)
+    BOOL incomplete = TRUE;
+    SSIZE_T status = parse(rdpTransport, s, &incomplete);
+    while (status == 0 && incomplete) {
+        size_t position = Stream_GetPosition(s);
+        size_t want = position < 2 ? 2 - position : 1;
+        if (!Stream_EnsureRemainingCapacity(s, want))
+            return -1;
+
+        SSIZE_T read = readBytes(rdpTransport, Stream_Pointer(s), want);
+        if (read < 0)
+            return -1;
+        Stream_Seek(s, (size_t)read);
+        if ((size_t)read < want)
+            return 0;   // 非阻塞模式下数据未到，已读部分保留在流中
+
+        status = parse(rdpTransport, s, &incomplete);
+    }
+    if (status < 0)
+        return -1;
+
+    // PDU 体：按长度一次读入接收流
+    size_t pduLength = (size_t)status;
+    size_t position = Stream_GetPosition(s);
+    if (position < pduLength) {
+        if (!Stream_EnsureRemainingCapacity(s, pduLength - position))
+            return -1;
+
+        SSIZE_T read = readBytes(rdpTransport, Stream_Pointer(s), pduLength - position);
+        if (read < 0)
+            return -1;
+        Stream_Seek(s, (size_t)read);
+    }
+
+    if (Stream_GetPosition(s) != pduLength)
+        return 0;
+
+    // 与默认的 ReadPdu 一致：交出时长度为整个 PDU，位置回到开头
+    Stream_SealLength(s);
+    Stream_SetPosition(s, 0);
+    return (int)pduLength;
+}
+
+void viDesk_transportGetStats(ViDeskTransport* transport, ViDeskTransportStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!transport)
+        return;
+
+    uint64_t since = atomic_load(&transport->sinceNs);
+    stats->pooled = transport->activePooled;
+    stats->elapsedNs = since ? viDesk_transportNowNs() - since : 0;
+    stats->recvCalls = atomic_load(&transport->recvCalls);
+    stats->sendCalls = atomic_load(&transport->sendCalls);
+    stats->waitCalls = atomic_load(&transport->waitCalls);
+    stats->layerReads = atomic_load(&transport->layerReads);
+    stats->bytesRead = atomic_load(&transport->bytesRead);
+    stats->pdus = atomic_load(&transport->pdus);
+    stats->allocations = atomic_load(&transport->allocations);
+    stats->prewarmSavedNs = atomic_load(&transport->prewarmSavedNs);
+
+    pthread_mutex_lock(&transport->raceLock);
+    memcpy(stats->remoteAddress, transport->race.address, sizeof(stats->remoteAddress));
+    stats->addressCandidates = transport->race.candidates;
+    stats->addressAttempts = transport->race.attempts;
+    stats->raceSavedNs = transport->race.savedNs;
+    pthread_mutex_unlock(&transport->raceLock);
+}
+
+void viDesk_transportResetStats(ViDeskTransport* transport) {
+    if (!transport)
+        return;
+
+    atomic_store(&transport->recvCalls, 0);
+    atomic_store(&transport->sendCalls, 0);
+    atomic_store(&transport->waitCalls, 0);
+    atomic_store(&transport->layerReads, 0);
+    atomic_store(&transport->bytesRead, 0);
+    atomic_store(&transport->pdus, 0);
+    atomic_store(&transport->allocations, 0);
+    atomic_store(&transport->sinceNs, viDesk_transportNowNs());
+}
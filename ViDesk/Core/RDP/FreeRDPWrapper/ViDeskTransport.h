@@ -0,0 +1,84 @@
+#ifndef ViDeskTransport_h
+#define ViDeskTransport_h
+
+#include "FreeRDPBridge.h"
+#include <freerdp/freerdp.h>
+#include <freerdp/transport_io.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 传输层 (桥接层内部使用)
+/// 通过 freerdp_set_io_callbacks 替换两处回调：
+/// - ConnectLayer：自己建立 TCP 连接，返回位于 TLS 之下的传输层。
+///   套接字每次 recv 读满一个 64 KB 的池化缓冲区，TLS 按记录头 (5 字节) 和记录体分两次请求的数据
+///   都从缓冲区取，一次系统调用通常能取回多个 TLS 记录、多个 PDU；缓冲区在连接之间复用。
+/// - ReadPdu：按 transport_parse_pdu 解析出的长度一次请求整个 PDU 体，不再像默认实现那样逐字节读取 PDU 头。
+///   省下的是 TLS 读取和系统调用的次数，数据仍要从池化缓冲区复制到 FreeRDP 的接收流。
+/// 关闭池化时使用 FreeRDP 默认的实现，只在套接字层外面包一层计数，便于对比；
+/// 连接预热 (ViDeskPrewarm) 的套接字也只有池化模式能接手
+typedef struct ViDeskTransport ViDeskTransport;
+
+ViDeskTransport* viDesk_transportNew(void);
+void viDesk_transportFree(ViDeskTransport* transport);
+
+/// 是否使用池化传输层 (下次连接生效)
+void viDesk_transportSetPooled(ViDeskTransport* transport, bool pooled);
+
+/// WAN 模拟参数 (下次连接生效，NULL 为关闭)，只作用于池化传输层
+void viDesk_transportSetWanProfile(ViDeskTransport* transport, const ViDeskWanProfile* profile);
+bool viDesk_transportWanEnabled(ViDeskTransport* transport);
+
+/// 获取本次连接的 WAN 模拟统计 (线程安全)
+void viDesk_transportGetWanStats(ViDeskTransport* transport, ViDeskWanEmulationStats* stats);
+
+/// 换上 connectLayer/readPdu 并清零统计 (PreConnect 中调用)
+/// connectLayer/readPdu 由桥接层提供，找到本模块后调用 viDesk_transportConnect/ReadPdu。
+/// 第一次调用时保存 FreeRDP 的默认回调，之后每次都在默认回调的基础上替换，
+/// 不会把 FreeRDP 在连接过程中包装过的回调 (如 transport dump) 当作默认值
+bool viDesk_transportInstall(ViDeskTransport* transport, rdpContext* context,
+                             pTransportConnectLayer connectLayer, pTransportRWFkt readPdu);
+
+/// 恢复 FreeRDP 的默认回调 (会话回放等不经过网络的连接使用)
+void viDesk_transportUninstall(ViDeskTransport* transport, rdpContext* context);
+
+/// 地址竞速的结果
+typedef struct {
+    char address[INET6_ADDRSTRLEN]; // 胜出的地址
+    uint32_t candidates;            // 参与竞速的地址数
+    uint32_t attempts;              // 实际发起连接的地址数
+    uint64_t elapsedNs;             // 解析完成到连接建立的时间
+    uint64_t savedNs;               // 比按解析顺序逐个尝试至少省下的时间
+} ViDeskConnectRace;
+
+/// 解析地址并建立 TCP 连接，返回已连接的非阻塞套接字 (失败返回 -1)，local 为本端地址
+/// 多个地址时按 Happy Eyeballs (RFC 8305) 竞速：IPv6/IPv4 交替，每 250 ms 或前一个失败时启动下一个，
+/// 第一个建立的连接胜出。timeoutMs 为每个地址的连接超时。race 可为 NULL。连接预热也使用这个函数
+int viDesk_transportOpenSocket(const char* hostname, int port, DWORD timeoutMs,
+                               struct sockaddr_storage* local, ViDeskConnectRace* race);
+
+/// 建立连接并返回传输层，失败时返回 NULL 并设置 FreeRDP 的错误码
+rdpTransportLayer* viDesk_transportConnect(ViDeskTransport* transport, rdpTransport* rdpTransport,
+                                           const char* hostname, int port, DWORD timeoutMs);
+
+/// 读取一个 PDU：>0 为 PDU 长度，0 为数据未到齐 (非阻塞)，<0 为错误
+int viDesk_transportReadPdu(ViDeskTransport* transport, rdpTransport* rdpTransport, wStream* s);
+
+/// 池化模式下 ReadPdu 的实现，parse/readBytes 通常为 transport_parse_pdu 和默认的 ReadBytes (单元测试可替换)
+/// 未到齐的数据保留在流中，下次调用接着读；读完一个 PDU 后封上流的长度并把位置移回开头
+typedef SSIZE_T (*ViDeskParsePdu)(rdpTransport* transport, wStream* s, BOOL* incomplete);
+int viDesk_transportReadPooledPdu(rdpTransport* rdpTransport, wStream* s, ViDeskParsePdu parse,
+                                  pTransportRead readBytes);
+
+/// 获取/重置统计 (线程安全)
+void viDesk_transportGetStats(ViDeskTransport* transport, ViDeskTransportStats* stats);
+void viDesk_transportResetStats(ViDeskTransport* transport);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskTransport_h */
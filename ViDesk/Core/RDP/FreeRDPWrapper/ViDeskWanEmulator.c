@@ -0,0 +1,482 @@
+/**
+ * ViDeskWanEmulator.c - WAN 模拟转发
+ */
+
+#include "ViDeskWanEmulator.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+// 每次从源端读取的最大字节
+#define VIDESK_WAN_CHUNK_SIZE (16u * 1024u)
+
+// 每个方向排队的上限 (相当于瓶颈路由器的缓冲区)，超过后停止读取源端
+#define VIDESK_WAN_QUEUE_LIMIT (1024u * 1024u)
+
+// 没有定时事件时的最长等待
+#define VIDESK_WAN_IDLE_WAIT_MS 1000
+
+typedef struct ViDeskWanChunk {
+    struct ViDeskWanChunk* next;
+    uint64_t queuedNs;
+    uint64_t releaseNs;
+    size_t length;
+    size_t offset;                  // 已写出的字节
+    uint8_t data[];
+} ViDeskWanChunk;
+
+typedef struct {
+    int from;
+    int to;
+    uint32_t kbps;
+    ViDeskWanChunk* head;
+    ViDeskWanChunk* tail;
+    size_t queued;
+    uint64_t linkFreeNs;            // 链路发送完已排队数据的时刻
+    uint64_t lastReleaseNs;         // 上一块的交付时刻 (保证顺序)
+    bool eof;                       // 源端已关闭
+    bool shutdown;                  // 已向目的端转发关闭
+    bool writeBlocked;              // 目的端写满，等待可写
+
+    _Atomic uint64_t bytes;
+    _Atomic uint64_t chunks;
+    _Atomic uint64_t totalDelayNs;  // 读入到交付的时间总和
+    _Atomic uint64_t peakQueued;
+} ViDeskWanDirection;
+
+struct ViDeskWanEmulator {
+    atomic_int refs;
+    ViDeskWanProfile profile;
+    int serverFd;
+    int pairFd;                     // 套接字对中转发线程使用的一端
+    int wakePipe[2];
+
+    pthread_mutex_t stopLock;
+    pthread_t thread;
+    bool threadRunning;
+    atomic_bool stopping;
+    atomic_bool running;
+
+    ViDeskWanDirection down;        // 服务器 -> 客户端
+    ViDeskWanDirection up;          // 客户端 -> 服务器
+
+    uint32_t rng;
+    uint64_t stallStartNs;          // 下一次 (或当前) 断流的开始和结束，0 表示不断流
+    uint64_t stallEndNs;
+    _Atomic uint32_t stalls;
+    _Atomic uint64_t stalledNs;
+};
+
+static uint64_t viDesk_wanNowNs(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// xorshift32：可复现的伪随机序列
+static uint32_t viDesk_wanRandom(ViDeskWanEmulator* emulator) {
+    uint32_t x = emulator->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    emulator->rng = x;
+    return x;
+}
+
+// [0, range] 内均匀分布
+static uint64_t viDesk_wanUniform(ViDeskWanEmulator* emulator, uint64_t range) {
+    return range ? (uint64_t)viDesk_wanRandom(emulator) % (range + 1) : 0;
+}
+
+// 从 afterNs 起安排下一次断流：间隔在平均值的 0.5~1.5 倍之间
+static void viDesk_wanScheduleStall(ViDeskWanEmulator* emulator, uint64_t afterNs) {
+    uint64_t intervalNs = (uint64_t)emulator->profile.stallIntervalMs * 1000000ULL;
+    if (intervalNs == 0 || emulator->profile.stallMs == 0) {
+        emulator->stallStartNs = emulator->stallEndNs = 0;
+        return;
+    }
+    emulator->stallStartNs = afterNs + intervalNs / 2 + viDesk_wanUniform(emulator, intervalNs);
+    emulator->stallEndNs = emulator->stallStartNs + (uint64_t)emulator->profile.stallMs * 1000000ULL;
+}
+
+static bool viDesk_wanStalled(ViDeskWanEmulator* emulator, uint64_t now) {
+    if (emulator->stallStartNs == 0)
+        return false;
+
+    while (now >= emulator->stallEndNs) {
+        atomic_fetch_add(&emulator->stalls, 1);
+        atomic_fetch_add(&emulator->stalledNs, emulator->stallEndNs - emulator->stallStartNs);
+        viDesk_wanScheduleStall(emulator, emulator->stallEndNs);
+    }
+    return now >= emulator->stallStartNs;
+}
+
+static void viDesk_wanSetNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+static void viDesk_wanDirectionFree(ViDeskWanDirection* direction) {
+    ViDeskWanChunk* chunk = direction->head;
+    while (chunk) {
+        ViDeskWanChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    direction->head = direction->tail = NULL;
+    direction->queued = 0;
+}
+
+// 从源端读入一块并计算交付时刻；返回 false 表示出错
+static bool viDesk_wanReceive(ViDeskWanEmulator* emulator, ViDeskWanDirection* direction, uint64_t now) {
+    ViDeskWanChunk* chunk = malloc(sizeof(ViDeskWanChunk) + VIDESK_WAN_CHUNK_SIZE);
+    if (!chunk)
+        return false;
+
+    ssize_t status;
+    do {
+        status = recv(direction->from, chunk->data, VIDESK_WAN_CHUNK_SIZE, 0);
+    } while (status < 0 && errno == EINTR);
+
+    if (status <= 0) {
+        free(chunk);
+        if (status == 0) {
+            direction->eof = true;
+            return true;
+        }
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+    // 带宽：链路空闲后开始发送，发送耗时 = 比特数 / 速率
+    uint64_t departNs = now;
+    if (direction->kbps > 0) {
+        uint64_t start = direction->linkFreeNs > now ? direction->linkFreeNs : now;
+        departNs = start + (uint64_t)status * 8000000ULL / direction->kbps;
+        direction->linkFreeNs = departNs;
+    }
+
+    // 延迟和抖动：抖动只推迟不提前到上一块之前，保持字节流顺序
+    uint64_t latencyNs = (uint64_t)emulator->profile.latencyMs * 1000000ULL;
+    uint64_t jitterNs = (uint64_t)emulator->profile.jitterMs * 1000000ULL;
+    uint64_t delayNs = latencyNs + viDesk_wanUniform(emulator, jitterNs * 2);
+    delayNs = delayNs > jitterNs ? delayNs - jitterNs : 0;
+    uint64_t releaseNs = departNs + delayNs;
+    if (releaseNs < direction->lastReleaseNs)
+        releaseNs = direction->lastReleaseNs;
+    direction->lastReleaseNs = releaseNs;
+
+    chunk->next = NULL;
+    chunk->queuedNs = now;
+    chunk->releaseNs = releaseNs;
+    chunk->length = (size_t)status;
+    chunk->offset = 0;
+    if (direction->tail)
+        direction->tail->next = chunk;
+    else
+        direction->head = chunk;
+    direction->tail = chunk;
+
+    direction->queued += (size_t)status;
+    if (direction->queued > atomic_load_explicit(&direction->peakQueued, memory_order_relaxed))
+        atomic_store_explicit(&direction->peakQueued, direction->queued, memory_order_relaxed);
+    return true;
+}
+
+// 把到期的数据写到目的端；返回 false 表示出错
+static bool viDesk_wanDeliver(ViDeskWanDirection* direction, uint64_t now) {
+    direction->writeBlocked = false;
+    while (direction->head && direction->head->releaseNs <= now) {
+        ViDeskWanChunk* chunk = direction->head;
+#ifdef MSG_NOSIGNAL
+        ssize_t status = send(direction->to, chunk->data + chunk->offset, chunk->length - chunk->offset, MSG_NOSIGNAL);
+#else
+        ssize_t status = send(direction->to, chunk->data + chunk->offset, chunk->length - chunk->offset, 0);
+#endif
+        if (status < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                direction->writeBlocked = true;
+                return true;
+            }
+            return false;
+        }
+
+        chunk->offset += (size_t)status;
+        direction->queued -= (size_t)status;
+        atomic_fetch_add_explicit(&direction->bytes, (uint64_t)status, memory_order_relaxed);
+        if (chunk->offset < chunk->length)
+            continue;
+
+        atomic_fetch_add_explicit(&direction->chunks, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&direction->totalDelayNs, now - chunk->queuedNs, memory_order_relaxed);
+        direction->head = chunk->next;
+        if (!direction->head)
+            direction->tail = NULL;
+        free(chunk);
+    }
+
+    // 源端已关闭且数据已交付完，向目的端转发关闭
+    if (direction->eof && !direction->head && !direction->shutdown) {
+        shutdown(direction->to, SHUT_WR);
+        direction->shutdown = true;
+    }
+    return true;
+}
+
+static void* viDesk_wanThread(void* arg) {
+    ViDeskWanEmulator* emulator = arg;
+    ViDeskWanDirection* directions[2] = { &emulator->down, &emulator->up };
+
+    viDesk_wanScheduleStall(emulator, viDesk_wanNowNs());
+
+    while (!atomic_load(&emulator->stopping)) {
+        uint64_t now = viDesk_wanNowNs();
+        bool stalled = viDesk_wanStalled(emulator, now);
+
+        bool ok = true;
+        if (!stalled) {
+            for (int i = 0; i < 2 && ok; i++)
+                ok = viDesk_wanDeliver(directions[i], now);
+        }
+        if (!ok || (emulator->down.shutdown && emulator->up.shutdown))
+            break;
+
+        // 下一个定时事件：断流结束，或最早一块数据到期
+        uint64_t wakeNs = 0;
+        if (stalled) {
+            wakeNs = emulator->stallEndNs;
+        } else {
+            for (int i = 0; i < 2; i++) {
+                ViDeskWanDirection* direction = directions[i];
+                if (direction->head && !direction->writeBlocked &&
+                    (wakeNs == 0 || direction->head->releaseNs < wakeNs))
+                    wakeNs = direction->head->releaseNs;
+            }
+            if (emulator->stallStartNs && (wakeNs == 0 || emulator->stallStartNs < wakeNs))
+                wakeNs = emulator->stallStartNs;
+        }
+
+        struct pollfd pfds[5];
+        ViDeskWanDirection* readers[2] = { NULL, NULL };
+        ViDeskWanDirection* writers[2] = { NULL, NULL };
+        nfds_t nfds = 0;
+        pfds[nfds++] = (struct pollfd){ .fd = emulator->wakePipe[0], .events = POLLIN };
+        for (int i = 0; i < 2; i++) {
+            ViDeskWanDirection* direction = directions[i];
+            if (!direction->eof && direction->queued < VIDESK_WAN_QUEUE_LIMIT) {
+                readers[i] = direction;
+                pfds[nfds++] = (struct pollfd){ .fd = direction->from, .events = POLLIN };
+            }
+            if (direction->writeBlocked && !stalled) {
+                writers[i] = direction;
+                pfds[nfds++] = (struct pollfd){ .fd = direction->to, .events = POLLOUT };
+            }
+        }
+
+        int waitMs = VIDESK_WAN_IDLE_WAIT_MS;
+        if (wakeNs) {
+            uint64_t remaining = wakeNs > now ? wakeNs - now : 0;
+            waitMs = (int)((remaining + 999999ULL) / 1000000ULL);
+            if (waitMs > VIDESK_WAN_IDLE_WAIT_MS)
+                waitMs = VIDESK_WAN_IDLE_WAIT_MS;
+        }
+
+        int status = poll(pfds, nfds, waitMs);
+        if (status < 0 && errno != EINTR)
+            break;
+        if (status <= 0)
+            continue;
+
+        now = viDesk_wanNowNs();
+        nfds_t index = 1;
+        for (int i = 0; i < 2 && ok; i++) {
+            if (readers[i]) {
+                if (pfds[index].revents & (POLLIN | POLLHUP | POLLERR))
+                    ok = viDesk_wanReceive(emulator, readers[i], now);
+                index++;
+            }
+            if (writers[i])
+                index++;    // 可写时下一轮投递
+        }
+        if (!ok)
+            break;
+    }
+
+    // 出错或两个方向都已关闭：让传输层读到连接关闭
+    shutdown(emulator->pairFd, SHUT_RDWR);
+    shutdown(emulator->serverFd, SHUT_RDWR);
+    atomic_store(&emulator->running, false);
+    return NULL;
+}
+
+static void viDesk_wanEmulatorDestroy(ViDeskWanEmulator* emulator) {
+    viDesk_wanEmulatorStop(emulator);
+    viDesk_wanDirectionFree(&emulator->down);
+    viDesk_wanDirectionFree(&emulator->up);
+    pthread_mutex_destroy(&emulator->stopLock);
+    free(emulator);
+}
+
+ViDeskWanEmulator* viDesk_wanEmulatorStart(int serverFd, const ViDeskWanProfile* profile, int* clientFd) {
+    if (serverFd < 0 || !profile || !clientFd)
+        return NULL;
+
+    ViDeskWanEmulator* emulator = calloc(1, sizeof(ViDeskWanEmulator));
+    if (!emulator)
+        return NULL;
+
+    int pair[2];
+    if (pthread_mutex_init(&emulator->stopLock, NULL) != 0) {
+        free(emulator);
+        return NULL;
+    }
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+        pthread_mutex_destroy(&emulator->stopLock);
+        free(emulator);
+        return NULL;
+    }
+    if (pipe(emulator->wakePipe) != 0) {
+        close(pair[0]);
+        close(pair[1]);
+        pthread_mutex_destroy(&emulator->stopLock);
+        free(emulator);
+        return NULL;
+    }
+
+    atomic_store(&emulator->refs, 1);
+    emulator->profile = *profile;
+    emulator->rng = profile->seed ? profile->seed : 1;
+    emulator->serverFd = serverFd;
+    emulator->pairFd = pair[1];
+    viDesk_wanSetNonBlocking(pair[0]);
+    viDesk_wanSetNonBlocking(pair[1]);
+    viDesk_wanSetNonBlocking(serverFd);
+
+    emulator->down.from = serverFd;
+    emulator->down.to = pair[1];
+    emulator->down.kbps = profile->downlinkKbps;
+    emulator->up.from = pair[1];
+    emulator->up.to = serverFd;
+    emulator->up.kbps = profile->uplinkKbps;
+
+    atomic_store(&emulator->running, true);
+    if (pthread_create(&emulator->thread, NULL, viDesk_wanThread, emulator) != 0) {
+        close(pair[0]);
+        close(pair[1]);
+        close(emulator->wakePipe[0]);
+        close(emulator->wakePipe[1]);
+        pthread_mutex_destroy(&emulator->stopLock);
+        free(emulator);
+        return NULL;
+    }
+    emulator->threadRunning = true;
+
+    *clientFd = pair[0];
+    return emulator;
+}
+
+void viDesk_wanEmulatorStop(ViDeskWanEmulator* emulator) {
+    if (!emulator)
+        return;
+
+    pthread_mutex_lock(&emulator->stopLock);
+    if (emulator->threadRunning) {
+        atomic_store(&emulator->stopping, true);
+        char byte = 0;
+        ssize_t written = write(emulator->wakePipe[1], &byte, 1);
+        (void)written;
+        pthread_join(emulator->thread, NULL);
+        emulator->threadRunning = false;
+
+        close(emulator->serverFd);
+        close(emulator->pairFd);
+        close(emulator->wakePipe[0]);
+        close(emulator->wakePipe[1]);
+        emulator->serverFd = emulator->pairFd = -1;
+        atomic_store(&emulator->running, false);
+    }
+    pthread_mutex_unlock(&emulator->stopLock);
+}
+
+void viDesk_wanEmulatorRetain(ViDeskWanEmulator* emulator) {
+    if (emulator)
+        atomic_fetch_add(&emulator->refs, 1);
+}
+
+void viDesk_wanEmulatorRelease(ViDeskWanEmulator* emulator) {
+    if (emulator && atomic_fetch_sub(&emulator->refs, 1) == 1)
+        viDesk_wanEmulatorDestroy(emulator);
+}
+
+void viDesk_wanEmulatorGetStats(ViDeskWanEmulator* emulator, ViDeskWanEmulationStats* stats) {
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!emulator)
+        return;
+
+    stats->enabled = true;
+    stats->running = atomic_load(&emulator->running);
+    stats->profile = emulator->profile;
+    stats->bytesDown = atomic_load(&emulator->down.bytes);
+    stats->bytesUp = atomic_load(&emulator->up.bytes);
+    stats->chunksDown = atomic_load(&emulator->down.chunks);
+    stats->chunksUp = atomic_load(&emulator->up.chunks);
+    stats->totalDelayDownNs = atomic_load(&emulator->down.totalDelayNs);
+    stats->totalDelayUpNs = atomic_load(&emulator->up.totalDelayNs);
+    stats->peakQueuedDown = atomic_load(&emulator->down.peakQueued);
+    stats->peakQueuedUp = atomic_load(&emulator->up.peakQueued);
+    stats->stalls = atomic_load(&emulator->stalls);
+    stats->stalledNs = atomic_load(&emulator->stalledNs);
+}
+
+bool viDesk_wanProfilePreset(ViDeskWanPreset preset, ViDeskWanProfile* profile) {
+    if (!profile)
+        return false;
+
+    memset(profile, 0, sizeof(*profile));
+    profile->seed = 1;
+    switch (preset) {
+        case VIDESK_WAN_PRESET_LTE:
+            // 往返约 70 ms，抖动明显，上行较窄，偶尔切换基站
+            profile->latencyMs = 35;
+            profile->jitterMs = 15;
+            profile->downlinkKbps = 20000;
+            profile->uplinkKbps = 5000;
+            profile->stallIntervalMs = 20000;
+            profile->stallMs = 400;
+            return true;
+        case VIDESK_WAN_PRESET_HOTEL_WIFI:
+            // 共享的窄带宽，抖动大，频繁的短时断流
+            profile->latencyMs = 40;
+            profile->jitterMs = 30;
+            profile->downlinkKbps = 3000;
+            profile->uplinkKbps = 1000;
+            profile->stallIntervalMs = 8000;
+            profile->stallMs = 1000;
+            return true;
+        case VIDESK_WAN_PRESET_TRANSATLANTIC:
+            // 往返约 90 ms 的有线链路：延迟高，但带宽充足、稳定
+            profile->latencyMs = 45;
+            profile->jitterMs = 3;
+            profile->downlinkKbps = 100000;
+            profile->uplinkKbps = 50000;
+            return true;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef ViDeskWanEmulator_h
+#define ViDeskWanEmulator_h
+
+#include "FreeRDPBridge.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// WAN 模拟 (桥接层内部使用，用于本地性能测试)
+/// 池化传输层连上服务器后，用一对本地套接字把转发线程插在中间：传输层读写其中一端，
+/// 转发线程在另一端和服务器套接字之间双向搬运数据，并按配置加入
+/// - 单向延迟和抖动 (抖动不会打乱顺序，与 TCP 一致)
+/// - 带宽上限：按字节数计算发送耗时，链路忙时排队，排队超过上限时停止读取，让发送方感受到拥塞
+/// - 断流：按平均间隔随机出现，期间两个方向都不交付数据，模拟丢包重传和无线网络切换
+/// 抖动和断流的随机序列由 seed 决定，同一配置的多次测试条件相同
+typedef struct ViDeskWanEmulator ViDeskWanEmulator;
+
+/// 启动转发线程，成功时 *clientFd 为交给传输层的一端 (非阻塞)，serverFd 的所有权转给模拟器
+/// 返回的对象引用计数为 1
+ViDeskWanEmulator* viDesk_wanEmulatorStart(int serverFd, const ViDeskWanProfile* profile, int* clientFd);
+
+/// 停止转发线程并关闭服务器套接字 (可重复调用，传输层关闭时调用)
+void viDesk_wanEmulatorStop(ViDeskWanEmulator* emulator);
+
+/// 引用计数：传输层和统计各持有一个引用，最后一个释放时停止并释放
+void viDesk_wanEmulatorRetain(ViDeskWanEmulator* emulator);
+void viDesk_wanEmulatorRelease(ViDeskWanEmulator* emulator);
+
+/// 获取统计 (线程安全)
+void viDesk_wanEmulatorGetStats(ViDeskWanEmulator* emulator, ViDeskWanEmulationStats* stats);
+
+/// 预设的网络条件，preset 无效或为 NONE 时返回 false
+bool viDesk_wanProfilePreset(ViDeskWanPreset preset, ViDeskWanProfile* profile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ViDeskWanEmulator_h */
@@ -1,6 +1,7 @@
 import Foundation
 import Combine
 import SwiftUI
+import QuartzCore
 
 /// RDP 会话管理器
 /// 负责管理 RDP 连接的完整生命周期
@@ -21,29 +22,60 @@ final class RDPSession {
     /// 远程剪贴板文本 (当远程用户复制文本时更新)
     private(set) var remoteClipboardText: String?
 
+    /// 是否正在录制输入
+    private(set) var isRecordingInput: Bool = false
+
+    /// 是否使用池化传输层 (下次连接生效，关闭时使用 FreeRDP 默认实现以便对比)
+    @ObservationIgnored var usesPooledTransport: Bool = true
+
+    /// 批量压缩级别 (下次连接生效)
+    @ObservationIgnored var compressionLevel: FreeRDPContext.CompressionLevel = .xcrush
+
+    /// WAN 模拟 (下次连接生效，nil 为不模拟；只作用于池化传输层)
+    @ObservationIgnored var wanProfile: FreeRDPContext.WanProfile?
+
+    /// 服务器主动移动指针时的回调 (桌面坐标)，输入管理器据此校正本地预测的光标
+    @ObservationIgnored var onServerPointerMoved: ((CGPoint) -> Void)?
+
+    /// 服务器当前的光标形状 (渲染器创建时据此初始化)
+    @ObservationIgnored private(set) var pointerShape: FreeRDPContext.PointerShape = .systemDefault
+
+    /// 服务器切换光标形状时的回调，渲染器据此更新光标叠加层
+    @ObservationIgnored var onPointerShapeChanged: ((FreeRDPContext.PointerShape) -> Void)?
+
     // MARK: - 私有属性
 
     private let context: FreeRDPContext
+    private weak var manager: SessionManager?
     private var config: ConnectionConfig?
     private var savedPassword: String?  // 保存密码用于重连
-    private var eventLoopTask: Task<Void, Never>?
+    private var eventLoopThread: Thread?
+    private var eventLoopExited: DispatchSemaphore?  // 独立事件线程退出时发出
+    private var eventLoopStopping: Task<Void, Never>?  // 等待独立事件线程退出
+    private var teardown: Task<Void, Never>?  // disconnect() 发起的事件线程停止和连接释放
     private var statisticsTimer: Timer?
     private var connectionStartTime: Date?
     private var reconnectAttempt: Int = 0
+    private var pendingSessionDump: (mode: FreeRDPContext.SessionDumpMode, url: URL)?  // 下次连接时应用
+    private var sessionDumpInfo = FreeRDPContext.SessionDumpInfo()
+    private var isReplayingSession = false  // 回放读完文件后的断开不是掉线，不重连
 
-    private let maxReconnectAttempts = 3
-    private let reconnectDelay: TimeInterval = 2.0
+    private let maxReconnectAttempts = 5
+    private let reconnectBaseDelay: TimeInterval = 0.5
+    private let reconnectMaxDelay: TimeInterval = 8.0
 
     // MARK: - 初始化
 
-    init() {
+    /// - Parameter manager: 共享调度的会话管理器；为 nil 时使用独立事件线程
+    init(manager: SessionManager? = nil) {
         self.context = FreeRDPContext()
+        self.manager = manager
         setupContextCallbacks()
     }
 
     deinit {
         Task { @MainActor [weak self] in
-            self?.cleanup()
+            await self?.cleanup()
         }
     }
 
@@ -63,18 +95,29 @@ final class RDPSession {
         self.savedPassword = password
         self.reconnectAttempt = 0
 
+        // 上一次 disconnect() 的连接释放完成后才能重新创建连接
+        await teardown?.value
         try await performConnect(password: password)
     }
 
     /// 断开连接
+    /// 状态立即变为 disconnected；等待事件线程退出和释放连接在后台完成，不阻塞主线程
     func disconnect() {
-        stopEventLoop()
+        if isRecordingInput {
+            _ = stopInputRecording()
+        }
         stopStatisticsTimer()
-        context.disconnect()
         state = .disconnected
         connectionStartTime = nil
         frameBuffer = nil
         // 注意：不断开 savedPassword，以便重连时使用
+
+        let previous = teardown
+        teardown = Task {
+            await previous?.value
+            await stopEventLoop()
+            context.disconnect()
+        }
     }
 
     /// 重新连接
@@ -88,6 +131,11 @@ final class RDPSession {
         try await connect(config: config, password: savedPassword)
     }
 
+    /// 原始上下文指针 (供会话管理器调度)
+    var rawContextPointer: UnsafeMutablePointer<ViDeskContext>? {
+        context.rawContextPointer
+    }
+
     // MARK: - 输入 API
 
     /// 发送鼠标移动
@@ -96,6 +144,23 @@ final class RDPSession {
         _ = context.sendMouseMove(x: x, y: y)
     }
 
+    /// 发送相对鼠标移动，服务器不支持 ainput 时返回 false (调用方回退到绝对坐标)
+    func sendMouseRelative(dx: Double, dy: Double) -> Bool {
+        guard state == .connected else { return false }
+        return context.sendMouseRelative(dx: dx, dy: dy)
+    }
+
+    /// 服务器是否支持多点触控
+    var supportsTouch: Bool {
+        state == .connected && context.isTouchAvailable
+    }
+
+    /// 发送触控帧，服务器不支持 RDPEI 时返回 false
+    func sendTouchFrame(_ contacts: [TouchContact]) -> Bool {
+        guard state == .connected else { return false }
+        return context.sendTouchFrame(contacts)
+    }
+
     /// 发送鼠标点击
     func sendMouseClick(button: MouseButton, x: Int, y: Int) {
         guard state == .connected else { return }
@@ -129,12 +194,8 @@ final class RDPSession {
 
     /// 发送文本输入
     func sendText(_ text: String) {
-        guard state == .connected else { return }
-        for scalar in text.unicodeScalars {
-            if scalar.value <= UInt16.max {
-                _ = context.sendUnicodeKey(UInt16(scalar.value))
-            }
-        }
+        guard state == .connected, !text.isEmpty else { return }
+        _ = context.sendUnicodeText(text)
     }
 
     /// 发送特殊按键组合
@@ -164,12 +225,203 @@ final class RDPSession {
         return context.getClipboardText()
     }
 
+    // MARK: - 发送统计
+
+    /// 出站发送统计 (大通道消息分片与输入耗时)
+    func sendStatistics() -> FreeRDPContext.SendStatistics {
+        context.sendStatistics()
+    }
+
+    /// 重置出站发送统计
+    func resetSendStatistics() {
+        context.resetSendStatistics()
+    }
+
+    /// 渲染器回报帧已呈现 (presentedTime 为 CACurrentMediaTime 时基)
+    func recordFramePresented(sequence: UInt64, presentedTime: CFTimeInterval) {
+        context.recordFramePresented(sequence: sequence, age: CACurrentMediaTime() - presentedTime)
+    }
+
+    /// 获取输入到上屏延迟统计
+    func latencyStatistics() -> FreeRDPContext.LatencyStatistics {
+        context.latencyStatistics()
+    }
+
+    /// 重置输入到上屏延迟统计
+    func resetLatencyStatistics() {
+        context.resetLatencyStatistics()
+    }
+
+    /// 最近的每秒统计样本 (帧率、解码字节、带宽、往返时间的历史)
+    func statisticsHistory() -> [FreeRDPContext.StatisticsSample] {
+        context.statisticsHistory()
+    }
+
+    /// 各虚拟通道的字节和消息数 (静态通道和 drdynvc 上的动态通道)
+    func channelStatistics() -> [FreeRDPContext.ChannelStatistics] {
+        context.channelStatistics()
+    }
+
+    /// 某个虚拟通道最近的每秒样本
+    func channelHistory(for channel: FreeRDPContext.ChannelStatistics) -> [FreeRDPContext.ChannelSample] {
+        context.channelHistory(for: channel)
+    }
+
+    /// 启用/停用自适应画质 (默认启用)
+    func setAdaptiveQuality(_ enabled: Bool) {
+        context.setAdaptiveQuality(enabled)
+    }
+
+    /// 自适应画质状态及调整记录
+    func qualityState() -> FreeRDPContext.QualityState {
+        context.qualityState()
+    }
+
+    func qualityDecisions() -> [FreeRDPContext.QualityDecision] {
+        context.qualityDecisions()
+    }
+
+    /// 获取传输层统计 (系统调用、每次 recv 的 PDU 数、接收路径分配)
+    func transportStatistics() -> FreeRDPContext.TransportStatistics {
+        context.transportStatistics()
+    }
+
+    func resetTransportStatistics() {
+        context.resetTransportStatistics()
+    }
+
+    /// 获取光标缓存统计 (命中率)
+    func pointerCacheStatistics() -> FreeRDPContext.PointerCacheStatistics {
+        context.pointerCacheStatistics()
+    }
+
+    // MARK: - 输入录制与回放
+
+    /// 输入录制文件目录 (Documents/InputRecordings)
+    static var inputRecordingsDirectory: URL {
+        FileManager.default.urls(for: .documentDirectory, in: .userDomainMask).first!
+            .appendingPathComponent("InputRecordings", isDirectory: true)
+    }
+
+    /// 开始录制本会话的输入，返回录制文件位置
+    func startInputRecording() -> URL? {
+        let directory = Self.inputRecordingsDirectory
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+
+        let formatter = DateFormatter()
+        formatter.dateFormat = "yyyyMMdd-HHmmss"
+        let url = directory.appendingPathComponent("input-\(formatter.string(from: Date())).vdir")
+
+        guard context.startInputRecording(to: url) else {
+            vLog("无法开始输入录制: \(context.lastError ?? "未知错误")")
+            return nil
+        }
+        isRecordingInput = true
+        vLog("开始输入录制: \(url.lastPathComponent)")
+        return url
+    }
+
+    /// 结束输入录制
+    func stopInputRecording() -> FreeRDPContext.InputReplayStatistics? {
+        isRecordingInput = false
+        guard let stats = context.stopInputRecording() else { return nil }
+        vLog("输入录制结束: \(stats.events) 个事件, \(String(format: "%.1f", stats.duration)) 秒, \(stats.bytes) 字节")
+        return stats
+    }
+
+    /// 按原始时间间隔回放录制文件
+    func replayInput(from url: URL) async -> (completed: Bool, statistics: FreeRDPContext.InputReplayStatistics) {
+        await context.replayInput(from: url)
+    }
+
+    /// 取消正在进行的回放
+    func cancelInputReplay() {
+        context.cancelInputReplay()
+    }
+
+    // MARK: - 会话录制与回放
+
+    /// 会话录制文件目录 (Documents/SessionCaptures)
+    static var sessionCapturesDirectory: URL {
+        FileManager.default.urls(for: .documentDirectory, in: .userDomainMask).first!
+            .appendingPathComponent("SessionCaptures", isDirectory: true)
+    }
+
+    /// 录制下一次连接收发的 PDU (在 connect 之前调用)，返回录制文件位置
+    func captureNextConnection() -> URL {
+        let directory = Self.sessionCapturesDirectory
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+
+        let formatter = DateFormatter()
+        formatter.dateFormat = "yyyyMMdd-HHmmss"
+        let url = directory.appendingPathComponent("session-\(formatter.string(from: Date())).vdsd")
+        pendingSessionDump = (.capture, url)
+        return url
+    }
+
+    /// 回放会话录制：不连接服务器，尽快把录制的 PDU 送入解码、GDI 和帧更新流程，读完后返回结果
+    /// config 的显示和安全设置应与录制时一致
+    /// - Returns: 录制文件概况和回放结果
+    func replaySession(from url: URL, config: ConnectionConfig) async throws
+        -> (info: FreeRDPContext.SessionDumpInfo, statistics: FreeRDPContext.SessionReplayStatistics) {
+        pendingSessionDump = (.replay, url)
+        isReplayingSession = true
+        defer { isReplayingSession = false }
+        try await connect(config: config)
+
+        // 读完文件后传输层断开，handleDisconnection 把状态设为 disconnected
+        while state.isActive {
+            try? await Task.sleep(for: .milliseconds(100))
+        }
+        return (sessionDumpInfo, context.sessionReplayStatistics())
+    }
+
+    /// 回放进行中的统计
+    func sessionReplayStatistics() -> FreeRDPContext.SessionReplayStatistics {
+        context.sessionReplayStatistics()
+    }
+
+    /// 连接存活检测统计 (心跳、静默时间、判定断开次数)
+    func livenessStatistics() -> FreeRDPContext.LivenessStatistics {
+        context.livenessStatistics()
+    }
+
+    /// WAN 模拟统计
+    func wanEmulationStatistics() -> FreeRDPContext.WanEmulationStatistics {
+        context.wanEmulationStatistics()
+    }
+
+    /// 批量压缩统计
+    func compressionStatistics() -> FreeRDPContext.CompressionStatistics {
+        context.compressionStatistics()
+    }
+
+    /// 快速重连统计 (掉线到重连完成、到第一帧的时间)
+    func reconnectStatistics() -> FreeRDPContext.ReconnectStatistics {
+        context.reconnectStatistics()
+    }
+
+    /// 无界面会话 (没有渲染器) 使用：帧更新即视为已呈现
+    func setHeadlessPresentation(_ enabled: Bool) {
+        context.setHeadlessPresentation(enabled)
+    }
+
+    /// 获取触控统计
+    func touchStatistics() -> FreeRDPContext.TouchStatistics {
+        context.touchStatistics()
+    }
+
+    /// 重置触控统计
+    func resetTouchStatistics() {
+        context.resetTouchStatistics()
+    }
+
     // MARK: - 私有方法
 
     private func setupContextCallbacks() {
-        context.setFrameUpdateHandler { [weak self] rect in
+        context.setFrameUpdateHandler { [weak self] rect, sequence in
             Task { @MainActor in
-                self?.handleFrameUpdate(rect: rect)
+                self?.handleFrameUpdate(rect: rect, sequence: sequence)
             }
         }
 
@@ -190,6 +442,20 @@ final class RDPSession {
                 self?.handleRemoteClipboardChanged(text)
             }
         }
+
+        context.setPointerPositionHandler { [weak self] point in
+            Task { @MainActor in
+                self?.onServerPointerMoved?(point)
+            }
+        }
+
+        context.setPointerShapeHandler { [weak self] shape in
+            Task { @MainActor in
+                guard let self = self else { return }
+                self.pointerShape = shape
+                self.onPointerShapeChanged?(shape)
+            }
+        }
     }
 
     private func performConnect(password: String?) async throws {
@@ -203,6 +469,9 @@ final class RDPSession {
             throw RDPError.connectionFailed("无法创建 RDP 上下文")
         }
         vLog("  [成功] FreeRDP 上下文已创建")
+        context.setPooledTransport(usesPooledTransport)
+        context.setCompressionLevel(compressionLevel)
+        context.setWanEmulation(wanProfile)
 
         guard let config = config else {
             vLog("  [失败] 无效的连接配置")
@@ -251,6 +520,33 @@ final class RDPSession {
             _ = context.setGateway(hostname: gateway)
         }
 
+        if let dump = pendingSessionDump {
+            pendingSessionDump = nil
+            guard let info = context.setSessionDump(dump.mode, url: dump.url) else {
+                let errorMessage = context.lastError ?? "无法打开会话录制文件"
+                vLog("  [失败] \(errorMessage)")
+                state = .error(.connectionFailed(errorMessage))
+                throw RDPError.connectionFailed(errorMessage)
+            }
+            sessionDumpInfo = info
+            if dump.mode == .replay {
+                vLog("  回放会话录制: \(dump.url.lastPathComponent), \(info.serverRecords) 个入站 PDU, \(info.serverBytes) 字节")
+                // 回放没有渲染器跟随：帧更新即视为已呈现，画质保持不变，结果才可重复
+                context.setHeadlessPresentation(true)
+                context.setAdaptiveQuality(false)
+            } else {
+                vLog("  录制会话到: \(dump.url.lastPathComponent)")
+            }
+        }
+
+        if let manager = manager {
+            guard manager.admit(self) else {
+                vLog("  [失败] 超出会话内存预算")
+                state = .error(.connectionFailed("超出会话内存预算"))
+                throw RDPError.connectionFailed("超出会话内存预算")
+            }
+        }
+
         vLog("  开始执行连接...")
         state = .authenticating
         let connected = await context.connect()
@@ -263,6 +559,7 @@ final class RDPSession {
             startStatisticsTimer()
             state = .connected
         } else {
+            manager?.remove(self)
             let errorMessage = context.lastError ?? "未知错误"
             vLog("  [失败] 连接失败: \(errorMessage)")
             state = .error(.connectionFailed(errorMessage))
@@ -293,7 +590,7 @@ final class RDPSession {
         initializeFrameBuffer()
     }
 
-    private func handleFrameUpdate(rect: CGRect) {
+    private func handleFrameUpdate(rect: CGRect, sequence: UInt64) {
         guard let frameBuffer = frameBuffer,
               let sourceBuffer = context.frameBuffer else { return }
 
@@ -304,7 +601,7 @@ final class RDPSession {
         let y = Int(rect.origin.y)
         if x + w > frameBuffer.width || y + h > frameBuffer.height { return }
 
-        frameBuffer.update(from: sourceBuffer, region: rect)
+        frameBuffer.update(from: sourceBuffer, region: rect, sequence: sequence)
     }
 
     private func handleConnectionStateChange(_ connectionState: FreeRDPContext.ConnectionState) {
@@ -329,47 +626,127 @@ final class RDPSession {
     }
 
     private func handleDisconnection() {
+        // 主动断开时 disconnect() 已把状态设为 disconnected，PostDisconnect 的通知随后才到
+        guard state != .disconnected else { return }
+
         vLog("handleDisconnection() - autoReconnect: \(config?.autoReconnect ?? false), attempt: \(reconnectAttempt)/\(maxReconnectAttempts)")
-        stopEventLoop()
         stopStatisticsTimer()
 
-        guard let config = config, config.autoReconnect,
-              reconnectAttempt < maxReconnectAttempts else {
+        guard let config = config, config.autoReconnect, !isReplayingSession else {
             vLog("  不再重连，设为 disconnected")
-            state = .disconnected
+            disconnect()
             return
         }
 
         Task {
+            await stopEventLoop()
+            // 等待事件线程退出期间用户可能已主动断开
+            guard state != .disconnected else { return }
+            await reconnectAfterDrop(hostname: config.hostname)
+        }
+    }
+
+    /// 掉线后保留上下文快速重连：第一次立即重试，之后按指数退避加随机抖动等待
+    private func reconnectAfterDrop(hostname: String) async {
+        while reconnectAttempt < maxReconnectAttempts {
             reconnectAttempt += 1
-            vLog("  自动重连 #\(reconnectAttempt), savedPassword长度: \(savedPassword?.count ?? 0)")
             state = .reconnecting(attempt: reconnectAttempt)
 
-            context.disconnect()
-            context.destroy()
+            let delay = reconnectDelay(forAttempt: reconnectAttempt)
+            vLog("  快速重连 #\(reconnectAttempt) \(hostname), 等待 \(String(format: "%.2f", delay)) 秒")
+            if delay > 0 {
+                try? await Task.sleep(for: .seconds(delay))
+            }
+            guard case .reconnecting = state else { return }
+
+            if let manager = manager, !manager.admit(self) {
+                vLog("  [失败] 超出会话内存预算")
+                break
+            }
 
-            try? await Task.sleep(for: .seconds(reconnectDelay))
-            try? await performConnect(password: savedPassword)
+            let resumed = await context.reconnect()
+
+            // 重连期间主动断开：viDesk_disconnect 只中止了重连，这里释放连接
+            guard case .reconnecting = state else {
+                manager?.remove(self)
+                context.disconnect()
+                return
+            }
+
+            if resumed {
+                let stats = context.reconnectStatistics()
+                vLog("  [成功] 快速重连: 掉线到连接 \(Int(stats.lastDropToConnect * 1000)) ms, cookie: \(stats.hasCookie)")
+                reconnectAttempt = 0
+                connectionStartTime = Date()
+                initializeFrameBuffer()
+                startEventLoop()
+                startStatisticsTimer()
+                state = .connected
+                return
+            }
+
+            manager?.remove(self)
+            vLog("  [失败] 快速重连: \(context.lastError ?? "未知错误")")
         }
+
+        vLog("  重连 \(reconnectAttempt) 次未成功，设为 disconnected")
+        state = .disconnected
+        context.disconnect()
+    }
+
+    /// 第 attempt 次重连前的等待时间
+    /// 第一次立即重试 (短暂断网最常见)，之后从 reconnectBaseDelay 开始翻倍，
+    /// 乘以 0.5~1 的随机系数，避免同一故障下的多个会话同时重连
+    private func reconnectDelay(forAttempt attempt: Int) -> TimeInterval {
+        guard attempt > 1 else { return 0 }
+        let backoff = min(reconnectBaseDelay * pow(2, Double(attempt - 2)), reconnectMaxDelay)
+        return backoff * Double.random(in: 0.5...1.0)
     }
 
     private func startEventLoop() {
-        let rawCtx = context.rawContextPointer
-        eventLoopTask = Task.detached(priority: .high) {
-            while !Task.isCancelled {
-                guard let rawCtx = rawCtx else { break }
-                let success = viDesk_processEvents(rawCtx, 16)
-                if !success {
+        // 由会话管理器的共享工作线程驱动
+        if let manager = manager {
+            manager.start(self)
+            return
+        }
+
+        guard let rawCtx = context.rawContextPointer else { return }
+
+        // 每个会话使用独立线程：viDesk_processEvents 会阻塞等待事件，
+        // 放在协作线程池中时多个会话会占满线程池
+        // 该线程同时负责网络 I/O 和解码，按网络角色设置调度策略
+        let exited = DispatchSemaphore(value: 0)
+        let thread = Thread {
+            viDesk_enterThreadRole(VIDESK_THREAD_ROLE_NETWORK, true)
+            while !Thread.current.isCancelled {
+                if !viDesk_processEvents(rawCtx, 16) {
                     break
                 }
-                try? await Task.sleep(for: .milliseconds(1))
             }
+            viDesk_leaveThreadRole()
+            exited.signal()
         }
+        thread.name = "ViDesk.EventLoop.\(config?.hostname ?? "")"
+        eventLoopThread = thread
+        eventLoopExited = exited
+        thread.start()
     }
 
-    private func stopEventLoop() {
-        eventLoopTask?.cancel()
-        eventLoopTask = nil
+    /// 停止事件处理，返回时事件线程已退出 (共享工作线程由 remove 等待处理完毕)
+    /// 之后才能重连、断开或释放上下文，否则 FreeRDP 会在事件线程仍在读写时拆掉传输层
+    private func stopEventLoop() async {
+        manager?.remove(self)
+        eventLoopThread?.cancel()
+        eventLoopThread = nil
+        // 线程最多在一次 viDesk_processEvents (16 ms 超时，发送阻塞时更久) 之后看到取消，
+        // 信号量在主 actor 之外等待；重复调用时等待同一个任务
+        if let exited = eventLoopExited {
+            eventLoopExited = nil
+            eventLoopStopping = Task.detached {
+                exited.wait()
+            }
+        }
+        await eventLoopStopping?.value
     }
 
     private func startStatisticsTimer() {
@@ -390,11 +767,26 @@ final class RDPSession {
             statistics.connectionDuration = Date().timeIntervalSince(startTime)
         }
 
-        // TODO: 从 FreeRDP 获取实际统计数据
+        let counters = context.sessionCounters()
+        statistics.bytesReceived = context.statistics().bytesReceived
+        statistics.bandwidth = counters.bandwidth
+        statistics.frameRate = Double(counters.frameRate)
+        statistics.framesReceived = counters.totalFrames
+        statistics.decodedBytes = counters.totalDecodedBytes
+        statistics.latency = counters.averageRTT
+        statistics.processingCPUTime = context.processingCPUTime
+        let memory = context.memoryUsage
+        let renderCopy = UInt64(frameBuffer.map { $0.width * $0.height * $0.bytesPerPixel } ?? 0)
+        statistics.memoryBytes = memory.frameBuffer + renderCopy + memory.gfxCache
+        let latency = context.latencyStatistics()
+        statistics.inputLatencyP50 = latency.p50
+        statistics.inputLatencyP95 = latency.p95
+        statistics.inputLatencyP99 = latency.p99
     }
 
-    private func cleanup() {
+    private func cleanup() async {
         disconnect()
+        await teardown?.value
         context.destroy()
     }
 }
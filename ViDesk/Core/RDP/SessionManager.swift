@@ -0,0 +1,132 @@
+import Foundation
+
+/// 多会话管理器
+/// 所有会话共享一组事件处理/解码工作线程，并在统一的内存预算内接纳新会话。
+/// 焦点会话 (当前前台窗口) 在工作线程上优先调度，但不会让后台会话饿死
+@MainActor
+@Observable
+final class SessionManager {
+    /// 共享实例；创建失败 (线程或事件句柄创建失败) 时为 nil，会话改用独立事件线程
+    static let shared: SessionManager? = {
+        do {
+            return try SessionManager()
+        } catch {
+            vLog("[SessionManager] \(error.localizedDescription)，会话改用独立事件线程")
+            return nil
+        }
+    }()
+
+    /// 聚合统计
+    struct Statistics {
+        var sessionCount: Int = 0
+        var runningCount: Int = 0
+        var workerCount: Int = 0
+        var memoryBudget: UInt64 = 0
+        var reservedBytes: UInt64 = 0
+        /// 帧缓冲区占用 (GDI 主缓冲区 + 渲染侧副本)
+        var frameBufferBytes: UInt64 = 0
+        /// GFX 表面和缓存占用
+        var gfxCacheBytes: UInt64 = 0
+        /// 所有会话的事件处理 CPU 时间
+        var processingCPUTime: TimeInterval = 0
+        var dispatchCount: UInt64 = 0
+        var focusedDispatchCount: UInt64 = 0
+
+        var totalMemoryBytes: UInt64 {
+            frameBufferBytes + gfxCacheBytes
+        }
+    }
+
+    /// 共享工作线程数
+    let workerCount: Int
+
+    /// 内存预算 (字节)
+    let memoryBudget: UInt64
+
+    /// 当前焦点会话
+    private(set) weak var focusedSession: RDPSession?
+
+    private let manager: OpaquePointer
+
+    /// - Throws: 无法创建调度线程、工作线程或唤醒事件时抛出 RDPError.resourceNotAvailable
+    init(workerCount: Int = SessionManager.defaultWorkerCount,
+         memoryBudget: UInt64 = SessionManager.defaultMemoryBudget) throws {
+        self.workerCount = workerCount
+        self.memoryBudget = memoryBudget
+        guard let manager = viDesk_createSessionManager(UInt32(workerCount), memoryBudget) else {
+            vLog("[SessionManager] 无法创建会话管理器 (工作线程: \(workerCount))")
+            throw RDPError.resourceNotAvailable
+        }
+        self.manager = manager
+        vLog("[SessionManager] 工作线程: \(workerCount), 内存预算: \(memoryBudget / 1_048_576) MB")
+    }
+
+    deinit {
+        viDesk_destroySessionManager(manager)
+    }
+
+    /// 默认工作线程数：保留一个核心给主线程和渲染
+    nonisolated static var defaultWorkerCount: Int {
+        max(2, ProcessInfo.processInfo.activeProcessorCount - 1)
+    }
+
+    /// 默认内存预算：物理内存的 1/4，最多 2 GB
+    nonisolated static var defaultMemoryBudget: UInt64 {
+        min(ProcessInfo.processInfo.physicalMemory / 4, 2 * 1024 * 1024 * 1024)
+    }
+
+    /// 创建由本管理器驱动的会话
+    func makeSession() -> RDPSession {
+        RDPSession(manager: self)
+    }
+
+    /// 设置焦点会话
+    func focus(_ session: RDPSession?) {
+        focusedSession = session
+        viDesk_sessionManagerSetFocused(manager, session?.rawContextPointer)
+    }
+
+    /// 获取聚合统计
+    func statistics() -> Statistics {
+        var raw = ViDeskSessionManagerStats()
+        viDesk_sessionManagerGetStats(manager, &raw)
+
+        var stats = Statistics()
+        stats.sessionCount = Int(raw.sessionCount)
+        stats.runningCount = Int(raw.runningCount)
+        stats.workerCount = Int(raw.workerCount)
+        stats.memoryBudget = raw.memoryBudget
+        stats.reservedBytes = raw.reservedBytes
+        // 渲染侧 FrameBuffer 与 GDI 主缓冲区等大
+        stats.frameBufferBytes = raw.frameBufferBytes * 2
+        stats.gfxCacheBytes = raw.gfxCacheBytes
+        stats.processingCPUTime = TimeInterval(raw.processingCpuNs) / 1_000_000_000
+        stats.dispatchCount = raw.dispatchCount
+        stats.focusedDispatchCount = raw.focusedDispatchCount
+        return stats
+    }
+
+    // MARK: - 会话生命周期 (由 RDPSession 调用)
+
+    /// 连接前接纳会话并预留内存，超出预算时返回 false
+    func admit(_ session: RDPSession) -> Bool {
+        guard let ctx = session.rawContextPointer else { return false }
+        let focused = focusedSession == nil || focusedSession === session
+        return viDesk_sessionManagerAdd(manager, ctx, focused)
+    }
+
+    /// 连接成功后开始调度
+    func start(_ session: RDPSession) {
+        guard let ctx = session.rawContextPointer else { return }
+        if focusedSession === session {
+            viDesk_sessionManagerSetFocused(manager, ctx)
+        }
+        viDesk_sessionManagerStart(manager, ctx)
+    }
+
+    /// 停止调度并释放预留 (阻塞到工作线程不再访问该会话)
+    func remove(_ session: RDPSession) {
+        guard let ctx = session.rawContextPointer else { return }
+        viDesk_sessionManagerRemove(manager, ctx)
+    }
+}
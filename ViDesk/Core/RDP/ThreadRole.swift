@@ -0,0 +1,96 @@
+import Foundation
+
+/// 线程角色 (对应桥接层 ViDeskThreadRole)
+/// 网络 I/O、解码和合成线程的调度策略与调度延迟统计
+enum ThreadRole: CaseIterable, Identifiable {
+    case network
+    case decode
+    case composition
+
+    /// 调度优先级
+    enum Priority {
+        case background
+        case utility
+        case userInitiated
+        case userInteractive
+
+        fileprivate var cValue: ViDeskThreadPriority {
+            switch self {
+            case .background: return VIDESK_THREAD_PRIORITY_BACKGROUND
+            case .utility: return VIDESK_THREAD_PRIORITY_UTILITY
+            case .userInitiated: return VIDESK_THREAD_PRIORITY_USER_INITIATED
+            case .userInteractive: return VIDESK_THREAD_PRIORITY_USER_INTERACTIVE
+            }
+        }
+    }
+
+    /// 角色统计快照
+    struct Statistics {
+        var threadCount: Int = 0
+        var workItems: UInt64 = 0
+        var busyTime: TimeInterval = 0
+        var cpuTime: TimeInterval = 0
+        /// 排队等待工作线程的时间
+        var waitTime: TimeInterval = 0
+        var maxWait: TimeInterval = 0
+        /// 能否测量运行队列延迟 (仅 Linux；Apple 平台只有排队等待)
+        var runDelayAvailable: Bool = false
+        /// 工作区间内在运行队列中等待 CPU 的时间
+        var runDelay: TimeInterval = 0
+        var maxRunDelay: TimeInterval = 0
+
+        /// 平均每个工作区间的排队等待
+        var averageWait: TimeInterval {
+            workItems > 0 ? waitTime / Double(workItems) : 0
+        }
+
+        /// 平均每个工作区间的运行队列延迟
+        var averageRunDelay: TimeInterval {
+            workItems > 0 ? runDelay / Double(workItems) : 0
+        }
+    }
+
+    var id: Self { self }
+
+    var displayName: String {
+        switch self {
+        case .network: return "网络 I/O"
+        case .decode: return "解码"
+        case .composition: return "合成"
+        }
+    }
+
+    fileprivate var cValue: ViDeskThreadRole {
+        switch self {
+        case .network: return VIDESK_THREAD_ROLE_NETWORK
+        case .decode: return VIDESK_THREAD_ROLE_DECODE
+        case .composition: return VIDESK_THREAD_ROLE_COMPOSITION
+        }
+    }
+
+    /// 设置调度策略，对之后进入该角色的线程生效
+    /// - Parameter affinityMask: CPU 位掩码，0 表示不限制 (仅 Linux 生效)
+    func setPolicy(_ priority: Priority, affinityMask: UInt64 = 0) {
+        viDesk_setThreadPolicy(cValue, priority.cValue, affinityMask)
+    }
+
+    /// 获取统计快照
+    var statistics: Statistics {
+        var raw = ViDeskThreadRoleStats()
+        viDesk_getThreadRoleStats(cValue, &raw)
+        return Statistics(threadCount: Int(raw.threadCount),
+                          workItems: raw.workItems,
+                          busyTime: TimeInterval(raw.busyNs) / 1_000_000_000,
+                          cpuTime: TimeInterval(raw.cpuNs) / 1_000_000_000,
+                          waitTime: TimeInterval(raw.waitNs) / 1_000_000_000,
+                          maxWait: TimeInterval(raw.maxWaitNs) / 1_000_000_000,
+                          runDelayAvailable: raw.runDelayAvailable,
+                          runDelay: TimeInterval(raw.runDelayNs) / 1_000_000_000,
+                          maxRunDelay: TimeInterval(raw.maxRunDelayNs) / 1_000_000_000)
+    }
+
+    /// 重置所有角色的统计
+    static func resetStatistics() {
+        viDesk_resetThreadRoleStats()
+    }
+}
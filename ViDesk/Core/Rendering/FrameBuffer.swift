@@ -17,6 +17,9 @@ final class FrameBuffer: @unchecked Sendable {
     /// 脏区域列表 (需要更新的区域)
     private var dirtyRegions: [CGRect] = []
 
+    /// 已复制进本缓冲区的最新帧序号 (用于输入到上屏延迟统计)
+    private var sequence: UInt64 = 0
+
     init(width: Int, height: Int, bytesPerPixel: Int = 4) {
         self.width = width
         self.height = height
@@ -43,7 +46,7 @@ final class FrameBuffer: @unchecked Sendable {
     }
 
     /// 更新指定区域
-    func update(from source: UnsafePointer<UInt8>, region: CGRect) {
+    func update(from source: UnsafePointer<UInt8>, region: CGRect, sequence: UInt64 = 0) {
         lock.lock()
         defer { lock.unlock() }
 
@@ -66,6 +69,7 @@ final class FrameBuffer: @unchecked Sendable {
         }
 
         dirtyRegions.append(region)
+        self.sequence = max(self.sequence, sequence)
     }
 
     /// 更新整个缓冲区
@@ -87,6 +91,16 @@ final class FrameBuffer: @unchecked Sendable {
         return regions
     }
 
+    /// 获取并清空脏区域，同时返回这些区域对应的最新帧序号
+    func popDirtyRegionsWithSequence() -> (regions: [CGRect], sequence: UInt64) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        let regions = dirtyRegions
+        dirtyRegions.removeAll()
+        return (regions, sequence)
+    }
+
     /// 检查是否有脏区域
     var hasDirtyRegions: Bool {
         lock.lock()
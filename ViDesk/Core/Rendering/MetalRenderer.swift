@@ -1,6 +1,7 @@
 import Foundation
 import Metal
 import MetalKit
+import CoreGraphics
 import simd
 
 /// Metal 渲染引擎
@@ -11,6 +12,7 @@ final class MetalRenderer: NSObject, MTKViewDelegate {
     private let device: MTLDevice
     private let commandQueue: MTLCommandQueue
     private var pipelineState: MTLRenderPipelineState?
+    private var cursorPipelineState: MTLRenderPipelineState?
     private var samplerState: MTLSamplerState?
 
     private var texture: MTLTexture?
@@ -38,6 +40,29 @@ final class MetalRenderer: NSObject, MTKViewDelegate {
     /// 视图尺寸
     private var viewSize: CGSize = .zero
 
+    /// 画面呈现回调 (帧序号, 呈现时刻)，在主线程调用
+    var onFramePresented: (@MainActor (UInt64, CFTimeInterval) -> Void)?
+
+    /// 已上传到纹理 / 已登记呈现回调的最新帧序号
+    private var uploadedSequence: UInt64 = 0
+    private var reportedSequence: UInt64 = 0
+
+    /// 本地光标热点位置 (纹理坐标)，nil 时不绘制
+    /// 光标在合成时叠加到桌面上，移动光标不需要上传任何帧缓冲区数据
+    var cursorPosition: CGPoint?
+
+    /// 光标图像 (BGRA，非预乘) 及其热点
+    private var cursorTexture: MTLTexture?
+    private var cursorSize: CGSize = .zero
+    private var cursorHotspot: CGPoint = .zero
+
+    /// 服务器隐藏了光标 (如视频全屏、文本输入时)
+    private var cursorHidden = false
+
+    /// 默认箭头，服务器切回系统默认光标时恢复
+    private var defaultCursorPixels: [UInt8] = []
+    private var defaultCursorSize: (width: Int, height: Int) = (0, 0)
+
     // MARK: - 顶点数据
 
     struct Vertex {
@@ -63,6 +88,7 @@ final class MetalRenderer: NSObject, MTKViewDelegate {
 
         setupPipeline()
         setupSampler()
+        setupDefaultCursor()
     }
 
     // MARK: - 设置
@@ -86,6 +112,15 @@ final class MetalRenderer: NSObject, MTKViewDelegate {
         } catch {
             print("Failed to create pipeline state: \(error)")
             createDefaultPipeline()
+            return
+        }
+
+        // 光标叠加管线，创建失败时只是不绘制本地光标
+        pipelineDescriptor.fragmentFunction = library.makeFunction(name: "fragmentShaderWithCursor")
+        do {
+            cursorPipelineState = try device.makeRenderPipelineState(descriptor: pipelineDescriptor)
+        } catch {
+            print("Failed to create cursor pipeline state: \(error)")
         }
     }
 
@@ -147,6 +182,115 @@ final class MetalRenderer: NSObject, MTKViewDelegate {
         samplerState = device.makeSamplerState(descriptor: samplerDescriptor)
     }
 
+    // MARK: - 光标
+
+    /// 默认光标：黑边白底箭头，热点在尖端
+    private func setupDefaultCursor() {
+        let width = 12
+        let height = 19
+        var pixels = [UInt8](repeating: 0, count: width * height * 4)
+
+        let drawn = pixels.withUnsafeMutableBytes { buffer -> Bool in
+            guard let cg = CGContext(data: buffer.baseAddress,
+                                     width: width,
+                                     height: height,
+                                     bitsPerComponent: 8,
+                                     bytesPerRow: width * 4,
+                                     space: CGColorSpaceCreateDeviceRGB(),
+                                     bitmapInfo: CGImageAlphaInfo.premultipliedFirst.rawValue |
+                                                 CGBitmapInfo.byteOrder32Little.rawValue) else {
+                return false
+            }
+
+            // 翻转为左上角原点，与桌面坐标一致
+            cg.translateBy(x: 0, y: CGFloat(height))
+            cg.scaleBy(x: 1, y: -1)
+
+            let arrow = CGMutablePath()
+            arrow.move(to: CGPoint(x: 0.5, y: 0.5))
+            arrow.addLine(to: CGPoint(x: 0.5, y: 16))
+            arrow.addLine(to: CGPoint(x: 4.5, y: 12.5))
+            arrow.addLine(to: CGPoint(x: 7.5, y: 18.5))
+            arrow.addLine(to: CGPoint(x: 9.5, y: 17.5))
+            arrow.addLine(to: CGPoint(x: 6.5, y: 11.5))
+            arrow.addLine(to: CGPoint(x: 11.5, y: 11.5))
+            arrow.closeSubpath()
+
+            cg.addPath(arrow)
+            cg.setFillColor(CGColor(red: 1, green: 1, blue: 1, alpha: 1))
+            cg.setStrokeColor(CGColor(red: 0, green: 0, blue: 0, alpha: 1))
+            cg.setLineWidth(1)
+            cg.drawPath(using: .fillStroke)
+            return true
+        }
+
+        // 着色器按非预乘 alpha 混合；箭头边缘是黑色，预乘与否结果相同
+        guard drawn else { return }
+        defaultCursorPixels = pixels
+        defaultCursorSize = (width, height)
+        setCursorImage(pixels, width: width, height: height, hotspot: .zero)
+    }
+
+    /// 应用服务器下发的光标形状
+    /// 光标只更新叠加层纹理，桌面纹理不需要重新上传
+    func setPointerShape(_ shape: FreeRDPContext.PointerShape) {
+        switch shape {
+        case .image(let pixels, let width, let height, let hotspot):
+            cursorHidden = false
+            setCursorImage(pixels, width: width, height: height, hotspot: hotspot)
+        case .hidden:
+            cursorHidden = true
+        case .systemDefault:
+            cursorHidden = false
+            setCursorImage(defaultCursorPixels, width: defaultCursorSize.width,
+                           height: defaultCursorSize.height, hotspot: .zero)
+        }
+    }
+
+    /// 替换光标图像 (BGRA，每行 width * 4 字节)
+    func setCursorImage(_ pixels: [UInt8], width: Int, height: Int, hotspot: CGPoint) {
+        guard width > 0, height > 0, pixels.count >= width * height * 4 else { return }
+
+        if cursorTexture?.width != width || cursorTexture?.height != height {
+            let descriptor = MTLTextureDescriptor.texture2DDescriptor(
+                pixelFormat: .bgra8Unorm,
+                width: width,
+                height: height,
+                mipmapped: false
+            )
+            descriptor.usage = [.shaderRead]
+            cursorTexture = device.makeTexture(descriptor: descriptor)
+        }
+
+        pixels.withUnsafeBytes { buffer in
+            cursorTexture?.replace(region: MTLRegionMake2D(0, 0, width, height),
+                                   mipmapLevel: 0,
+                                   withBytes: buffer.baseAddress!,
+                                   bytesPerRow: width * 4)
+        }
+        cursorSize = CGSize(width: width, height: height)
+        cursorHotspot = hotspot
+    }
+
+    /// 绑定光标管线及其参数；不需要绘制光标时返回 false
+    private func bindCursor(to encoder: MTLRenderCommandEncoder) -> Bool {
+        guard !cursorHidden, let cursorPipelineState, let cursorTexture, let position = cursorPosition,
+              textureWidth > 0, textureHeight > 0 else {
+            return false
+        }
+
+        var origin = SIMD2<Float>(Float(position.x - cursorHotspot.x), Float(position.y - cursorHotspot.y))
+        var size = SIMD2<Float>(Float(cursorSize.width), Float(cursorSize.height))
+        var desktopSize = SIMD2<Float>(Float(textureWidth), Float(textureHeight))
+
+        encoder.setRenderPipelineState(cursorPipelineState)
+        encoder.setFragmentTexture(cursorTexture, index: 1)
+        encoder.setFragmentBytes(&origin, length: MemoryLayout<SIMD2<Float>>.stride, index: 0)
+        encoder.setFragmentBytes(&size, length: MemoryLayout<SIMD2<Float>>.stride, index: 1)
+        encoder.setFragmentBytes(&desktopSize, length: MemoryLayout<SIMD2<Float>>.stride, index: 2)
+        return true
+    }
+
     // MARK: - 纹理管理
 
     private func createTexture(width: Int, height: Int) {
@@ -230,10 +374,11 @@ final class MetalRenderer: NSObject, MTKViewDelegate {
         guard let frameBuffer = frameBuffer, let texture = texture else { return }
 
         if frameBuffer.hasDirtyRegions {
-            let dirtyRegions = frameBuffer.popDirtyRegions()
+            let (dirtyRegions, sequence) = frameBuffer.popDirtyRegionsWithSequence()
             for region in dirtyRegions {
                 frameBuffer.copyRegionToTexture(texture, region: region)
             }
+            uploadedSequence = max(uploadedSequence, sequence)
         }
     }
 
@@ -264,7 +409,12 @@ final class MetalRenderer: NSObject, MTKViewDelegate {
             return
         }
 
+        // 合成角色只统计纹理上传：currentDrawable 可能阻塞等待可用的 drawable，不计入
+        // MTKView 在主线程绘制，只参与统计，不修改主线程的调度策略
+        viDesk_enterThreadRole(VIDESK_THREAD_ROLE_COMPOSITION, false)
+        viDesk_beginThreadRoleWork()
         updateTexture()
+        viDesk_endThreadRoleWork()
 
         guard let drawable = view.currentDrawable,
               let renderPassDescriptor = view.currentRenderPassDescriptor,
@@ -280,7 +430,9 @@ final class MetalRenderer: NSObject, MTKViewDelegate {
             return
         }
 
-        renderEncoder.setRenderPipelineState(pipelineState)
+        if !bindCursor(to: renderEncoder) {
+            renderEncoder.setRenderPipelineState(pipelineState)
+        }
 
         if let texture = texture {
             renderEncoder.setFragmentTexture(texture, index: 0)
@@ -301,6 +453,19 @@ final class MetalRenderer: NSObject, MTKViewDelegate {
 
         renderEncoder.endEncoding()
 
+        // 本次绘制包含新的帧更新时，在真正上屏后回报呈现时刻
+        if uploadedSequence > reportedSequence, let handler = onFramePresented {
+            let sequence = uploadedSequence
+            reportedSequence = sequence
+            drawable.addPresentedHandler { presented in
+                let presentedTime = presented.presentedTime
+                guard presentedTime > 0 else { return }
+                Task { @MainActor in
+                    handler(sequence, presentedTime)
+                }
+            }
+        }
+
         commandBuffer.present(drawable)
         commandBuffer.commit()
     }
@@ -46,6 +46,14 @@ final class ConnectionManagerViewModel {
     private let storageService: ConnectionStorageService
     private let keychainService: KeychainService
 
+    /// 预热窗口：卡片悬停或获得焦点后，这段时间内发起的连接直接使用已建立的 TCP 连接
+    private let prewarmWindow: TimeInterval = 10
+
+    /// 停留多久才预热，指针快速划过的卡片不预热
+    private let prewarmDwell: Duration = .milliseconds(150)
+
+    private var prewarmTask: Task<Void, Never>?
+
     // MARK: - 初始化
 
     init(storageService: ConnectionStorageService = .shared,
@@ -171,6 +179,26 @@ final class ConnectionManagerViewModel {
         keychainService.hasPassword(for: config.id)
     }
 
+    /// 预热可能要连接的主机：后台解析 DNS 并建立 TCP，窗口期内未连接则由桥接层关闭
+    func prewarm(_ config: ConnectionConfig) {
+        // 经网关的连接不直连主机
+        if let gateway = config.gatewayHostname, !gateway.isEmpty { return }
+        guard !config.hostname.isEmpty else { return }
+
+        let hostname = config.hostname
+        let port = config.port
+        let window = prewarmWindow
+        let dwell = prewarmDwell
+        prewarmTask?.cancel()
+        prewarmTask = Task {
+            try? await Task.sleep(for: dwell)
+            guard !Task.isCancelled else { return }
+            if FreeRDPContext.prewarm(hostname: hostname, port: port, window: window) {
+                vLog("预热连接: \(hostname):\(port)")
+            }
+        }
+    }
+
     /// 更新最后连接时间
     func markAsConnected(_ config: ConnectionConfig) {
         do {
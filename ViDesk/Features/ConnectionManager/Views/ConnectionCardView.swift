@@ -4,8 +4,11 @@ import SwiftUI
 struct ConnectionCardView: View {
     let config: ConnectionConfig
     let onTap: () -> Void
+    /// 悬停或获得焦点时调用 (用户可能即将连接)
+    var onHighlight: (() -> Void)? = nil
 
     @State private var isHovered = false
+    @FocusState private var isFocused: Bool
 
     var body: some View {
         Button(action: onTap) {
@@ -63,10 +66,19 @@ struct ConnectionCardView: View {
             }
         }
         .buttonStyle(.plain)
+        .focused($isFocused)
         .onHover { hovering in
             withAnimation(.easeInOut(duration: 0.2)) {
                 isHovered = hovering
             }
+            if hovering {
+                onHighlight?()
+            }
+        }
+        .onChange(of: isFocused) { _, focused in
+            if focused {
+                onHighlight?()
+            }
         }
     }
 
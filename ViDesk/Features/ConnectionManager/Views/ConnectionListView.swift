@@ -159,6 +159,8 @@ struct ConnectionListView: View {
                         ForEach(viewModel.recentConnections) { config in
                             ConnectionCardView(config: config) {
                                 initiateConnection(config)
+                            } onHighlight: {
+                                viewModel.prewarm(config)
                             }
                             .contextMenu {
                                 connectionContextMenu(for: config)
@@ -179,6 +181,8 @@ struct ConnectionListView: View {
                         ForEach(displayedConnections) { config in
                             ConnectionCardView(config: config) {
                                 initiateConnection(config)
+                            } onHighlight: {
+                                viewModel.prewarm(config)
                             }
                             .contextMenu {
                                 connectionContextMenu(for: config)
@@ -0,0 +1,114 @@
+import Foundation
+
+/// 批量压缩级别基准
+/// 回放会话录制目录中的全部录制，按录制时服务器实际使用的压缩级别分组，
+/// 报告每个级别的压缩率和解码流水线吞吐量。先在调试连接中选好压缩级别并录制同一操作流程，
+/// 各级别的结果才有可比性；回放时解压按录制中每个 PDU 的压缩类型进行，与回放端的设置无关。
+/// 吞吐量按整个回放的时间计，包含解压、解码和 GDI，不是单独的解压速度
+@MainActor
+@Observable
+final class BulkCompressionBenchmark {
+    /// 单个压缩级别的结果 (同级别的多个录制累加)
+    struct LevelResult: Identifiable {
+        let level: FreeRDPContext.CompressionLevel
+        var recordings: Int = 0
+        var wireBytes: UInt64 = 0
+        var compressedBytes: UInt64 = 0
+        var uncompressedBytes: UInt64 = 0
+        var elapsed: TimeInterval = 0
+
+        var id: Int { level.rawValue }
+
+        /// 压缩率 (解压后 / 线路上，只计压缩过的 PDU)
+        var ratio: Double {
+            compressedBytes > 0 ? Double(uncompressedBytes) / Double(compressedBytes) : 0
+        }
+
+        /// 解码流水线吞吐量 (MB/s)：解压后的字节 / 整个回放 (解压、解码和 GDI) 的时间
+        var pipelineMegabytesPerSecond: Double {
+            elapsed > 0 ? Double(uncompressedBytes) / 1_000_000 / elapsed : 0
+        }
+
+        /// 线路数据吞吐量 (MB/s)
+        var wireMegabytesPerSecond: Double {
+            elapsed > 0 ? Double(wireBytes) / 1_000_000 / elapsed : 0
+        }
+
+        var summary: String {
+            String(format: "%@: %d 个录制, 线路 %.1f MB, 压缩率 %.2fx, 解码流水线 %.1f MB/s, 线路 %.1f MB/s",
+                   level.displayName, recordings, Double(wireBytes) / 1_000_000, ratio,
+                   pipelineMegabytesPerSecond, wireMegabytesPerSecond)
+        }
+    }
+
+    private(set) var isRunning = false
+    private(set) var progress = ""
+    private(set) var errorMessage: String?
+    private(set) var results: [LevelResult] = []
+
+    /// 没有对应录制的级别 (提示需要补录)
+    var missingLevels: [FreeRDPContext.CompressionLevel] {
+        FreeRDPContext.CompressionLevel.allCases.filter { level in
+            !results.contains { $0.level == level }
+        }
+    }
+
+    /// 运行测试 (config 的安全设置应与录制时一致)
+    func run(config: ConnectionConfig) async {
+        guard !isRunning else { return }
+
+        let recordings = ((try? FileManager.default.contentsOfDirectory(
+            at: RDPSession.sessionCapturesDirectory,
+            includingPropertiesForKeys: nil
+        )) ?? []).filter { $0.pathExtension == "vdsd" }.sorted { $0.lastPathComponent < $1.lastPathComponent }
+
+        guard !recordings.isEmpty else {
+            errorMessage = "没有会话录制文件，请先选择压缩级别并打开“录制下次连接”后进行调试连接"
+            return
+        }
+
+        isRunning = true
+        results = []
+        errorMessage = nil
+        defer {
+            isRunning = false
+            progress = ""
+        }
+
+        var byLevel: [FreeRDPContext.CompressionLevel: LevelResult] = [:]
+        var failures = 0
+        for (index, recording) in recordings.enumerated() {
+            progress = "正在回放 \(recording.lastPathComponent) (\(index + 1)/\(recordings.count))..."
+
+            let session = RDPSession()
+            let info: FreeRDPContext.SessionDumpInfo
+            let replay: FreeRDPContext.SessionReplayStatistics
+            do {
+                let outcome = try await session.replaySession(from: recording, config: config)
+                info = outcome.info
+                replay = outcome.statistics
+            } catch {
+                vLog("[Benchmark] 回放 \(recording.lastPathComponent) 失败: \(error.localizedDescription)")
+                failures += 1
+                continue
+            }
+            session.disconnect()
+
+            var result = byLevel[info.compressionLevel] ?? LevelResult(level: info.compressionLevel)
+            result.recordings += 1
+            result.wireBytes += replay.bytesReplayed
+            result.compressedBytes += replay.compressedBytes
+            result.uncompressedBytes += replay.uncompressedBytes
+            result.elapsed += replay.elapsed
+            byLevel[info.compressionLevel] = result
+        }
+
+        results = byLevel.values.sorted { $0.level.rawValue < $1.level.rawValue }
+        for result in results {
+            vLog("[Benchmark] \(result.summary)")
+        }
+        if failures > 0 {
+            errorMessage = "\(failures) 个录制回放失败 (安全设置与录制时不一致或文件损坏)"
+        }
+    }
+}
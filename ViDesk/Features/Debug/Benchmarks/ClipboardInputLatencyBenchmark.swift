@@ -0,0 +1,100 @@
+import Foundation
+
+/// 大剪贴板传输期间的输入延迟测试
+/// 建立一个无界面会话，把本地剪贴板设为大段文本并向远程发送 Ctrl+V，
+/// 远程应用请求剪贴板数据后，该数据经发送调度器分片写出；
+/// 期间以 120Hz 发送鼠标移动，比较传输期间与空闲时的输入发送耗时
+@MainActor
+@Observable
+final class ClipboardInputLatencyBenchmark {
+    /// 测试结果
+    struct Result {
+        let payloadBytes: Int
+        /// 传输期间实际写出的字节数
+        let bulkBytesSent: UInt64
+        let idleAverage: TimeInterval
+        let idleMax: TimeInterval
+        let bulkInputEvents: Int
+        let bulkAverage: TimeInterval
+        let bulkMax: TimeInterval
+
+        var summary: String {
+            String(format: "剪贴板 %.0f MB (已发送 %.1f MB): 空闲输入 平均 %.2f ms / 最大 %.2f ms, 传输中输入 %d 次 平均 %.2f ms / 最大 %.2f ms",
+                   Double(payloadBytes) / 1_048_576, Double(bulkBytesSent) / 1_048_576,
+                   idleAverage * 1000, idleMax * 1000,
+                   bulkInputEvents, bulkAverage * 1000, bulkMax * 1000)
+        }
+    }
+
+    /// 剪贴板文本大小 (字节)
+    var payloadBytes = 50 * 1024 * 1024
+
+    /// 采样时长
+    var duration: TimeInterval = 20
+
+    /// 鼠标移动发送间隔
+    private let moveInterval: Duration = .microseconds(8_333)
+
+    private(set) var isRunning = false
+    private(set) var progress = ""
+    private(set) var result: Result?
+
+    /// 运行测试 (远程桌面焦点需位于可粘贴文本的窗口)
+    func run(config: ConnectionConfig, password: String?) async {
+        guard !isRunning else { return }
+        isRunning = true
+        result = nil
+        defer {
+            isRunning = false
+            progress = ""
+        }
+
+        let session = RDPSession()
+        progress = "正在连接..."
+        do {
+            try await session.connect(config: config, password: password)
+        } catch {
+            vLog("[Benchmark] 剪贴板延迟测试连接失败: \(error.localizedDescription)")
+            return
+        }
+        defer { session.disconnect() }
+
+        // 空闲基线
+        progress = "测量空闲输入耗时..."
+        session.resetSendStatistics()
+        await sendMoves(session: session, for: 2)
+        let idle = session.sendStatistics()
+
+        // 触发远程粘贴，远程请求数据后开始分片发送
+        progress = "正在传输 \(payloadBytes / 1_048_576) MB 剪贴板..."
+        session.syncClipboardToRemote(String(repeating: "x", count: payloadBytes))
+        try? await Task.sleep(for: .seconds(1))
+        session.resetSendStatistics()
+        session.sendSpecialKey(.ctrlV)
+        await sendMoves(session: session, for: duration)
+        let bulk = session.sendStatistics()
+
+        let result = Result(payloadBytes: payloadBytes,
+                            bulkBytesSent: bulk.bulkBytesSent,
+                            idleAverage: idle.averageInputSend,
+                            idleMax: idle.maxInputSend,
+                            bulkInputEvents: bulk.inputEventsDuringBulk,
+                            bulkAverage: bulk.averageInputSendDuringBulk,
+                            bulkMax: bulk.maxInputSendDuringBulk)
+        vLog("[Benchmark] \(result.summary)")
+        self.result = result
+    }
+
+    // MARK: - 私有方法
+
+    /// 在屏幕左上角附近来回移动鼠标
+    private func sendMoves(session: RDPSession, for seconds: TimeInterval) async {
+        let end = Date().addingTimeInterval(seconds)
+        var step = 0
+        while Date() < end && session.state == .connected {
+            session.sendMouseMove(x: 100 + step % 200, y: 100)
+            step += 1
+            try? await Task.sleep(for: moveInterval)
+        }
+    }
+}
@@ -0,0 +1,177 @@
+import Foundation
+
+/// 并发会话基准测试
+/// 对同一主机同时建立 N 个无界面会话，统计每个会话的吞吐量、CPU 和总内存占用
+/// 可选择每会话独立事件线程或由 SessionManager 共享工作线程驱动
+@MainActor
+@Observable
+final class ConcurrentSessionBenchmark {
+    /// 单轮测试结果
+    struct Result: Identifiable {
+        let id = UUID()
+        /// 并发会话数
+        let sessionCount: Int
+        /// 成功建立的会话数
+        let connectedCount: Int
+        /// 每会话平均接收吞吐量 (字节/秒)
+        let perSessionThroughput: Double
+        /// 每会话事件线程平均 CPU 占用 (单核百分比)
+        let perSessionCPU: Double
+        /// 整个进程的 CPU 占用 (单核百分比)
+        let processCPU: Double
+        /// 所有会话的帧缓冲区和 GFX 缓存总占用 (字节)
+        let totalMemory: UInt64
+        /// 是否使用共享工作线程
+        let sharedWorkers: Bool
+        /// 模拟的网络条件
+        let wanPreset: FreeRDPContext.WanPreset
+
+        var summary: String {
+            String(format: "%d 会话 (%d 成功, %@, %@): %.1f KB/s/会话, CPU %.1f%%/会话, 进程 %.1f%%, 内存 %.1f MB",
+                   sessionCount, connectedCount, sharedWorkers ? "共享线程" : "独立线程", wanPreset.displayName,
+                   perSessionThroughput / 1024, perSessionCPU, processCPU,
+                   Double(totalMemory) / 1_048_576)
+        }
+    }
+
+    /// 测试轮次的会话数
+    var sessionCounts: [Int] = [1, 4, 8]
+
+    /// 使用 SessionManager 共享工作线程驱动会话
+    var useSharedWorkers = true
+
+    /// 使用池化传输层 (关闭时为 FreeRDP 默认实现，用于对比系统调用次数)
+    var usePooledTransport = true
+
+    /// 模拟的网络条件 (需要池化传输层)，各轮的随机种子相同，结果可以直接对比
+    var wanPreset: FreeRDPContext.WanPreset = .none
+
+    /// 每轮采样时长
+    var duration: TimeInterval = 10
+
+    private(set) var isRunning = false
+    private(set) var progress = ""
+    private(set) var results: [Result] = []
+    private(set) var errorMessage: String?
+
+    /// 依次运行每一轮测试
+    func run(config: ConnectionConfig, password: String?) async {
+        guard !isRunning else { return }
+        isRunning = true
+        results.removeAll()
+        errorMessage = nil
+        defer {
+            isRunning = false
+            progress = ""
+        }
+
+        for count in sessionCounts {
+            progress = "正在测试 \(count) 个并发会话..."
+            vLog("[Benchmark] 开始 \(count) 个并发会话")
+            do {
+                let result = try await runRound(sessionCount: count, config: config, password: password)
+                vLog("[Benchmark] \(result.summary)")
+                results.append(result)
+            } catch {
+                errorMessage = "无法创建会话管理器: \(error.localizedDescription)"
+                return
+            }
+        }
+    }
+
+    // MARK: - 私有方法
+
+    private func runRound(sessionCount: Int, config: ConnectionConfig, password: String?) async throws -> Result {
+        // 每轮使用独立的管理器，预算不限制，只比较调度方式
+        let manager = useSharedWorkers ? try SessionManager(memoryBudget: .max) : nil
+        let sessions = (0..<sessionCount).map { _ in RDPSession(manager: manager) }
+        for session in sessions {
+            session.usesPooledTransport = usePooledTransport
+            session.wanProfile = wanPreset.profile
+        }
+        manager?.focus(sessions.first)
+
+        // 并发建立连接
+        await withTaskGroup(of: Void.self) { group in
+            for session in sessions {
+                group.addTask { @MainActor in
+                    try? await session.connect(config: config, password: password)
+                }
+            }
+        }
+
+        let connected = sessions.filter { $0.state == .connected }
+
+        // 等待一个统计周期，取基线
+        try? await Task.sleep(for: .seconds(1))
+        let startStats = connected.map { $0.statistics }
+        for session in connected {
+            session.resetTransportStatistics()
+        }
+        let startCPU = Self.processCPUTime()
+        let startTime = Date()
+
+        try? await Task.sleep(for: .seconds(duration))
+
+        let endStats = connected.map { $0.statistics }
+        let transportStats = connected.map { $0.transportStatistics() }
+        let wanStats = connected.map { $0.wanEmulationStatistics() }.filter { $0.isEnabled }
+        let elapsed = Date().timeIntervalSince(startTime)
+        let processCPU = (Self.processCPUTime() - startCPU) / elapsed * 100
+        let totalMemory = endStats.reduce(UInt64(0)) { $0 + $1.memoryBytes }
+        if let stats = manager?.statistics() {
+            vLog("[Benchmark] 调度 \(stats.dispatchCount) 次 (焦点 \(stats.focusedDispatchCount)), 工作线程 \(stats.workerCount)")
+        }
+        if !transportStats.isEmpty {
+            let count = Double(transportStats.count)
+            let syscalls = transportStats.reduce(0) { $0 + $1.syscallsPerSecond } / count
+            let pdusPerRecv = transportStats.reduce(0) { $0 + $1.pdusPerRecv } / count
+            vLog(String(format: "[Benchmark] 传输层 (%@): %.0f 次系统调用/秒/会话, %.2f PDU/recv",
+                        usePooledTransport ? "池化" : "默认", syscalls, pdusPerRecv))
+        }
+        if !wanStats.isEmpty {
+            let count = Double(wanStats.count)
+            let delay = wanStats.reduce(0) { $0 + $1.averageDelayDown } / count
+            let stalls = wanStats.reduce(0) { $0 + Int($1.stalls) }
+            let peak = wanStats.map { $0.peakQueuedDown }.max() ?? 0
+            vLog(String(format: "[Benchmark] WAN 模拟 (%@): 下行平均延迟 %.0f ms, 断流 %d 次, 下行排队峰值 %.0f KB",
+                        wanPreset.displayName, delay * 1000, stalls, Double(peak) / 1024))
+        }
+
+        for session in sessions {
+            session.disconnect()
+        }
+
+        guard !connected.isEmpty, elapsed > 0 else {
+            return Result(sessionCount: sessionCount, connectedCount: 0,
+                          perSessionThroughput: 0, perSessionCPU: 0, processCPU: processCPU,
+                          totalMemory: 0, sharedWorkers: useSharedWorkers, wanPreset: wanPreset)
+        }
+
+        var totalBytes: Double = 0
+        var totalCPU: TimeInterval = 0
+        for (start, end) in zip(startStats, endStats) {
+            totalBytes += Double(end.bytesReceived &- start.bytesReceived)
+            totalCPU += end.processingCPUTime - start.processingCPUTime
+        }
+
+        let count = Double(connected.count)
+        return Result(sessionCount: sessionCount,
+                      connectedCount: connected.count,
+                      perSessionThroughput: totalBytes / elapsed / count,
+                      perSessionCPU: totalCPU / elapsed / count * 100,
+                      processCPU: processCPU,
+                      totalMemory: totalMemory,
+                      sharedWorkers: useSharedWorkers,
+                      wanPreset: wanPreset)
+    }
+
+    /// 进程累计 CPU 时间 (用户态 + 内核态)
+    private static func processCPUTime() -> TimeInterval {
+        var usage = rusage()
+        guard getrusage(RUSAGE_SELF, &usage) == 0 else { return 0 }
+        let user = TimeInterval(usage.ru_utime.tv_sec) + TimeInterval(usage.ru_utime.tv_usec) / 1_000_000
+        let system = TimeInterval(usage.ru_stime.tv_sec) + TimeInterval(usage.ru_stime.tv_usec) / 1_000_000
+        return user + system
+    }
+}
@@ -0,0 +1,118 @@
+import Foundation
+
+/// 输入回放延迟测试
+/// 建立一个无界面会话，按原始时间间隔回放会话工具栏录制的输入 (如输入 500 个字符、拖动窗口、滚动页面)，
+/// 统计输入到帧更新的延迟；同一录制文件在不同版本上回放，结果可以直接比较。
+/// 回放前应让远程桌面处于与录制时相同的状态 (窗口位置、焦点)
+@MainActor
+@Observable
+final class InputReplayBenchmark {
+    /// 测试结果
+    struct Result {
+        let recording: String
+        let events: Int
+        let failedEvents: Int
+        let duration: TimeInterval
+        let averageLag: TimeInterval
+        let samples: Int
+        let p50: TimeInterval
+        let p95: TimeInterval
+        let p99: TimeInterval
+        let expiredInputs: UInt64
+
+        var summary: String {
+            String(format: "%@: %d 个事件 (失败 %d), %.1f 秒, 回放滞后 %.2f ms; 延迟样本 %d: p50 %.1f / p95 %.1f / p99 %.1f ms, 无画面变化 %llu",
+                   recording, events, failedEvents, duration, averageLag * 1000,
+                   samples, p50 * 1000, p95 * 1000, p99 * 1000, expiredInputs)
+        }
+    }
+
+    /// 可回放的录制文件 (最新的在前)
+    private(set) var recordings: [URL] = []
+
+    /// 选中的录制文件
+    var selectedRecording: URL?
+
+    private(set) var isRunning = false
+    private(set) var progress = ""
+    private(set) var errorMessage: String?
+    private(set) var result: Result?
+
+    /// 刷新录制文件列表
+    func refreshRecordings() {
+        let directory = RDPSession.inputRecordingsDirectory
+        let files = (try? FileManager.default.contentsOfDirectory(
+            at: directory,
+            includingPropertiesForKeys: [.contentModificationDateKey]
+        )) ?? []
+
+        recordings = files
+            .filter { $0.pathExtension == "vdir" }
+            .sorted { lhs, rhs in
+                let l = (try? lhs.resourceValues(forKeys: [.contentModificationDateKey]).contentModificationDate) ?? .distantPast
+                let r = (try? rhs.resourceValues(forKeys: [.contentModificationDateKey]).contentModificationDate) ?? .distantPast
+                return l > r
+            }
+
+        if selectedRecording == nil || !recordings.contains(where: { $0 == selectedRecording }) {
+            selectedRecording = recordings.first
+        }
+    }
+
+    /// 运行测试
+    func run(config: ConnectionConfig, password: String?) async {
+        guard !isRunning else { return }
+        guard let recording = selectedRecording else {
+            errorMessage = "没有可回放的录制文件，请先在会话工具栏录制输入"
+            return
+        }
+
+        isRunning = true
+        result = nil
+        errorMessage = nil
+        defer {
+            isRunning = false
+            progress = ""
+        }
+
+        let session = RDPSession()
+        progress = "正在连接..."
+        do {
+            try await session.connect(config: config, password: password)
+        } catch {
+            vLog("[Benchmark] 输入回放测试连接失败: \(error.localizedDescription)")
+            errorMessage = error.localizedDescription
+            return
+        }
+        defer { session.disconnect() }
+
+        // 没有渲染器：帧更新即视为呈现；等待动态通道 (ainput、RDPEI) 打开后再开始
+        session.setHeadlessPresentation(true)
+        try? await Task.sleep(for: .seconds(2))
+        session.resetLatencyStatistics()
+
+        progress = "正在回放 \(recording.lastPathComponent)..."
+        let (completed, replay) = await session.replayInput(from: recording)
+
+        // 等待最后几个输入对应的帧更新
+        try? await Task.sleep(for: .seconds(1))
+        let latency = session.latencyStatistics()
+
+        if !completed {
+            errorMessage = "回放未完成 (会话已断开或录制文件损坏)，以下为已回放部分的结果"
+        }
+
+        let result = Result(recording: recording.lastPathComponent,
+                            events: replay.events,
+                            failedEvents: replay.failedEvents,
+                            duration: replay.duration,
+                            averageLag: replay.averageLag,
+                            samples: latency.samples,
+                            p50: latency.p50,
+                            p95: latency.p95,
+                            p99: latency.p99,
+                            expiredInputs: latency.expiredInputs)
+        vLog("[Benchmark] \(result.summary)")
+        self.result = result
+    }
+}
@@ -0,0 +1,108 @@
+import Foundation
+
+/// 会话回放解码基准
+/// 回放调试连接录制的会话 (收到的全部 PDU)，不连接服务器，也不按原始时间间隔等待，
+/// 数据读入后立即经过解码、GDI 和帧更新回调；同一录制文件在不同版本上回放，
+/// 吞吐量可以直接比较，用来评估解码和渲染路径的优化
+@MainActor
+@Observable
+final class SessionReplayBenchmark {
+    /// 测试结果
+    struct Result {
+        let recording: String
+        let inboundRecords: Int
+        let elapsed: TimeInterval
+        let firstFrame: TimeInterval
+        let frames: UInt64
+        let framesPerSecond: Double
+        let decodedBytes: UInt64
+        let decodedMegabytesPerSecond: Double
+        let bytesReplayed: UInt64
+
+        var summary: String {
+            String(format: "%@: %d 个入站 PDU (%.1f MB), %.2f 秒, 首帧 %.1f ms; %llu 帧 (%.1f fps), 解码 %.1f MB (%.1f MB/s)",
+                   recording, inboundRecords, Double(bytesReplayed) / 1_000_000, elapsed, firstFrame * 1000,
+                   frames, framesPerSecond, Double(decodedBytes) / 1_000_000, decodedMegabytesPerSecond)
+        }
+    }
+
+    /// 可回放的录制文件 (最新的在前)
+    private(set) var recordings: [URL] = []
+
+    /// 选中的录制文件
+    var selectedRecording: URL?
+
+    private(set) var isRunning = false
+    private(set) var progress = ""
+    private(set) var errorMessage: String?
+    private(set) var result: Result?
+
+    /// 刷新录制文件列表
+    func refreshRecordings() {
+        let directory = RDPSession.sessionCapturesDirectory
+        let files = (try? FileManager.default.contentsOfDirectory(
+            at: directory,
+            includingPropertiesForKeys: [.contentModificationDateKey]
+        )) ?? []
+
+        recordings = files
+            .filter { $0.pathExtension == "vdsd" }
+            .sorted { lhs, rhs in
+                let l = (try? lhs.resourceValues(forKeys: [.contentModificationDateKey]).contentModificationDate) ?? .distantPast
+                let r = (try? rhs.resourceValues(forKeys: [.contentModificationDateKey]).contentModificationDate) ?? .distantPast
+                return l > r
+            }
+
+        if selectedRecording == nil || !recordings.contains(where: { $0 == selectedRecording }) {
+            selectedRecording = recordings.first
+        }
+    }
+
+    /// 运行测试 (config 的安全设置应与录制时一致)
+    func run(config: ConnectionConfig) async {
+        guard !isRunning else { return }
+        guard let recording = selectedRecording else {
+            errorMessage = "没有会话录制文件，请先打开“录制下次连接”后进行一次调试连接"
+            return
+        }
+
+        isRunning = true
+        result = nil
+        errorMessage = nil
+        defer {
+            isRunning = false
+            progress = ""
+        }
+
+        let session = RDPSession()
+        progress = "正在回放 \(recording.lastPathComponent)..."
+        let info: FreeRDPContext.SessionDumpInfo
+        let replay: FreeRDPContext.SessionReplayStatistics
+        do {
+            let outcome = try await session.replaySession(from: recording, config: config)
+            info = outcome.info
+            replay = outcome.statistics
+        } catch {
+            vLog("[Benchmark] 会话回放失败: \(error.localizedDescription)")
+            errorMessage = error.localizedDescription
+            return
+        }
+        session.disconnect()
+
+        if !replay.finished {
+            errorMessage = "回放未结束，以下为已回放部分的结果"
+        }
+
+        let result = Result(recording: recording.lastPathComponent,
+                            inboundRecords: info.serverRecords,
+                            elapsed: replay.elapsed,
+                            firstFrame: replay.firstFrameTime,
+                            frames: replay.frames,
+                            framesPerSecond: replay.framesPerSecond,
+                            decodedBytes: replay.decodedBytes,
+                            decodedMegabytesPerSecond: replay.decodedMegabytesPerSecond,
+                            bytesReplayed: replay.bytesReplayed)
+        vLog("[Benchmark] \(result.summary)")
+        self.result = result
+    }
+}
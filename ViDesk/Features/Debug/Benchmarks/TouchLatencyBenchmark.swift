@@ -0,0 +1,109 @@
+import Foundation
+
+/// 双指缩放的手势到帧延迟测试
+/// 建立一个无界面会话，通过 RDPEI 在屏幕中央反复发送双指张开/合拢的触控帧 (120Hz)，
+/// 统计每个触控帧到其后第一次帧更新的延迟；远程应在前台打开浏览器页面以响应缩放
+@MainActor
+@Observable
+final class TouchLatencyBenchmark {
+    /// 测试结果
+    struct Result {
+        let gestures: Int
+        let touchFrames: Int
+        let samples: Int
+        let averageLatency: TimeInterval
+        let maxLatency: TimeInterval
+
+        var summary: String {
+            String(format: "双指缩放 %d 次, 触控帧 %d, 延迟样本 %d: 平均 %.1f ms / 最大 %.1f ms",
+                   gestures, touchFrames, samples, averageLatency * 1000, maxLatency * 1000)
+        }
+    }
+
+    /// 缩放手势次数 (张开、合拢交替)
+    var gestureCount = 20
+
+    /// 单次手势时长
+    var gestureDuration: TimeInterval = 0.5
+
+    /// 触控帧发送间隔 (120Hz，与手势识别器的采样频率一致)
+    private let frameInterval: Duration = .microseconds(8_333)
+
+    private(set) var isRunning = false
+    private(set) var progress = ""
+    private(set) var errorMessage: String?
+    private(set) var result: Result?
+
+    /// 运行测试
+    func run(config: ConnectionConfig, password: String?) async {
+        guard !isRunning else { return }
+        isRunning = true
+        result = nil
+        errorMessage = nil
+        defer {
+            isRunning = false
+            progress = ""
+        }
+
+        let session = RDPSession()
+        progress = "正在连接..."
+        do {
+            try await session.connect(config: config, password: password)
+        } catch {
+            vLog("[Benchmark] 触控延迟测试连接失败: \(error.localizedDescription)")
+            errorMessage = error.localizedDescription
+            return
+        }
+        defer { session.disconnect() }
+
+        // RDPEI 通道在连接完成后由服务器打开
+        try? await Task.sleep(for: .seconds(2))
+        guard session.supportsTouch else {
+            errorMessage = "服务器未打开 RDPEI 通道，无法测试多点触控"
+            vLog("[Benchmark] 触控延迟测试: \(errorMessage!)")
+            return
+        }
+
+        let center = CGPoint(x: CGFloat(config.displaySettings.width) / 2,
+                             y: CGFloat(config.displaySettings.height) / 2)
+        session.resetTouchStatistics()
+
+        for index in 0..<gestureCount {
+            progress = "缩放手势 \(index + 1)/\(gestureCount)..."
+            let spreading = index % 2 == 0
+            await pinch(session: session, center: center,
+                        from: spreading ? 40 : 240, to: spreading ? 240 : 40)
+            try? await Task.sleep(for: .milliseconds(300))
+        }
+
+        let stats = session.touchStatistics()
+        let result = Result(gestures: gestureCount,
+                            touchFrames: stats.frames,
+                            samples: stats.latencySamples,
+                            averageLatency: stats.averageLatency,
+                            maxLatency: stats.maxLatency)
+        vLog("[Benchmark] \(result.summary)")
+        self.result = result
+    }
+
+    // MARK: - 私有方法
+
+    /// 两个手指沿水平方向从 from 间距移动到 to 间距
+    private func pinch(session: RDPSession, center: CGPoint, from: CGFloat, to: CGFloat) async {
+        let steps = max(1, Int(gestureDuration * 120))
+
+        func contacts(spread: CGFloat, phase: TouchPhase) -> [TouchContact] {
+            [TouchContact(id: 0, location: CGPoint(x: center.x - spread / 2, y: center.y), phase: phase),
+             TouchContact(id: 1, location: CGPoint(x: center.x + spread / 2, y: center.y), phase: phase)]
+        }
+
+        _ = session.sendTouchFrame(contacts(spread: from, phase: .began))
+        for step in 1...steps {
+            guard session.state == .connected else { return }
+            try? await Task.sleep(for: frameInterval)
+            let spread = from + (to - from) * CGFloat(step) / CGFloat(steps)
+            _ = session.sendTouchFrame(contacts(spread: spread, phase: .moved))
+        }
+        _ = session.sendTouchFrame(contacts(spread: to, phase: .ended))
+    }
+}
@@ -30,6 +30,24 @@ struct DebugView: View {
     @State private var pingResult = ""
     @State private var pingResults: [Double] = []
 
+    // 并发会话基准
+    @State private var sessionBenchmark = ConcurrentSessionBenchmark()
+    @State private var clipboardBenchmark = ClipboardInputLatencyBenchmark()
+    @State private var touchBenchmark = TouchLatencyBenchmark()
+    @State private var replayBenchmark = InputReplayBenchmark()
+    @State private var sessionReplayBenchmark = SessionReplayBenchmark()
+    @State private var captureNextSession = false
+    @State private var compressionLevel: FreeRDPContext.CompressionLevel = .xcrush
+    @State private var compressionBenchmark = BulkCompressionBenchmark()
+    @State private var wanPreset: FreeRDPContext.WanPreset = .none
+
+    // 线程角色统计
+    @State private var threadRoleStats: [(role: ThreadRole, stats: ThreadRole.Statistics)] = []
+
+    // 虚拟通道统计 (调试连接)
+    @State private var channelStats: [FreeRDPContext.ChannelStatistics] = []
+    @State private var channelHistories: [String: [FreeRDPContext.ChannelSample]] = [:]
+
     var body: some View {
         List {
             Section("RDP 连接测试") {
@@ -42,6 +60,17 @@ struct DebugView: View {
                 Toggle("使用 NLA (服务器要求)", isOn: $useNLA)
                 Toggle("使用 TLS", isOn: $useTLS)
                 Toggle("忽略证书错误", isOn: $ignoreCertErrors)
+                Toggle("录制下次连接 (用于解码回放)", isOn: $captureNextSession)
+                Picker("批量压缩", selection: $compressionLevel) {
+                    ForEach(FreeRDPContext.CompressionLevel.allCases) { level in
+                        Text(level.displayName).tag(level)
+                    }
+                }
+                Picker("网络模拟", selection: $wanPreset) {
+                    ForEach(FreeRDPContext.WanPreset.allCases) { preset in
+                        Text(preset.displayName).tag(preset)
+                    }
+                }
 
                 HStack {
                     Text("状态:")
@@ -56,6 +85,12 @@ struct DebugView: View {
                     .buttonStyle(.borderedProminent)
                     .disabled(isConnecting || testHostname.isEmpty || testUsername.isEmpty)
 
+                    Button("预热") {
+                        prewarmRDPConnection()
+                    }
+                    .buttonStyle(.bordered)
+                    .disabled(isConnecting || testHostname.isEmpty)
+
                     if rdpSession != nil {
                         Button("断开") {
                             disconnectRDP()
@@ -72,6 +107,263 @@ struct DebugView: View {
                 .buttonStyle(.bordered)
             }
 
+            Section("并发会话基准") {
+                Toggle("共享工作线程", isOn: $sessionBenchmark.useSharedWorkers)
+                    .disabled(sessionBenchmark.isRunning)
+
+                Toggle("池化传输层", isOn: $sessionBenchmark.usePooledTransport)
+                    .disabled(sessionBenchmark.isRunning)
+
+                Picker("网络模拟", selection: $sessionBenchmark.wanPreset) {
+                    ForEach(FreeRDPContext.WanPreset.allCases) { preset in
+                        Text(preset.displayName).tag(preset)
+                    }
+                }
+                .disabled(sessionBenchmark.isRunning || !sessionBenchmark.usePooledTransport)
+
+                Button(sessionBenchmark.isRunning ? "测试中..." : "运行 1/4/8 会话基准") {
+                    runSessionBenchmark()
+                }
+                .buttonStyle(.borderedProminent)
+                .disabled(sessionBenchmark.isRunning || testHostname.isEmpty || testUsername.isEmpty)
+
+                if !sessionBenchmark.progress.isEmpty {
+                    Text(sessionBenchmark.progress)
+                        .foregroundStyle(.secondary)
+                }
+
+                if let error = sessionBenchmark.errorMessage {
+                    Text(error)
+                        .font(.caption)
+                        .foregroundStyle(.red)
+                }
+
+                ForEach(sessionBenchmark.results) { result in
+                    Text(result.summary)
+                        .font(.caption.monospaced())
+                }
+            }
+
+            Section("剪贴板传输输入延迟") {
+                Text("测试会向远程发送 Ctrl+V，请先让远程焦点位于文本编辑器")
+                    .font(.caption)
+                    .foregroundStyle(.secondary)
+
+                Button(clipboardBenchmark.isRunning ? "测试中..." : "运行 50 MB 剪贴板测试") {
+                    runClipboardBenchmark()
+                }
+                .buttonStyle(.bordered)
+                .disabled(clipboardBenchmark.isRunning || testHostname.isEmpty || testUsername.isEmpty)
+
+                if !clipboardBenchmark.progress.isEmpty {
+                    Text(clipboardBenchmark.progress)
+                        .foregroundStyle(.secondary)
+                }
+
+                if let result = clipboardBenchmark.result {
+                    Text(result.summary)
+                        .font(.caption.monospaced())
+                }
+            }
+
+            Section("多点触控延迟") {
+                Text("测试在屏幕中央发送双指缩放触控帧，请先在远程打开浏览器页面")
+                    .font(.caption)
+                    .foregroundStyle(.secondary)
+
+                Button(touchBenchmark.isRunning ? "测试中..." : "运行双指缩放测试") {
+                    runTouchBenchmark()
+                }
+                .buttonStyle(.bordered)
+                .disabled(touchBenchmark.isRunning || testHostname.isEmpty || testUsername.isEmpty)
+
+                if !touchBenchmark.progress.isEmpty {
+                    Text(touchBenchmark.progress)
+                        .foregroundStyle(.secondary)
+                }
+
+                if let error = touchBenchmark.errorMessage {
+                    Text(error)
+                        .font(.caption)
+                        .foregroundStyle(.red)
+                }
+
+                if let result = touchBenchmark.result {
+                    Text(result.summary)
+                        .font(.caption.monospaced())
+                }
+            }
+
+            Section("输入回放延迟") {
+                Text("回放会话工具栏录制的输入，请先让远程桌面处于与录制时相同的状态")
+                    .font(.caption)
+                    .foregroundStyle(.secondary)
+
+                Picker("录制文件", selection: $replayBenchmark.selectedRecording) {
+                    ForEach(replayBenchmark.recordings, id: \.self) { url in
+                        Text(url.lastPathComponent).tag(Optional(url))
+                    }
+                }
+                .disabled(replayBenchmark.isRunning)
+
+                Button(replayBenchmark.isRunning ? "测试中..." : "运行回放测试") {
+                    runReplayBenchmark()
+                }
+                .buttonStyle(.bordered)
+                .disabled(replayBenchmark.isRunning || replayBenchmark.selectedRecording == nil ||
+                          testHostname.isEmpty || testUsername.isEmpty)
+
+                if !replayBenchmark.progress.isEmpty {
+                    Text(replayBenchmark.progress)
+                        .foregroundStyle(.secondary)
+                }
+
+                if let error = replayBenchmark.errorMessage {
+                    Text(error)
+                        .font(.caption)
+                        .foregroundStyle(.red)
+                }
+
+                if let result = replayBenchmark.result {
+                    Text(result.summary)
+                        .font(.caption.monospaced())
+                }
+            }
+            .onAppear {
+                replayBenchmark.refreshRecordings()
+            }
+
+            Section("会话回放解码吞吐量") {
+                Text("不连接服务器，尽快回放录制的会话；安全选项需与录制时一致")
+                    .font(.caption)
+                    .foregroundStyle(.secondary)
+
+                Picker("会话录制", selection: $sessionReplayBenchmark.selectedRecording) {
+                    ForEach(sessionReplayBenchmark.recordings, id: \.self) { url in
+                        Text(url.lastPathComponent).tag(Optional(url))
+                    }
+                }
+                .disabled(sessionReplayBenchmark.isRunning)
+
+                Button(sessionReplayBenchmark.isRunning ? "回放中..." : "运行解码回放") {
+                    runSessionReplayBenchmark()
+                }
+                .buttonStyle(.bordered)
+                .disabled(sessionReplayBenchmark.isRunning || sessionReplayBenchmark.selectedRecording == nil)
+
+                if !sessionReplayBenchmark.progress.isEmpty {
+                    Text(sessionReplayBenchmark.progress)
+                        .foregroundStyle(.secondary)
+                }
+
+                if let error = sessionReplayBenchmark.errorMessage {
+                    Text(error)
+                        .font(.caption)
+                        .foregroundStyle(.red)
+                }
+
+                if let result = sessionReplayBenchmark.result {
+                    Text(result.summary)
+                        .font(.caption.monospaced())
+                }
+            }
+            .onAppear {
+                sessionReplayBenchmark.refreshRecordings()
+            }
+
+            Section("批量压缩级别") {
+                Text("回放全部会话录制，按录制时的压缩级别比较压缩率和解码流水线吞吐量；每个级别录制同一操作流程")
+                    .font(.caption)
+                    .foregroundStyle(.secondary)
+
+                Button(compressionBenchmark.isRunning ? "回放中..." : "运行压缩级别对比") {
+                    runCompressionBenchmark()
+                }
+                .buttonStyle(.bordered)
+                .disabled(compressionBenchmark.isRunning)
+
+                if !compressionBenchmark.progress.isEmpty {
+                    Text(compressionBenchmark.progress)
+                        .foregroundStyle(.secondary)
+                }
+
+                if let error = compressionBenchmark.errorMessage {
+                    Text(error)
+                        .font(.caption)
+                        .foregroundStyle(.red)
+                }
+
+                ForEach(compressionBenchmark.results) { result in
+                    Text(result.summary)
+                        .font(.caption.monospaced())
+                }
+
+                if !compressionBenchmark.results.isEmpty && !compressionBenchmark.missingLevels.isEmpty {
+                    Text("缺少录制: " + compressionBenchmark.missingLevels.map(\.displayName).joined(separator: ", "))
+                        .font(.caption)
+                        .foregroundStyle(.secondary)
+                }
+            }
+
+            Section("线程角色调度") {
+                ForEach(threadRoleStats, id: \.role) { entry in
+                    Text(String(format: "%@: %d 线程, %llu 次, 平均排队 %.2f ms (最长 %.2f), %@, CPU %.1f s",
+                                entry.role.displayName, entry.stats.threadCount, entry.stats.workItems,
+                                entry.stats.averageWait * 1000, entry.stats.maxWait * 1000,
+                                runDelayText(entry.stats), entry.stats.cpuTime))
+                        .font(.caption.monospaced())
+                }
+
+                HStack {
+                    Button("刷新") {
+                        refreshThreadRoleStats()
+                    }
+                    .buttonStyle(.bordered)
+
+                    Button("重置") {
+                        ThreadRole.resetStatistics()
+                        refreshThreadRoleStats()
+                    }
+                    .buttonStyle(.bordered)
+                }
+            }
+
+            Section("虚拟通道") {
+                if rdpSession == nil {
+                    Text("先建立调试连接")
+                        .foregroundStyle(.secondary)
+                }
+
+                ForEach(channelStats) { channel in
+                    VStack(alignment: .leading, spacing: 2) {
+                        Text(String(format: "%@%@: 入 %.1f KB/s, 出 %.1f KB/s",
+                                    channel.displayName, channel.isDynamic ? (channel.isOpen ? "" : " (已关闭)") : " [静态]",
+                                    Double(channel.bytesInPerSecond) / 1024, Double(channel.bytesOutPerSecond) / 1024))
+                        Text(String(format: "累计 入 %.2f MB / %llu 条, 出 %.2f MB / %llu 条",
+                                    Double(channel.bytesIn) / 1_000_000, channel.messagesIn,
+                                    Double(channel.bytesOut) / 1_000_000, channel.messagesOut))
+                            .foregroundStyle(.secondary)
+                        if let history = channelHistories[channel.id], !history.isEmpty {
+                            Text("最近 \(history.count) 秒 " + Self.sparkline(history.map { $0.bytesIn + $0.bytesOut }))
+                                .foregroundStyle(.secondary)
+                        }
+                    }
+                    .font(.caption.monospaced())
+                }
+
+                if let overhead = drdynvcOverhead {
+                    Text(String(format: "drdynvc 协议开销: 入 %.1f KB, 出 %.1f KB",
+                                Double(overhead.inbound) / 1024, Double(overhead.outbound) / 1024))
+                        .font(.caption.monospaced())
+                }
+
+                Button("刷新") {
+                    refreshChannelStats()
+                }
+                .buttonStyle(.bordered)
+                .disabled(rdpSession == nil)
+            }
+
             Section("Ping 测试") {
                 TextField("IP 地址", text: $pingIP)
                     .keyboardType(.decimalPad)
@@ -222,6 +514,18 @@ struct DebugView: View {
             let session = RDPSession()
             rdpSession = session
 
+            if captureNextSession {
+                captureNextSession = false
+                let url = session.captureNextConnection()
+                addLog("录制本次连接: \(url.lastPathComponent)")
+            }
+            session.compressionLevel = compressionLevel
+            session.wanProfile = wanPreset.profile
+            if let profile = wanPreset.profile {
+                addLog("网络模拟: \(wanPreset.displayName), 单向延迟 \(profile.latencyMs)±\(profile.jitterMs) ms, " +
+                       "带宽 \(profile.downlinkKbps)/\(profile.uplinkKbps) kbps")
+            }
+
             let port = Int(testPort) ?? 3389
             let config = ConnectionConfig(
                 name: "调试连接",
@@ -239,6 +543,15 @@ struct DebugView: View {
                 await MainActor.run {
                     connectionStatus = "已连接"
                     addLog("RDP 连接成功!")
+                    let transport = session.transportStatistics()
+                    if transport.prewarmSaved > 0 {
+                        addLog(String(format: "使用预热的 TCP 连接，省下 %.0f ms", transport.prewarmSaved * 1000))
+                    }
+                    if !transport.remoteAddress.isEmpty {
+                        addLog(String(format: "连接地址: %@ (尝试 %u/%u 个地址，至少省下 %.0f ms)",
+                                      transport.remoteAddress, transport.addressAttempts,
+                                      transport.addressCandidates, transport.raceSaved * 1000))
+                    }
                     isConnecting = false
                 }
             } catch {
@@ -252,13 +565,175 @@ struct DebugView: View {
         }
     }
 
+    /// 预热测试主机，10 秒内点击连接时使用
+    private func prewarmRDPConnection() {
+        let port = Int(testPort) ?? 3389
+        if FreeRDPContext.prewarm(hostname: testHostname, port: port, window: 10) {
+            addLog("预热连接: \(testHostname):\(port) (10 秒内有效)")
+        } else {
+            addLog("预热失败: \(testHostname):\(port)")
+        }
+    }
+
     private func disconnectRDP() {
+        if let wan = rdpSession?.wanEmulationStatistics(), wan.isEnabled {
+            addLog(String(format: "网络模拟: 下行 %.1f MB 平均延迟 %.0f ms, 上行平均延迟 %.0f ms, 断流 %u 次共 %.1f 秒",
+                          Double(wan.bytesDown) / 1_000_000, wan.averageDelayDown * 1000,
+                          wan.averageDelayUp * 1000, wan.stalls, wan.stalledTime))
+        }
         rdpSession?.disconnect()
         rdpSession = nil
+        channelStats = []
+        channelHistories = [:]
         connectionStatus = "已断开"
         addLog("RDP 已断开")
     }
 
+    // MARK: - 并发会话基准
+
+    /// 基准测试使用的连接配置 (取自上方测试字段)
+    private var benchmarkConfig: ConnectionConfig {
+        ConnectionConfig(
+            name: "基准测试",
+            hostname: testHostname,
+            port: Int(testPort) ?? 3389,
+            username: testUsername,
+            domain: testDomain.isEmpty ? nil : testDomain,
+            autoReconnect: false,
+            useNLA: useNLA,
+            useTLS: useTLS,
+            ignoreCertificateErrors: ignoreCertErrors
+        )
+    }
+
+    private func runSessionBenchmark() {
+        let config = benchmarkConfig
+        addLog("开始并发会话基准: \(testHostname)")
+
+        Task {
+            await sessionBenchmark.run(config: config, password: testPassword)
+            if let error = sessionBenchmark.errorMessage {
+                addLog("并发会话基准: \(error)")
+            }
+            for result in sessionBenchmark.results {
+                addLog("基准: \(result.summary)")
+            }
+        }
+    }
+
+    private func runClipboardBenchmark() {
+        let config = benchmarkConfig
+        addLog("开始剪贴板传输输入延迟测试: \(testHostname)")
+
+        Task {
+            await clipboardBenchmark.run(config: config, password: testPassword)
+            if let result = clipboardBenchmark.result {
+                addLog("基准: \(result.summary)")
+            }
+        }
+    }
+
+    private func runTouchBenchmark() {
+        let config = benchmarkConfig
+        addLog("开始多点触控延迟测试: \(testHostname)")
+
+        Task {
+            await touchBenchmark.run(config: config, password: testPassword)
+            if let result = touchBenchmark.result {
+                addLog("基准: \(result.summary)")
+            } else if let error = touchBenchmark.errorMessage {
+                addLog("触控测试失败: \(error)")
+            }
+        }
+    }
+
+    private func runReplayBenchmark() {
+        let config = benchmarkConfig
+        addLog("开始输入回放测试: \(replayBenchmark.selectedRecording?.lastPathComponent ?? "")")
+
+        Task {
+            await replayBenchmark.run(config: config, password: testPassword)
+            if let error = replayBenchmark.errorMessage {
+                addLog("回放测试: \(error)")
+            }
+            if let result = replayBenchmark.result {
+                addLog("基准: \(result.summary)")
+            }
+        }
+    }
+
+    private func runSessionReplayBenchmark() {
+        let config = benchmarkConfig
+        addLog("开始会话回放: \(sessionReplayBenchmark.selectedRecording?.lastPathComponent ?? "")")
+
+        Task {
+            await sessionReplayBenchmark.run(config: config)
+            if let error = sessionReplayBenchmark.errorMessage {
+                addLog("会话回放: \(error)")
+            }
+            if let result = sessionReplayBenchmark.result {
+                addLog("基准: \(result.summary)")
+            }
+        }
+    }
+
+    private func runCompressionBenchmark() {
+        let config = benchmarkConfig
+        addLog("开始压缩级别对比")
+
+        Task {
+            await compressionBenchmark.run(config: config)
+            if let error = compressionBenchmark.errorMessage {
+                addLog("压缩级别对比: \(error)")
+            }
+            for result in compressionBenchmark.results {
+                addLog("基准: \(result.summary)")
+            }
+        }
+    }
+
+    // MARK: - 线程角色
+
+    private func refreshThreadRoleStats() {
+        threadRoleStats = ThreadRole.allCases.map { ($0, $0.statistics) }
+    }
+
+    private func runDelayText(_ stats: ThreadRole.Statistics) -> String {
+        guard stats.runDelayAvailable else { return "运行队列 不可用" }
+        return String(format: "运行队列 %.2f ms (最长 %.2f)", stats.averageRunDelay * 1000, stats.maxRunDelay * 1000)
+    }
+
+    // MARK: - 虚拟通道
+
+    private func refreshChannelStats() {
+        guard let session = rdpSession else {
+            channelStats = []
+            channelHistories = [:]
+            return
+        }
+        channelStats = session.channelStatistics()
+        channelHistories = Dictionary(uniqueKeysWithValues: channelStats.map { ($0.id, session.channelHistory(for: $0)) })
+    }
+
+    /// drdynvc 线路字节减去各动态通道的负载
+    private var drdynvcOverhead: (inbound: UInt64, outbound: UInt64)? {
+        guard let drdynvc = channelStats.first(where: { !$0.isDynamic && $0.name == "drdynvc" }) else { return nil }
+        let dynamic = channelStats.filter { $0.isDynamic }
+        let payloadIn = dynamic.reduce(UInt64(0)) { $0 + $1.bytesIn }
+        let payloadOut = dynamic.reduce(UInt64(0)) { $0 + $1.bytesOut }
+        return (drdynvc.bytesIn > payloadIn ? drdynvc.bytesIn - payloadIn : 0,
+                drdynvc.bytesOut > payloadOut ? drdynvc.bytesOut - payloadOut : 0)
+    }
+
+    /// 按最大值归一化的字符迷你图
+    private static func sparkline(_ values: [UInt64]) -> String {
+        let levels = Array("▁▂▃▄▅▆▇█")
+        guard let peak = values.max(), peak > 0 else {
+            return String(repeating: levels[0], count: values.count)
+        }
+        return String(values.map { levels[Int($0 * UInt64(levels.count - 1) / peak)] })
+    }
+
     // MARK: - TCP 连接测试
 
     private struct TCPTestResult {
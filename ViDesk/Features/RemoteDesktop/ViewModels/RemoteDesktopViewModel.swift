@@ -55,7 +55,7 @@ final class RemoteDesktopViewModel {
     // MARK: - 初始化
 
     init() {
-        self.session = RDPSession()
+        self.session = SessionManager.shared?.makeSession() ?? RDPSession()
         self.inputManager = InputManager()
         self.inputManager.bind(to: session)
     }
@@ -69,6 +69,9 @@ final class RemoteDesktopViewModel {
         self.password = password
         errorMessage = nil
 
+        // 用户刚打开的会话优先获得内存预算和调度
+        focus()
+
         do {
             try await session.connect(config: config, password: password)
             vLog("ViewModel.connect() 成功")
@@ -87,6 +90,11 @@ final class RemoteDesktopViewModel {
         inputManager.unbind()
     }
 
+    /// 将本会话设为焦点会话 (窗口回到前台时调用)
+    func focus() {
+        SessionManager.shared?.focus(session)
+    }
+
     /// 清除错误消息
     func clearError() {
         errorMessage = nil
@@ -138,6 +146,20 @@ final class RemoteDesktopViewModel {
         session.getRemoteClipboard()
     }
 
+    /// 是否正在录制输入
+    var isRecordingInput: Bool {
+        session.isRecordingInput
+    }
+
+    /// 开始/结束输入录制 (录制文件可在调试页回放)
+    func toggleInputRecording() {
+        if session.isRecordingInput {
+            _ = session.stopInputRecording()
+        } else {
+            _ = session.startInputRecording()
+        }
+    }
+
     // MARK: - UI 操作
 
     /// 切换虚拟键盘
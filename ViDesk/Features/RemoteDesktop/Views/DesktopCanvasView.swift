@@ -88,6 +88,18 @@ struct MetalDesktopView: UIViewRepresentable {
         // 设置渲染器
         if let renderer = MetalRenderer(device: device) {
             renderer.scaleMode = scaleMode
+            renderer.onFramePresented = { [weak session] sequence, presentedTime in
+                session?.recordFramePresented(sequence: sequence, presentedTime: presentedTime)
+            }
+            // 光标在本地预测位置绘制，不等待服务器回显
+            renderer.cursorPosition = inputManager.localCursorPosition
+            inputManager.onLocalCursorChanged = { [weak renderer] position in
+                renderer?.cursorPosition = position
+            }
+            renderer.setPointerShape(session.pointerShape)
+            session.onPointerShapeChanged = { [weak renderer] shape in
+                renderer?.setPointerShape(shape)
+            }
             mtkView.delegate = renderer
             context.coordinator.renderer = renderer
         } else {
@@ -106,6 +118,7 @@ struct MetalDesktopView: UIViewRepresentable {
     func updateUIView(_ uiView: MTKView, context: Context) {
         context.coordinator.renderer?.scaleMode = scaleMode
         context.coordinator.renderer?.frameBuffer = session.frameBuffer
+        context.coordinator.updateInputMode(inputManager.inputMode)
     }
 
     func makeCoordinator() -> Coordinator {
@@ -128,13 +141,32 @@ struct MetalDesktopView: UIViewRepresentable {
         longPressGesture.minimumPressDuration = 0.5
         view.addGestureRecognizer(longPressGesture)
 
-        // 拖拽手势
+        // 拖拽手势 (单指)
         let panGesture = UIPanGestureRecognizer(target: coordinator, action: #selector(Coordinator.handlePan(_:)))
+        panGesture.maximumNumberOfTouches = 1
         view.addGestureRecognizer(panGesture)
 
+        // 双指滑动 (滚轮，含水平方向和惯性)
+        let scrollGesture = UIPanGestureRecognizer(target: coordinator, action: #selector(Coordinator.handleScroll(_:)))
+        scrollGesture.minimumNumberOfTouches = 2
+        scrollGesture.maximumNumberOfTouches = 2
+        view.addGestureRecognizer(scrollGesture)
+
         // 缩放手势 (滚轮)
         let pinchGesture = UIPinchGestureRecognizer(target: coordinator, action: #selector(Coordinator.handlePinch(_:)))
         view.addGestureRecognizer(pinchGesture)
+
+        // 直接触控：原始触点转发，启用时上面的鼠标模拟手势全部停用
+        let touchRecognizer = TouchForwardingRecognizer(target: nil, action: nil)
+        touchRecognizer.onTouches = { [weak coordinator, weak view] touches in
+            guard let coordinator, let view else { return }
+            coordinator.handleTouches(touches, in: view)
+        }
+        view.addGestureRecognizer(touchRecognizer)
+
+        coordinator.mouseGestures = [tapGesture, doubleTapGesture, longPressGesture, panGesture, scrollGesture, pinchGesture]
+        coordinator.touchRecognizer = touchRecognizer
+        coordinator.updateInputMode(inputManager.inputMode)
     }
 
     // MARK: - Coordinator
@@ -142,11 +174,31 @@ struct MetalDesktopView: UIViewRepresentable {
     class Coordinator: NSObject {
         let inputManager: InputManager
         var renderer: MetalRenderer?
+        var mouseGestures: [UIGestureRecognizer] = []
+        var touchRecognizer: TouchForwardingRecognizer?
 
         init(inputManager: InputManager) {
             self.inputManager = inputManager
         }
 
+        /// 按输入模式切换鼠标模拟手势和原始触点转发
+        func updateInputMode(_ mode: InputMode) {
+            let direct = mode == .directTouch
+            touchRecognizer?.isEnabled = direct
+            for gesture in mouseGestures {
+                gesture.isEnabled = !direct
+            }
+        }
+
+        @MainActor
+        func handleTouches(_ touches: [TouchForwardingRecognizer.Touch], in view: UIView) {
+            let contacts = touches.compactMap { touch -> TouchContact? in
+                guard let point = convertToTextureCoordinate(touch.location, in: view) else { return nil }
+                return TouchContact(id: touch.id, location: point, phase: touch.phase)
+            }
+            inputManager.handleTouches(contacts)
+        }
+
         private func convertToTextureCoordinate(_ point: CGPoint, in view: UIView) -> CGPoint? {
             return renderer?.viewToTextureCoordinate(point, viewSize: view.bounds.size)
         }
@@ -198,11 +250,40 @@ struct MetalDesktopView: UIViewRepresentable {
         }
 
         @MainActor
-        @objc func handlePinch(_ gesture: UIPinchGestureRecognizer) {
-            guard gesture.state == .ended else { return }
+        @objc func handleScroll(_ gesture: UIPanGestureRecognizer) {
+            guard let view = gesture.view else { return }
 
-            let delta = (gesture.scale - 1.0) * 120
-            inputManager.scroll(delta: delta)
+            switch gesture.state {
+            case .began:
+                inputManager.beginScroll()
+                gesture.setTranslation(.zero, in: view)
+            case .changed:
+                // 每次只取增量，由 InputManager 累积后按显示帧发送
+                let translation = gesture.translation(in: view)
+                gesture.setTranslation(.zero, in: view)
+                inputManager.updateScroll(translation: CGSize(width: translation.x, height: translation.y))
+            case .ended:
+                let velocity = gesture.velocity(in: view)
+                inputManager.endScroll(velocity: CGSize(width: velocity.x, height: velocity.y))
+            default:
+                break
+            }
+        }
+
+        @MainActor
+        @objc func handlePinch(_ gesture: UIPinchGestureRecognizer) {
+            switch gesture.state {
+            case .began:
+                inputManager.handlePinchGesture(scale: gesture.scale, phase: .began)
+            case .changed:
+                inputManager.handlePinchGesture(scale: gesture.scale, phase: .changed)
+            case .ended:
+                inputManager.handlePinchGesture(scale: gesture.scale, phase: .ended)
+            case .cancelled, .failed:
+                inputManager.handlePinchGesture(scale: gesture.scale, phase: .cancelled)
+            default:
+                break
+            }
         }
     }
 }
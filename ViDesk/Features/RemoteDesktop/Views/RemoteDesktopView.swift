@@ -3,6 +3,7 @@ import SwiftUI
 /// 远程桌面视图
 struct RemoteDesktopView: View {
     @State private var viewModel: RemoteDesktopViewModel
+    @Environment(\.scenePhase) private var scenePhase
 
     let config: ConnectionConfig
     let password: String?
@@ -109,6 +110,11 @@ struct RemoteDesktopView: View {
         .onDisappear {
             viewModel.disconnect()
         }
+        .onChange(of: scenePhase) { _, phase in
+            if phase == .active {
+                viewModel.focus()
+            }
+        }
         .gesture(
             TapGesture(count: 3)
                 .onEnded {
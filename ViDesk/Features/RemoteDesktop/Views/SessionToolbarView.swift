@@ -32,6 +32,18 @@ struct SessionToolbarView: View {
                 clipboardMenu
             }
 
+            Divider()
+                .frame(height: 24)
+
+            // 输入录制按钮
+            ToolbarButton(
+                icon: viewModel.isRecordingInput ? "stop.circle" : "record.circle",
+                label: viewModel.isRecordingInput ? "停止录制" : "录制输入",
+                isActive: viewModel.isRecordingInput
+            ) {
+                viewModel.toggleInputRecording()
+            }
+
             Divider()
                 .frame(height: 24)
 
@@ -76,6 +88,9 @@ struct SessionToolbarView: View {
             // 延迟
             StatItem(icon: "clock", value: viewModel.statistics.formattedLatency, unit: "")
 
+            // 输入到上屏延迟 (p50 / p95 / p99)
+            StatItem(icon: "hand.point.up.left", value: viewModel.statistics.formattedInputLatency, unit: "")
+
             // 连接时长
             StatItem(icon: "timer", value: viewModel.statistics.formattedDuration, unit: "")
         }
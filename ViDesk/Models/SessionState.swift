@@ -104,12 +104,27 @@ struct SessionStatistics {
     var bandwidth: Int = 0
     var framesReceived: UInt64 = 0
     var bytesReceived: UInt64 = 0
+    /// 交给解码器的图像数据累计字节数
+    var decodedBytes: UInt64 = 0
     var connectionDuration: TimeInterval = 0
+    /// 事件处理线程在本会话上消耗的 CPU 时间
+    var processingCPUTime: TimeInterval = 0
+    /// 帧缓冲区 (含渲染侧副本) 和 GFX 缓存的内存占用
+    var memoryBytes: UInt64 = 0
+    /// 输入到上屏延迟百分位 (最近 512 个样本)
+    var inputLatencyP50: TimeInterval = 0
+    var inputLatencyP95: TimeInterval = 0
+    var inputLatencyP99: TimeInterval = 0
 
     var formattedLatency: String {
         String(format: "%.0f ms", latency * 1000)
     }
 
+    var formattedInputLatency: String {
+        String(format: "%.0f / %.0f / %.0f ms",
+               inputLatencyP50 * 1000, inputLatencyP95 * 1000, inputLatencyP99 * 1000)
+    }
+
     var formattedBandwidth: String {
         if bandwidth >= 1_000_000 {
             return String(format: "%.1f Mbps", Double(bandwidth) / 1_000_000)
@@ -10,6 +10,8 @@
 
 // FreeRDP 桥接层
 #import "Core/RDP/FreeRDPWrapper/FreeRDPBridge.h"
+#import "Core/RDP/FreeRDPWrapper/ViDeskSessionManager.h"
+#import "Core/RDP/FreeRDPWrapper/ViDeskThreadRoles.h"
 
 // 如果直接链接 FreeRDP 库，取消以下注释
 // #import <freerdp/freerdp.h>
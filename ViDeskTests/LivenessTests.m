@@ -0,0 +1,85 @@
+/**
+ * LivenessTests.m - 连接存活检测的单元测试
+ * 覆盖服务器发心跳时按心跳参数判断，以及不发心跳时的后备阈值和探测
+ */
+
+#import <XCTest/XCTest.h>
+#include "ViDeskLiveness.h"
+
+static const uint64_t kSecond = 1000000000ULL;
+
+@interface LivenessTests : XCTestCase
+@property (nonatomic) ViDeskLiveness* liveness;
+@end
+
+@implementation LivenessTests
+
+- (void)setUp {
+    self.liveness = viDesk_livenessNew();
+    XCTAssertTrue(self.liveness != NULL);
+    viDesk_livenessReset(self.liveness, 1 * kSecond);
+}
+
+- (void)tearDown {
+    viDesk_livenessFree(self.liveness);
+    self.liveness = NULL;
+}
+
+- (void)testNoHeartbeatUsesFallbackThresholds {
+    ViDeskLiveness* liveness = self.liveness;
+    uint64_t start = 1 * kSecond;
+
+    // 空闲的短暂静默不算异常，也不探测
+    XCTAssertEqual(viDesk_livenessCheck(liveness, start + 10 * kSecond, NULL), VIDESK_LIVENESS_ALIVE);
+    XCTAssertFalse(viDesk_livenessTakeProbe(liveness));
+
+    // 超过告警阈值：可疑，并请求一次探测
+    XCTAssertEqual(viDesk_livenessCheck(liveness, start + 20 * kSecond, NULL), VIDESK_LIVENESS_SUSPECT);
+    XCTAssertTrue(viDesk_livenessTakeProbe(liveness));
+    XCTAssertEqual(viDesk_livenessCheck(liveness, start + 30 * kSecond, NULL), VIDESK_LIVENESS_SUSPECT);
+    XCTAssertFalse(viDesk_livenessTakeProbe(liveness));
+
+    // 探测之后仍然静默：判定断开，只报告一次
+    uint64_t silence = 0;
+    XCTAssertEqual(viDesk_livenessCheck(liveness, start + 50 * kSecond, &silence), VIDESK_LIVENESS_DEAD);
+    XCTAssertEqual(silence, 50 * kSecond);
+    XCTAssertEqual(viDesk_livenessCheck(liveness, start + 60 * kSecond, NULL), VIDESK_LIVENESS_SUSPECT);
+
+    ViDeskLivenessStats stats;
+    viDesk_livenessGetStats(liveness, start + 60 * kSecond, &stats);
+    XCTAssertFalse(stats.heartbeatActive);
+    XCTAssertEqual(stats.suspects, 1u);
+    XCTAssertEqual(stats.probes, 1u);
+    XCTAssertEqual(stats.deadDetections, 1u);
+    XCTAssertGreaterThan(stats.timeoutNs, 0ull);
+}
+
+- (void)testProbeAnsweredKeepsSessionAlive {
+    ViDeskLiveness* liveness = self.liveness;
+    uint64_t start = 1 * kSecond;
+
+    XCTAssertEqual(viDesk_livenessCheck(liveness, start + 20 * kSecond, NULL), VIDESK_LIVENESS_SUSPECT);
+    XCTAssertTrue(viDesk_livenessTakeProbe(liveness));
+
+    // 服务器回应了探测
+    viDesk_livenessRecordInbound(liveness, start + 21 * kSecond);
+    XCTAssertEqual(viDesk_livenessCheck(liveness, start + 22 * kSecond, NULL), VIDESK_LIVENESS_ALIVE);
+
+    // 下一段静默重新探测
+    XCTAssertEqual(viDesk_livenessCheck(liveness, start + 40 * kSecond, NULL), VIDESK_LIVENESS_SUSPECT);
+    XCTAssertTrue(viDesk_livenessTakeProbe(liveness));
+}
+
+- (void)testHeartbeatThresholds {
+    ViDeskLiveness* liveness = self.liveness;
+    uint64_t start = 1 * kSecond;
+
+    // 周期 2 秒，错过 2 个告警，3 个断开
+    viDesk_livenessRecordHeartbeat(liveness, 2, 2, 3, start);
+    XCTAssertEqual(viDesk_livenessCheck(liveness, start + 4 * kSecond, NULL), VIDESK_LIVENESS_ALIVE);
+    XCTAssertEqual(viDesk_livenessCheck(liveness, start + 5 * kSecond, NULL), VIDESK_LIVENESS_SUSPECT);
+    XCTAssertFalse(viDesk_livenessTakeProbe(liveness));
+    XCTAssertEqual(viDesk_livenessCheck(liveness, start + 7 * kSecond, NULL), VIDESK_LIVENESS_DEAD);
+}
+
+@end
@@ -0,0 +1,40 @@
+/**
+ * MouseWheelEncodingTests.m - 滚轮指针标志编码的单元测试
+ * 负的旋转量按 9 位二进制补码编码，低 8 位为 0x200 减去幅度
+ */
+
+#import <XCTest/XCTest.h>
+#include <freerdp/input.h>
+#include "FreeRDPBridge.h"
+
+@interface MouseWheelEncodingTests : XCTestCase
+@end
+
+@implementation MouseWheelEncodingTests
+
+- (void)testPositiveDelta {
+    XCTAssertEqual(viDesk_wheelFlags(0, false), PTR_FLAGS_WHEEL);
+    XCTAssertEqual(viDesk_wheelFlags(120, false), PTR_FLAGS_WHEEL | 0x78);
+    XCTAssertEqual(viDesk_wheelFlags(1000, false), PTR_FLAGS_WHEEL | 0xFF);
+}
+
+- (void)testNegativeDeltaIsTwosComplement {
+    const uint16_t negative = PTR_FLAGS_WHEEL | PTR_FLAGS_WHEEL_NEGATIVE;
+    XCTAssertEqual(viDesk_wheelFlags(-1, false), negative | 0xFF);
+    XCTAssertEqual(viDesk_wheelFlags(-30, false), negative | 0xE2);
+    XCTAssertEqual(viDesk_wheelFlags(-120, false), negative | 0x88);
+    XCTAssertEqual(viDesk_wheelFlags(-255, false), negative | 0x01);
+}
+
+- (void)testNegativeDeltaClampsTo256 {
+    const uint16_t negative = PTR_FLAGS_WHEEL | PTR_FLAGS_WHEEL_NEGATIVE;
+    XCTAssertEqual(viDesk_wheelFlags(-256, false), negative);
+    XCTAssertEqual(viDesk_wheelFlags(-1000, false), negative);
+}
+
+- (void)testHorizontalWheel {
+    XCTAssertEqual(viDesk_wheelFlags(-120, true), PTR_FLAGS_HWHEEL | PTR_FLAGS_WHEEL_NEGATIVE | 0x88);
+    XCTAssertEqual(viDesk_wheelFlags(120, true), PTR_FLAGS_HWHEEL | 0x78);
+}
+
+@end
@@ -0,0 +1,118 @@
+/**
+ * TransportReadPduTests.m - 池化传输层 ReadPdu 的单元测试
+ * 用脚本化的 ReadBytes 按片交付数据，检查未到齐时的返回值和交出 PDU 时流的长度、位置
+ */
+
+#import <XCTest/XCTest.h>
+#include <string.h>
+#include "ViDeskTransport.h"
+
+/// 每次 ReadBytes 调用交付一片，片用完后返回 0 (非阻塞模式下数据未到)
+typedef struct {
+    const BYTE* data;
+    size_t chunks[8];
+    size_t count;
+    size_t next;
+    size_t offset;
+    size_t calls;
+} ScriptedReader;
+
+static ScriptedReader gReader;
+
+static SSIZE_T scriptedReadBytes(rdpTransport* transport, BYTE* data, size_t bytes) {
+    gReader.calls++;
+    if (gReader.next >= gReader.count)
+        return 0;
+
+    size_t size = gReader.chunks[gReader.next++];
+    if (size > bytes)
+        size = bytes;
+    memcpy(data, gReader.data + gReader.offset, size);
+    gReader.offset += size;
+    return (SSIZE_T)size;
+}
+
+/// 简化的 PDU 头：2 字节大端长度 (含头)
+static SSIZE_T scriptedParsePdu(rdpTransport* transport, wStream* s, BOOL* incomplete) {
+    size_t position = Stream_GetPosition(s);
+    if (position < 2) {
+        *incomplete = TRUE;
+        return 0;
+    }
+    const BYTE* header = Stream_Buffer(s);
+    *incomplete = FALSE;
+    return ((SSIZE_T)header[0] << 8) | header[1];
+}
+
+@interface TransportReadPduTests : XCTestCase
+@end
+
+@implementation TransportReadPduTests
+
+- (void)setUp {
+    memset(&gReader, 0, sizeof(gReader));
+}
+
+- (void)testPartialBodyThenCompletion {
+    static const BYTE pdu[10] = { 0x00, 0x0A, 1, 2, 3, 4, 5, 6, 7, 8 };
+    gReader.data = pdu;
+    gReader.chunks[0] = 2;  // 头
+    gReader.chunks[1] = 3;  // 体的前 3 字节
+    gReader.count = 2;
+
+    wStream* s = Stream_New(NULL, 4);
+    XCTAssertTrue(s != NULL);
+
+    // 头和部分体：数据未到齐，已读部分保留在流中
+    int status = viDesk_transportReadPooledPdu(NULL, s, scriptedParsePdu, scriptedReadBytes);
+    XCTAssertEqual(status, 0);
+    XCTAssertEqual(Stream_GetPosition(s), (size_t)5);
+
+    // 剩余的体到达
+    gReader.chunks[2] = 5;
+    gReader.count = 3;
+    status = viDesk_transportReadPooledPdu(NULL, s, scriptedParsePdu, scriptedReadBytes);
+    XCTAssertEqual(status, 10);
+    XCTAssertEqual(Stream_Length(s), (size_t)10);
+    XCTAssertEqual(Stream_GetPosition(s), (size_t)0);
+    XCTAssertEqual(memcmp(Stream_Buffer(s), pdu, sizeof(pdu)), 0);
+    XCTAssertEqual(gReader.calls, (size_t)3);
+
+    Stream_Free(s, TRUE);
+}
+
+- (void)testHeaderSplitAcrossReads {
+    static const BYTE pdu[4] = { 0x00, 0x04, 0xAB, 0xCD };
+    gReader.data = pdu;
+    gReader.chunks[0] = 1;  // 头只到了 1 字节
+    gReader.count = 1;
+
+    wStream* s = Stream_New(NULL, 16);
+    XCTAssertTrue(s != NULL);
+
+    int status = viDesk_transportReadPooledPdu(NULL, s, scriptedParsePdu, scriptedReadBytes);
+    XCTAssertEqual(status, 0);
+    XCTAssertEqual(Stream_GetPosition(s), (size_t)1);
+
+    gReader.chunks[1] = 1;
+    gReader.chunks[2] = 2;
+    gReader.count = 3;
+    status = viDesk_transportReadPooledPdu(NULL, s, scriptedParsePdu, scriptedReadBytes);
+    XCTAssertEqual(status, 4);
+    XCTAssertEqual(Stream_Length(s), (size_t)4);
+    XCTAssertEqual(Stream_GetPosition(s), (size_t)0);
+
+    Stream_Free(s, TRUE);
+}
+
+- (void)testReadErrorPropagates {
+    wStream* s = Stream_New(NULL, 16);
+    XCTAssertTrue(s != NULL);
+
+    int status = viDesk_transportReadPooledPdu(NULL, s, scriptedParsePdu, NULL);
+    XCTAssertEqual(status, -1);
+
+    Stream_Free(s, TRUE);
+}
+
+@end